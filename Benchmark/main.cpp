@@ -0,0 +1,372 @@
+#include <Cutlass.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Cutlass;
+
+//ヘッドレスで各処理の速度を計測し, 結果をJSONで出力する
+//使い方 : cutlass_bench [--objects N] [--iterations N] [--out path]
+
+namespace
+{
+    //SimpleSampleのTexturedCubeと同じレイアウト
+    struct Vertex
+    {
+        float pos[3];
+        float color[3];
+        float normal[3];
+        float UV[2];
+    };
+
+    struct Uniform
+    {
+        float world[16];
+        float view[16];
+        float proj[16];
+        float lightDirection[4];
+    };
+
+    struct Config
+    {
+        uint32_t objects    = 1000;
+        uint32_t iterations = 100;
+        uint32_t width      = 512;
+        uint32_t height     = 512;
+        std::string outPath;
+    };
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    template <typename F>
+    double measureMs(F&& f)
+    {
+        const auto begin = Clock::now();
+        f();
+        return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    }
+
+    void check(Result result, const char* what)
+    {
+        if (Result::eSuccess != result)
+        {
+            std::cerr << "benchmark failed : " << what << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    bool parseArgs(int argc, char** argv, Config& config_out)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const bool hasValue = i + 1 < argc;
+            if (!std::strcmp(argv[i], "--objects") && hasValue)
+                config_out.objects = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (!std::strcmp(argv[i], "--iterations") && hasValue)
+                config_out.iterations = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (!std::strcmp(argv[i], "--out") && hasValue)
+                config_out.outPath = argv[++i];
+            else
+                return false;
+        }
+
+        return config_out.objects > 0 && config_out.iterations > 0;
+    }
+
+    //立方体
+    void makeCube(std::vector<Vertex>& vertices_out, std::vector<uint32_t>& indices_out)
+    {
+        const float k = 1.f;
+        const float normals[6][3] = {{0, 0, 1.f}, {1.f, 0, 0}, {-1.f, 0, 0}, {0, 0, -1.f}, {0, 1.f, 0}, {0, -1.f, 0}};
+
+        vertices_out.clear();
+        indices_out.clear();
+        for (uint32_t face = 0; face < 6; ++face)
+        {
+            const float* n = normals[face];
+            //法線に垂直な2軸
+            const float u[3] = {n[1] + n[2], n[0], 0};
+            const float v[3] = {0, n[2], n[0] + n[1]};
+
+            for (uint32_t corner = 0; corner < 4; ++corner)
+            {
+                const float su = corner & 1 ? k : -k;
+                const float sv = corner & 2 ? k : -k;
+
+                Vertex vertex{};
+                for (uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    vertex.pos[axis]    = n[axis] * k + u[axis] * su + v[axis] * sv;
+                    vertex.color[axis]  = 1.f;
+                    vertex.normal[axis] = n[axis];
+                }
+                vertex.UV[0] = corner & 1 ? 1.f : 0.f;
+                vertex.UV[1] = corner & 2 ? 1.f : 0.f;
+                vertices_out.emplace_back(vertex);
+            }
+
+            const uint32_t base = face * 4;
+            for (const uint32_t i : {0u, 2u, 1u, 1u, 2u, 3u})
+                indices_out.emplace_back(base + i);
+        }
+    }
+
+    class JsonWriter
+    {
+    public:
+        void add(const std::string& key, double value)
+        {
+            mResults.emplace_back(key, value);
+        }
+
+        std::string str(const Config& config) const
+        {
+            std::ostringstream oss;
+            oss << "{\n";
+            oss << "  \"config\": {\"objects\": " << config.objects
+                << ", \"iterations\": " << config.iterations
+                << ", \"width\": " << config.width
+                << ", \"height\": " << config.height
+                << ", \"headless\": true},\n";
+            oss << "  \"results\": {\n";
+            for (size_t i = 0; i < mResults.size(); ++i)
+            {
+                oss << "    \"" << mResults[i].first << "\": " << mResults[i].second;
+                oss << (i + 1 < mResults.size() ? ",\n" : "\n");
+            }
+            oss << "  }\n";
+            oss << "}\n";
+
+            return oss.str();
+        }
+
+    private:
+        std::vector<std::pair<std::string, double>> mResults;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    if (!parseArgs(argc, argv, config))
+    {
+        std::cerr << "usage : cutlass_bench [--objects N] [--iterations N] [--out path]\n";
+        return EXIT_FAILURE;
+    }
+
+    JsonWriter json;
+
+    Context context;
+    check(context.initialize("cutlass_bench", false, true), "initialize");
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    makeCube(vertices, indices);
+
+    HBuffer vertexBuffer, indexBuffer, uniformBuffer;
+    {
+        BufferInfo bi;
+        bi.setVertexBuffer<Vertex>(vertices.size());
+        check(context.createBuffer(bi, vertexBuffer), "create vertex buffer");
+        check(context.writeBuffer(bi.size, vertices.data(), vertexBuffer), "write vertex buffer");
+
+        bi.setIndexBuffer<uint32_t>(indices.size());
+        check(context.createBuffer(bi, indexBuffer), "create index buffer");
+        check(context.writeBuffer(bi.size, indices.data(), indexBuffer), "write index buffer");
+
+        Uniform uniform{};
+        for (uint32_t i = 0; i < 4; ++i)
+            uniform.world[i * 5] = uniform.view[i * 5] = uniform.proj[i * 5] = 1.f;
+        bi.setUniformBuffer<Uniform>();
+        check(context.createBuffer(bi, uniformBuffer), "create uniform buffer");
+        check(context.writeBuffer(bi.size, &uniform, uniformBuffer), "write uniform buffer");
+    }
+
+    {//writeBuffer, writeTextureのスループット(デバイスローカルへのステージング転送)
+        constexpr size_t bufferSize = 16ull * 1024 * 1024;
+        std::vector<uint8_t> data(bufferSize, 0x7f);
+
+        HBuffer buffer;
+        check(context.createBuffer(BufferInfo(bufferSize, BufferUsage::eVertex, false), buffer), "create upload buffer");
+        const double ms = measureMs([&]
+        {
+            for (uint32_t i = 0; i < config.iterations; ++i)
+                check(context.writeBuffer(bufferSize, data.data(), buffer), "writeBuffer");
+        });
+        json.add("write_buffer_mb_per_sec", bufferSize * config.iterations / (1024. * 1024.) / (ms / 1000.));
+        context.destroyBuffer(buffer);
+
+        constexpr uint32_t textureSize = 1024;
+        TextureInfo ti;
+        ti.setSRTex2D(textureSize, textureSize, true);
+        HTexture texture;
+        check(context.createTexture(ti, texture), "create upload texture");
+        const double texMs = measureMs([&]
+        {
+            for (uint32_t i = 0; i < config.iterations; ++i)
+                check(context.writeTexture(data.data(), texture), "writeTexture");
+        });
+        json.add("write_texture_mb_per_sec", textureSize * textureSize * 4. * config.iterations / (1024. * 1024.) / (texMs / 1000.));
+        context.destroyTexture(texture);
+    }
+
+    HTexture texture, colorTarget, depthTarget;
+    {
+        std::vector<uint8_t> pixels(64 * 64 * 4, 0xff);
+        TextureInfo ti;
+        ti.setSRTex2D(64, 64, true);
+        check(context.createTexture(ti, texture), "create texture");
+        check(context.writeTexture(pixels.data(), texture), "write texture");
+
+        ti.setRTTex2DColor(config.width, config.height);
+        check(context.createTexture(ti, colorTarget), "create color target");
+        ti.setRTTex2DDepth(config.width, config.height);
+        check(context.createTexture(ti, depthTarget), "create depth target");
+    }
+
+    HRenderPass renderPass;
+    check(context.createRenderPass(RenderPassInfo(colorTarget, depthTarget), renderPass), "create render pass");
+
+    HGraphicsPipeline pipeline;
+    {//パイプライン作成(初回と, ドライバのキャッシュが効く2回目以降)
+        const std::string dir(CUTLASS_BENCH_SHADER_DIR);
+        const Shader VS(dir + "/TexturedCube/vert.spv", "main");
+        const Shader FS(dir + "/TexturedCube/frag.spv", "main");
+        const GraphicsPipelineInfo gpi(VS, FS, renderPass, DepthStencilState::eDepth,
+                                       RasterizerState(PolygonMode::eFill, CullMode::eBack, FrontFace::eClockwise));
+
+        json.add("pipeline_create_cold_ms", measureMs([&] { check(context.createGraphicsPipeline(gpi, pipeline), "create pipeline"); }));
+
+        double warmMs = 0;
+        for (uint32_t i = 0; i < config.iterations; ++i)
+        {
+            HGraphicsPipeline warm;
+            warmMs += measureMs([&] { check(context.createGraphicsPipeline(gpi, warm), "create pipeline"); });
+            context.destroyGraphicsPipeline(warm);
+        }
+        json.add("pipeline_create_cached_ms", warmMs / config.iterations);
+    }
+
+    ShaderResourceSet SRSet;
+    SRSet.bind(0, uniformBuffer);
+    SRSet.bind(1, texture);
+
+    //オブジェクト毎にリソースセットをbindするかどうか
+    const auto recordScene = [&](CommandList& commandList, bool bindPerObject)
+    {
+        commandList.clear();
+        commandList.begin(renderPass, true);
+        commandList.bind(pipeline);
+        commandList.bind(vertexBuffer, indexBuffer);
+        commandList.bind(0, SRSet);
+        for (uint32_t i = 0; i < config.objects; ++i)
+        {
+            if (bindPerObject && i > 0)
+                commandList.bind(0, SRSet);
+            commandList.renderIndexed(static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+        }
+        commandList.end();
+    };
+
+    {//コマンドリストの記録(CPUのみ)
+        CommandList commandList;
+        const double ms = measureMs([&]
+        {
+            for (uint32_t i = 0; i < config.iterations; ++i)
+                recordScene(commandList, false);
+        });
+        json.add("command_list_record_per_sec", config.iterations / (ms / 1000.));
+        json.add("command_record_ns_per_draw", ms * 1e6 / (double(config.iterations) * config.objects));
+    }
+
+    CommandList sceneList;
+    recordScene(sceneList, false);
+
+    HCommandBuffer commandBuffer;
+    {//コマンドバッファの作成・更新
+        double createMs = 0;
+        for (uint32_t i = 0; i < config.iterations; ++i)
+        {
+            HCommandBuffer cb;
+            createMs += measureMs([&] { check(context.createCommandBuffer(sceneList, cb), "createCommandBuffer"); });
+            context.destroyCommandBuffer(cb);
+        }
+        json.add("create_command_buffer_ms", createMs / config.iterations);
+
+        check(context.createCommandBuffer(sceneList, commandBuffer), "createCommandBuffer");
+        const double updateMs = measureMs([&]
+        {
+            for (uint32_t i = 0; i < config.iterations; ++i)
+                check(context.updateCommandBuffer(sceneList, commandBuffer), "updateCommandBuffer");
+        });
+        json.add("update_command_buffer_ms", updateMs / config.iterations);
+    }
+
+    {//ディスクリプタセットの確保(オブジェクト毎にbindした場合との差)
+        CommandList bindList;
+        recordScene(bindList, true);
+
+        double bindMs = 0, baseMs = 0;
+        for (uint32_t i = 0; i < config.iterations; ++i)
+        {
+            HCommandBuffer cb;
+            bindMs += measureMs([&] { check(context.createCommandBuffer(bindList, cb), "createCommandBuffer"); });
+            context.destroyCommandBuffer(cb);
+            baseMs += measureMs([&] { check(context.createCommandBuffer(sceneList, cb), "createCommandBuffer"); });
+            context.destroyCommandBuffer(cb);
+        }
+
+        const double perSetUs = (bindMs - baseMs) * 1000. / (double(config.iterations) * config.objects);
+        json.add("descriptor_set_alloc_us", perSetUs > 0 ? perSetUs : 0);
+    }
+
+    {//N個のオブジェクトの描画(GPUの完了までを含む)
+        //読み出しで同じキューのそれまでの描画の完了を待つ
+        const auto waitGPU = [&]
+        {
+            HReadback ticket;
+            const void* pData = nullptr;
+            size_t size       = 0;
+            check(context.readBuffer(uniformBuffer, ticket), "readBuffer");
+            check(context.getReadbackData(ticket, pData, size), "getReadbackData");
+            check(context.releaseReadback(ticket), "releaseReadback");
+        };
+
+        check(context.execute(commandBuffer), "execute");
+        waitGPU();
+
+        const double ms = measureMs([&]
+        {
+            for (uint32_t i = 0; i < config.iterations; ++i)
+                check(context.execute(commandBuffer), "execute");
+            waitGPU();
+        });
+        json.add("frames_per_sec", config.iterations / (ms / 1000.));
+        json.add("draws_per_sec", double(config.objects) * config.iterations / (ms / 1000.));
+    }
+
+    context.destroy();
+
+    const std::string result = json.str(config);
+    if (config.outPath.empty())
+        std::cout << result;
+    else
+    {
+        std::ofstream ofs(config.outPath);
+        ofs << result;
+        if (!ofs)
+        {
+            std::cerr << "failed to write result : " << config.outPath << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
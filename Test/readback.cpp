@@ -0,0 +1,116 @@
+#include <Cutlass.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace Cutlass;
+
+//読み出しリングのチケットを確保と異なる順で返しても, 残ったチケットの領域が上書きされないことを確認する
+
+namespace
+{
+    bool check(Result result, const char* what)
+    {
+        if (Result::eSuccess != result)
+            std::cerr << "test failed : " << what << "\n";
+        return Result::eSuccess == result;
+    }
+
+    bool fetch(Context& context, const HReadback& ticket, std::vector<uint8_t>& data_out)
+    {
+        const void* pData = nullptr;
+        size_t size       = 0;
+        if (!check(context.getReadbackData(ticket, pData, size), "getReadbackData"))
+            return false;
+
+        data_out.assign(static_cast<const uint8_t*>(pData), static_cast<const uint8_t*>(pData) + size);
+        return true;
+    }
+
+    bool createFilledBuffer(Context& context, const uint8_t value, HBuffer& handle_out)
+    {
+        BufferInfo bi(256, BufferUsage::eUniform, true);
+        const std::vector<uint8_t> data(bi.size, value);
+        return check(context.createBuffer(bi, handle_out), "createBuffer") &&
+               check(context.writeBuffer(bi.size, data.data(), handle_out), "writeBuffer");
+    }
+
+    bool releaseNewestFirst(Context& context, const HBuffer& a, const HBuffer& b)
+    {
+        HReadback oldest, middle, newest, next;
+        if (!check(context.readBuffer(a, oldest), "readBuffer") ||
+            !check(context.readBuffer(b, middle), "readBuffer") ||
+            !check(context.readBuffer(a, newest), "readBuffer"))
+            return false;
+
+        std::vector<uint8_t> expected, actual;
+        if (!fetch(context, oldest, expected))
+            return false;
+
+        if (!check(context.releaseReadback(newest), "releaseReadback") ||
+            !check(context.releaseReadback(middle), "releaseReadback") ||
+            !check(context.readBuffer(b, next), "readBuffer") ||
+            !fetch(context, next, actual) || !fetch(context, oldest, actual))
+            return false;
+
+        if (actual != expected)
+        {
+            std::cerr << "test failed : readback ring overlapped a live ticket\n";
+            return false;
+        }
+
+        return check(context.releaseReadback(oldest), "releaseReadback") &&
+               check(context.releaseReadback(next), "releaseReadback");
+    }
+
+    bool releaseMiddleFirst(Context& context, const HBuffer& a, const HBuffer& b)
+    {
+        HReadback first, second, third, next;
+        if (!check(context.readBuffer(a, first), "readBuffer") ||
+            !check(context.readBuffer(b, second), "readBuffer") ||
+            !check(context.readBuffer(a, third), "readBuffer"))
+            return false;
+
+        std::vector<uint8_t> expectedFirst, expectedThird, actual;
+        if (!fetch(context, first, expectedFirst) || !fetch(context, third, expectedThird))
+            return false;
+
+        if (!check(context.releaseReadback(second), "releaseReadback") ||
+            !check(context.readBuffer(b, next), "readBuffer") || !fetch(context, next, actual))
+            return false;
+
+        std::vector<uint8_t> actualFirst, actualThird;
+        if (!fetch(context, first, actualFirst) || !fetch(context, third, actualThird))
+            return false;
+
+        if (actualFirst != expectedFirst || actualThird != expectedThird)
+        {
+            std::cerr << "test failed : readback ring overlapped a live ticket\n";
+            return false;
+        }
+
+        return check(context.releaseReadback(first), "releaseReadback") &&
+               check(context.releaseReadback(third), "releaseReadback") &&
+               check(context.releaseReadback(next), "releaseReadback");
+    }
+}
+
+int main()
+{
+    Context context;
+    if (!check(context.initialize("cutlass_test_readback", false, true), "initialize"))
+        return EXIT_FAILURE;
+
+    HBuffer a, b;
+    bool passed = createFilledBuffer(context, 0xAA, a) && createFilledBuffer(context, 0x55, b);
+    passed      = passed && releaseNewestFirst(context, a, b);
+    passed      = passed && releaseMiddleFirst(context, a, b);
+
+    context.destroy();
+
+    if (passed)
+        std::cerr << "readback test passed\n";
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,112 @@
+#include <Cutlass.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace Cutlass;
+
+//RenderGraphのパス削除がGPUなしで期待どおりに動くことを確認する
+
+namespace
+{
+    HTexture makeTexture(const uint32_t id)
+    {
+        HTexture handle;
+        handle.setID(id);
+        return handle;
+    }
+
+    bool checkOrder(RenderGraph& graph, const std::vector<uint32_t>& expected, const char* what)
+    {
+        std::unordered_map<HTexture, std::pair<uint32_t, uint32_t>> lifetimes;
+        if (Result::eSuccess != graph.getTextureLifetimes(lifetimes))
+        {
+            std::cerr << "test failed : " << what << " (getTextureLifetimes)\n";
+            return false;
+        }
+
+        if (graph.getExecutionOrder() != expected)
+        {
+            std::cerr << "test failed : " << what << " (execution order :";
+            for (const auto& index : graph.getExecutionOrder())
+                std::cerr << " " << index;
+            std::cerr << ")\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    //読まれる前に全体を上書きされる書き込みは削除される
+    bool overwrittenProducerIsCulled()
+    {
+        const HTexture a   = makeTexture(1);
+        const HTexture out = makeTexture(2);
+
+        RenderGraph graph;
+        graph.addPass(RenderGraphPassInfo({}, {a}));     // 0 : overwritten by 1
+        graph.addPass(RenderGraphPassInfo({}, {a}));     // 1
+        graph.addPass(RenderGraphPassInfo({a}, {out}));  // 2
+        graph.markOutput(out);
+
+        return checkOrder(graph, {1, 2}, "overwritten producer") && graph.getCulledPassCount() == 1;
+    }
+
+    //以前の内容を読む書き込みは前の書き込みを残す
+    bool readModifyWriteKeepsProducer()
+    {
+        const HTexture a   = makeTexture(1);
+        const HTexture out = makeTexture(2);
+
+        RenderGraph graph;
+        graph.addPass(RenderGraphPassInfo({}, {a}));     // 0
+        graph.addPass(RenderGraphPassInfo({a}, {a}));    // 1 : reads the result of 0
+        graph.addPass(RenderGraphPassInfo({a}, {out}));  // 2
+        graph.markOutput(out);
+
+        return checkOrder(graph, {0, 1, 2}, "read-modify-write") && graph.getCulledPassCount() == 0;
+    }
+
+    //出力は最後の書き込みだけが残り, 出力に寄与しないパスも削除される
+    bool onlyLastOutputWriterIsKept()
+    {
+        const HTexture unused = makeTexture(1);
+        const HTexture out    = makeTexture(2);
+
+        RenderGraph graph;
+        graph.addPass(RenderGraphPassInfo({}, {out}));     // 0 : overwritten by 2
+        graph.addPass(RenderGraphPassInfo({}, {unused}));  // 1 : never read
+        graph.addPass(RenderGraphPassInfo({}, {out}));     // 2
+        graph.markOutput(out);
+
+        return checkOrder(graph, {2}, "last output writer") && graph.getCulledPassCount() == 2;
+    }
+
+    //深度は前の内容に対してテストされるので, 深度プリパスは残る
+    bool depthPrepassIsKept()
+    {
+        const HTexture depth = makeTexture(1);
+        const HTexture out   = makeTexture(2);
+
+        RenderGraph graph;
+        graph.addPass(RenderGraphPassInfo({}, {}, depth));     // 0 : depth prepass
+        graph.addPass(RenderGraphPassInfo({}, {out}, depth));  // 1
+        graph.markOutput(out);
+
+        return checkOrder(graph, {0, 1}, "depth prepass") && graph.getCulledPassCount() == 0;
+    }
+}
+
+int main()
+{
+    bool passed = overwrittenProducerIsCulled();
+    passed      = readModifyWriteKeepsProducer() && passed;
+    passed      = onlyLastOutputWriterIsKept() && passed;
+    passed      = depthPrepassIsKept() && passed;
+
+    if (passed)
+        std::cerr << "render graph test passed\n";
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.hpp"
+#include "TextureFile.hpp"
+#include "Utility.hpp"
+
+namespace Cutlass
+{
+    enum class AssetType : uint32_t
+    {
+        eTexture,
+        eVertexBuffer,
+        eIndexBuffer,
+        eShader,  // SPIR-V
+    };
+
+    //アセットパック内のエントリ, pDataはマップされたファイルを直接指す(AssetPackを閉じると無効)
+    struct AssetEntry
+    {
+        AssetType type;
+        const uint8_t* pData;
+        size_t size;
+        //以下テクスチャのみ
+        ResourceType format;
+        uint32_t width;
+        uint32_t height;
+        //レベル0から順に並ぶ, offsetはpDataの先頭から
+        std::vector<TextureFile::MipLevel> mipLevels;
+    };
+
+    //前処理済みのアセットを1ファイルにまとめたもの(インデックス + アラインされたデータ)
+    //ファイルはメモリにマップされ, データはマップから直接ステージングバッファにコピーされる
+    class AssetPack
+    {
+    public:
+        AssetPack();
+        AssetPack(std::string_view path);
+        ~AssetPack();
+
+        AssetPack(const AssetPack&)            = delete;
+        AssetPack& operator=(const AssetPack&) = delete;
+
+        Result open(std::string_view path);
+        void close();
+
+        bool isOpened() const;
+        Result find(std::string_view name, AssetEntry& entry_out) const;
+        std::vector<std::string> getNames() const;
+
+        //SPIR-Vをマップから読み込む
+        Result loadShader(std::string_view name, Shader& shader_out, std::string_view entryPoint = "") const;
+
+        constexpr static uint32_t version = 1;
+        //各データの先頭のアラインメント
+        constexpr static size_t blobAlignment = 256;
+
+    private:
+        std::string mPath;
+        const uint8_t* mpMapped;
+        size_t mMappedSize;
+#ifdef _WIN32
+        void* mFile;
+        void* mMapping;
+#else
+        int mFd;
+#endif
+        std::unordered_map<std::string, AssetEntry> mEntries;
+    };
+
+    //アセットパックを書き出す(オフラインでの変換用)
+    class AssetPackWriter
+    {
+    public:
+        //ミップチェーンを含むKTX2, DDSをそのまま格納する
+        Result addTexture(std::string_view name, const TextureFile& file);
+        Result addBuffer(std::string_view name, const AssetType type, const void* pData, const size_t size);
+        Result addShader(std::string_view name, const Shader& shader);
+
+        Result write(std::string_view path) const;
+
+    private:
+        struct Blob
+        {
+            std::string name;
+            AssetType type;
+            ResourceType format;
+            uint32_t width;
+            uint32_t height;
+            uint32_t mipLevels;
+            std::vector<uint8_t> data;
+        };
+
+        inline Result addBlob(Blob&& blob);
+
+        std::vector<Blob> mBlobs;
+    };
+}
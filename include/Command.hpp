@@ -2,9 +2,12 @@
 
 #include <optional>
 #include <queue>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <variant>
 
+#include "ComputePipeline.hpp"
 #include "GraphicsPipeline.hpp"
 #include "Utility.hpp"
 
@@ -13,6 +16,13 @@ namespace Cutlass
     using ColorClearValue = std::array<float, 4>;
     using DepthClearValue = std::tuple<float, uint32_t>;
 
+    //コマンドを実行するキュー
+    enum class QueueType
+    {
+        eGraphics,
+        eCompute,  //非同期コンピュート(専用キューが無ければグラフィックスキューで実行)
+    };
+
     //struct CmdBeginRenderPass
     // {
     //     HRenderPass RPHandle;
@@ -34,10 +44,19 @@ namespace Cutlass
         HGraphicsPipeline handle;
     };
 
+    struct CmdBindComputePipeline
+    {
+        HComputePipeline handle;
+    };
+
     struct CmdEnd
     {
     };
 
+    struct CmdNextSubpass
+    {
+    };
+
     struct CmdPresent
     {
     };
@@ -100,11 +119,47 @@ namespace Cutlass
         HTexture handle;
     };
 
+    //テクスチャへのアクセス方法(レイアウト, ステージ, アクセスマスクを決定する)
+    enum class TextureAccess
+    {
+        eUndefined,  //以前の内容は破棄される
+        eColorAttachment,
+        eDepthAttachment,
+        eShaderRead,
+        eStorage,
+    };
+
+    struct CmdTransition
+    {
+        HTexture handle;
+        TextureAccess src;
+        TextureAccess dst;
+        //srcがeUndefinedの場合に, 同じメモリを直前に使用していたテクスチャのアクセス(エイリアスの受け渡し)
+        TextureAccess discarded = TextureAccess::eUndefined;
+    };
+
     struct CmdExecuteSubCommand
     {
         HCommandBuffer handle;
     };
 
+    struct CmdDispatch
+    {
+        uint32_t groupCountX;
+        uint32_t groupCountY;
+        uint32_t groupCountZ;
+    };
+
+    //GPUプロファイラで計測する区間(名前は計測結果に使われる)
+    struct CmdBeginScope
+    {
+        std::string name;
+    };
+
+    struct CmdEndScope
+    {
+    };
+
     enum class CommandType
     {
         eBegin,
@@ -119,6 +174,12 @@ namespace Cutlass
         eRenderImGui,
         eBarrier,
         eExecuteSubCommand,
+        eBindComputePipeline,
+        eDispatch,
+        eTransition,
+        eNextSubpass,
+        eBeginScope,
+        eEndScope,
     };
 
     using CommandInfoVariant = std::variant<
@@ -133,7 +194,13 @@ namespace Cutlass
         CmdRender,
         CmdRenderImGui,
         CmdBarrier,
-        CmdExecuteSubCommand>;
+        CmdExecuteSubCommand,
+        CmdBindComputePipeline,
+        CmdDispatch,
+        CmdTransition,
+        CmdNextSubpass,
+        CmdBeginScope,
+        CmdEndScope>;
 
     using InternalCommandList = std::vector<std::pair<CommandType, CommandInfoVariant>>;
 
@@ -197,13 +264,20 @@ namespace Cutlass
     {
     public:
         CommandList()
-            : indexed(false), begun(false), graphicsPipeline(false), useSub(false), uniformBufferCount(0), combinedTextureCount(0)
+            : indexed(false), begun(false), graphicsPipeline(false), computePipeline(false), useSub(false), uniformBufferCount(0), combinedTextureCount(0), queueType(QueueType::eGraphics)
+        {
+        }
+
+        CommandList(const QueueType queueType)
+            : indexed(false), begun(false), graphicsPipeline(false), computePipeline(false), useSub(false), uniformBufferCount(0), combinedTextureCount(0), queueType(queueType)
         {
         }
 
         void begin(const HRenderPass& handle, bool clearFlag, const ColorClearValue ccv = {0.2f, 0.2f, 0.2f, 1.f}, const DepthClearValue dcv = {1.f, 0});
         void begin(const HRenderPass& handle, const DepthClearValue dcv = {1.f, 0}, const ColorClearValue ccv = {0.2f, 0.2f, 0.2f, 1.f});
         void end(bool presentIfRenderedFrameBuffer = true);
+        //複数のサブパスを持つレンダーパスで次のサブパスへ進む(パイプラインは再度bindする)
+        void nextSubpass();
 
         //void present();
         //void bindGraphicsPipeline(const HGraphicsPipeline& handle);
@@ -213,6 +287,8 @@ namespace Cutlass
         // void bindShaderResourceSet(const uint32_t set, const ShaderResourceSet &shaderResourceSet);
 
         void bind(const HGraphicsPipeline& handle);
+        //compute queue only
+        void bind(const HComputePipeline& handle);
 
         //bind vertex buffer only
         void bind(const HBuffer& VBHandle);
@@ -224,6 +300,9 @@ namespace Cutlass
         //option
         void bindIndexBuffer(const HBuffer& IBHandle);
 
+        //compute queue only
+        void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+
         void renderIndexed(
             uint32_t indexCount,         
             uint32_t instanceCount = 1,
@@ -241,9 +320,16 @@ namespace Cutlass
         void renderImGui();
 
         void barrier(const HTexture& handle);
+        //明示的なレイアウト遷移(RenderGraphが使用する), レンダーパスの外でのみ有効
+        void transition(const HTexture& handle, const TextureAccess src, const TextureAccess dst,
+                        const TextureAccess discarded = TextureAccess::eUndefined);
 
         void executeSubCommand(const HCommandBuffer& handle);
 
+        //GPUプロファイラの計測区間(入れ子にできる, レンダーパスは自動で計測される)
+        void beginScope(std::string_view name);
+        void endScope();
+
         void append(CommandList& commandList);
 
         void clear();
@@ -256,13 +342,17 @@ namespace Cutlass
 
         uint32_t getCombinedTextureCount() const;
 
+        QueueType getQueueType() const;
+
     private:
         InternalCommandList mCommands;
         bool indexed;
         bool begun;
         bool graphicsPipeline;
+        bool computePipeline;
         bool useSub;
         uint32_t uniformBufferCount;
         uint32_t combinedTextureCount;
+        QueueType queueType;
     };
 }  // namespace Cutlass
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Utility.hpp"
+
+#include "Shader.hpp"
+
+namespace Cutlass
+{
+    struct ComputePipelineInfo
+    {
+        ComputePipelineInfo()
+        {
+        }
+
+        ComputePipelineInfo(const Shader& CS)
+            : CS(CS)
+        {
+        }
+
+        Shader CS;
+    };
+}  // namespace Cutlass
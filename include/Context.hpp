@@ -7,18 +7,26 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include <array>
+#include <chrono>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "AssetPack.hpp"
 #include "Buffer.hpp"
 #include "Command.hpp"
+#include "ComputePipeline.hpp"
 #include "Event.hpp"
 #include "GraphicsPipeline.hpp"
+#include "RenderGraph.hpp"
 #include "RenderPass.hpp"
 #include "Texture.hpp"
+#include "TextureFile.hpp"
+#include "Trace.hpp"
 #include "ThirdParty/imgui.h"
 #include "ThirdParty/imgui_impl_glfw.h"
 #include "ThirdParty/imgui_impl_vulkan.h"
@@ -30,17 +38,34 @@ namespace Cutlass
     //{major, minor, patch}
     constexpr uint8_t version[3] = {0, 8, 1};
 
+    //スワップチェーンの表示モード(非対応の場合はeMailbox, eFIFORelaxed -> eFIFO, eImmediate -> eMailbox -> eFIFOの順に代替される)
+    enum class PresentMode
+    {
+        eFIFO,         //垂直同期
+        eFIFORelaxed,  //垂直同期, 間に合わなかったフレームは即座に表示(ティアリングあり)
+        eMailbox,      //垂直同期, 最新のフレームで待機中のフレームを置き換える(ティアリングなし・低遅延)
+        eImmediate,    //垂直同期なし
+    };
+
+    //フレームのペーシング
+    enum class FramePacing
+    {
+        eNone,
+        //updateInputで次の表示に間に合う直前まで待機してから入力を取得する(入力から表示までの遅延を最小化)
+        eJustInTime,
+    };
+
     struct WindowInfo
     {
         WindowInfo() {}
 
-        WindowInfo(const uint32_t width, const uint32_t height, const uint32_t frameCount, const std::string& windowName, bool fullScreen = false, bool vsync = true, bool useImGui = true)
-            : width(width), height(height), frameCount(frameCount), windowName(windowName), vsync(vsync), fullScreen(fullScreen), useImGui(useImGui)
+        WindowInfo(const uint32_t width, const uint32_t height, const uint32_t frameCount, const std::string& windowName, bool fullScreen = false, bool vsync = true, bool useImGui = true, bool resizable = true)
+            : width(width), height(height), frameCount(frameCount), windowName(windowName), vsync(vsync), fullScreen(fullScreen), useImGui(useImGui), resizable(resizable)
         {
         }
 
-        WindowInfo(const uint32_t width, const uint32_t height, const uint32_t frameCount, const char* windowName, bool fullScreen = false, bool vsync = true, bool useImGui = true)
-            : width(width), height(height), frameCount(frameCount), windowName(std::string(windowName)), vsync(vsync), fullScreen(fullScreen), useImGui(useImGui)
+        WindowInfo(const uint32_t width, const uint32_t height, const uint32_t frameCount, const char* windowName, bool fullScreen = false, bool vsync = true, bool useImGui = true, bool resizable = true)
+            : width(width), height(height), frameCount(frameCount), windowName(std::string(windowName)), vsync(vsync), fullScreen(fullScreen), useImGui(useImGui), resizable(resizable)
         {
         }
 
@@ -51,13 +76,136 @@ namespace Cutlass
         bool vsync;
         bool fullScreen;
         bool useImGui;
+        //サイズ変更時はスワップチェーン, 深度バッファ, フレームバッファが作り直され, コマンドバッファは次の実行時に再記録される
+        bool resizable = true;
+        //未指定ならvsyncによりeFIFOかeImmediate
+        std::optional<PresentMode> presentMode = std::nullopt;
+        //同時に処理するフレーム数(1~frameCount, 0ならframeCount - 1), frameCountはスワップチェーンのイメージ数
+        uint32_t framesInFlight = 0;
+        FramePacing framePacing = FramePacing::eNone;
+    };
+
+    //転送キューによるアップロードの統計
+    struct UploadStats
+    {
+        UploadStats()
+            : uploadCount(0), uploadedBytes(0), totalSeconds(0), dedicatedTransferQueue(false)
+        {
+        }
+
+        //アップロードのスループット(MB/s)
+        double getThroughput() const
+        {
+            return totalSeconds > 0 ? uploadedBytes / (1024. * 1024.) / totalSeconds : 0;
+        }
+
+        uint64_t uploadCount;
+        uint64_t uploadedBytes;
+        double totalSeconds;
+        //グラフィックスキューとは別の転送専用キューを使用しているか
+        bool dedicatedTransferQueue;
+    };
+
+    //GPUのタイムスタンプで計測した区間の時間
+    struct GPUTiming
+    {
+        //レンダーパスは"render pass <ハンドルのID>", それ以外はCommandList::beginScopeで指定した名前
+        std::string name;
+        //入れ子の深さ(最も外側が0)
+        uint32_t depth;
+        double milliseconds;
+    };
+
+    //パイプライン統計クエリの結果(レンダーパス毎)
+    struct PipelineStatistics
+    {
+        std::string name;
+        uint64_t inputAssemblyVertices;
+        uint64_t inputAssemblyPrimitives;
+        uint64_t vertexShaderInvocations;
+        uint64_t clippingInvocations;
+        uint64_t clippingPrimitives;
+        uint64_t fragmentShaderInvocations;
+    };
+
+    //CPU側で数えた1フレーム分の処理の回数
+    struct FrameStats
+    {
+        FrameStats()
+            : drawCount(0), dispatchCount(0), pipelineBindCount(0), bufferBindCount(0), descriptorSetBindCount(0), barrierCount(0), descriptorSetAllocCount(0), submitCount(0), uploadedBytes(0)
+        {
+        }
+
+        FrameStats& operator+=(const FrameStats& other)
+        {
+            drawCount += other.drawCount;
+            dispatchCount += other.dispatchCount;
+            pipelineBindCount += other.pipelineBindCount;
+            bufferBindCount += other.bufferBindCount;
+            descriptorSetBindCount += other.descriptorSetBindCount;
+            barrierCount += other.barrierCount;
+            descriptorSetAllocCount += other.descriptorSetAllocCount;
+            submitCount += other.submitCount;
+            uploadedBytes += other.uploadedBytes;
+            return *this;
+        }
+
+        //以下は実行したコマンドバッファに記録されていた数
+        uint64_t drawCount;
+        uint64_t dispatchCount;
+        uint64_t pipelineBindCount;
+        //頂点・インデックスバッファ
+        uint64_t bufferBindCount;
+        uint64_t descriptorSetBindCount;
+        uint64_t barrierCount;
+        //コマンドバッファの作成・更新時に確保したディスクリプタセット
+        uint64_t descriptorSetAllocCount;
+        //executeによるキューへの発行
+        uint64_t submitCount;
+        //転送が完了したアップロード
+        uint64_t uploadedBytes;
+    };
+
+    //メモリヒープ毎の使用量と予算(byte)
+    struct MemoryHeapBudget
+    {
+        uint32_t heapIndex;
+        bool deviceLocal;
+        uint64_t size;
+        //VK_EXT_memory_budgetが無ければヒープの大きさの8割
+        uint64_t budget;
+        //プロセス全体の使用量(VK_EXT_memory_budgetが無ければallocatedと同じ)
+        uint64_t usage;
+        //Contextが確保した量
+        uint64_t allocated;
+    };
+
+    //メモリタイプ毎にContextが確保した量
+    struct MemoryTypeUsage
+    {
+        uint32_t typeIndex;
+        uint32_t heapIndex;
+        //VkMemoryPropertyFlags
+        uint32_t propertyFlags;
+        uint64_t allocated;
+        uint32_t allocationCount;
+    };
+
+    struct MemoryBudgetReport
+    {
+        //VK_EXT_memory_budgetによる値
+        bool budgetSupported;
+        std::vector<MemoryHeapBudget> heaps;
+        std::vector<MemoryTypeUsage> types;
+        //デバイスローカルのヒープが予算に近いためにホストのメモリに確保した回数
+        uint32_t hostFallbackCount;
     };
 
     class Context
     {
     public:
         Context();
-        Context(std::string_view appName, bool debugFlag, Result& result_out);
+        Context(std::string_view appName, bool debugFlag, Result& result_out, bool headless = false);
 
         ~Context();
 
@@ -68,7 +216,10 @@ namespace Cutlass
         Context& operator=(Context&&) = delete;
 
         //明示的に初期化
-        Result initialize(std::string_view appName, bool debugFlag);
+        //headlessならGLFWとサーフェス関連の拡張を使用しない(ウィンドウは作成できず, テクスチャにのみ描画する)
+        Result initialize(std::string_view appName, bool debugFlag, bool headless = false);
+
+        bool isHeadless() const;
 
         //ウィンドウ作成・破棄
         Result createWindow(const WindowInfo& info, HWindow& handle_out);
@@ -89,13 +240,88 @@ namespace Cutlass
         Result destroyTexture(const HTexture& handle);
 
         //ファイルからテクスチャ作成
-        Result createTextureFromFile(const char* fileName, HTexture& handle_out);
+        //generateMipmapsがtrueならミップチェーンをGPU上で生成する
+        //.ktx2, .ddsはデコードせずに含まれるミップチェーンをそのまま使用する(generateMipmapsは無視される)
+        Result createTextureFromFile(const char* fileName, HTexture& handle_out, const bool generateMipmaps = true);
+
+        //複数のファイルからまとめてテクスチャを作成(handles_outはfileNamesと同じ順)
+        //デコードはスレッドプールで並列に行い, ステージングリングからバッチ単位で転送する
+        //失敗した場合は作成途中のテクスチャも破棄し, handles_outは空になる
+        Result createTexturesFromFiles(const std::vector<std::string>& fileNames, std::vector<HTexture>& handles_out, const bool generateMipmaps = true);
+
+        //読み込み済みのKTX2, DDSからシェーダリソースのテクスチャを作成
+        Result createTexture(const TextureFile& file, HTexture& handle_out);
+
+        //アセットパックのマップから直接転送して作成(テクスチャ, 頂点・インデックスバッファ)
+        //シェーダはAssetPack::loadShaderで読み込む
+        Result createTexture(const AssetPack& pack, std::string_view name, HTexture& handle_out);
+        Result createBuffer(const AssetPack& pack, std::string_view name, HBuffer& handle_out);
+
+        //サンプラ作成(同じ設定のサンプラは共有され, 既存のハンドルが返る)
+        //ShaderResourceSet::bindでテクスチャと組み合わせて使う, Contextの破棄時にまとめて破棄される
+        Result createSampler(const SamplerInfo& info, HSampler& handle_out);
 
         //テクスチャからサイズを取得する
         Result getTextureSize(const HTexture& handle, uint32_t& width_out, uint32_t& height_out, uint32_t& depth_out);
 
         //テクスチャにデータ書き込み(使用注意, 書き込むデータのサイズはテクスチャのサイズに従うもの以外危険)
+        //書き込むのはミップレベル0のみ, 下位のレベルはそこから生成される
         Result writeTexture(const void* const pData, const HTexture& handle);
+        //配列・キューブマップの1レイヤー(面)のみ書き込む(3Dテクスチャは全体を書き込む)
+        Result writeTexture(const void* const pData, const HTexture& handle, const uint32_t layer);
+
+        //GPUからの非同期読み出し(テクスチャはミップレベル0の全レイヤーを詰めて, バッファは全体をコピーする)
+        //グラフィックスキューでそれまでに発行した描画とコンピュートキューの処理の後にコピーされ, フレームの描画は待機しない
+        //ticket_outはコピーの完了後にgetReadbackDataで読め, 使い終わったらreleaseReadbackでリングに返す
+        Result readTexture(const HTexture& handle, HReadback& ticket_out);
+        Result readBuffer(const HBuffer& handle, HReadback& ticket_out);
+
+        //コピーが完了していればtrue(待機しない)
+        bool isReadbackReady(const HReadback& ticket) const;
+
+        //コピーの完了を待ってデータを取得する(pData_outはreleaseReadbackまで有効)
+        Result getReadbackData(const HReadback& ticket, const void*& pData_out, size_t& size_out);
+
+        //読み出し用リングの領域を解放する
+        Result releaseReadback(const HReadback& ticket);
+
+        //transientなテクスチャにメモリを割り当てる(createRenderPassより前に呼ぶ)
+        //graph内で生存期間が重ならないテクスチャは同じメモリを共有する
+        Result allocateTransientTextures(RenderGraph& graph);
+
+        //直近のallocateTransientTexturesでtransientなテクスチャが要求したメモリ量と実際に確保したメモリ量(byte)
+        Result getTransientMemorySize(size_t& requested_out, size_t& allocated_out) const;
+
+        //バッファ・テクスチャのアップロード統計を取得・リセット
+        Result getUploadStats(UploadStats& stats_out) const;
+        Result resetUploadStats();
+
+        //GPUのタイムスタンプによる計測, 有効にした後に作成・更新したコマンドバッファが対象
+        Result enableGPUProfiler(const bool enable);
+        //直近に完了した実行での各区間の時間(GPUの完了を待たないため数フレーム遅れて反映される)
+        Result getGPUTimings(const HCommandBuffer& handle, std::vector<GPUTiming>& timings_out);
+
+        //パイプライン統計クエリ(レンダーパス毎), 有効にした後に作成・更新したコマンドバッファが対象
+        Result enablePipelineStatistics(const bool enable);
+        Result getPipelineStatistics(const HCommandBuffer& handle, std::vector<PipelineStatistics>& statistics_out);
+
+        //直近のフレームの統計(ウィンドウへの表示毎に区切られる)
+        Result getFrameStats(FrameStats& stats_out) const;
+        //統計のフレームを区切る(ウィンドウに表示しない場合は毎フレーム呼ぶ)
+        Result markFrameEnd();
+
+        //フレーム時間, GPUプロファイラの区間, ヒープ毎のメモリ使用量, DescriptorPoolの使用状況, リソース数をImGuiで表示する
+        //ImGui::NewFrameとImGui::Renderの間で毎フレーム呼ぶ(ImGuiを使用するウィンドウが必要)
+        Result drawPerformanceOverlay(bool* pOpen = nullptr);
+
+        //ヒープ・メモリタイプ毎のメモリ使用量と予算
+        Result getMemoryBudget(MemoryBudgetReport& report_out);
+
+        //主要な処理のCPU区間とGPUプロファイラの区間をChrome trace形式で記録する(GPUプロファイラも有効になる)
+        //GPUの区間はCalibrated Timestampsが使えればCPUの時刻に揃えられる(使えなければ発行時刻を起点とする)
+        Result enableTrace(const bool enable);
+        //記録した区間を書き出して破棄する
+        Result writeTrace(std::string_view path);
 
         Result createRenderPass(const RenderPassInfo& info, HRenderPass& handle_out);
 
@@ -103,6 +329,10 @@ namespace Cutlass
         Result createGraphicsPipeline(const GraphicsPipelineInfo& info, HGraphicsPipeline& handle_out);
         Result destroyGraphicsPipeline(const HGraphicsPipeline& handle);
 
+        //コンピュートパイプライン構築
+        Result createComputePipeline(const ComputePipelineInfo& info, HComputePipeline& handle_out);
+        Result destroyComputePipeline(const HComputePipeline& handle);
+
         //描画コマンドバッファを作成
         Result createCommandBuffer(const std::vector<CommandList>& commandLists, HCommandBuffer& handle_out);
         Result createCommandBuffer(const CommandList& commandList, HCommandBuffer& handle_out);
@@ -124,22 +354,50 @@ namespace Cutlass
         Result updateSubCommandBuffer(const SubCommandList& subCommandList, const HCommandBuffer& handle);
 
         //現在処理中のフレームバッファのインデックスを取得(0~frameCount)
+        //オフスクリーンならRenderPassInfo::frameColorTargetsのうち直近に実行したフレームのインデックス
         uint32_t getFrameBufferIndex(const HRenderPass& handle) const;
 
         //コマンド実行, バックバッファ表示
+        //オフスクリーンではコマンドバッファ毎の前回の実行完了を待ち, 含まれる全てのレンダーパスのフレームを進める
         Result execute(const HCommandBuffer& handle);
+        //waitCommandBuffersの直近の実行完了を待ってから実行(キューを跨ぐ依存関係)
+        Result execute(const HCommandBuffer& handle, const std::vector<HCommandBuffer>& waitCommandBuffers);
+        //複数のウィンドウに表示するコマンドバッファ(ウィンドウ毎に1つ)を, 全てのイメージを取得してから1回の送信で実行し,
+        //全てのスワップチェーンを1回のvkQueuePresentKHRで表示する(最小化中のウィンドウは飛ばされる)
+        Result executeWindows(const std::vector<HCommandBuffer>& handles, const std::vector<HCommandBuffer>& waitCommandBuffers = {});
+
+        //表示モードの変更(次の実行時にスワップチェーンが作り直される)
+        Result setPresentMode(const HWindow& handle, const PresentMode mode);
+        //実際に使用されている表示モード
+        Result getPresentMode(const HWindow& handle, PresentMode& mode_out) const;
+        Result setFramePacing(const HWindow& handle, const FramePacing pacing);
 
         //入出力インタフェース
         //各イベントを更新、毎フレーム呼ばないと入力は検知できません
-        Result updateInput() const;
+        //FramePacing::eJustInTimeのウィンドウがあれば, 直前のフレームの完了と次の表示に間に合う時刻まで待機してから更新する
+        //入力はウィンドウ毎にこの時点のスナップショットとなり, 以下の取得はスナップショットを読むだけ(ウィンドウ指定なしはフォーカスのあるウィンドウ)
+        Result updateInput();
 
-        //キー入力取得
+        //キー入力取得(押された瞬間か押され続けている)
         bool getKey(const Key& key) const;
         bool getKey(const HWindow& handle, const Key& key) const;
+        //押された瞬間・押され続けている・離された瞬間の区別
+        KeyState getKeyState(const Key& key) const;
+        KeyState getKeyState(const HWindow& handle, const Key& key) const;
 
         //マウス状態取得
-        Result getMousePos(double& x, double& y) const;  //第1ウィンドウが前提
+        Result getMousePos(double& x, double& y) const;
         Result getMousePos(const HWindow& handle, double& x, double& y) const;
+        //前のフレームからのカーソルの移動量
+        Result getMouseDelta(double& x, double& y) const;
+        Result getMouseDelta(const HWindow& handle, double& x, double& y) const;
+        //このフレームのスクロール量
+        Result getScroll(double& x, double& y) const;
+        Result getScroll(const HWindow& handle, double& x, double& y) const;
+
+        //このフレームに入力された文字(UTF-32)
+        Result getTextInput(std::u32string& text_out) const;
+        Result getTextInput(const HWindow& handle, std::u32string& text_out) const;
 
         //ウィンドウ終了通知(指定なしで全てのウィンドウの論理和)
         bool shouldClose() const;
@@ -170,6 +428,25 @@ namespace Cutlass
             uint32_t mMaxFrameNum;
             //同時処理可能なフレーム数
             uint32_t mMaxFrameInFlight;
+            //要求された表示モード(実際のモードはmPresentMode)
+            PresentMode mRequestedPresentMode;
+            //リサイズ・out of dateによりスワップチェーンの再作成が必要(最小化中は作成できない)
+            bool mNeedsRecreate = false;
+
+            //フレームのペーシング(時刻はTracer::nowのナノ秒, 間隔と時間は指数移動平均)
+            FramePacing mFramePacing = FramePacing::eNone;
+            uint64_t mFrameBeginNs   = 0;
+            uint64_t mLastPresentNs  = 0;
+            //次のフレームが表示される見込みの時刻(早く表示要求したフレームは次の垂直同期で表示されるとみなす)
+            uint64_t mNextPresentNs = 0;
+            double mPresentInterval = 0;
+            //フェンス・イメージ取得の待ち時間を除いたCPUの処理時間
+            double mFrameCPUTime = 0;
+            //直前に表示したフレームの描画完了を示すタイムラインセマフォの値
+            uint64_t mLastPresentedValue = 0;
+
+            //入力(GLFWのウィンドウのユーザーポインタから参照されるため, mWindowMapに追加した後のものを使う)
+            Event mEvent;
 
             // ImGui
             bool useImGui;
@@ -180,6 +457,9 @@ namespace Cutlass
             std::optional<VkBuffer> mBuffer;
             std::optional<VkDeviceMemory> mMemory;
             bool mIsHostVisible;
+            VkDeviceSize mSize = 0;
+            //グラフィックス・コンピュートキュー間で共有(所有権の移動を行わない)
+            bool mConcurrentSharing = false;
         };
 
         struct ImageObject
@@ -195,6 +475,54 @@ namespace Cutlass
             VkImageLayout currentLayout;
             VkExtent3D extent;
             VkImageSubresourceRange range;
+            //グラフィックス・コンピュートキュー間で共有(所有権の移動を行わない)
+            bool mConcurrentSharing = false;
+            //メモリ割り当てをallocateTransientTexturesまで遅延する
+            bool mIsTransient = false;
+            bool mIsSampled = true;
+            VkSampleCountFlagBits mSampleCount = VK_SAMPLE_COUNT_1_BIT;
+            uint32_t mMipLevels = 1;
+            //ブロック圧縮フォーマット(writeTextureでは書き込めない)
+            bool mIsCompressed = false;
+            Dimension mDimension = Dimension::e2D;
+            //配列・キューブマップのレイヤー数
+            uint32_t mArrayLayers = 1;
+        };
+
+        struct SamplerObject
+        {
+            SamplerInfo mInfo;
+            VkSampler mSampler;
+        };
+
+        //読み出しリング内の1回分のコピー
+        struct ReadbackObject
+        {
+            VkDeviceSize mOffset;
+            //リング内で占有する大きさ(アライメント済み)
+            VkDeviceSize mSize;
+            size_t mDataSize;
+            VkFence mFence;
+            VkCommandBuffer mCommand;
+            bool mIsInvalidated = false;
+        };
+
+        //GPUからの読み出し先(ホストから見えるメモリを永続的にマップする)
+        struct ReadbackRing
+        {
+            std::optional<VkBuffer> mBuffer;
+            std::optional<VkDeviceMemory> mMemory;
+            uint8_t* pMapped = nullptr;
+            VkDeviceSize mSize = 0;
+            VkDeviceSize mAlignment = 256;
+            bool mIsCoherent = true;
+        };
+
+        //transientテクスチャが共有するメモリ, テクスチャが全て破棄されると使われなくなる
+        struct TransientBlock
+        {
+            VkDeviceMemory mMemory;
+            std::vector<HTexture> mTextures;
         };
 
         struct RenderPassObject
@@ -209,13 +537,30 @@ namespace Cutlass
             uint32_t mTargetNum;
             bool mDepthTestEnable;
             bool mLoadPrevData;
-            //取得されたスワップチェーンイメージのインデックス、テクスチャレンダリングなどしているときは関係ない
+            //ウィンドウ描画の前段のサブパスで使用する中間ターゲット
+            std::vector<HTexture> mIntermediateTargets;
+            //各サブパスのカラーアタッチメント数(パイプラインのブレンド設定用)
+            std::vector<uint32_t> mSubpassColorCounts;
+            VkSampleCountFlagBits mSampleCount;
+            //内部で作成したマルチサンプルアタッチメント(カラーアタッチメントの順)
+            std::vector<HTexture> mMultiSampleTargets;
+            //取得されたスワップチェーンイメージのインデックス, オフスクリーンなら直近に実行したフレームのフレームバッファ
             uint32_t mFrameBufferIndex;
+            //オフスクリーンで同時に処理するフレーム数(ウィンドウはWindowObjectのものを使う)
+            uint32_t mFramesInFlight = 1;
+            //オフスクリーンのフレーム毎のカラーターゲット(空ならcolorTargetsを共有する)
+            std::vector<std::vector<HTexture>> mFrameColorTargets;
+            //ウィンドウのフレームバッファを作り直すためのアタッチメントの配置
+            std::vector<uint32_t> mColorAttachments;
+            std::vector<uint32_t> mResolveAttachments;
+            std::optional<uint32_t> mDepthAttachment;
+            uint32_t mAttachmentCount = 0;
 
             //同期オブジェクト, レンダリングの仕方によっては一部しか使用しない
-            std::vector<VkFence> mFences;
-            //フレーム同時処理用一時的格納場所
-            std::vector<VkFence> imagesInFlight;
+            //ウィンドウのフレーム毎に, 直近の実行完了時にグラフィックスのタイムラインセマフォに書き込まれる値
+            std::vector<uint64_t> mFrameSignalValues;
+            //スワップチェーンイメージ毎の, 直近に描画したフレームのタイムライン値
+            std::vector<uint64_t> imagesInFlight;
             std::vector<VkSemaphore> mRenderCompletedSems;
             std::vector<VkSemaphore> mPresentCompletedSems;
         };
@@ -229,6 +574,18 @@ namespace Cutlass
             std::optional<Shader> mFS;
             std::vector<size_t> mSetSizes;  //各DescriptorSetのbinding数
             HRenderPass mHRenderPass;
+            //ビューポート・シザーは動的ステートとしてバインド時に設定する(無ければレンダーパスの大きさ)
+            std::optional<VkViewport> mViewport;
+            std::optional<VkRect2D> mScissor;
+        };
+
+        struct ComputePipelineObject
+        {
+            std::optional<VkPipelineLayout> mPipelineLayout;
+            std::optional<VkPipeline> mPipeline;
+            std::vector<VkDescriptorSetLayout> mDescriptorSetLayouts;
+            std::optional<Shader> mCS;
+            std::vector<size_t> mSetSizes;  //各DescriptorSetのbinding数
         };
 
         // struct DescriptorPool
@@ -257,15 +614,49 @@ namespace Cutlass
             uint32_t combinedTextureCount;
         };
 
+        //タイムスタンプで計測する区間(クエリは開始が2 * i, 終了が2 * i + 1)
+        struct TimestampScope
+        {
+            std::string mName;
+            uint32_t mDepth;
+        };
+
+        //コマンドバッファ(フレーム)毎の計測用クエリ
+        struct ProfilerQuery
+        {
+            VkQueryPool mPool = VK_NULL_HANDLE;
+            uint32_t mQueryCount = 0;
+            std::vector<TimestampScope> mScopes;
+            //記録中に開いている区間
+            std::vector<uint32_t> mOpenScopes;
+            //発行済みで結果を取得していない
+            bool mPending = false;
+            //発行時のタイムラインセマフォの値(新しい結果の判定用)
+            uint64_t mSignalValue = 0;
+            //発行したCPUの時刻(トレースでGPUの時刻を揃えられない場合に使う)
+            uint64_t mSubmitNs = 0;
+
+            //パイプライン統計クエリ(レンダーパス毎に1つ)
+            VkQueryPool mStatisticsPool = VK_NULL_HANDLE;
+            uint32_t mStatisticsCount = 0;
+            std::vector<std::string> mStatisticsNames;
+            bool mStatisticsActive = false;
+
+            //記録したコマンドの数(実行毎にフレームの統計に加算する)
+            FrameStats mRecordedStats;
+        };
+
         struct CommandObject
         {
             CommandObject()
-                : mPresentFlag(false), mSubCommand(false), mDescriptorPoolIndex(0), mUBCount(0), mCTCount(0)
+                : mPresentFlag(false), mSubCommand(false), mDescriptorPoolIndex(0), mUBCount(0), mCTCount(0), mQueueType(QueueType::eGraphics), mExecuteIndex(0), mSignalValue(0)
             {
             }
 
             std::vector<VkCommandBuffer> mCommandBuffers;
             std::optional<HRenderPass> mHRenderPass;  //同じ内容を描画するウィンドウが複数ある場合
+            //記録された全てのレンダーパス(mHRenderPassは最後に開始したもの)
+            std::vector<HRenderPass> mHRenderPasses;
             std::optional<HGraphicsPipeline> mHGPO;
             std::vector<std::vector<std::optional<VkDescriptorSet>>> mDescriptorSets;
             // std::vector<HTexture> mBarrieredTextures;
@@ -274,9 +665,56 @@ namespace Cutlass
             bool mSubCommand;
             uint32_t mUBCount;
             uint32_t mCTCount;
+
+            //実行するキュー
+            QueueType mQueueType;
+            std::optional<HComputePipeline> mHCPO;
+            //コマンドバッファ毎の実行完了(オフスクリーンとコンピュートキュー用), mExecuteIndexは次に実行するコマンドバッファ
+            std::vector<VkFence> mFences;
+            uint32_t mExecuteIndex;
+            //直近の実行完了時にキューのタイムラインセマフォに書き込まれる値
+            uint64_t mSignalValue;
+            //記録中にストレージとしてGENERALへ移した画像と元のレイアウト(記録の最後に戻す)
+            std::vector<std::pair<HTexture, VkImageLayout>> mStorageLayouts;
+
+            //GPUプロファイラ用(プロファイラが無効なら空)
+            std::vector<ProfilerQuery> mProfilerQueries;
+            std::vector<GPUTiming> mGPUTimings;
+            std::vector<PipelineStatistics> mPipelineStatistics;
+            uint64_t mGPUTimingValue = 0;
+
+            //スワップチェーンの再作成後に再記録するためのコマンド
+            std::vector<CommandList> mCommandLists;
+            std::vector<SubCommandList> mSubCommandLists;
+            bool mNeedsRerecord = false;
+        };
+
+        //発行済みで完了を待っているアップロード
+        struct PendingUpload
+        {
+            VkFence fence;
+            std::optional<VkSemaphore> transferCompletedSem;
+            VkCommandBuffer transferCommand;
+            std::optional<VkCommandBuffer> acquireCommand;
+            size_t size;
+            std::chrono::high_resolution_clock::time_point begin;
         };
 
+        //createTexturesFromFilesのステージングリングの大きさ(半分ずつデコードと転送に交互に使う)
+        constexpr static VkDeviceSize stagingRingSize = 64ull * 1024 * 1024;
+        //読み出しリングの初期サイズ(これより大きな読み出しはチケットがなくなった時点で拡張する)
+        constexpr static VkDeviceSize readbackRingSize = 64ull * 1024 * 1024;
+        //予算に対してこの割合を超える確保はデバイスローカルのヒープから行わない
+        constexpr static double memoryBudgetThreshold = 0.9;
+        //FramePacing::eJustInTimeで見積もりに加える余裕(ns)と, 移動平均の重み
+        constexpr static uint64_t framePacingMarginNs = 2'000'000;
+        constexpr static double framePacingSmoothing  = 0.1;
+
         static inline Result checkVkResult(VkResult);
+        static inline VkAttachmentLoadOp convertLoadOp(const LoadOp op);
+        static inline VkAttachmentStoreOp convertStoreOp(const StoreOp op);
+        //サーフェス・スワップチェーンに関わる拡張(headlessでは有効にしない)
+        static inline bool isPresentationExtension(const char* extensionName);
         inline Result createInstance();
         inline Result selectPhysicalDevice();
         inline Result createDevice();
@@ -285,31 +723,148 @@ namespace Cutlass
 
         inline Result createSurface(WindowObject& wo);
         inline Result selectSurfaceFormat(WindowObject& wo, VkFormat format);
-        inline Result createSwapchain(WindowObject& wo, bool vsync);
+        inline Result createSwapchain(WindowObject& wo, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+        //サーフェスが対応する中から要求に最も近い表示モードを選ぶ
+        inline VkPresentModeKHR selectPresentMode(const WindowObject& wo, const PresentMode mode) const;
+        //FramePacing::eJustInTimeのウィンドウの次の表示に間に合う時刻まで待機する
+        inline Result waitFramePacing();
+        //モニタのリフレッシュ間隔(ns), 取得できなければ表示間隔の移動平均
+        inline double getRefreshPeriod(const WindowObject& wo) const;
         inline Result createSwapchainImages(WindowObject& wo);
+        //ウィンドウの大きさでスワップチェーン, 深度バッファ, 各レンダーパスのフレームバッファを作り直す
+        inline Result recreateSwapchain(const HWindow& handle);
+        inline Result recreateWindowTargets(RenderPassObject& rpo, const WindowObject& wo);
+        inline Result createWindowFramebuffers(RenderPassObject& rpo, const WindowObject& wo);
+        //ウィンドウのスワップチェーンイメージを取得する(リサイズ・最小化中で取得しなければacquired_outがfalse)
+        //waitNs_outはフェンスとイメージ取得の待ち時間, 取得後に失敗した場合もacquired_outはtrueになる
+        inline Result acquireWindowImage(const HCommandBuffer& handle, bool& acquired_out, uint64_t& waitNs_out);
+        //表示後のフレームペーシングの見積もりを更新する
+        inline void updateFramePacing(WindowObject& wo, const uint64_t waitNs, const uint64_t signalValue);
+        //グラフィックスキューのタイムラインセマフォがvalueに達するまで待つ(0なら待たない)
+        inline Result waitGraphicsTimeline(const uint64_t value);
+        //提出に失敗してリセットされたままのフェンスをシグナル状態で作り直す
+        inline Result restoreFence(VkFence& fence);
+        //保持しているコマンドで記録し直す
+        inline Result rerecordCommandBuffer(const HCommandBuffer& handle);
         inline Result createDepthBuffer(WindowObject& wo);
         inline Result setUpImGui(WindowObject& wo, RenderPassObject& rpo);
 
         inline Result searchGraphicsQueueIndex();
+        inline Result searchTransferQueueIndex();
+        inline Result searchComputeQueueIndex();
+        inline Result createTimelineSemaphores();
         inline uint32_t getMemoryTypeIndex(uint32_t requestBits, VkMemoryPropertyFlags requestProps) const;
+        //デバイスメモリの確保・解放(ヒープ毎の使用量を集計する)
+        inline VkResult allocateMemory(const VkMemoryAllocateInfo& ai, VkDeviceMemory& memory_out);
+        inline void freeMemory(const VkDeviceMemory memory);
+        //デバイスローカルのヒープが予算に近ければキャッシュを解放し, それでも足りなければホストのメモリタイプを返す
+        inline uint32_t getBudgetedMemoryTypeIndex(uint32_t requestBits, VkMemoryPropertyFlags requestProps, const VkDeviceSize size);
+        inline void updateMemoryBudget();
+        //コンピュートキューが別ファミリならリソースを共有するキューファミリを返す(不要ならfalse)
+        inline bool getConcurrentQueueFamilies(std::vector<uint32_t>& families_out) const;
+        inline bool isNearBudget(const uint32_t heapIndex, const VkDeviceSize size) const;
+        //heapIndexのヒープから解放できるキャッシュ(テクスチャが全て破棄されたtransientメモリ, 使用中でない読み出しリング)を解放する
+        inline bool evictCachedMemory(const uint32_t heapIndex);
 
         inline Result createSyncObjects(RenderPassObject& rdsto);
+        //オフスクリーンのフレーム毎のフレームバッファを作成する(ivVecのカラーターゲットの位置をフレーム毎に差し替える)
+        inline Result createOffscreenFramebuffers(RenderPassObject& rpo, std::vector<VkImageView> ivVec, const std::vector<uint32_t>& resolveAttachments, VkFramebufferCreateInfo fbci);
+        inline const std::vector<HTexture>& getFrameColorTargets(const RenderPassObject& rpo, const size_t frameBufferIndex) const;
 
         inline Result createBuffer(const BufferInfo& info, const HBuffer& handle);
 
+        //転送キュー経由のアップロード
+        inline Result createStagingBuffer(const size_t size, const void* const pData, BufferObject& bo_out);
+        inline Result beginUploadCommand(VkCommandPool commandPool, VkCommandBuffer& command_out);
+        //acquireCommandはキューファミリが異なる場合の所有権取得用(グラフィックスキューで実行)
+        inline Result submitUploadCommand(VkCommandBuffer transferCommand, std::optional<VkCommandBuffer> acquireCommand, const size_t size);
+        //完了を待たずに発行する(waitUploadで完了待ちと解放を行う)
+        inline Result submitUploadCommandAsync(VkCommandBuffer transferCommand, std::optional<VkCommandBuffer> acquireCommand, const size_t size, PendingUpload& pending_out);
+        inline Result waitUpload(PendingUpload& pending);
+        inline void releaseUpload(PendingUpload& pending);
+
+        //前処理済み(圧縮フォーマットを含む)のミップチェーンからシェーダリソースのテクスチャを作成
+        inline Result createPackedTexture(const ResourceType format, const uint32_t width, const uint32_t height, const std::vector<TextureFile::MipLevel>& mipLevels, const void* const pData, const size_t size, HTexture& handle_out);
+        //stb_imageでデコードするテクスチャ用の画像, ビュー, サンプラを作成
+        inline Result createFileImageObject(const uint32_t width, const uint32_t height, const bool generateMipmaps, ImageObject& io_out);
+        static inline bool isCompressedTextureFile(const char* fileName);
+
         //描画パスをテクスチャから構築
         //描画対象オブジェクトをスワップチェインから構築
-        inline Result createRenderPass(const HWindow& handle, bool depthTestEnable, HRenderPass& handle_out);
+        inline Result createRenderPass(const HWindow& handle, bool depthTestEnable, const RenderPassInfo& info, HRenderPass& handle_out);
         //普通に構築
-        inline Result createRenderPass(const std::vector<HTexture>& colors, const bool loadPrevFrame, HRenderPass& handle_out);
-        inline Result createRenderPass(const std::vector<HTexture>& colors, const HTexture& depth, const bool loadPrevFrame, HRenderPass& handle_out);
+        inline Result createRenderPass(const std::vector<HTexture>& colors, const RenderPassInfo& info, HRenderPass& handle_out);
+        inline Result createRenderPass(const std::vector<HTexture>& colors, const HTexture& depth, const RenderPassInfo& info, HRenderPass& handle_out);
+
+        //colorOpsが空ならloadPrevFrameから決定
+        inline Result getColorOps(const RenderPassInfo& info, const size_t index, AttachmentOps& ops_out) const;
+
+        //VkRenderPassCreateInfoから参照されるため, vkCreateRenderPassまで保持する
+        struct SubpassDescriptions
+        {
+            std::vector<std::vector<VkAttachmentReference>> colorRefs;
+            std::vector<std::vector<VkAttachmentReference>> resolveRefs;
+            std::vector<std::vector<VkAttachmentReference>> inputRefs;
+            std::vector<std::vector<uint32_t>> preserves;
+            std::optional<VkAttachmentReference> depthRef;
+            std::vector<VkSubpassDescription> descs;
+            //サブパス間の依存関係
+            std::vector<VkSubpassDependency> deps;
+            std::vector<uint32_t> colorCounts;
+        };
+
+        //colorAttachmentsはSubpassInfoのインデックスからアタッチメントのインデックスへの対応
+        //resolveAttachmentsは空(マルチサンプルでない)かcolorAttachmentsと同じ長さ
+        inline Result createSubpassDescriptions(const std::vector<SubpassInfo>& subpasses, const std::vector<uint32_t>& colorAttachments, const std::vector<uint32_t>& resolveAttachments, const std::optional<uint32_t>& depthAttachment, SubpassDescriptions& sd_out);
+
+        //マルチサンプル
+        inline Result getSampleCountFlag(const uint32_t sampleCount, const bool depth, VkSampleCountFlagBits& flag_out) const;
+        //レンダーパス内でのみ使用する(メモリに書き戻さない)マルチサンプルアタッチメント
+        inline Result createMultiSampleTarget(const VkExtent3D& extent, const VkFormat format, const VkSampleCountFlagBits samples, const bool depth, HTexture& handle_out);
+        //カラーアタッチメントをマルチサンプルに置き換え, 元のアタッチメントを解決先として末尾に追加する
+        inline Result createMultiSampleAttachments(RenderPassObject& rpo, const std::vector<uint32_t>& colorAttachments, std::vector<VkAttachmentDescription>& adVec, std::vector<uint32_t>& resolveAttachments_out);
 
         inline Result enableDebugReport();
         inline Result disableDebugReport();
-        inline Result setImageMemoryBarrier(VkCommandBuffer command, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkImageAspectFlags aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT);
+        //ステージングバッファからのコピーとレイアウト遷移を記録する(acquireCommandは必要になった時に開始される)
+        inline Result recordImageUpload(VkCommandBuffer command, std::optional<VkCommandBuffer>& acquireCommand, const ImageObject& io, VkBuffer stagingBuffer, const std::vector<VkBufferImageCopy>& regions, const bool generateMips, const uint32_t baseLayer, const uint32_t layerCount);
+        //ステージングバッファを経由して各リージョンに書き込み, SHADER_READ_ONLYにする
+        inline Result uploadImage(ImageObject& io, const void* const pData, const size_t size, const std::vector<VkBufferImageCopy>& regions, const bool generateMips, const uint32_t baseLayer, const uint32_t layerCount);
+        //レベル0が書き込まれた全レベルTRANSFER_DSTの画像からミップチェーンを生成し, SHADER_READ_ONLYにする(グラフィックスキューのみ)
+        inline Result generateMipmaps(VkCommandBuffer command, const ImageObject& io, const uint32_t baseLayer, const uint32_t layerCount);
+
+        //読み出しリングの作成・破棄
+        inline Result createReadbackRing(const VkDeviceSize size);
+        inline void destroyReadbackRing();
+        //リングから領域を確保し, コピーを記録するコマンドを開始する
+        inline Result beginReadback(const size_t size, ReadbackObject& ro_out);
+        //コピーのコマンドを発行してチケットを発行する
+        inline Result submitReadback(ReadbackObject& ro, HReadback& ticket_out);
+
+        //コマンドリストの計測区間の数に合わせてクエリプールを用意する
+        inline Result createProfilerQueries(CommandObject& co, const size_t index, const InternalCommandList& icl);
+        inline Result createQueryPool(const VkQueryType type, const uint32_t count, VkQueryPool& pool_out);
+        //完了していればタイムスタンプ・パイプライン統計を読み出す(待機しない)
+        inline Result resolveProfilerQueries(CommandObject& co, const size_t index);
+        //発行したコマンドバッファの結果を待つ状態にし, 記録したコマンドの数をフレームの統計に加える
+        inline void submitProfilerQueries(CommandObject& co, const size_t index);
+        //GPUのタイムスタンプと同時刻のsteady_clockの時刻(ナノ秒)
+        inline Result getCalibratedTimestamps(uint64_t& ticks_out, uint64_t& hostNs_out);
+        inline void destroyProfilerQueries(CommandObject& co);
+
+        //同じ設定のサンプラがあればそれを返し, なければ作成してキャッシュする
+        inline Result getCachedSampler(const SamplerInfo& info, HSampler& handle_out);
+        inline Result getCachedSampler(const SamplerInfo& info, VkSampler& sampler_out);
+        inline Result setImageMemoryBarrier(VkCommandBuffer command, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkImageAspectFlags aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT, const uint32_t baseLayer = 0, const uint32_t layerCount = VK_REMAINING_ARRAY_LAYERS);
+        //コンピュートシェーダのストレージ画像との間のレイアウト遷移(グラフィックス・コンピュートどちらのキューでも有効)
+        inline void setStorageImageBarrier(VkCommandBuffer command, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout);
 
         inline Result createShaderModule(const Shader& shader, const VkShaderStageFlagBits& stage, VkPipelineShaderStageCreateInfo* pSSCI);
 
+        //キューを跨ぐ依存関係の待機セマフォを取得
+        inline Result getWaitSemaphores(const std::vector<HCommandBuffer>& waitCommandBuffers, std::vector<VkSemaphore>& semaphores_out, std::vector<uint64_t>& values_out, std::vector<VkPipelineStageFlags>& stages_out);
+        inline Result executeCompute(CommandObject& co, const std::vector<HCommandBuffer>& waitCommandBuffers);
+
         //各コマンド関数
         inline Result writeCommandInternal(CommandObject& co, size_t frameBufferIndex, const InternalCommandList& icl, const bool useSecondary = false);
         // inline Result cmdBeginRenderPass(CommandObject& co, size_t frameBufferIndex, const CmdBeginRenderPass& info);
@@ -324,6 +879,15 @@ namespace Cutlass
         inline Result cmdRender(CommandObject& co, size_t frameBufferIndex, const CmdRender& info);
         inline Result cmdBarrier(CommandObject& co, size_t frameBufferIndex, const CmdBarrier& info);
         inline Result cmdExecuteSubCommand(CommandObject& co, size_t frameBufferIndex, const CmdExecuteSubCommand& info);
+        inline Result cmdBindComputePipeline(CommandObject& co, size_t frameBufferIndex, const CmdBindComputePipeline& info);
+        inline Result cmdDispatch(CommandObject& co, size_t frameBufferIndex, const CmdDispatch& info);
+        inline Result cmdTransition(CommandObject& co, size_t frameBufferIndex, const CmdTransition& info);
+        inline Result cmdNextSubpass(CommandObject& co, size_t frameBufferIndex, const CmdNextSubpass& info);
+        inline Result cmdBeginScope(CommandObject& co, size_t frameBufferIndex, const CmdBeginScope& info);
+        inline Result cmdEndScope(CommandObject& co, size_t frameBufferIndex, const CmdEndScope& info);
+        //レンダーパス全体(全サブパス)を計測する
+        inline Result beginPassQueries(CommandObject& co, size_t frameBufferIndex, const HRenderPass& handle);
+        inline Result endPassQueries(CommandObject& co, size_t frameBufferIndex);
 
         // ImGui用コマンド構築
         inline Result cmdRenderImGui(CommandObject& co, size_t frameBufferIndex);
@@ -340,13 +904,24 @@ namespace Cutlass
         HTexture mNextTextureHandle;
         HRenderPass mNextRenderPassHandle;
         HGraphicsPipeline mNextGPHandle;
+        HComputePipeline mNextCPHandle;
         HCommandBuffer mNextCBHandle;
+        HSampler mNextSamplerHandle;
+        HReadback mNextReadbackHandle;
         std::unordered_map<HWindow, WindowObject> mWindowMap;
         std::unordered_map<HBuffer, BufferObject> mBufferMap;
         std::unordered_map<HTexture, ImageObject> mImageMap;
         std::unordered_map<HGraphicsPipeline, GraphicsPipelineObject> mGPMap;
+        std::unordered_map<HComputePipeline, ComputePipelineObject> mCPMap;
         std::unordered_map<HRenderPass, RenderPassObject> mRPMap;
         std::unordered_map<HCommandBuffer, CommandObject> mCommandBufferMap;
+        std::unordered_map<HSampler, SamplerObject> mSamplerMap;
+        std::unordered_map<HReadback, ReadbackObject> mReadbackMap;
+
+        //読み出しリング, チケットは確保した順に並ぶ(先頭から順に領域が空く)
+        ReadbackRing mReadbackRing;
+        std::deque<HReadback> mReadbackOrder;
+        std::vector<VkFence> mReadbackFencePool;
 
         // Vulkan API
         VkInstance mInstance;
@@ -357,6 +932,75 @@ namespace Cutlass
         VkQueue mDeviceQueue;
         VkCommandPool mCommandPool;
 
+        //転送専用キュー(存在しなければグラフィックスキューと同一)
+        uint32_t mTransferQueueIndex;
+        VkQueue mTransferQueue;
+        VkCommandPool mTransferCommandPool;
+        UploadStats mUploadStats;
+
+        //異方性フィルタリング(非対応なら常に無効)
+        bool mSamplerAnisotropy;
+        float mMaxSamplerAnisotropy;
+
+        //非同期コンピュートキュー(存在しなければグラフィックスキューと同一)
+        uint32_t mComputeQueueIndex;
+        VkQueue mComputeQueue;
+        VkCommandPool mComputeCommandPool;
+
+        //GPUプロファイラ(タイムスタンプの有効ビット数が0のキューでは計測しない)
+        bool mGPUProfilerEnabled;
+        float mTimestampPeriod;
+        uint32_t mGraphicsTimestampValidBits;
+        uint32_t mComputeTimestampValidBits;
+        bool mPipelineStatisticsEnabled;
+        bool mPipelineStatisticsSupported;
+
+        //CPU側の統計(記録中のフレームと直近のフレーム)
+        FrameStats mFrameStats;
+        FrameStats mLastFrameStats;
+
+        //直近のフレーム時間(ms, リングバッファ)
+        std::array<float, 120> mFrameTimes;
+        size_t mFrameTimeIndex;
+        uint64_t mLastFrameEndNs;
+
+        //確保中のデバイスメモリとヒープ毎の使用量(byte)
+        struct MemoryAllocation
+        {
+            uint32_t mTypeIndex;
+            VkDeviceSize mSize;
+        };
+        std::unordered_map<VkDeviceMemory, MemoryAllocation> mAllocations;
+        std::vector<VkDeviceSize> mHeapUsages;
+        std::vector<VkDeviceSize> mTypeUsages;
+        std::vector<uint32_t> mTypeAllocationCounts;
+
+        //ヒープ毎の予算とプロセス全体の使用量(updateMemoryBudgetで更新する)
+        bool mMemoryBudgetSupported;
+        std::vector<VkDeviceSize> mHeapBudgets;
+        std::vector<VkDeviceSize> mHeapProcessUsages;
+        uint32_t mHostFallbackCount;
+
+        //入力の取得でウィンドウを指定しない場合に使う, 直近のupdateInputでフォーカスのあったウィンドウ
+        std::optional<HWindow> mFocusedWindow;
+
+        //トレース(VK_EXT_calibrated_timestampsが無ければmvkGetCalibratedTimestampsEXTはnullptr)
+        Tracer mTracer;
+        PFN_vkGetCalibratedTimestampsEXT mvkGetCalibratedTimestampsEXT;
+        //ホストの時刻をCLOCK_MONOTONIC(steady_clock)で取得できる
+        bool mMonotonicTimeDomain;
+
+        //キュー毎のタイムラインセマフォ(キューを跨ぐ依存関係用)
+        VkSemaphore mGraphicsTimelineSem;
+        uint64_t mGraphicsTimelineValue;
+        VkSemaphore mComputeTimelineSem;
+        uint64_t mComputeTimelineValue;
+
+        // transientテクスチャ用に確保したメモリ(複数のテクスチャで共有)
+        std::vector<TransientBlock> mTransientBlocks;
+        size_t mTransientRequestedSize;
+        size_t mTransientAllocatedSize;
+
         // DescriptorPoolは横断的に確保する
         std::vector<std::pair<DescriptorPoolInfo, VkDescriptorPool>> mDescriptorPools;
 
@@ -369,6 +1013,8 @@ namespace Cutlass
         uint32_t mMaxFrame;
         //初期化確認
         bool mIsInitialized;
+        //GLFWを使用せずに初期化した
+        bool mIsHeadless;
 
         // ImGui用, 描画対象は常にフレームバッファ
         std::optional<VkDescriptorPool> mImGuiDescriptorPool;
@@ -4,6 +4,11 @@
 #include "Shader.hpp"
 #include "RenderPass.hpp"
 #include "GraphicsPipeline.hpp"
+#include "ComputePipeline.hpp"
+#include "RenderGraph.hpp"
+#include "TextureFile.hpp"
+#include "AssetPack.hpp"
+#include "Trace.hpp"
 #include "Buffer.hpp"
 #include "Texture.hpp"
 #include "Utility.hpp"
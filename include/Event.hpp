@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
+#include <bitset>
 #include <cstdint>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -255,4 +258,81 @@ namespace Cutlass
             (Key::RightAlt),
             (Key::RightSuper),
             (Key::Menu)};
+
+    //キーコードからkeyMapのインデックスへの表(keyMapに無いキーはkeyNum)
+    constexpr std::array<uint8_t, static_cast<std::size_t>(Key::LAST) + 1> keyIndexTable = []()
+    {
+        std::array<uint8_t, static_cast<std::size_t>(Key::LAST) + 1> table{};
+        for (auto& index : table)
+            index = static_cast<uint8_t>(keyNum);
+        for (std::size_t i = 0; i < keyNum; ++i)
+            table[static_cast<std::size_t>(keyMap[i])] = static_cast<uint8_t>(i);
+        return table;
+    }();
+
+    constexpr std::size_t getKeyIndex(const Key key)
+    {
+        const auto code = static_cast<std::size_t>(key);
+        return code < keyIndexTable.size() ? keyIndexTable[code] : keyNum;
+    }
+
+    enum class KeyState
+    {
+        eNone,
+        ePressed,   //このフレームで押された
+        eHeld,      //前のフレームから押され続けている
+        eReleased,  //このフレームで離された
+    };
+
+    //ウィンドウ1つ分の入力
+    //GLFWのコールバックで蓄積し, Context::updateInputで1フレーム分のスナップショットに確定する
+    //問い合わせはスナップショットを読むだけなので, 同じフレーム内では何度呼んでも同じ結果になる
+    class Event
+    {
+    public:
+        Event();
+
+        KeyState getKeyState(const Key key) const;
+        //押された瞬間か押され続けている
+        bool getKey(const Key key) const;
+
+        void getMousePos(double& x, double& y) const;
+        //前のフレームからのカーソルの移動量
+        void getMouseDelta(double& x, double& y) const;
+        //このフレームのスクロール量
+        void getScroll(double& x, double& y) const;
+        //このフレームに入力された文字(UTF-32)
+        const std::u32string& getText() const;
+
+        //GLFWのコールバックから呼ばれる
+        void onKey(const int key, const int action);
+        void onCursorPos(const double x, const double y);
+        void onScroll(const double x, const double y);
+        void onChar(const uint32_t codepoint);
+
+        //蓄積した入力でスナップショットを更新する
+        void update();
+
+    private:
+        //コールバックで更新される現在の状態と, フレーム内に押されたキー(フレーム内に離されたものも1フレームは押されたことにする)
+        std::bitset<keyNum> mDownKeys;
+        std::bitset<keyNum> mPressedKeys;
+        double mCursorX;
+        double mCursorY;
+        bool mHasCursor;
+        double mScrollAccumX;
+        double mScrollAccumY;
+        std::u32string mTextAccum;
+
+        //スナップショット
+        std::bitset<keyNum> mKeys;
+        std::bitset<keyNum> mPrevKeys;
+        double mMouseX;
+        double mMouseY;
+        double mMouseDeltaX;
+        double mMouseDeltaY;
+        double mScrollX;
+        double mScrollY;
+        std::u32string mText;
+    };
 };  // namespace Cutlass
\ No newline at end of file
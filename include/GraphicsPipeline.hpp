@@ -83,7 +83,10 @@ namespace Cutlass
 
     enum class MultiSampleState
     {
-        eDefault,
+        eDefault,  //描画対象のレンダーパスのサンプル数に合わせる
+        eMSAA2,
+        eMSAA4,
+        eMSAA8,
     };
 
     enum class DepthStencilState
@@ -147,7 +150,8 @@ namespace Cutlass
                    FS.getPath().compare(other.FS.getPath()) == 0 &&
                    (viewport == other.viewport) && (viewport ? viewport.value() == other.viewport.value() : 1) &&
                    (scissor == other.scissor) && (scissor ? scissor.value() == other.scissor.value() : 1) &&
-                   renderPass == other.renderPass;
+                   renderPass == other.renderPass &&
+                   subpass == other.subpass;
         }
 
         ColorBlend colorBlend;
@@ -160,6 +164,7 @@ namespace Cutlass
         std::optional<Viewport> viewport;  //左上手前、右下奥3次元(Depthは正規化座標)
         std::optional<Scissor> scissor;    //左上、右下2次元
         HRenderPass renderPass;            //描画対象
+        uint32_t subpass = 0;              //renderPass内で使用するサブパスのインデックス
         // RenderPass renderPass;
     };
 };  // namespace Cutlass
@@ -200,6 +205,7 @@ namespace std
                     for (size_t j = 0; j < 2; ++j)
                         combineHash(seed, data.scissor.value()[i][j]);
             combineHash(seed, data.renderPass.getID());
+            combineHash(seed, data.subpass);
 
             return seed;
         }
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "Utility.hpp"
+
+#include "Command.hpp"
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Cutlass
+{
+    struct RenderGraphPassInfo
+    {
+        RenderGraphPassInfo()
+        {
+
+        }
+
+        RenderGraphPassInfo
+        (
+            const CommandList& commandList,
+            const std::vector<HTexture>& reads,
+            const std::vector<HTexture>& writes,
+            const std::optional<HTexture>& depthWrite = std::nullopt
+        )
+        : reads(reads)
+        , writes(writes)
+        , depthWrite(depthWrite)
+        {
+            commandLists.emplace_back(commandList);
+        }
+
+        //コマンドリストは後からRenderGraph::setCommandListsで設定する
+        RenderGraphPassInfo
+        (
+            const std::vector<HTexture>& reads,
+            const std::vector<HTexture>& writes,
+            const std::optional<HTexture>& depthWrite = std::nullopt
+        )
+        : reads(reads)
+        , writes(writes)
+        , depthWrite(depthWrite)
+        {
+
+        }
+
+        RenderGraphPassInfo
+        (
+            const std::vector<CommandList>& commandLists,
+            const std::vector<HTexture>& reads,
+            const std::vector<HTexture>& writes,
+            const std::optional<HTexture>& depthWrite = std::nullopt
+        )
+        : commandLists(commandLists)
+        , reads(reads)
+        , writes(writes)
+        , depthWrite(depthWrite)
+        {
+
+        }
+
+        //フレーム毎のコマンドリスト(1つなら全フレームで共有), パス内でbarrierを呼ぶ必要はない
+        std::vector<CommandList> commandLists;
+        //シェーダから読むテクスチャ
+        std::vector<HTexture> reads;
+        //カラーターゲット(コンピュートならストレージテクスチャ)として書き込むテクスチャ
+        //書き込みを宣言しないパスはグラフ外(ウィンドウ等)に出力するものとして扱われる
+        //以前の内容を読み込んで書き足す場合(loadPrevFrame等)はreadsにも含める, 含めなければ全体を上書きするものとして扱う
+        std::vector<HTexture> writes;
+        //深度は以前の内容に対してテストされるため, 直前の書き込みは常に必要とされる
+        std::optional<HTexture> depthWrite;
+    };
+
+    //パス間の依存関係からコマンドを並べ替え, 不要なパスの削除とバリアの挿入を行う
+    class RenderGraph
+    {
+    public:
+        RenderGraph();
+
+        //宣言順は実行順に影響しない, 戻り値はパスのインデックス
+        uint32_t addPass(const RenderGraphPassInfo& info);
+
+        //パスのコマンドリストを設定する(テクスチャの割り当て後にレンダーパスを作成する場合)
+        Result setCommandLists(const uint32_t pass, const std::vector<CommandList>& commandLists);
+        Result setCommandList(const uint32_t pass, const CommandList& commandList);
+
+        //グラフの外で使用するテクスチャ, これに寄与しないパスは削除される
+        void markOutput(const HTexture& handle);
+
+        //メモリを他のテクスチャと共有しているため, 生存期間外では内容が保持されないテクスチャ
+        //groupは同じメモリを共有するテクスチャで共通の番号
+        void markAliased(const HTexture& handle, const uint32_t group);
+
+        //各テクスチャを使用する最初と最後のパスの実行順での位置(コマンドリストは不要)
+        //出力テクスチャはグラフ全体を生存期間とする
+        Result getTextureLifetimes(std::unordered_map<HTexture, std::pair<uint32_t, uint32_t>>& lifetimes_out);
+
+        void clear();
+
+        //フレーム毎のコマンドリストを構築(createCommandBufferにそのまま渡せる)
+        Result compile(std::vector<CommandList>& commandLists_out);
+        Result compile(CommandList& commandList_out);
+
+        //compile後に有効
+        const std::vector<uint32_t>& getExecutionOrder() const;
+        uint32_t getCulledPassCount() const;
+        uint32_t getTransitionCount() const;
+
+    private:
+        struct TextureState
+        {
+            TextureAccess first;
+            TextureAccess current;
+            bool firstIsWrite;
+        };
+
+        inline Result sortPasses();
+        inline void cullPasses();
+        inline TextureAccess getWriteAccess(const RenderGraphPassInfo& pass) const;
+
+        std::vector<RenderGraphPassInfo> mPasses;
+        std::vector<HTexture> mOutputs;
+        std::unordered_map<HTexture, uint32_t> mAliased;
+
+        std::vector<uint32_t> mExecutionOrder;
+        uint32_t mCulledPassCount;
+        uint32_t mTransitionCount;
+    };
+}
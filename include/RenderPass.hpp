@@ -9,6 +9,75 @@
 
 namespace Cutlass
 {
+    //レンダーパス開始時のアタッチメントの扱い
+    enum class LoadOp
+    {
+        eClear,
+        eLoad,
+        eDontCare,  //以前の内容は不定になる
+    };
+
+    //レンダーパス終了時のアタッチメントの扱い
+    enum class StoreOp
+    {
+        eStore,
+        eDontCare,  //パス内でのみ使用する(後続のパスから読まない)場合, メモリへの書き戻しを省略できる
+    };
+
+    struct AttachmentOps
+    {
+        AttachmentOps()
+        : load(LoadOp::eClear)
+        , store(StoreOp::eStore)
+        {
+
+        }
+
+        AttachmentOps
+        (
+            const LoadOp load,
+            const StoreOp store = StoreOp::eStore
+        )
+        : load(load)
+        , store(store)
+        {
+
+        }
+
+        LoadOp load;
+        StoreOp store;
+    };
+
+    //サブパスで使用するカラーアタッチメントのインデックス
+    //オフスクリーンならcolorTargetsのインデックス, ウィンドウなら0がスワップチェーンイメージで1以降がcolorTargets
+    struct SubpassInfo
+    {
+        SubpassInfo()
+        : useDepth(false)
+        {
+
+        }
+
+        SubpassInfo
+        (
+            const std::vector<uint32_t>& colorTargets,
+            const std::vector<uint32_t>& inputTargets = std::vector<uint32_t>(),
+            const bool useDepth = false
+        )
+        : colorTargets(colorTargets)
+        , inputTargets(inputTargets)
+        , useDepth(useDepth)
+        {
+
+        }
+
+        //書き込むアタッチメント
+        std::vector<uint32_t> colorTargets;
+        //前のサブパスの出力を同じピクセル位置で読む(subpassInput)アタッチメント
+        std::vector<uint32_t> inputTargets;
+        bool useDepth;
+    };
+
     struct RenderPassInfo
     {
         RenderPassInfo() 
@@ -91,13 +160,49 @@ namespace Cutlass
             const HWindow& window
         )
         : window(window)
+        , loadPrevFrame(false)
         {
 
         }
 
-        std::optional<HWindow> window;//if window handle was set, colortargets will be ignored
+        //ウィンドウへの描画の前段のサブパスで中間ターゲット(colorTargets)に描画する
+        RenderPassInfo
+        (
+            const HWindow& window,
+            const std::vector<HTexture>& colorTargets,
+            const std::vector<SubpassInfo>& subpasses
+        )
+        : window(window)
+        , colorTargets(colorTargets)
+        , loadPrevFrame(false)
+        , subpasses(subpasses)
+        {
+
+        }
+
+        //if window handle was set, colortargets will be used only as intermediate targets of subpasses
+        std::optional<HWindow> window;
         std::vector<HTexture> colorTargets;
         std::optional<HTexture> depthTarget;
         bool loadPrevFrame;
+
+        //カラーアタッチメント毎のload/store(空ならloadPrevFrameから決定), インデックスはSubpassInfoと同じ
+        std::vector<AttachmentOps> colorOps;
+        std::optional<AttachmentOps> depthOps;
+        //空なら全てのカラーターゲットに書き込む1つのサブパス
+        std::vector<SubpassInfo> subpasses;
+        //2以上ならカラーターゲット(ウィンドウならスワップチェーンイメージ)毎にtransientなマルチサンプルアタッチメントを内部で作成し,
+        //パスの最後に解決する(storeがeDontCareのターゲットには解決しない), 深度ターゲットは同じサンプル数で作成すること
+        //内部のアタッチメントには以前の内容が無いため, カラーのloadにeLoadは指定できない(loadPrevFrameも同様)
+        uint32_t sampleCount = 1;
+
+        //オフスクリーンのレンダーパスで同時に処理するフレーム数, ウィンドウはWindowInfo::framesInFlightを使う
+        //各コマンドバッファは自身の前回の実行の完了を待つため, 同時に処理されるのはコマンドリストの数まで
+        //frameColorTargetsが空なら全フレームでcolorTargetsに描画する(レンダーパスの外部依存で前フレームの書き込みを待つ, 深度ターゲットは常に共有)
+        uint32_t framesInFlight = 1;
+        //フレーム毎のカラーターゲット(空でなければcolorTargetsの代わりに使い, 要素数はframesInFlightと一致させる)
+        //各フレームのターゲットは形式・大きさを揃え, 深度ターゲットとマルチサンプルアタッチメントは全フレームで共有する
+        //フレームiはi番目のコマンドリストで記録されるため, コマンドリストはframesInFlight個用意すること
+        std::vector<std::vector<HTexture>> frameColorTargets;
     };
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <string_view>
 #include <vector>
 
+#include "Texture.hpp"
 #include "Utility.hpp"
 
 namespace Cutlass
@@ -34,13 +35,17 @@ namespace Cutlass
     {
         void bind(uint8_t binding, const HBuffer& handle);
         void bind(uint8_t binding, const HTexture& handle);
+        //テクスチャ作成時のサンプラの代わりにContext::createSamplerで作成したサンプラを使用する
+        void bind(uint8_t binding, const HTexture& handle, const HSampler& sampler);
 
         const std::map<uint8_t, HBuffer>& getUniformBuffers() const;
         const std::map<uint8_t, HTexture>& getCombinedTextures() const;
+        const std::map<uint8_t, HSampler>& getSamplers() const;
 
     private:
         std::map<uint8_t, HBuffer> uniformBuffers;
         std::map<uint8_t, HTexture> combinedTextures;
+        std::map<uint8_t, HSampler> samplers;
     };
 
     struct Shader
@@ -53,6 +58,8 @@ namespace Cutlass
 
         void load(std::string_view path, std::string_view entryPoint);
         void load(std::string_view path);
+        //メモリ上のSPIR-Vから読み込む(nameはgetPathで返される)
+        void load(const void* pData, const size_t size, std::string_view name, std::string_view entryPoint = "");
 
         // void load(const char* path, const std::string_view entryPoint);
 
@@ -61,6 +68,8 @@ namespace Cutlass
             eUniformBuffer,
             eCombinedTexture,
             eSampler,
+            eStorageTexture,
+            eInputAttachment,  //同じレンダーパスの前のサブパスの出力(テクスチャとしてbindする)
         };
 
         const std::vector<char>& getShaderByteCode() const;
@@ -71,18 +80,24 @@ namespace Cutlass
 
         // key = <set, binding>, param = resource type
         const std::map<std::pair<uint8_t, uint8_t>, ShaderResourceType>& getLayoutTable() const;
+        // key = <set, binding>, param = テクスチャの次元(e2D, e2DArray, eCube, e3Dのいずれかとして宣言されたもののみ)
+        const std::map<std::pair<uint8_t, uint8_t>, Dimension>& getTextureDimensionTable() const;
         // first = type, second = semantic
         const std::vector<std::pair<ResourceType, std::optional<std::string>>>& getInputVariables() const;
         // first = type, second = semantic
         const std::vector<std::pair<ResourceType, std::optional<std::string>>>& getOutputVariables() const;
 
     private:
+        void reflect(std::string_view entryPoint);
+
         std::vector<char> mFileData;
         std::string mEntryPoint;
         std::string mPath;
 
         // <<set, binding>, resource type>
         std::map<std::pair<uint8_t, uint8_t>, ShaderResourceType> mResourceLayoutTable;
+        // <<set, binding>, dimension>
+        std::map<std::pair<uint8_t, uint8_t>, Dimension> mTextureDimensionTable;
         // <type, semantic>
         std::vector<std::pair<ResourceType, std::optional<std::string>>> mInputVariables;
         std::vector<std::pair<ResourceType, std::optional<std::string>>> mOutputVariables;
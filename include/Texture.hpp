@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 #include <utility>
 #include "Utility.hpp"
 
@@ -16,17 +17,133 @@ namespace Cutlass
         eSwapchainImage,//自分で指定しても破損するだけです
     };
 
+    //e2D以外はシェーダリソースかeUnorderedのみ
     enum class Dimension
     {
         e2D,
-        //e3D, //現段階ではまだ未定
+        e2DArray,  //depthをレイヤー数として扱う
+        eCube,     //6レイヤー(+X, -X, +Y, -Y, +Z, -Z), 幅と高さは同じ
+        e3D,
     };
 
 	enum class SamplerType
 	{
-		eDefault,
+		eDefault,       //線形補間, クランプ
+		eLinearRepeat,  //線形補間, リピート
+		eNearestClamp,  //最近傍補間, クランプ
+		eNearestRepeat, //最近傍補間, リピート
+		eAnisotropic,   //異方性フィルタリング(16x), リピート
+		eShadow,        //深度比較(LESS_OR_EQUAL), クランプ
 	};
 
+    enum class Filter
+    {
+        eNearest,
+        eLinear,
+    };
+
+    enum class AddressMode
+    {
+        eRepeat,
+        eMirroredRepeat,
+        eClampToEdge,
+        eClampToBorder,
+    };
+
+    //VkCompareOpと同じ順序
+    enum class CompareOp
+    {
+        eNever,
+        eLess,
+        eEqual,
+        eLessOrEqual,
+        eGreater,
+        eNotEqual,
+        eGreaterOrEqual,
+        eAlways,
+    };
+
+    //サンプラの設定, 同じ設定のサンプラはContext内で共有される
+    struct SamplerInfo
+    {
+        SamplerInfo() {}
+
+        SamplerInfo(SamplerType type)
+        {
+            switch (type)
+            {
+            case SamplerType::eLinearRepeat:
+                setAddressMode(AddressMode::eRepeat);
+                break;
+            case SamplerType::eNearestClamp:
+                setFilter(Filter::eNearest);
+                break;
+            case SamplerType::eNearestRepeat:
+                setFilter(Filter::eNearest);
+                setAddressMode(AddressMode::eRepeat);
+                break;
+            case SamplerType::eAnisotropic:
+                setAddressMode(AddressMode::eRepeat);
+                maxAnisotropy = 16.f;
+                break;
+            case SamplerType::eShadow:
+                compareOp = CompareOp::eLessOrEqual;
+                break;
+            default:
+                break;
+            }
+        }
+
+        inline void setFilter(Filter filter)
+        {
+            magFilter = filter;
+            minFilter = filter;
+            mipmapFilter = filter;
+        }
+
+        inline void setAddressMode(AddressMode mode)
+        {
+            addressU = mode;
+            addressV = mode;
+            addressW = mode;
+        }
+
+        bool operator==(const SamplerInfo& other) const
+        {
+            return magFilter == other.magFilter &&
+                   minFilter == other.minFilter &&
+                   mipmapFilter == other.mipmapFilter &&
+                   addressU == other.addressU &&
+                   addressV == other.addressV &&
+                   addressW == other.addressW &&
+                   maxAnisotropy == other.maxAnisotropy &&
+                   mipLodBias == other.mipLodBias &&
+                   compareOp == other.compareOp &&
+                   minLod == other.minLod &&
+                   maxLod == other.maxLod;
+        }
+
+        bool operator!=(const SamplerInfo& other) const
+        {
+            return !(*this == other);
+        }
+
+        Filter magFilter = Filter::eLinear;
+        Filter minFilter = Filter::eLinear;
+        Filter mipmapFilter = Filter::eLinear;
+        AddressMode addressU = AddressMode::eClampToEdge;
+        AddressMode addressV = AddressMode::eClampToEdge;
+        AddressMode addressW = AddressMode::eClampToEdge;
+        //1以下なら異方性フィルタリングを行わない(デバイスの上限に丸められる)
+        float maxAnisotropy = 1.f;
+        float mipLodBias = 0.f;
+        //設定すると深度比較サンプラになる
+        std::optional<CompareOp> compareOp;
+        //maxLodの既定値はミップレベルを制限しない(VK_LOD_CLAMP_NONE)
+        float minLod = 0.f;
+        float maxLod = 1000.f;
+    };
+
     struct TextureInfo
     {
         TextureInfo() {}
@@ -96,6 +213,52 @@ namespace Cutlass
             usage = TextureUsage::eDepthStencilTarget;
         }
 
+        inline void setSRTex2DArray(uint32_t _width, uint32_t _height, uint32_t _layers, bool _isHostVisible, ResourceType _format = ResourceType::eUNormVec4, SamplerType _samplerType = SamplerType::eDefault)
+        {
+            setSRTex2D(_width, _height, _isHostVisible, _format, _samplerType);
+            depth = _layers;
+            dimension = Dimension::e2DArray;
+        }
+
+        inline void setSRTexCube(uint32_t _size, bool _isHostVisible, ResourceType _format = ResourceType::eUNormVec4, SamplerType _samplerType = SamplerType::eDefault)
+        {
+            setSRTex2D(_size, _size, _isHostVisible, _format, _samplerType);
+            depth = 6;
+            dimension = Dimension::eCube;
+        }
+
+        inline void setSRTex3D(uint32_t _width, uint32_t _height, uint32_t _depth, bool _isHostVisible, ResourceType _format = ResourceType::eUNormVec4, SamplerType _samplerType = SamplerType::eDefault)
+        {
+            setSRTex2D(_width, _height, _isHostVisible, _format, _samplerType);
+            depth = _depth;
+            dimension = Dimension::e3D;
+        }
+
+        //マルチサンプルのレンダーターゲットにする(サンプル数は2の累乗)
+        inline void setMultiSample(uint32_t _sampleCount)
+        {
+            sampleCount = _sampleCount;
+        }
+
+        //ミップレベル数を設定する(0なら最大までのミップチェーン, シェーダリソースのみ)
+        inline void setMipLevels(uint32_t _mipLevels = 0)
+        {
+            mipLevels = _mipLevels;
+        }
+
+        //samplerTypeの代わりに任意のサンプラを既定のサンプラとして使用する
+        inline void setSampler(const SamplerInfo& _samplerInfo)
+        {
+            samplerInfo = _samplerInfo;
+        }
+
+        //レンダーターゲットをtransientにする(Context::allocateTransientTexturesでメモリが割り当てられる)
+        inline void setTransient(bool _isSampled = true)
+        {
+            isTransient = true;
+            isSampled = _isSampled;
+        }
+
         TextureUsage usage;
         Dimension dimension;
         ResourceType format;
@@ -104,5 +267,15 @@ namespace Cutlass
         uint32_t width;
         uint32_t height;
         uint32_t depth;
+        //trueなら生存期間の重ならない他のtransientなレンダーターゲットとメモリを共有する
+        bool isTransient = false;
+        //transientかつfalseならシェーダから読まれない(TRANSIENT_ATTACHMENT, LAZILY_ALLOCATEDメモリを使用)
+        bool isSampled = true;
+        //1以外はレンダーターゲットのみ
+        uint32_t sampleCount = 1;
+        //0なら最大までのミップチェーン, 1以外はシェーダリソースのみ(書き込み時に下位レベルを生成する)
+        uint32_t mipLevels = 1;
+        //設定されていればsamplerTypeより優先される
+        std::optional<SamplerInfo> samplerInfo;
     };
 };
\ No newline at end of file
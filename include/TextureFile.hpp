@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Utility.hpp"
+
+namespace Cutlass
+{
+    //BCフォーマットならtrue
+    bool isBlockCompressed(const ResourceType format);
+    //1つのミップレベルのバイト数(TextureFileが扱うフォーマットのみ)
+    size_t getTextureLevelSize(const ResourceType format, const uint32_t width, const uint32_t height);
+
+    //KTX2, DDSのテクスチャをデコードせずに読み込む(2Dのみ, ミップチェーンを含む)
+    struct TextureFile
+    {
+        struct MipLevel
+        {
+            //getData()の先頭からのオフセット
+            size_t offset;
+            size_t size;
+            uint32_t width;
+            uint32_t height;
+        };
+
+        TextureFile() {}
+
+        TextureFile(std::string_view path) { load(path); }
+
+        //コンテナはファイル先頭のマジックナンバーで判定する
+        Result load(std::string_view path);
+        //メモリ上のコンテナを読む(データはコピーされる)
+        Result parse(const void* pData, const size_t size);
+
+        bool isLoaded() const;
+        ResourceType getFormat() const;
+        uint32_t getWidth() const;
+        uint32_t getHeight() const;
+        //レベル0から順に並ぶ
+        const std::vector<MipLevel>& getMipLevels() const;
+        const std::vector<uint8_t>& getData() const;
+
+    private:
+        Result parseKTX2(const uint8_t* pData, const size_t size);
+        Result parseDDS(const uint8_t* pData, const size_t size);
+        //レベル0の大きさとフォーマットからミップレベルを詰めて並べる(戻り値は全レベルのバイト数)
+        size_t setMipLevels(const uint32_t levelCount);
+
+        std::string mPath;
+        bool mIsLoaded = false;
+        ResourceType mFormat;
+        uint32_t mWidth  = 0;
+        uint32_t mHeight = 0;
+        std::vector<MipLevel> mMipLevels;
+        std::vector<uint8_t> mData;
+    };
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Utility.hpp"
+
+namespace Cutlass
+{
+    //Chrome trace形式(chrome://tracing, Perfettoで読み込める)で区間を記録する
+    //時刻は全てstd::chrono::steady_clockのナノ秒
+    class Tracer
+    {
+    public:
+        //GPUの区間を記録するトラック(CPUの区間は記録したスレッド毎のトラックになる)
+        enum class Track : uint32_t
+        {
+            eCPU,
+            eGraphicsQueue,
+            eComputeQueue,
+        };
+
+        Tracer();
+
+        Tracer(const Tracer&)            = delete;
+        Tracer& operator=(const Tracer&) = delete;
+
+        //有効にした時刻がトレースの原点になる
+        void setEnabled(const bool enable);
+        bool isEnabled() const;
+
+        static uint64_t now();
+
+        void addEvent(std::string_view name, const Track track, const uint64_t beginNs, const uint64_t endNs);
+
+        //記録したイベントを書き出して破棄する
+        Result write(std::string_view path);
+        void clear();
+
+    private:
+        struct Event
+        {
+            std::string name;
+            //Chrome traceのスレッドID
+            uint32_t tid;
+            uint64_t beginNs;
+            uint64_t endNs;
+        };
+
+        //isEnabledはロックせずに読むため
+        std::atomic<bool> mEnabled;
+        uint64_t mOriginNs;
+        std::mutex mMutex;
+        std::vector<Event> mEvents;
+        std::unordered_map<std::thread::id, uint32_t> mThreadIDs;
+    };
+
+    //スコープの間を区間として記録する(Tracerが無効なら何もしない)
+    class TraceScope
+    {
+    public:
+        //nameは記録されるまで有効な文字列(リテラル)であること
+        TraceScope(Tracer& tracer, const char* name);
+        ~TraceScope();
+
+        TraceScope(const TraceScope&)            = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        Tracer& mTracer;
+        const char* mName;
+        uint64_t mBeginNs;
+        bool mEnabled;
+    };
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <unordered_map>
 
@@ -280,6 +281,59 @@ namespace Cutlass
         uint32_t id;
     };
 
+    struct HComputePipeline
+    {
+        bool operator==(const HComputePipeline& r) const
+        {
+            return id == r.id;
+        }
+
+        bool operator!=(const HComputePipeline& r) const
+        {
+            return id != r.id;
+        }
+
+        HComputePipeline& operator++()
+        {
+            ++id;
+            return *this;
+        }
+
+        HComputePipeline operator++(int)
+        {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        HComputePipeline& operator--()
+        {
+            --id;
+            return *this;
+        }
+
+        HComputePipeline operator--(int)
+        {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        uint32_t setID(uint32_t rid)
+        {
+            id = rid;
+            return rid;
+        }
+
+        uint32_t getID() const
+        {
+            return id;
+        }
+
+    private:
+        uint32_t id;
+    };
+
     struct HCommandBuffer
     {
 
@@ -334,6 +388,114 @@ namespace Cutlass
         uint32_t id;
     };
 
+    struct HSampler
+    {
+
+        bool operator==(const HSampler& r) const
+        {
+            return id == r.id;
+        }
+
+        bool operator!=(const HSampler& r) const
+        {
+            return id != r.id;
+        }
+
+        HSampler& operator++()
+        {
+            ++id;
+            return *this;
+        }
+
+        HSampler operator++(int)
+        {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        HSampler& operator--()
+        {
+            --id;
+            return *this;
+        }
+
+        HSampler operator--(int)
+        {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        uint32_t setID(uint32_t rid)
+        {
+            id = rid;
+            return rid;
+        }
+        
+        uint32_t getID() const
+        {
+            return id;
+        }
+
+    private:
+        uint32_t id;
+    };
+
+    struct HReadback
+    {
+
+        bool operator==(const HReadback& r) const
+        {
+            return id == r.id;
+        }
+
+        bool operator!=(const HReadback& r) const
+        {
+            return id != r.id;
+        }
+
+        HReadback& operator++()
+        {
+            ++id;
+            return *this;
+        }
+
+        HReadback operator++(int)
+        {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        HReadback& operator--()
+        {
+            --id;
+            return *this;
+        }
+
+        HReadback operator--(int)
+        {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        uint32_t setID(uint32_t rid)
+        {
+            id = rid;
+            return rid;
+        }
+        
+        uint32_t getID() const
+        {
+            return id;
+        }
+
+    private:
+        uint32_t id;
+    };
+
     enum class Result
     {
         eFailure = 0,
@@ -361,7 +523,29 @@ namespace Cutlass
         eFMat2,      // 16
         eFMat3,      // 17
         eFMat4,      // 18
+        //ブロック圧縮(テクスチャのみ, TextureFileから作成する)
+        eBC1UNorm,   // 19
+        eBC1SRGB,    // 20
+        eBC2UNorm,   // 21
+        eBC2SRGB,    // 22
+        eBC3UNorm,   // 23
+        eBC3SRGB,    // 24
+        eBC4UNorm,   // 25
+        eBC5UNorm,   // 26
+        eBC6HUFloat, // 27
+        eBC7UNorm,   // 28
+        eBC7SRGB,    // 29
     };
+
+    //最大の辺から全てのミップレベルの段数を求める(floor(log2(max(width, height, depth))) + 1)
+    inline uint32_t getFullMipLevels(const uint32_t width, const uint32_t height, const uint32_t depth = 1)
+    {
+        uint32_t levels = 1;
+        for (uint32_t size = std::max({width, height, depth}); size > 1; size >>= 1)
+            ++levels;
+
+        return levels;
+    }
 };  // namespace Cutlass
 
 namespace std
@@ -411,6 +595,15 @@ namespace std
         }
     };
 
+    template <>
+    struct hash<Cutlass::HComputePipeline>
+    {
+        size_t operator()(const Cutlass::HComputePipeline& data) const
+        {
+            return std::hash<uint32_t>()(data.getID());
+        }
+    };
+
     template <>
     struct hash<Cutlass::HCommandBuffer>
     {
@@ -419,4 +612,22 @@ namespace std
             return std::hash<uint32_t>()(data.getID());
         }
     };
+
+    template <>
+    struct hash<Cutlass::HSampler>
+    {
+        size_t operator()(const Cutlass::HSampler& data) const
+        {
+            return std::hash<uint32_t>()(data.getID());
+        }
+    };
+
+    template <>
+    struct hash<Cutlass::HReadback>
+    {
+        size_t operator()(const Cutlass::HReadback& data) const
+        {
+            return std::hash<uint32_t>()(data.getID());
+        }
+    };
 }  // namespace std
\ No newline at end of file
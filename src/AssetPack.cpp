@@ -0,0 +1,391 @@
+#include "../include/AssetPack.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Cutlass
+{
+    namespace
+    {
+        // file layout : PackHeader, PackEntry * entryCount, aligned blobs
+        struct PackHeader
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t entryCount;
+            uint32_t reserved;
+        };
+
+        struct PackEntry
+        {
+            char name[64];
+            uint32_t type;
+            uint32_t format;
+            uint32_t width;
+            uint32_t height;
+            uint32_t mipLevels;
+            uint32_t reserved;
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        static_assert(sizeof(PackHeader) == 16, "asset pack header must be packed");
+        static_assert(sizeof(PackEntry) == 104, "asset pack entry must be packed");
+
+        const char packMagic[4] = {'C', 'T', 'P', 'K'};
+    }
+
+    AssetPack::AssetPack()
+        : mpMapped(nullptr)
+        , mMappedSize(0)
+#ifdef _WIN32
+        , mFile(nullptr)
+        , mMapping(nullptr)
+#else
+        , mFd(-1)
+#endif
+    {
+
+    }
+
+    AssetPack::AssetPack(std::string_view path)
+        : AssetPack()
+    {
+        open(path);
+    }
+
+    AssetPack::~AssetPack()
+    {
+        close();
+    }
+
+    Result AssetPack::open(std::string_view path)
+    {
+        close();
+        mPath = std::string(path);
+
+#ifdef _WIN32
+        mFile = CreateFileA(mPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (mFile == INVALID_HANDLE_VALUE)
+        {
+            mFile = nullptr;
+            std::cerr << "failed to open asset pack : " << path << "\n";
+            return Result::eFailure;
+        }
+
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(mFile, &fileSize);
+        mMappedSize = static_cast<size_t>(fileSize.QuadPart);
+
+        mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mMapping)
+            mpMapped = reinterpret_cast<const uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        mFd = ::open(mPath.c_str(), O_RDONLY);
+        if (mFd < 0)
+        {
+            std::cerr << "failed to open asset pack : " << path << "\n";
+            return Result::eFailure;
+        }
+
+        struct stat st;
+        if (fstat(mFd, &st) == 0 && st.st_size > 0)
+        {
+            mMappedSize = static_cast<size_t>(st.st_size);
+            void* p     = mmap(nullptr, mMappedSize, PROT_READ, MAP_PRIVATE, mFd, 0);
+            if (p != MAP_FAILED)
+                mpMapped = reinterpret_cast<const uint8_t*>(p);
+        }
+#endif
+
+        if (!mpMapped)
+        {
+            std::cerr << "failed to map asset pack : " << path << "\n";
+            close();
+            return Result::eFailure;
+        }
+
+        PackHeader header;
+        if (mMappedSize < sizeof(PackHeader))
+        {
+            std::cerr << "asset pack header is broken!\n";
+            close();
+            return Result::eFailure;
+        }
+        std::memcpy(&header, mpMapped, sizeof(PackHeader));
+
+        if (std::memcmp(header.magic, packMagic, sizeof(packMagic)) != 0 || header.version != version)
+        {
+            std::cerr << "invalid asset pack (or version mismatch) : " << path << "\n";
+            close();
+            return Result::eFailure;
+        }
+
+        if (mMappedSize < sizeof(PackHeader) + size_t(header.entryCount) * sizeof(PackEntry))
+        {
+            std::cerr << "asset pack index is broken!\n";
+            close();
+            return Result::eFailure;
+        }
+
+        for (uint32_t i = 0; i < header.entryCount; ++i)
+        {
+            PackEntry pe;
+            std::memcpy(&pe, mpMapped + sizeof(PackHeader) + size_t(i) * sizeof(PackEntry), sizeof(PackEntry));
+
+            if (pe.offset > mMappedSize || mMappedSize - pe.offset < pe.size)
+            {
+                std::cerr << "asset pack entry " << i << " is out of file!\n";
+                close();
+                return Result::eFailure;
+            }
+
+            AssetEntry entry;
+            entry.type   = static_cast<AssetType>(pe.type);
+            entry.pData  = mpMapped + pe.offset;
+            entry.size   = static_cast<size_t>(pe.size);
+            entry.format = static_cast<ResourceType>(pe.format);
+            entry.width  = pe.width;
+            entry.height = pe.height;
+
+            // texture levels are packed from level 0
+            if (entry.type == AssetType::eTexture)
+            {
+                if (pe.width == 0 || pe.height == 0 || pe.mipLevels > getFullMipLevels(pe.width, pe.height))
+                {
+                    std::cerr << "asset pack texture " << i << " has invalid size or mip levels!\n";
+                    close();
+                    return Result::eFailure;
+                }
+
+                size_t offset = 0;
+                for (uint32_t level = 0; level < pe.mipLevels; ++level)
+                {
+                    TextureFile::MipLevel ml;
+                    ml.width  = std::max(pe.width >> level, 1u);
+                    ml.height = std::max(pe.height >> level, 1u);
+                    ml.offset = offset;
+                    ml.size   = getTextureLevelSize(entry.format, ml.width, ml.height);
+                    offset += ml.size;
+                    entry.mipLevels.emplace_back(ml);
+                }
+
+                if (offset > entry.size || entry.mipLevels.empty())
+                {
+                    std::cerr << "asset pack texture " << i << " is broken!\n";
+                    close();
+                    return Result::eFailure;
+                }
+            }
+
+            const std::string name(pe.name, strnlen(pe.name, sizeof(pe.name)));
+            mEntries.emplace(name, entry);
+        }
+
+        return Result::eSuccess;
+    }
+
+    void AssetPack::close()
+    {
+        mEntries.clear();
+
+#ifdef _WIN32
+        if (mpMapped)
+            UnmapViewOfFile(mpMapped);
+        if (mMapping)
+            CloseHandle(mMapping);
+        if (mFile)
+            CloseHandle(mFile);
+        mMapping = nullptr;
+        mFile    = nullptr;
+#else
+        if (mpMapped)
+            munmap(const_cast<uint8_t*>(mpMapped), mMappedSize);
+        if (mFd >= 0)
+            ::close(mFd);
+        mFd = -1;
+#endif
+
+        mpMapped    = nullptr;
+        mMappedSize = 0;
+    }
+
+    bool AssetPack::isOpened() const
+    {
+        return mpMapped != nullptr;
+    }
+
+    Result AssetPack::find(std::string_view name, AssetEntry& entry_out) const
+    {
+        const auto itr = mEntries.find(std::string(name));
+        if (itr == mEntries.end())
+        {
+            std::cerr << "asset is not found in pack : " << name << "\n";
+            return Result::eFailure;
+        }
+
+        entry_out = itr->second;
+        return Result::eSuccess;
+    }
+
+    std::vector<std::string> AssetPack::getNames() const
+    {
+        std::vector<std::string> names;
+        names.reserve(mEntries.size());
+        for (const auto& [name, entry] : mEntries)
+            names.emplace_back(name);
+
+        return names;
+    }
+
+    Result AssetPack::loadShader(std::string_view name, Shader& shader_out, std::string_view entryPoint) const
+    {
+        AssetEntry entry;
+        if (Result::eSuccess != find(name, entry))
+            return Result::eFailure;
+
+        if (entry.type != AssetType::eShader)
+        {
+            std::cerr << "asset is not a shader : " << name << "\n";
+            return Result::eFailure;
+        }
+
+        shader_out.load(entry.pData, entry.size, name, entryPoint);
+        return Result::eSuccess;
+    }
+
+    Result AssetPackWriter::addTexture(std::string_view name, const TextureFile& file)
+    {
+        if (!file.isLoaded())
+        {
+            std::cerr << "texture file is not loaded!\n";
+            return Result::eFailure;
+        }
+
+        Blob blob;
+        blob.name      = std::string(name);
+        blob.type      = AssetType::eTexture;
+        blob.format    = file.getFormat();
+        blob.width     = file.getWidth();
+        blob.height    = file.getHeight();
+        blob.mipLevels = static_cast<uint32_t>(file.getMipLevels().size());
+        blob.data      = file.getData();
+
+        return addBlob(std::move(blob));
+    }
+
+    Result AssetPackWriter::addBuffer(std::string_view name, const AssetType type, const void* pData, const size_t size)
+    {
+        if (type != AssetType::eVertexBuffer && type != AssetType::eIndexBuffer)
+        {
+            std::cerr << "invalid asset type for buffer!\n";
+            return Result::eFailure;
+        }
+
+        Blob blob{};
+        blob.name = std::string(name);
+        blob.type = type;
+        blob.data.assign(reinterpret_cast<const uint8_t*>(pData), reinterpret_cast<const uint8_t*>(pData) + size);
+
+        return addBlob(std::move(blob));
+    }
+
+    Result AssetPackWriter::addShader(std::string_view name, const Shader& shader)
+    {
+        const auto& byteCode = shader.getShaderByteCode();
+
+        Blob blob{};
+        blob.name = std::string(name);
+        blob.type = AssetType::eShader;
+        blob.data.assign(byteCode.begin(), byteCode.end());
+
+        return addBlob(std::move(blob));
+    }
+
+    Result AssetPackWriter::addBlob(Blob&& blob)
+    {
+        if (blob.name.empty() || blob.name.size() >= sizeof(PackEntry::name))
+        {
+            std::cerr << "asset name must be 1 - " << sizeof(PackEntry::name) - 1 << " characters : " << blob.name << "\n";
+            return Result::eFailure;
+        }
+
+        if (std::any_of(mBlobs.begin(), mBlobs.end(), [&blob](const Blob& b) { return b.name == blob.name; }))
+        {
+            std::cerr << "asset name is duplicated : " << blob.name << "\n";
+            return Result::eFailure;
+        }
+
+        mBlobs.emplace_back(std::move(blob));
+        return Result::eSuccess;
+    }
+
+    Result AssetPackWriter::write(std::string_view path) const
+    {
+        std::ofstream outfile(std::string(path), std::ios::binary);
+        if (!outfile)
+        {
+            std::cerr << "failed to open asset pack : " << path << "\n";
+            return Result::eFailure;
+        }
+
+        const auto align = [](uint64_t offset) { return (offset + AssetPack::blobAlignment - 1) / AssetPack::blobAlignment * AssetPack::blobAlignment; };
+
+        PackHeader header{};
+        std::memcpy(header.magic, packMagic, sizeof(packMagic));
+        header.version    = AssetPack::version;
+        header.entryCount = static_cast<uint32_t>(mBlobs.size());
+
+        std::vector<PackEntry> entries(mBlobs.size());
+        uint64_t offset = align(sizeof(PackHeader) + sizeof(PackEntry) * mBlobs.size());
+        for (size_t i = 0; i < mBlobs.size(); ++i)
+        {
+            const auto& blob = mBlobs[i];
+            auto& pe         = entries[i];
+
+            std::memset(&pe, 0, sizeof(PackEntry));
+            std::memcpy(pe.name, blob.name.data(), blob.name.size());
+            pe.type      = static_cast<uint32_t>(blob.type);
+            pe.format    = static_cast<uint32_t>(blob.format);
+            pe.width     = blob.width;
+            pe.height    = blob.height;
+            pe.mipLevels = blob.mipLevels;
+            pe.offset    = offset;
+            pe.size      = blob.data.size();
+
+            offset = align(offset + blob.data.size());
+        }
+
+        outfile.write(reinterpret_cast<const char*>(&header), sizeof(PackHeader));
+        outfile.write(reinterpret_cast<const char*>(entries.data()), sizeof(PackEntry) * entries.size());
+
+        const std::vector<char> padding(AssetPack::blobAlignment, 0);
+        for (size_t i = 0; i < mBlobs.size(); ++i)
+        {
+            outfile.write(padding.data(), static_cast<std::streamsize>(entries[i].offset - static_cast<uint64_t>(outfile.tellp())));
+            outfile.write(reinterpret_cast<const char*>(mBlobs[i].data.data()), mBlobs[i].data.size());
+        }
+
+        if (!outfile)
+        {
+            std::cerr << "failed to write asset pack : " << path << "\n";
+            return Result::eFailure;
+        }
+
+        return Result::eSuccess;
+    }
+}
@@ -6,6 +6,11 @@ namespace Cutlass
 {   
     void CommandList::begin(const HRenderPass& handle, bool clearFlag, const ColorClearValue ccv, const DepthClearValue dcv)
     {
+        if(queueType == QueueType::eCompute)
+        {
+            std::cerr << "render pass can not begin on compute queue!\n";
+            return;
+        }
         mCommands.emplace_back(CommandType::eBegin, CmdBegin{handle, ccv, dcv, clearFlag});
         begun = true;
         useSub = false;
@@ -13,6 +18,11 @@ namespace Cutlass
 
     void CommandList::begin(const HRenderPass& handle, const DepthClearValue dcv, const ColorClearValue ccv)
     {
+        if(queueType == QueueType::eCompute)
+        {
+            std::cerr << "render pass can not begin on compute queue!\n";
+            return;
+        }
         mCommands.emplace_back(CommandType::eBegin, CmdBegin{handle, ccv, dcv, true});
         begun = true;
         useSub = false;
@@ -28,6 +38,17 @@ namespace Cutlass
         graphicsPipeline = false;
     }
 
+    void CommandList::nextSubpass()
+    {
+        if(!begun)
+        {
+            std::cerr << "This command list is not begun!\n";
+            return;
+        }
+        mCommands.emplace_back(CommandType::eNextSubpass, CmdNextSubpass{});
+        graphicsPipeline = false;
+    }
+
     void CommandList::bind(const HGraphicsPipeline& handle)
     {
         if(!begun)
@@ -39,6 +60,17 @@ namespace Cutlass
         graphicsPipeline = true;
     }
 
+    void CommandList::bind(const HComputePipeline& handle)
+    {
+        if(queueType != QueueType::eCompute)
+        {
+            std::cerr << "compute pipeline can be bound only on compute queue!\n";
+            return;
+        }
+        mCommands.emplace_back(CommandType::eBindComputePipeline, CmdBindComputePipeline{handle});
+        computePipeline = true;
+    }
+
     void CommandList::bind(const HBuffer& VBHandle)
     {
         mCommands.emplace_back(CommandType::eBindVB, CmdBindVB{VBHandle});
@@ -54,7 +86,7 @@ namespace Cutlass
 
     void CommandList::bind(const uint16_t set, const ShaderResourceSet& shaderResourceSet)
     {
-        if(!graphicsPipeline)
+        if(!graphicsPipeline && !computePipeline)
         {
             std::cerr << "bind graphics pipeline first!\n";
             return;
@@ -72,6 +104,16 @@ namespace Cutlass
         indexed = true;
     }
 
+    void CommandList::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+    {
+        if(!computePipeline)
+        {
+            std::cerr << "bind compute pipeline first!\n";
+            return;
+        }
+        mCommands.emplace_back(CommandType::eDispatch, CmdDispatch{groupCountX, groupCountY, groupCountZ});
+    }
+
     // void CommandList::present()
     // {
     //     mCommands.emplace_back(CommandType::ePresent, CmdPresent{});
@@ -120,6 +162,17 @@ namespace Cutlass
         mCommands.emplace_back(CommandType::eBarrier, CmdBarrier{handle});//, std::nullopt});
     }
 
+    void CommandList::transition(const HTexture& handle, const TextureAccess src, const TextureAccess dst,
+                                 const TextureAccess discarded)
+    {
+        if(begun)
+        {
+            std::cerr << "transition can not be recorded inside render pass!\n";
+            return;
+        }
+        mCommands.emplace_back(CommandType::eTransition, CmdTransition{handle, src, dst, discarded});
+    }
+
     void CommandList::renderImGui()
     {
         if(!begun)
@@ -130,6 +183,16 @@ namespace Cutlass
         mCommands.emplace_back(CommandType::eRenderImGui, CmdRenderImGui{});
     }
 
+    void CommandList::beginScope(std::string_view name)
+    {
+        mCommands.emplace_back(CommandType::eBeginScope, CmdBeginScope{std::string(name)});
+    }
+
+    void CommandList::endScope()
+    {
+        mCommands.emplace_back(CommandType::eEndScope, CmdEndScope{});
+    }
+
     void CommandList::append(CommandList& commandList)
     {
         auto& icl = commandList.getInternalCommandData();
@@ -178,6 +241,11 @@ namespace Cutlass
         return combinedTextureCount;
     }
 
+    QueueType CommandList::getQueueType() const
+    {
+        return queueType;
+    }
+
     //------------------------------------------------------------------
 
     SubCommandList::SubCommandList(const HRenderPass& usedInMainCommand)
@@ -1,9 +1,17 @@
 #include "../include/Context.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <variant>
 #include <vector>
 
@@ -52,31 +60,95 @@ namespace Cutlass
             abort();
     }
 
+    // input callbacks, user pointer of each window is its Event
+    // ImGui chains these callbacks when it is set up after the window creation
+    static void KeyCallback(GLFWwindow* pWindow, int key, int scancode, int action, int mods)
+    {
+        static_cast<Event*>(glfwGetWindowUserPointer(pWindow))->onKey(key, action);
+    }
+
+    static void CursorPosCallback(GLFWwindow* pWindow, double x, double y)
+    {
+        static_cast<Event*>(glfwGetWindowUserPointer(pWindow))->onCursorPos(x, y);
+    }
+
+    static void ScrollCallback(GLFWwindow* pWindow, double x, double y)
+    {
+        static_cast<Event*>(glfwGetWindowUserPointer(pWindow))->onScroll(x, y);
+    }
+
+    static void CharCallback(GLFWwindow* pWindow, unsigned int codepoint)
+    {
+        static_cast<Event*>(glfwGetWindowUserPointer(pWindow))->onChar(codepoint);
+    }
+
     Context::Context()
     {
         mIsInitialized = false;
+        mIsHeadless    = false;
         mMaxFrame      = 0;
         mNextWindowHandle.setID(1);
         mNextBufferHandle.setID(1);
         mNextTextureHandle.setID(1);
         mNextRenderPassHandle.setID(1);
         mNextGPHandle.setID(1);
+        mNextCPHandle.setID(1);
         mNextCBHandle.setID(1);
+        mNextSamplerHandle.setID(1);
+        mNextReadbackHandle.setID(1);
+        mSamplerAnisotropy      = false;
+        mMaxSamplerAnisotropy   = 1.f;
+        mGPUProfilerEnabled     = false;
+        mTimestampPeriod        = 1.f;
+        mGraphicsTimestampValidBits = 0;
+        mComputeTimestampValidBits  = 0;
+        mPipelineStatisticsEnabled   = false;
+        mPipelineStatisticsSupported = false;
+        mvkGetCalibratedTimestampsEXT = nullptr;
+        mMonotonicTimeDomain          = false;
+        mFrameTimes.fill(0.f);
+        mFrameTimeIndex  = 0;
+        mLastFrameEndNs  = 0;
+        mMemoryBudgetSupported = false;
+        mHostFallbackCount     = 0;
+        mTransientRequestedSize = 0;
+        mTransientAllocatedSize = 0;
         mAppName = std::string("CutlassApp");
     }
 
-    Context::Context(std::string_view appName, bool debugFlag, Result& result_out)
+    Context::Context(std::string_view appName, bool debugFlag, Result& result_out, bool headless)
     {
         mIsInitialized = false;
+        mIsHeadless    = false;
         mMaxFrame      = 0;
         mNextWindowHandle.setID(1);
         mNextBufferHandle.setID(1);
         mNextTextureHandle.setID(1);
         mNextRenderPassHandle.setID(1);
         mNextGPHandle.setID(1);
+        mNextCPHandle.setID(1);
         mNextCBHandle.setID(1);
-
-        result_out = initialize(appName, debugFlag);
+        mNextSamplerHandle.setID(1);
+        mNextReadbackHandle.setID(1);
+        mSamplerAnisotropy      = false;
+        mMaxSamplerAnisotropy   = 1.f;
+        mGPUProfilerEnabled     = false;
+        mTimestampPeriod        = 1.f;
+        mGraphicsTimestampValidBits = 0;
+        mComputeTimestampValidBits  = 0;
+        mPipelineStatisticsEnabled   = false;
+        mPipelineStatisticsSupported = false;
+        mvkGetCalibratedTimestampsEXT = nullptr;
+        mMonotonicTimeDomain          = false;
+        mFrameTimes.fill(0.f);
+        mFrameTimeIndex  = 0;
+        mLastFrameEndNs  = 0;
+        mMemoryBudgetSupported = false;
+        mHostFallbackCount     = 0;
+        mTransientRequestedSize = 0;
+        mTransientAllocatedSize = 0;
+
+        result_out = initialize(appName, debugFlag, headless);
     }
 
     Context::~Context()
@@ -88,26 +160,30 @@ namespace Cutlass
         }
     }
 
-    Result Context::initialize(std::string_view appName, bool debugFlag)
+    Result Context::initialize(std::string_view appName, bool debugFlag, bool headless)
     {
         Result result;
 
-        mAppName   = std::string(appName);
-        mDebugFlag = debugFlag;
+        mAppName    = std::string(appName);
+        mDebugFlag  = debugFlag;
+        mIsHeadless = headless;
 
         std::cerr << "initializing started...\n";
 
-        // GLFW initialization
-
-        if (!glfwInit())
+        // GLFW initialization (headless context has no window)
+        if (mIsHeadless)
+            std::cerr << "headless mode, GLFW is not used\n";
+        else
         {
-            std::cerr << "Failed to initialize GLFW!\n";
-            exit(-1);
-        }
-        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+            if (!glfwInit())
+            {
+                std::cerr << "Failed to initialize GLFW!\n";
+                return Result::eFailure;
+            }
+            glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 
-        std::cerr << "GLFW initialized\n";
+            std::cerr << "GLFW initialized\n";
+        }
 
         // instance
         result = createInstance();
@@ -144,6 +220,28 @@ namespace Cutlass
         }
         std::cerr << "found index of GraphicsQueue\n";
 
+        // search transfer queue
+        result = searchTransferQueueIndex();
+        if (Result::eSuccess != result)
+        {
+            return result;
+        }
+        if (mTransferQueueIndex != mGraphicsQueueIndex)
+            std::cerr << "found index of dedicated TransferQueue\n";
+        else
+            std::cerr << "dedicated TransferQueue was not found, uploads use GraphicsQueue\n";
+
+        // search compute queue
+        result = searchComputeQueueIndex();
+        if (Result::eSuccess != result)
+        {
+            return result;
+        }
+        if (mComputeQueueIndex != mGraphicsQueueIndex)
+            std::cerr << "found index of async ComputeQueue\n";
+        else
+            std::cerr << "async ComputeQueue was not found, compute commands use GraphicsQueue\n";
+
         // logical device
         result = createDevice();
         if (Result::eSuccess != result)
@@ -160,6 +258,14 @@ namespace Cutlass
         }
         std::cerr << "created VkCommandPool\n";
 
+        // semaphores for cross queue dependencies
+        result = createTimelineSemaphores();
+        if (Result::eSuccess != result)
+        {
+            return result;
+        }
+        std::cerr << "created timeline semaphores\n";
+
         // descriptor pool
         result = addDescriptorPool();
         if (Result::eSuccess != result)
@@ -174,6 +280,11 @@ namespace Cutlass
         return Result::eSuccess;
     }
 
+    bool Context::isHeadless() const
+    {
+        return mIsHeadless;
+    }
+
     Result Context::destroy()
     {
         if (!mIsInitialized)
@@ -192,7 +303,7 @@ namespace Cutlass
             if (e.second.mBuffer)
                 vkDestroyBuffer(mDevice, e.second.mBuffer.value(), nullptr);
             if (e.second.mMemory)
-                vkFreeMemory(mDevice, e.second.mMemory.value(), nullptr);
+                freeMemory(e.second.mMemory.value());
         }
         std::cerr << "destroyed user allocated buffers(size : " << mBufferMap.size()
                   << ")\n";
@@ -210,21 +321,26 @@ namespace Cutlass
             if (e.second.mImage)
                 vkDestroyImage(mDevice, e.second.mImage.value(), nullptr);
             if (e.second.mMemory)
-                vkFreeMemory(mDevice, e.second.mMemory.value(), nullptr);
-
-            if (e.second.mSampler)
-                vkDestroySampler(mDevice, e.second.mSampler.value(), nullptr);
+                freeMemory(e.second.mMemory.value());
         }
 
+        // shared by transient textures
+        for (auto& block : mTransientBlocks)
+            freeMemory(block.mMemory);
+        mTransientBlocks.clear();
+
         std::cerr << "destroyed user allocated textures(size : " << mImageMap.size()
                   << ")\n";
-        std::cerr << "destroyed user allocated sampler\n";
         mImageMap.clear();
 
+        // samplers are shared by textures, so they are destroyed only here
+        for (auto& e : mSamplerMap)
+            vkDestroySampler(mDevice, e.second.mSampler, nullptr);
+        std::cerr << "destroyed sampler cache(size : " << mSamplerMap.size() << ")\n";
+        mSamplerMap.clear();
+
         for (auto& e : mRPMap)
         {
-            for (auto& f : e.second.mFences)
-                vkDestroyFence(mDevice, f, nullptr);
             for (const auto& pcSem : e.second.mPresentCompletedSems)
                 vkDestroySemaphore(mDevice, pcSem, nullptr);
             for (const auto& rcSem : e.second.mRenderCompletedSems)
@@ -248,6 +364,18 @@ namespace Cutlass
                 vkDestroyPipeline(mDevice, e.second.mPipeline.value(), nullptr);
         }
 
+        for (auto& e : mCPMap)
+        {
+            for (const auto& dsl : e.second.mDescriptorSetLayouts)
+                vkDestroyDescriptorSetLayout(mDevice, dsl, nullptr);
+            if (e.second.mPipelineLayout)
+                vkDestroyPipelineLayout(mDevice, e.second.mPipelineLayout.value(),
+                                        nullptr);
+            if (e.second.mPipeline)
+                vkDestroyPipeline(mDevice, e.second.mPipeline.value(), nullptr);
+        }
+        mCPMap.clear();
+
         for (auto& co : mCommandBufferMap)
         {
             if (!co.second.mDescriptorSets.empty())
@@ -272,7 +400,13 @@ namespace Cutlass
                 }
             }
 
-            vkFreeCommandBuffers(mDevice, mCommandPool,
+            for (auto& f : co.second.mFences)
+                vkDestroyFence(mDevice, f, nullptr);
+
+            destroyProfilerQueries(co.second);
+
+            vkFreeCommandBuffers(mDevice,
+                                 co.second.mQueueType == QueueType::eCompute ? mComputeCommandPool : mCommandPool,
                                  uint32_t(co.second.mCommandBuffers.size()),
                                  co.second.mCommandBuffers.data());
         }
@@ -280,15 +414,28 @@ namespace Cutlass
         std::cerr << "destroyed command buffers(size : " << mCommandBufferMap.size()
                   << ")\n";
         mCommandBufferMap.clear();
-        // for(auto& e : mSamplerMap)
-        //{
-        //     vkDestroySampler(mDevice, e.second, nullptr);
-        // }
-        // mSamplerMap.clear();
+
+        // tickets not released by user
+        for (auto& e : mReadbackMap)
+        {
+            vkDestroyFence(mDevice, e.second.mFence, nullptr);
+            vkFreeCommandBuffers(mDevice, mCommandPool, 1, &e.second.mCommand);
+        }
+        mReadbackMap.clear();
+        mReadbackOrder.clear();
+        for (auto& f : mReadbackFencePool)
+            vkDestroyFence(mDevice, f, nullptr);
+        mReadbackFencePool.clear();
+        destroyReadbackRing();
 
         vkDestroyCommandPool(mDevice, mCommandPool, nullptr);
+        vkDestroyCommandPool(mDevice, mTransferCommandPool, nullptr);
+        vkDestroyCommandPool(mDevice, mComputeCommandPool, nullptr);
         std::cerr << "destroyed command pool\n";
 
+        vkDestroySemaphore(mDevice, mGraphicsTimelineSem, nullptr);
+        vkDestroySemaphore(mDevice, mComputeTimelineSem, nullptr);
+
         for (auto& dp_pair : mDescriptorPools)
         {
             vkDestroyDescriptorPool(mDevice, dp_pair.second, nullptr);
@@ -350,8 +497,11 @@ namespace Cutlass
         vkDestroyInstance(mInstance, nullptr);
         std::cerr << "destroyed instance\n";
 
-        glfwTerminate();
-        std::cerr << "GLFW Terminated\n";
+        if (!mIsHeadless)
+        {
+            glfwTerminate();
+            std::cerr << "GLFW Terminated\n";
+        }
 
         std::cerr << "all destroying process succeeded\n";
         mIsInitialized = false;
@@ -377,7 +527,7 @@ namespace Cutlass
         if (bo.mBuffer)
             vkDestroyBuffer(mDevice, bo.mBuffer.value(), nullptr);
         if (bo.mMemory)
-            vkFreeMemory(mDevice, bo.mMemory.value(), nullptr);
+            freeMemory(bo.mMemory.value());
 
         mBufferMap.erase(handle);
 
@@ -409,10 +559,7 @@ namespace Cutlass
         if (io.mImage)
             vkDestroyImage(mDevice, io.mImage.value(), nullptr);
         if (io.mMemory)
-            vkFreeMemory(mDevice, io.mMemory.value(), nullptr);
-
-        if (io.mSampler)
-            vkDestroySampler(mDevice, io.mSampler.value(), nullptr);
+            freeMemory(io.mMemory.value());
 
         mImageMap.erase(handle);
 
@@ -501,6 +648,32 @@ namespace Cutlass
         return result;
     }
 
+    Result Context::destroyComputePipeline(const HComputePipeline& handle)
+    {
+        if (mDebugFlag && mCPMap.count(handle) <= 0)
+        {
+            std::cerr << "invalid compute pipeline handle!\n";
+            return Result::eFailure;
+        }
+
+        auto& cpo = mCPMap[handle];
+
+        // stop queue before
+        vkQueueWaitIdle(mComputeQueue);
+
+        for (const auto& dsl : cpo.mDescriptorSetLayouts)
+            vkDestroyDescriptorSetLayout(mDevice, dsl, nullptr);
+
+        if (cpo.mPipelineLayout)
+            vkDestroyPipelineLayout(mDevice, cpo.mPipelineLayout.value(), nullptr);
+        if (cpo.mPipeline)
+            vkDestroyPipeline(mDevice, cpo.mPipeline.value(), nullptr);
+
+        mCPMap.erase(handle);
+
+        return Result::eSuccess;
+    }
+
     Result Context::destroyCommandBuffer(const HCommandBuffer& handle)
     {
         Result result = Result::eSuccess;
@@ -515,6 +688,13 @@ namespace Cutlass
 
         // stop queue before
         vkQueueWaitIdle(mDeviceQueue);
+        if (co.mQueueType == QueueType::eCompute)
+            vkQueueWaitIdle(mComputeQueue);
+
+        for (auto& f : co.mFences)
+            vkDestroyFence(mDevice, f, nullptr);
+
+        destroyProfilerQueries(co);
 
         if (!co.mDescriptorSets.empty())
         {
@@ -536,7 +716,8 @@ namespace Cutlass
             }
         }
 
-        vkFreeCommandBuffers(mDevice, mCommandPool,
+        vkFreeCommandBuffers(mDevice,
+                             co.mQueueType == QueueType::eCompute ? mComputeCommandPool : mCommandPool,
                              uint32_t(co.mCommandBuffers.size()),
                              co.mCommandBuffers.data());
 
@@ -595,6 +776,44 @@ namespace Cutlass
         return Result::eSuccess;
     }
 
+    VkAttachmentLoadOp Context::convertLoadOp(const LoadOp op)
+    {
+        switch (op)
+        {
+            case LoadOp::eClear:
+                return VK_ATTACHMENT_LOAD_OP_CLEAR;
+            case LoadOp::eLoad:
+                return VK_ATTACHMENT_LOAD_OP_LOAD;
+            case LoadOp::eDontCare:
+                return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        }
+
+        return VK_ATTACHMENT_LOAD_OP_CLEAR;
+    }
+
+    VkAttachmentStoreOp Context::convertStoreOp(const StoreOp op)
+    {
+        switch (op)
+        {
+            case StoreOp::eStore:
+                return VK_ATTACHMENT_STORE_OP_STORE;
+            case StoreOp::eDontCare:
+                return VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        }
+
+        return VK_ATTACHMENT_STORE_OP_STORE;
+    }
+
+    bool Context::isPresentationExtension(const char* extensionName)
+    {
+        const std::string_view name(extensionName);
+        for (const auto& keyword : {"surface", "swapchain", "present", "display", "full_screen_exclusive", "hdr_metadata"})
+            if (name.find(keyword) != std::string_view::npos)
+                return true;
+
+        return false;
+    }
+
     Result Context::createInstance()
     {
         Result result;
@@ -630,6 +849,8 @@ namespace Cutlass
             std::cerr << "enabled extensions : \n";
             for (const auto& v : props)
             {
+                if (mIsHeadless && isPresentationExtension(v.extensionName))
+                    continue;
                 extensions.push_back(v.extensionName);
                 std::cerr << v.extensionName << "\n";
             }
@@ -729,6 +950,11 @@ namespace Cutlass
 
         // get physical memory properties
         vkGetPhysicalDeviceMemoryProperties(mPhysDev, &mPhysMemProps);
+        mHeapUsages.assign(mPhysMemProps.memoryHeapCount, 0);
+        mTypeUsages.assign(mPhysMemProps.memoryTypeCount, 0);
+        mTypeAllocationCounts.assign(mPhysMemProps.memoryTypeCount, 0);
+        mHeapBudgets.assign(mPhysMemProps.memoryHeapCount, 0);
+        mHeapProcessUsages.assign(mPhysMemProps.memoryHeapCount, 0);
 
         return Result::eSuccess;
     }
@@ -743,10 +969,60 @@ namespace Cutlass
         for (uint32_t i = 0; i < propCount; ++i)
             if (props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
             {
-                mGraphicsQueueIndex = i;
+                mGraphicsQueueIndex         = i;
+                mGraphicsTimestampValidBits = props[i].timestampValidBits;
+                break;
+            }
+
+        return Result::eSuccess;
+    }
+
+    Result Context::searchTransferQueueIndex()
+    {
+        uint32_t propCount;
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysDev, &propCount, nullptr);
+        std::vector<VkQueueFamilyProperties> props(propCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysDev, &propCount, props.data());
+
+        // fallback : graphics queue can also execute transfer commands
+        mTransferQueueIndex = mGraphicsQueueIndex;
+
+        // transfer only queue family (DMA engine)
+        for (uint32_t i = 0; i < propCount; ++i)
+            if ((props[i].queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+                !(props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) &&
+                !(props[i].queueFlags & VK_QUEUE_COMPUTE_BIT))
+            {
+                mTransferQueueIndex = i;
+                break;
+            }
+
+        mUploadStats.dedicatedTransferQueue = mTransferQueueIndex != mGraphicsQueueIndex;
+
+        return Result::eSuccess;
+    }
+
+    Result Context::searchComputeQueueIndex()
+    {
+        uint32_t propCount;
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysDev, &propCount, nullptr);
+        std::vector<VkQueueFamilyProperties> props(propCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysDev, &propCount, props.data());
+
+        // fallback : graphics queue can also execute compute commands
+        mComputeQueueIndex = mGraphicsQueueIndex;
+
+        // compute only queue family (async compute)
+        for (uint32_t i = 0; i < propCount; ++i)
+            if ((props[i].queueFlags & VK_QUEUE_COMPUTE_BIT) &&
+                !(props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            {
+                mComputeQueueIndex = i;
                 break;
             }
 
+        mComputeTimestampValidBits = props[mComputeQueueIndex].timestampValidBits;
+
         return Result::eSuccess;
     }
 
@@ -776,23 +1052,65 @@ namespace Cutlass
 
         {
             const float defaultQueuePriority(1.0f);
-            VkDeviceQueueCreateInfo devQueueCI{};
-            devQueueCI.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-            devQueueCI.queueFamilyIndex = mGraphicsQueueIndex;
-            devQueueCI.queueCount       = 1;
-            devQueueCI.pQueuePriorities = &defaultQueuePriority;
+            std::vector<VkDeviceQueueCreateInfo> devQueueCIs;
+            {
+                VkDeviceQueueCreateInfo devQueueCI{};
+                devQueueCI.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+                devQueueCI.queueFamilyIndex = mGraphicsQueueIndex;
+                devQueueCI.queueCount       = 1;
+                devQueueCI.pQueuePriorities = &defaultQueuePriority;
+                devQueueCIs.emplace_back(devQueueCI);
+            }
+
+            for (const auto index : {mTransferQueueIndex, mComputeQueueIndex})
+            {
+                if (std::any_of(devQueueCIs.begin(), devQueueCIs.end(),
+                                [index](const VkDeviceQueueCreateInfo& ci)
+                                { return ci.queueFamilyIndex == index; }))
+                    continue;
+
+                VkDeviceQueueCreateInfo devQueueCI{};
+                devQueueCI.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+                devQueueCI.queueFamilyIndex = index;
+                devQueueCI.queueCount       = 1;
+                devQueueCI.pQueuePriorities = &defaultQueuePriority;
+                devQueueCIs.emplace_back(devQueueCI);
+            }
+
+            // for cross queue dependencies
+            VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+            timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+            timelineFeatures.timelineSemaphore = VK_TRUE;
+
+            // anisotropic filtering is enabled only if supported
+            VkPhysicalDeviceFeatures supportedFeatures;
+            vkGetPhysicalDeviceFeatures(mPhysDev, &supportedFeatures);
+            VkPhysicalDeviceFeatures features{};
+            features.samplerAnisotropy       = supportedFeatures.samplerAnisotropy;
+            features.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+
+            VkPhysicalDeviceProperties props;
+            vkGetPhysicalDeviceProperties(mPhysDev, &props);
+            mSamplerAnisotropy    = supportedFeatures.samplerAnisotropy == VK_TRUE;
+            mMaxSamplerAnisotropy = props.limits.maxSamplerAnisotropy;
+            mTimestampPeriod      = props.limits.timestampPeriod;
+            mPipelineStatisticsSupported = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
 
             std::vector<const char*> extensions;
             for (const auto& v : devExtProps)
             {
+                if (mIsHeadless && isPresentationExtension(v.extensionName))
+                    continue;
                 if (strcmp(v.extensionName, "VK_KHR_buffer_device_address"))
                     extensions.push_back(v.extensionName);
             }
 
             VkDeviceCreateInfo ci{};
             ci.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-            ci.pQueueCreateInfos       = &devQueueCI;
-            ci.queueCreateInfoCount    = 1;
+            ci.pNext                   = &timelineFeatures;
+            ci.pQueueCreateInfos       = devQueueCIs.data();
+            ci.queueCreateInfoCount    = uint32_t(devQueueCIs.size());
+            ci.pEnabledFeatures        = &features;
             ci.ppEnabledExtensionNames = extensions.data();
             ci.enabledExtensionCount   = uint32_t(extensions.size());
 
@@ -804,6 +1122,39 @@ namespace Cutlass
         }
 
         vkGetDeviceQueue(mDevice, mGraphicsQueueIndex, 0, &mDeviceQueue);
+        vkGetDeviceQueue(mDevice, mTransferQueueIndex, 0, &mTransferQueue);
+        vkGetDeviceQueue(mDevice, mComputeQueueIndex, 0, &mComputeQueue);
+
+        // GPU timestamps are mapped onto the host clock only if the device can be calibrated
+        const bool calibrateable = std::any_of(devExtProps.begin(), devExtProps.end(),
+                                               [](const VkExtensionProperties& v)
+                                               { return strcmp(v.extensionName, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) == 0; });
+        const auto getTimeDomains = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(
+            vkGetInstanceProcAddr(mInstance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+        if (calibrateable && getTimeDomains)
+        {
+            uint32_t count = 0;
+            getTimeDomains(mPhysDev, &count, nullptr);
+            std::vector<VkTimeDomainEXT> domains(count);
+            getTimeDomains(mPhysDev, &count, domains.data());
+
+            const auto hasDomain = [&domains](const VkTimeDomainEXT domain)
+            { return std::find(domains.begin(), domains.end(), domain) != domains.end(); };
+
+            if (hasDomain(VK_TIME_DOMAIN_DEVICE_EXT))
+                mvkGetCalibratedTimestampsEXT = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(
+                    vkGetDeviceProcAddr(mDevice, "vkGetCalibratedTimestampsEXT"));
+#ifdef __linux__
+            // steady_clock is CLOCK_MONOTONIC on linux
+            mMonotonicTimeDomain = mvkGetCalibratedTimestampsEXT && hasDomain(VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT);
+#endif
+        }
+
+        // all supported extensions are enabled
+        mMemoryBudgetSupported = std::any_of(devExtProps.begin(), devExtProps.end(),
+                                             [](const VkExtensionProperties& v)
+                                             { return strcmp(v.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0; });
+        updateMemoryBudget();
 
         return Result::eSuccess;
     }
@@ -825,6 +1176,67 @@ namespace Cutlass
                 return result;
             }
         }
+
+        // for uploading
+        {
+            VkCommandPoolCreateInfo ci{};
+            ci.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            ci.queueFamilyIndex = mTransferQueueIndex;
+            ci.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+            result = checkVkResult(
+                vkCreateCommandPool(mDevice, &ci, nullptr, &mTransferCommandPool));
+            if (Result::eSuccess != result)
+            {
+                return result;
+            }
+        }
+
+        // for async compute
+        {
+            VkCommandPoolCreateInfo ci{};
+            ci.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            ci.queueFamilyIndex = mComputeQueueIndex;
+            ci.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+            result = checkVkResult(
+                vkCreateCommandPool(mDevice, &ci, nullptr, &mComputeCommandPool));
+            if (Result::eSuccess != result)
+            {
+                return result;
+            }
+        }
+        return Result::eSuccess;
+    }
+
+    Result Context::createTimelineSemaphores()
+    {
+        Result result;
+
+        VkSemaphoreTypeCreateInfo tci{};
+        tci.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        tci.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        tci.initialValue  = 0;
+
+        VkSemaphoreCreateInfo ci{};
+        ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        ci.pNext = &tci;
+
+        result = checkVkResult(vkCreateSemaphore(mDevice, &ci, nullptr, &mGraphicsTimelineSem));
+        if (Result::eSuccess != result)
+        {
+            return result;
+        }
+
+        result = checkVkResult(vkCreateSemaphore(mDevice, &ci, nullptr, &mComputeTimelineSem));
+        if (Result::eSuccess != result)
+        {
+            return result;
+        }
+
+        mGraphicsTimelineValue = 0;
+        mComputeTimelineValue  = 0;
+
         return Result::eSuccess;
     }
 
@@ -832,13 +1244,20 @@ namespace Cutlass
     {
         Result result = Result::eSuccess;
 
-        std::array<VkDescriptorPoolSize, 2> sizes;
+        std::array<VkDescriptorPoolSize, 4> sizes;
 
         sizes[0].descriptorCount = DescriptorPoolInfo::poolUBSize;
         sizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 
+        sizes[1].descriptorCount = DescriptorPoolInfo::poolCTSize;
+        sizes[1].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+        // storage textures and input attachments are counted as combined textures
+        sizes[2].descriptorCount = DescriptorPoolInfo::poolCTSize;
+        sizes[2].type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+
         sizes.back().descriptorCount = DescriptorPoolInfo::poolCTSize;
-        sizes.back().type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        sizes.back().type            = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
 
         VkDescriptorPoolCreateInfo dpci{};
         dpci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -938,7 +1357,7 @@ namespace Cutlass
         return Result::eSuccess;
     }
 
-    Result Context::createSwapchain(WindowObject& wo, bool vsync)
+    Result Context::createSwapchain(WindowObject& wo, VkSwapchainKHR oldSwapchain)
     {
         Result result;
         mMaxFrame = std::max(wo.mMaxFrameNum, mMaxFrame);
@@ -963,22 +1382,22 @@ namespace Cutlass
         }
 
         auto& extent = wo.mSurfaceCaps.currentExtent;
-        if (extent.width <= 0u || extent.height <= 0u)
+        if (extent.width <= 0u || extent.height <= 0u || extent.width == UINT32_MAX)
         {
-            // ignore invalid param and use window size
+            // surface size is determined by the swapchain, use framebuffer size of the window
             int width, height;
-            glfwGetWindowSize(wo.mpWindow.value(), &width, &height);
-            extent.width  = static_cast<uint32_t>(width);
-            extent.height = static_cast<uint32_t>(height);
+            glfwGetFramebufferSize(wo.mpWindow.value(), &width, &height);
+            extent.width  = std::clamp(static_cast<uint32_t>(width), wo.mSurfaceCaps.minImageExtent.width, wo.mSurfaceCaps.maxImageExtent.width);
+            extent.height = std::clamp(static_cast<uint32_t>(height), wo.mSurfaceCaps.minImageExtent.height, wo.mSurfaceCaps.maxImageExtent.height);
         }
 
-        wo.mPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+        wo.mPresentMode = selectPresentMode(wo, wo.mRequestedPresentMode);
 
         uint32_t queueFamilyIndices[] = {mGraphicsQueueIndex};
         VkSwapchainCreateInfoKHR ci{};
         ci.sType                 = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
         ci.surface               = wo.mSurface.value();
-        ci.minImageCount         = wo.mSurfaceCaps.minImageCount;
+        ci.minImageCount         = wo.mMaxFrameNum;
         ci.imageFormat           = wo.mSurfaceFormat.format;
         ci.imageColorSpace       = wo.mSurfaceFormat.colorSpace;
         ci.imageExtent           = extent;
@@ -987,9 +1406,9 @@ namespace Cutlass
         ci.imageArrayLayers      = 1;
         ci.imageSharingMode      = VK_SHARING_MODE_EXCLUSIVE;
         ci.queueFamilyIndexCount = 0;
-        ci.presentMode =
-            vsync ? VK_PRESENT_MODE_FIFO_KHR : VK_PRESENT_MODE_IMMEDIATE_KHR;
-        ci.oldSwapchain   = VK_NULL_HANDLE;
+        ci.presentMode           = wo.mPresentMode;
+        // images being presented are handed over to the new swapchain
+        ci.oldSwapchain   = oldSwapchain;
         ci.clipped        = VK_TRUE;
         ci.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 
@@ -1011,6 +1430,46 @@ namespace Cutlass
         return Result::eSuccess;
     }
 
+    VkPresentModeKHR Context::selectPresentMode(const WindowObject& wo, const PresentMode mode) const
+    {
+        uint32_t modeCount = 0;
+        vkGetPhysicalDeviceSurfacePresentModesKHR(mPhysDev, wo.mSurface.value(), &modeCount, nullptr);
+        std::vector<VkPresentModeKHR> modes(modeCount);
+        vkGetPhysicalDeviceSurfacePresentModesKHR(mPhysDev, wo.mSurface.value(), &modeCount, modes.data());
+
+        // in order of preference, FIFO is always supported
+        std::vector<VkPresentModeKHR> candidates;
+        switch (mode)
+        {
+            case PresentMode::eFIFORelaxed:
+                candidates = {VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+                break;
+            case PresentMode::eMailbox:
+                candidates = {VK_PRESENT_MODE_MAILBOX_KHR};
+                break;
+            case PresentMode::eImmediate:
+                candidates = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+                break;
+            default:
+                break;
+        }
+
+        for (const auto candidate : candidates)
+        {
+            if (std::find(modes.begin(), modes.end(), candidate) != modes.end())
+            {
+                if (candidate != candidates.front())
+                    std::cerr << "requested present mode is not supported, fall back to mailbox\n";
+                return candidate;
+            }
+        }
+
+        if (!candidates.empty())
+            std::cerr << "requested present mode is not supported, fall back to FIFO\n";
+
+        return VK_PRESENT_MODE_FIFO_KHR;
+    }
+
     Result Context::createSwapchainImages(WindowObject& wo)
     {
         Result result;
@@ -1075,66 +1534,438 @@ namespace Cutlass
         return Result::eSuccess;
     }
 
-    Result Context::enableDebugReport()
+    Result Context::recreateSwapchain(const HWindow& handle)
     {
-        GetInstanceProcAddr(vkCreateDebugReportCallbackEXT);
-        GetInstanceProcAddr(vkDebugReportMessageEXT);
-        GetInstanceProcAddr(vkDestroyDebugReportCallbackEXT);
-
-        VkDebugReportFlagsEXT flags =
-            VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_WARNING_BIT_EXT;
-
-        VkDebugReportCallbackCreateInfoEXT drcci{};
-        drcci.sType       = VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT;
-        drcci.flags       = flags;
-        drcci.pfnCallback = &DebugReportCallback;
-        mvkCreateDebugReportCallbackEXT(mInstance, &drcci, nullptr, &mDebugReport);
+        Result result = Result::eSuccess;
 
-        std::cerr << "enabled debug mode\n";
+        auto& wo           = mWindowMap[handle];
+        wo.mNeedsRecreate = true;
 
-        return Result::eSuccess;
-    }
+        // minimized window can not have any swapchain, try again later
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(wo.mpWindow.value(), &width, &height);
+        if (width == 0 || height == 0)
+            return Result::eSuccess;
 
-    Result Context::disableDebugReport()
-    {
-        if (mvkDestroyDebugReportCallbackEXT)
         {
-            mvkDestroyDebugReportCallbackEXT(mInstance, mDebugReport, nullptr);
+            TraceScope trace(mTracer, "wait device idle");
+            vkDeviceWaitIdle(mDevice);
         }
 
-        std::cerr << "disabled debug mode\n";
+        result = checkVkResult(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
+            mPhysDev, wo.mSurface.value(), &wo.mSurfaceCaps));
+        if (Result::eSuccess != result)
+        {
+            std::cerr << "Failed to get physical device surface capability!\n";
+            return result;
+        }
 
-        return Result::eSuccess;
-    }
+        if (wo.mSurfaceCaps.currentExtent.width == 0 || wo.mSurfaceCaps.currentExtent.height == 0)
+            return Result::eSuccess;
 
-    uint32_t Context::getMemoryTypeIndex(uint32_t requestBits,
-                                         VkMemoryPropertyFlags requestProps) const
-    {
-        uint32_t result = 0;
-        for (uint32_t i = 0; i < mPhysMemProps.memoryTypeCount; ++i)
         {
-            if (requestBits & 1)
+            const VkSwapchainKHR oldSwapchain = wo.mSwapchain.value();
+            result                            = createSwapchain(wo, oldSwapchain);
+            vkDestroySwapchainKHR(mDevice, oldSwapchain, nullptr);
+            if (Result::eSuccess != result)
             {
-                const auto& types = mPhysMemProps.memoryTypes[i];
-                if ((types.propertyFlags & requestProps) == requestProps)
-                {
-                    result = i;
-                    break;
-                }
+                wo.mSwapchain.reset();
+                return result;
             }
+        }
 
-            requestBits >>= 1;
+        // swapchain images are owned by the swapchain, only views are destroyed
+        for (const auto& h : wo.mHSwapchainImages)
+        {
+            vkDestroyImageView(mDevice, mImageMap[h].mView.value(), nullptr);
+            mImageMap.erase(h);
         }
-        return result;
-    }
+        wo.mHSwapchainImages.clear();
+
+        result = createSwapchainImages(wo);
+        if (Result::eSuccess != result)
+            return result;
+
+        result = destroyTexture(wo.mHDepthBuffer);
+        if (Result::eSuccess != result)
+            return result;
+
+        result = createDepthBuffer(wo);
+        if (Result::eSuccess != result)
+            return result;
+
+        std::vector<HRenderPass> renderPasses;
+        for (auto& [rpHandle, rpo] : mRPMap)
+        {
+            if (!rpo.mHWindow || rpo.mHWindow.value() != handle)
+                continue;
+
+            result = recreateWindowTargets(rpo, wo);
+            if (Result::eSuccess != result)
+                return result;
+            renderPasses.emplace_back(rpHandle);
+        }
+
+        // command buffers refer to old framebuffers, they are re-recorded at the next execution
+        const auto isRecreated = [&renderPasses](const HRenderPass& rp)
+        { return std::find(renderPasses.begin(), renderPasses.end(), rp) != renderPasses.end(); };
+        for (auto& [cbHandle, co] : mCommandBufferMap)
+        {
+            if (co.mSubCommand)
+                co.mNeedsRerecord |= std::any_of(co.mSubCommandLists.begin(), co.mSubCommandLists.end(),
+                                                 [&](const SubCommandList& scl) { return isRecreated(scl.getRenderPass()); });
+            else if (co.mHRenderPass && isRecreated(co.mHRenderPass.value()))
+                co.mNeedsRerecord = true;
+        }
+
+        wo.mCurrentFrame  = 0;
+        wo.mNeedsRecreate = false;
+        // the refresh rate may have changed (e.g. moved to another monitor)
+        wo.mLastPresentNs   = 0;
+        wo.mNextPresentNs   = 0;
+        wo.mPresentInterval = 0;
+
+        std::cerr << "recreated swapchain (" << wo.mSwapchainExtent.width << " x " << wo.mSwapchainExtent.height << ")\n";
+
+        return Result::eSuccess;
+    }
+
+    Result Context::recreateWindowTargets(RenderPassObject& rpo, const WindowObject& wo)
+    {
+        Result result = Result::eSuccess;
+
+        for (auto& framebuffer : rpo.mFramebuffers)
+            if (framebuffer)
+                vkDestroyFramebuffer(mDevice, framebuffer.value(), nullptr);
+        rpo.mFramebuffers.clear();
+
+        VkExtent3D extent{wo.mSwapchainExtent.width, wo.mSwapchainExtent.height, 1};
+
+        // intermediate targets are owned by the user, so the render area is clipped by them
+        for (const auto& tex : rpo.mIntermediateTargets)
+        {
+            const auto& io = mImageMap[tex];
+            if (io.extent.width < extent.width || io.extent.height < extent.height)
+                std::cerr << "intermediate target is smaller than the resized window, render area is clipped!\n";
+            extent.width  = std::min(extent.width, io.extent.width);
+            extent.height = std::min(extent.height, io.extent.height);
+        }
+        rpo.mExtent = extent;
+
+        if (rpo.mSampleCount == VK_SAMPLE_COUNT_1_BIT)
+        {
+            if (rpo.depthTarget)
+                rpo.depthTarget = wo.mHDepthBuffer;
+        }
+        else
+        {  // multisampled attachments live only in the render pass
+            const auto recreate = [&](HTexture& target, const bool depth)
+            {
+                HTexture newTarget;
+                Result result = createMultiSampleTarget(extent, mImageMap[target].format, rpo.mSampleCount, depth, newTarget);
+                if (Result::eSuccess != result)
+                    return result;
+
+                result = destroyTexture(target);
+                target = newTarget;
+                return result;
+            };
+
+            for (auto& target : rpo.mMultiSampleTargets)
+            {
+                result = recreate(target, false);
+                if (Result::eSuccess != result)
+                    return result;
+            }
+
+            if (rpo.depthTarget)
+            {
+                result = recreate(rpo.depthTarget.value(), true);
+                if (Result::eSuccess != result)
+                    return result;
+            }
+        }
+
+        // new swapchain may have more images than before
+        rpo.imagesInFlight.assign(std::max(rpo.imagesInFlight.size(), wo.mHSwapchainImages.size()), 0);
+
+        return createWindowFramebuffers(rpo, wo);
+    }
+
+    Result Context::createWindowFramebuffers(RenderPassObject& rpo, const WindowObject& wo)
+    {
+        Result result = Result::eSuccess;
+
+        VkFramebufferCreateInfo fbci{};
+        fbci.sType      = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        fbci.renderPass = rpo.mRenderPass.value();
+        fbci.width      = rpo.mExtent.value().width;
+        fbci.height     = rpo.mExtent.value().height;
+        fbci.layers     = 1;
+
+        const auto& colorAttachments   = rpo.mColorAttachments;
+        const auto& resolveAttachments = rpo.mResolveAttachments;
+
+        for (auto& h : wo.mHSwapchainImages)
+        {
+            std::vector<VkImageView> ivVec(rpo.mAttachmentCount);
+            for (size_t i = 0; i < colorAttachments.size(); ++i)
+            {
+                // intermediate targets are shared by all swapchain images
+                const auto& target = i == 0 ? h : rpo.mIntermediateTargets[i - 1];
+                if (resolveAttachments.empty())
+                {
+                    ivVec[colorAttachments[i]] = mImageMap[target].mView.value();
+                    continue;
+                }
+
+                ivVec[colorAttachments[i]] = mImageMap[rpo.mMultiSampleTargets[i]].mView.value();
+                if (resolveAttachments[i] != VK_ATTACHMENT_UNUSED)
+                    ivVec[resolveAttachments[i]] = mImageMap[target].mView.value();
+            }
+
+            if (rpo.mDepthAttachment)
+                ivVec[rpo.mDepthAttachment.value()] = mImageMap[rpo.depthTarget.value()].mView.value();
+
+            fbci.attachmentCount = static_cast<uint32_t>(ivVec.size());
+            fbci.pAttachments    = ivVec.data();
+
+            VkFramebuffer framebuffer;
+            result = checkVkResult(
+                vkCreateFramebuffer(mDevice, &fbci, nullptr, &framebuffer));
+            if (Result::eSuccess != result)
+            {
+                std::cerr << "failed to create frame buffer!\n";
+                return result;
+            }
+            rpo.mFramebuffers.emplace_back(framebuffer);
+        }
+
+        return result;
+    }
+
+    Result Context::enableDebugReport()
+    {
+        GetInstanceProcAddr(vkCreateDebugReportCallbackEXT);
+        GetInstanceProcAddr(vkDebugReportMessageEXT);
+        GetInstanceProcAddr(vkDestroyDebugReportCallbackEXT);
+
+        VkDebugReportFlagsEXT flags =
+            VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_WARNING_BIT_EXT;
+
+        VkDebugReportCallbackCreateInfoEXT drcci{};
+        drcci.sType       = VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT;
+        drcci.flags       = flags;
+        drcci.pfnCallback = &DebugReportCallback;
+        mvkCreateDebugReportCallbackEXT(mInstance, &drcci, nullptr, &mDebugReport);
+
+        std::cerr << "enabled debug mode\n";
+
+        return Result::eSuccess;
+    }
+
+    Result Context::disableDebugReport()
+    {
+        if (mvkDestroyDebugReportCallbackEXT)
+        {
+            mvkDestroyDebugReportCallbackEXT(mInstance, mDebugReport, nullptr);
+        }
+
+        std::cerr << "disabled debug mode\n";
+
+        return Result::eSuccess;
+    }
+
+    uint32_t Context::getMemoryTypeIndex(uint32_t requestBits,
+                                         VkMemoryPropertyFlags requestProps) const
+    {
+        uint32_t result = 0;
+        for (uint32_t i = 0; i < mPhysMemProps.memoryTypeCount; ++i)
+        {
+            if (requestBits & 1)
+            {
+                const auto& types = mPhysMemProps.memoryTypes[i];
+                if ((types.propertyFlags & requestProps) == requestProps)
+                {
+                    result = i;
+                    break;
+                }
+            }
+
+            requestBits >>= 1;
+        }
+        return result;
+    }
+
+    VkResult Context::allocateMemory(const VkMemoryAllocateInfo& ai, VkDeviceMemory& memory_out)
+    {
+        const uint32_t heapIndex = mPhysMemProps.memoryTypes[ai.memoryTypeIndex].heapIndex;
+
+        const VkResult result = vkAllocateMemory(mDevice, &ai, nullptr, &memory_out);
+        if (result != VK_SUCCESS)
+        {
+            if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY)
+            {
+                updateMemoryBudget();
+                std::cerr << "failed to allocate " << ai.allocationSize << " bytes from heap " << heapIndex
+                          << " (usage : " << mHeapProcessUsages[heapIndex] << ", budget : " << mHeapBudgets[heapIndex] << ")\n";
+            }
+            return result;
+        }
+
+        mAllocations.emplace(memory_out, MemoryAllocation{ai.memoryTypeIndex, ai.allocationSize});
+        mHeapUsages[heapIndex] += ai.allocationSize;
+        mTypeUsages[ai.memoryTypeIndex] += ai.allocationSize;
+        ++mTypeAllocationCounts[ai.memoryTypeIndex];
+
+        return result;
+    }
+
+    void Context::freeMemory(const VkDeviceMemory memory)
+    {
+        const auto itr = mAllocations.find(memory);
+        if (itr != mAllocations.end())
+        {
+            mHeapUsages[mPhysMemProps.memoryTypes[itr->second.mTypeIndex].heapIndex] -= itr->second.mSize;
+            mTypeUsages[itr->second.mTypeIndex] -= itr->second.mSize;
+            --mTypeAllocationCounts[itr->second.mTypeIndex];
+            mAllocations.erase(itr);
+        }
+
+        vkFreeMemory(mDevice, memory, nullptr);
+    }
+
+    uint32_t Context::getBudgetedMemoryTypeIndex(uint32_t requestBits, VkMemoryPropertyFlags requestProps, const VkDeviceSize size)
+    {
+        const uint32_t index = getMemoryTypeIndex(requestBits, requestProps);
+        if (!(requestProps & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+            return index;
+
+        const uint32_t heapIndex = mPhysMemProps.memoryTypes[index].heapIndex;
+
+        updateMemoryBudget();
+        if (!isNearBudget(heapIndex, size))
+            return index;
+
+        if (evictCachedMemory(heapIndex))
+        {
+            updateMemoryBudget();
+            if (!isNearBudget(heapIndex, size))
+                return index;
+        }
+
+        // the GPU can still read host memory (slowly)
+        for (uint32_t i = 0; i < mPhysMemProps.memoryTypeCount; ++i)
+        {
+            const uint32_t hostHeapIndex = mPhysMemProps.memoryTypes[i].heapIndex;
+            if (!(requestBits & (1u << i)) ||
+                (mPhysMemProps.memoryHeaps[hostHeapIndex].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ||
+                isNearBudget(hostHeapIndex, size))
+                continue;
+
+            ++mHostFallbackCount;
+            std::cerr << "heap " << heapIndex << " is near its budget, allocated from host memory (heap " << hostHeapIndex << ")\n";
+            return i;
+        }
+
+        std::cerr << "heap " << heapIndex << " is near its budget and no host memory is available!\n";
+        return index;
+    }
+
+    void Context::updateMemoryBudget()
+    {
+        if (!mMemoryBudgetSupported)
+        {
+            // same heuristic as common allocators
+            for (uint32_t i = 0; i < mPhysMemProps.memoryHeapCount; ++i)
+            {
+                mHeapBudgets[i]       = mPhysMemProps.memoryHeaps[i].size * 8 / 10;
+                mHeapProcessUsages[i] = mHeapUsages[i];
+            }
+            return;
+        }
+
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+        budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2 props{};
+        props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        props.pNext = &budget;
+        vkGetPhysicalDeviceMemoryProperties2(mPhysDev, &props);
+
+        for (uint32_t i = 0; i < mPhysMemProps.memoryHeapCount; ++i)
+        {
+            mHeapBudgets[i]       = budget.heapBudget[i];
+            mHeapProcessUsages[i] = budget.heapUsage[i];
+        }
+    }
+
+    bool Context::isNearBudget(const uint32_t heapIndex, const VkDeviceSize size) const
+    {
+        return static_cast<double>(mHeapProcessUsages[heapIndex] + size) > mHeapBudgets[heapIndex] * memoryBudgetThreshold;
+    }
+
+    bool Context::evictCachedMemory(const uint32_t heapIndex)
+    {
+        bool evicted = false;
+
+        // transient memory is no longer used after all of its textures are destroyed
+        for (auto itr = mTransientBlocks.begin(); itr != mTransientBlocks.end();)
+        {
+            const bool idle = std::none_of(itr->mTextures.begin(), itr->mTextures.end(),
+                                           [this](const HTexture& h) { return mImageMap.count(h) > 0; });
+            const auto allocation = mAllocations.find(itr->mMemory);
+            if (!idle || allocation == mAllocations.end() ||
+                mPhysMemProps.memoryTypes[allocation->second.mTypeIndex].heapIndex != heapIndex)
+            {
+                ++itr;
+                continue;
+            }
+
+            freeMemory(itr->mMemory);
+            itr     = mTransientBlocks.erase(itr);
+            evicted = true;
+        }
+
+        // readback ring is created again on the next readback (device local only on UMA)
+        if (mReadbackRing.mMemory && mReadbackOrder.empty())
+        {
+            const auto itr = mAllocations.find(mReadbackRing.mMemory.value());
+            if (itr != mAllocations.end() && mPhysMemProps.memoryTypes[itr->second.mTypeIndex].heapIndex == heapIndex)
+            {
+                destroyReadbackRing();
+                evicted = true;
+            }
+        }
+
+        return evicted;
+    }
 
     Result Context::createWindow(const WindowInfo& info, HWindow& handle_out)
     {
+        if (mIsHeadless)
+        {
+            std::cerr << "headless context can not create window!\n";
+            return Result::eFailure;
+        }
+
         Result result = Result::eSuccess;
         WindowObject wo;
         wo.mMaxFrameNum      = info.frameCount;
-        wo.mMaxFrameInFlight = std::max(1, static_cast<int>(info.frameCount) - 1);
+        wo.mMaxFrameInFlight = info.framesInFlight ? info.framesInFlight : std::max(1, static_cast<int>(info.frameCount) - 1);
         wo.mCurrentFrame     = 0;
+        wo.mFramePacing      = info.framePacing;
+
+        if (info.presentMode)
+            wo.mRequestedPresentMode = info.presentMode.value();
+        else
+            wo.mRequestedPresentMode = info.vsync ? PresentMode::eFIFO : PresentMode::eImmediate;
+
+        if (wo.mMaxFrameInFlight > info.frameCount)
+        {
+            std::cerr << "frames in flight must not be greater than frame count!\n";
+            return Result::eFailure;
+        }
 
         if (!mIsInitialized)
         {
@@ -1142,6 +1973,8 @@ namespace Cutlass
             return Result::eFailure;
         }
 
+        glfwWindowHint(GLFW_RESIZABLE, info.resizable ? GLFW_TRUE : GLFW_FALSE);
+
         if (info.fullScreen)
             wo.mpWindow = std::make_optional(
                 glfwCreateWindow(info.width, info.height, info.windowName.c_str(),
@@ -1164,7 +1997,7 @@ namespace Cutlass
         }
         std::cerr << "created VkSurfaceKHR\n";
 
-        result = createSwapchain(wo, info.vsync);
+        result = createSwapchain(wo);
         if (Result::eSuccess != result)
         {
             return result;
@@ -1198,6 +2031,20 @@ namespace Cutlass
         handle_out = mNextWindowHandle++;
         mWindowMap.emplace(handle_out, wo);
 
+        {  // elements of unordered_map are never moved
+            GLFWwindow* pWindow = wo.mpWindow.value();
+            auto& event         = mWindowMap[handle_out].mEvent;
+            glfwSetWindowUserPointer(pWindow, &event);
+            glfwSetKeyCallback(pWindow, KeyCallback);
+            glfwSetCursorPosCallback(pWindow, CursorPosCallback);
+            glfwSetScrollCallback(pWindow, ScrollCallback);
+            glfwSetCharCallback(pWindow, CharCallback);
+
+            double x = 0, y = 0;
+            glfwGetCursorPos(pWindow, &x, &y);
+            event.onCursorPos(x, y);
+        }
+
         return result;
     }
 
@@ -1234,6 +2081,21 @@ namespace Cutlass
         return createBuffer(info, handle);
     }
 
+    bool Context::getConcurrentQueueFamilies(std::vector<uint32_t>& families_out) const
+    {
+        families_out.clear();
+
+        // any resource may be bound on the compute queue, so sharing is needed only for another family
+        if (mComputeQueueIndex == mGraphicsQueueIndex)
+            return false;
+
+        families_out = {mGraphicsQueueIndex, mComputeQueueIndex};
+        if (mTransferQueueIndex != mGraphicsQueueIndex && mTransferQueueIndex != mComputeQueueIndex)
+            families_out.emplace_back(mTransferQueueIndex);
+
+        return true;
+    }
+
     Result Context::createBuffer(const BufferInfo& info, const HBuffer& handle)
     {
         Result result = Result::eFailure;
@@ -1271,9 +2133,27 @@ namespace Cutlass
                 return Result::eFailure;
             }
 
+            // device local buffer is written via staging buffer
+            if (!info.isHostVisible)
+                ci.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+            // for readBuffer
+            ci.usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
             ci.size  = info.size;
+            bo.mSize = info.size;
             ci.pNext = nullptr;
 
+            // buffers bound on the compute queue of another family are not transferred, but shared
+            std::vector<uint32_t> queueFamilyIndices;
+            if (getConcurrentQueueFamilies(queueFamilyIndices))
+            {
+                ci.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+                ci.queueFamilyIndexCount = uint32_t(queueFamilyIndices.size());
+                ci.pQueueFamilyIndices   = queueFamilyIndices.data();
+                bo.mConcurrentSharing    = true;
+            }
+
             {
                 VkBuffer buffer;
                 result = checkVkResult(vkCreateBuffer(mDevice, &ci, nullptr, &buffer));
@@ -1306,12 +2186,12 @@ namespace Cutlass
             VkMemoryAllocateInfo ai{};
             ai.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
             ai.allocationSize  = reqs.size;
-            ai.memoryTypeIndex = getMemoryTypeIndex(reqs.memoryTypeBits, fb);
+            ai.memoryTypeIndex = getBudgetedMemoryTypeIndex(reqs.memoryTypeBits, fb, reqs.size);
 
             // allocate device memory
             {
                 VkDeviceMemory memory;
-                result = checkVkResult(vkAllocateMemory(mDevice, &ai, nullptr, &memory));
+                result = checkVkResult(allocateMemory(ai, memory));
                 if (Result::eSuccess != result)
                 {
                     return result;
@@ -1352,6 +2232,90 @@ namespace Cutlass
 
         BufferObject& bo = mBufferMap[handle];
 
+        // device local buffer : copy from staging buffer on transfer queue
+        if (!bo.mIsHostVisible)
+        {
+            BufferObject stagingBo;
+            result = createStagingBuffer(size, pData, stagingBo);
+            if (Result::eSuccess != result)
+                return result;
+
+            VkCommandBuffer command;
+            result = beginUploadCommand(mTransferCommandPool, command);
+            if (Result::eSuccess != result)
+            {
+                freeMemory(stagingBo.mMemory.value());
+                vkDestroyBuffer(mDevice, stagingBo.mBuffer.value(), nullptr);
+                return result;
+            }
+
+            VkBufferCopy copyRegion{};
+            copyRegion.size = size;
+            vkCmdCopyBuffer(command, stagingBo.mBuffer.value(), bo.mBuffer.value(), 1,
+                            &copyRegion);
+
+            VkBufferMemoryBarrier bmb{};
+            bmb.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            bmb.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bmb.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bmb.buffer              = bo.mBuffer.value();
+            bmb.offset              = 0;
+            bmb.size                = VK_WHOLE_SIZE;
+
+            constexpr VkAccessFlags readAccess =
+                VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                VK_ACCESS_UNIFORM_READ_BIT;
+            constexpr VkPipelineStageFlags readStage =
+                VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+            std::optional<VkCommandBuffer> acquireCommand;
+            if (mTransferQueueIndex == mGraphicsQueueIndex)
+            {
+                bmb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                bmb.dstAccessMask = readAccess;
+                vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT, readStage, 0, 0,
+                                     nullptr, 1, &bmb, 0, nullptr);
+            }
+            // concurrent buffer needs no ownership transfer, the upload fence is waited before use
+            else if (!bo.mConcurrentSharing)
+            {
+                // release ownership (transfer -> graphics)
+                bmb.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+                bmb.dstAccessMask       = 0;
+                bmb.srcQueueFamilyIndex = mTransferQueueIndex;
+                bmb.dstQueueFamilyIndex = mGraphicsQueueIndex;
+                vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                     VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1,
+                                     &bmb, 0, nullptr);
+
+                // acquire ownership
+                VkCommandBuffer acquire;
+                result = beginUploadCommand(mCommandPool, acquire);
+                if (Result::eSuccess != result)
+                {
+                    vkEndCommandBuffer(command);
+                    vkFreeCommandBuffers(mDevice, mTransferCommandPool, 1, &command);
+                    freeMemory(stagingBo.mMemory.value());
+                    vkDestroyBuffer(mDevice, stagingBo.mBuffer.value(), nullptr);
+                    return result;
+                }
+                bmb.srcAccessMask = 0;
+                bmb.dstAccessMask = readAccess;
+                vkCmdPipelineBarrier(acquire, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, readStage, 0,
+                                     0, nullptr, 1, &bmb, 0, nullptr);
+                acquireCommand = acquire;
+            }
+
+            result = submitUploadCommand(command, acquireCommand, size);
+
+            // release staging buffer
+            freeMemory(stagingBo.mMemory.value());
+            vkDestroyBuffer(mDevice, stagingBo.mBuffer.value(), nullptr);
+
+            return result;
+        }
+
         void* p;  // mapping dst address
 
         result = checkVkResult(
@@ -1360,6 +2324,7 @@ namespace Cutlass
             return result;
         memcpy(p, pData, size);
         vkUnmapMemory(mDevice, bo.mMemory.value());
+        mFrameStats.uploadedBytes += size;
 
         return Result::eSuccess;
     }
@@ -1468,15 +2433,48 @@ namespace Cutlass
                     if (info.depth != 1)
                         std::cerr << "ignored invalid depth param\n";
                     break;
-                    // case TextureDimention::e3D:
-                    //     ci.imageType = VK_IMAGE_TYPE_3D;
-                    //     ci.extent = {uint32_t(info.width),
-                    //     uint32_t(info.height), uint32_t(info.depth)}; break;
-                default:
-                    std::cerr << "invalid dimention of texture!\n";
-                    return Result::eFailure;
+                case Dimension::e2DArray:
+                    ci.imageType    = VK_IMAGE_TYPE_2D;
+                    ci.extent       = {uint32_t(info.width), uint32_t(info.height), 1};
+                    io.mArrayLayers = info.depth;
                     break;
+                case Dimension::eCube:
+                    if (info.width != info.height)
+                    {
+                        std::cerr << "cube map must be square!\n";
+                        return Result::eFailure;
+                    }
+                    if (info.depth != 1 && info.depth != 6)
+                        std::cerr << "ignored invalid depth param\n";
+                    ci.imageType    = VK_IMAGE_TYPE_2D;
+                    ci.extent       = {uint32_t(info.width), uint32_t(info.height), 1};
+                    ci.flags        = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+                    io.mArrayLayers = 6;
+                    break;
+                case Dimension::e3D:
+                    ci.imageType = VK_IMAGE_TYPE_3D;
+                    ci.extent    = {uint32_t(info.width), uint32_t(info.height), uint32_t(info.depth)};
+                    break;
+                default:
+                    std::cerr << "invalid dimention of texture!\n";
+                    return Result::eFailure;
+                    break;
+            }
+
+            if (ci.extent.depth == 0 || io.mArrayLayers == 0)
+            {
+                std::cerr << "texture depth (or layer count) must not be 0!\n";
+                return Result::eFailure;
+            }
+
+            // attachments are always single layer 2D images
+            if (info.dimension != Dimension::e2D && info.usage != TextureUsage::eShaderResource &&
+                info.usage != TextureUsage::eUnordered)
+            {
+                std::cerr << "only shader resource or unordered texture can be array, cube or 3D!\n";
+                return Result::eFailure;
             }
+            io.mDimension = info.dimension;
 
             switch (info.usage)
             {
@@ -1484,20 +2482,30 @@ namespace Cutlass
                     ci.usage         = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
                     io.currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
                     break;
+                // attachments can be read by later subpasses as input attachments
                 case TextureUsage::eColorTarget:
-                    ci.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
-                               VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+                    if (info.isTransient && !info.isSampled)
+                        ci.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
+                                   VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+                    else
+                        ci.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                                   VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
                     io.currentLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
                     break;
                 case TextureUsage::eDepthStencilTarget:
-                    ci.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
-                               VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+                    if (info.isTransient && !info.isSampled)
+                        ci.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
+                                   VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+                    else
+                        ci.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                                   VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
                     io.currentLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
                     break;
                 case TextureUsage::eUnordered:
                     ci.usage = VK_IMAGE_USAGE_SAMPLED_BIT |
                                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
-                               VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+                               VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                               VK_IMAGE_USAGE_STORAGE_BIT;
                     io.currentLayout = VK_IMAGE_LAYOUT_GENERAL;
                     break;
                 default:
@@ -1508,9 +2516,48 @@ namespace Cutlass
 
             io.usage = info.usage;
 
-            ci.arrayLayers   = 1;
-            ci.mipLevels     = 1;
-            ci.samples       = VK_SAMPLE_COUNT_1_BIT;
+            // every texture that can be bound as a descriptor may be used on the compute queue,
+            // never sampled transient attachments stay on the graphics queue
+            std::vector<uint32_t> queueFamilyIndices;
+            if (!(info.isTransient && !info.isSampled) && getConcurrentQueueFamilies(queueFamilyIndices))
+            {
+                ci.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+                ci.queueFamilyIndexCount = uint32_t(queueFamilyIndices.size());
+                ci.pQueueFamilyIndices   = queueFamilyIndices.data();
+                io.mConcurrentSharing    = true;
+            }
+
+            // multisampled image is used only as render target
+            if (info.sampleCount != 1 && info.usage != TextureUsage::eColorTarget &&
+                info.usage != TextureUsage::eDepthStencilTarget)
+            {
+                std::cerr << "only render target can be multisampled!\n";
+                return Result::eFailure;
+            }
+
+            result = getSampleCountFlag(info.sampleCount, info.usage == TextureUsage::eDepthStencilTarget, io.mSampleCount);
+            if (Result::eSuccess != result)
+                return result;
+
+            // attachments and storage images are accessed through a single level view
+            if (info.mipLevels != 1 && info.usage != TextureUsage::eShaderResource)
+            {
+                std::cerr << "only shader resource texture can have mipmaps!\n";
+                return Result::eFailure;
+            }
+
+            io.mMipLevels = getFullMipLevels(ci.extent.width, ci.extent.height, ci.extent.depth);
+            if (info.mipLevels != 0)
+                io.mMipLevels = std::min(info.mipLevels, io.mMipLevels);
+
+            // lower levels are blitted from upper levels, and also read by readTexture
+            // (lazily allocated attachments can not be used as transfer source)
+            if (!(info.isTransient && !info.isSampled))
+                ci.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+            ci.arrayLayers   = io.mArrayLayers;
+            ci.mipLevels     = io.mMipLevels;
+            ci.samples       = io.mSampleCount;
             ci.tiling        = VK_IMAGE_TILING_OPTIMAL;
             ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
             io.extent        = ci.extent;
@@ -1527,6 +2574,39 @@ namespace Cutlass
             }
         }
 
+        // memory and view are created by allocateTransientTextures
+        if (info.isTransient)
+        {
+            if (info.usage != TextureUsage::eColorTarget && info.usage != TextureUsage::eDepthStencilTarget)
+            {
+                std::cerr << "only render target can be transient!\n";
+                vkDestroyImage(mDevice, io.mImage.value(), nullptr);
+                return Result::eFailure;
+            }
+
+            io.mIsTransient   = true;
+            io.mIsSampled     = info.isSampled;
+            io.mIsHostVisible = false;
+            io.range          = {info.usage == TextureUsage::eDepthStencilTarget ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+            if (io.mIsSampled)
+            {
+                VkSampler sampler;
+                result = getCachedSampler(info.samplerInfo.value_or(SamplerInfo(info.samplerType)), sampler);
+                if (Result::eSuccess != result)
+                {
+                    vkDestroyImage(mDevice, io.mImage.value(), nullptr);
+                    return result;
+                }
+                io.mSampler = sampler;
+            }
+
+            handle_out = mNextTextureHandle++;
+            mImageMap.emplace(handle_out, io);
+
+            return Result::eSuccess;
+        }
+
         // calc memory size
         VkMemoryRequirements reqs;
         vkGetImageMemoryRequirements(mDevice, io.mImage.value(), &reqs);
@@ -1548,11 +2628,11 @@ namespace Cutlass
             io.mIsHostVisible = true;
         }
 
-        ai.memoryTypeIndex = getMemoryTypeIndex(reqs.memoryTypeBits, fb);
+        ai.memoryTypeIndex = getBudgetedMemoryTypeIndex(reqs.memoryTypeBits, fb, reqs.size);
         // allocate memory
         {
             VkDeviceMemory memory;
-            vkAllocateMemory(mDevice, &ai, nullptr, &memory);
+            allocateMemory(ai, memory);
 
             io.mMemory = memory;
         }
@@ -1571,9 +2651,15 @@ namespace Cutlass
                 case Dimension::e2D:
                     ci.viewType = VK_IMAGE_VIEW_TYPE_2D;
                     break;
-                    // case TextureDimention::e3D:
-                    //     ci.viewType = VK_IMAGE_VIEW_TYPE_3D;
-                    //     break;
+                case Dimension::e2DArray:
+                    ci.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+                    break;
+                case Dimension::eCube:
+                    ci.viewType = VK_IMAGE_VIEW_TYPE_CUBE;
+                    break;
+                case Dimension::e3D:
+                    ci.viewType = VK_IMAGE_VIEW_TYPE_3D;
+                    break;
                 default:
                     return Result::eFailure;
                     break;
@@ -1595,7 +2681,7 @@ namespace Cutlass
                     ci.subresourceRange = io.range = {aspectFlag, 0, 1, 0, 1};
                     break;
                 default:
-                    ci.subresourceRange = io.range = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+                    ci.subresourceRange = io.range = {VK_IMAGE_ASPECT_COLOR_BIT, 0, io.mMipLevels, 0, io.mArrayLayers};
                     break;
             }
 
@@ -1614,19 +2700,10 @@ namespace Cutlass
         }
 
         {
-            // TODO: impl changing sampler
-            VkSamplerCreateInfo sci{};
-            sci.sType         = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-            sci.pNext         = nullptr;
-            sci.minFilter     = VK_FILTER_LINEAR;
-            sci.magFilter     = VK_FILTER_LINEAR;
-            sci.addressModeU  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-            sci.addressModeV  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-            sci.addressModeW  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-            sci.maxAnisotropy = 1.f;
-            sci.borderColor   = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
             VkSampler sampler;
-            result = checkVkResult(vkCreateSampler(mDevice, &sci, nullptr, &sampler));
+            result = getCachedSampler(info.samplerInfo.value_or(SamplerInfo(info.samplerType)), sampler);
+            if (result != Result::eSuccess)
+                return result;
 
             io.mSampler = sampler;
         }
@@ -1669,7 +2746,8 @@ namespace Cutlass
     }
 
     Result Context::createTextureFromFile(const char* fileName,
-                                          HTexture& handle_out)
+                                          HTexture& handle_out,
+                                          const bool generateMipmaps)
     {
         if (!mIsInitialized)
         {
@@ -1677,46 +2755,353 @@ namespace Cutlass
             return Result::eFailure;
         }
 
+        if (!fileName)
+        {
+            std::cerr << "invalid file name\n";
+            return Result::eFailure;
+        }
+
+        // pre-compressed containers are uploaded without decoding
+        if (isCompressedTextureFile(fileName))
+        {
+            TextureFile file;
+            if (Result::eSuccess != file.load(fileName))
+                return Result::eFailure;
+
+            return createTexture(file, handle_out);
+        }
+
+        int width = 0, height = 0;
+        stbi_uc* pImage = stbi_load(fileName, &width, &height, nullptr, 4);
+        if (!pImage)
+        {
+            std::cerr << "Failed to load texture file!\n";
+            return Result::eFailure;
+        }
+
         ImageObject io;
-        Result result;
+        Result result = createFileImageObject(uint32_t(width), uint32_t(height), generateMipmaps, io);
+        if (Result::eSuccess != result)
+        {
+            stbi_image_free(pImage);
+            return result;
+        }
 
-        stbi_uc* pImage = nullptr;
-        int width = 0, height = 0, channel = 0;
-        io.format         = VK_FORMAT_R8G8B8A8_SRGB;  // fixed format
-        io.mSizeOfChannel = 4;
-        io.usage          = TextureUsage::eShaderResource;
+        handle_out = mNextTextureHandle++;
+        mImageMap.emplace(handle_out, io);
+
+        result = writeTexture(pImage, handle_out);
+
+        if (pImage != nullptr)
+            stbi_image_free(pImage);
+
+        return result;
+    }
 
+    Result Context::createTexturesFromFiles(const std::vector<std::string>& fileNames,
+                                            std::vector<HTexture>& handles_out,
+                                            const bool generateMipmaps)
+    {
+        if (!mIsInitialized)
         {
-            VkImageCreateInfo ci{};
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        Result result = Result::eSuccess;
+
+        struct Job
+        {
+            size_t index;
+            uint32_t batch;
+            VkDeviceSize offset;  // in the half of staging ring
+            size_t size;
+        };
+
+        // no texture is left behind on failure
+        std::vector<HTexture> created;
+        const auto discard = [&](const Result failure)
+        {
+            for (const auto& handle : created)
+                destroyTexture(handle);
+            handles_out.clear();
+            return failure;
+        };
 
-            if (!fileName)
+        // images are created from headers, pixels are decoded by workers later
+        std::vector<Job> jobs;
+        handles_out.resize(fileNames.size());
+        for (size_t i = 0; i < fileNames.size(); ++i)
+        {
+            if (isCompressedTextureFile(fileNames[i].c_str()))
             {
-                std::cerr << "invalid file name\n";
-                return Result::eFailure;
+                result = createTextureFromFile(fileNames[i].c_str(), handles_out[i], generateMipmaps);
+                if (Result::eSuccess != result)
+                    return discard(result);
+                created.emplace_back(handles_out[i]);
+                continue;
             }
 
-            pImage  = stbi_load(fileName, &width, &height, nullptr, 4);
-            channel = 4;
-            if (!pImage)
+            int width = 0, height = 0, channel = 0;
+            if (!stbi_info(fileNames[i].c_str(), &width, &height, &channel))
             {
-                std::cerr << "Failed to load texture file!\n";
-                return Result::eFailure;
+                std::cerr << "failed to load texture file : " << fileNames[i] << "\n";
+                return discard(Result::eFailure);
+            }
+
+            // partially created image is also registered to be released
+            ImageObject io;
+            result         = createFileImageObject(uint32_t(width), uint32_t(height), generateMipmaps, io);
+            handles_out[i] = mNextTextureHandle++;
+            mImageMap.emplace(handles_out[i], io);
+            created.emplace_back(handles_out[i]);
+            if (Result::eSuccess != result)
+                return discard(result);
+
+            jobs.emplace_back(Job{i, 0, 0, size_t(width) * height * io.mSizeOfChannel});
+        }
+
+        if (jobs.empty())
+            return Result::eSuccess;
+
+        // split into batches that fit in a half of the ring (a larger image extends the ring)
+        constexpr VkDeviceSize alignment = 16;
+        VkDeviceSize halfSize            = stagingRingSize / 2;
+        for (const auto& job : jobs)
+            halfSize = std::max(halfSize, (job.size + alignment - 1) / alignment * alignment);
+
+        std::vector<uint32_t> jobCounts(1, 0);
+        std::vector<size_t> batchSizes(1, 0);
+        {
+            VkDeviceSize used = 0;
+            for (auto& job : jobs)
+            {
+                const VkDeviceSize aligned = (job.size + alignment - 1) / alignment * alignment;
+                if (used + aligned > halfSize)
+                {
+                    jobCounts.emplace_back(0);
+                    batchSizes.emplace_back(0);
+                    used = 0;
+                }
+
+                job.batch  = static_cast<uint32_t>(jobCounts.size() - 1);
+                job.offset = used;
+                used += aligned;
+                ++jobCounts.back();
+                batchSizes.back() += job.size;
+            }
+        }
+        const uint32_t batchCount = static_cast<uint32_t>(jobCounts.size());
+
+        BufferObject stagingBo;
+        result = createStagingBuffer(halfSize * 2, nullptr, stagingBo);
+        if (Result::eSuccess != result)
+            return discard(result);
+
+        uint8_t* pStaging = nullptr;
+        {
+            void* p;
+            result = checkVkResult(vkMapMemory(mDevice, stagingBo.mMemory.value(), 0, VK_WHOLE_SIZE, 0, &p));
+            if (Result::eSuccess != result)
+            {
+                freeMemory(stagingBo.mMemory.value());
+                vkDestroyBuffer(mDevice, stagingBo.mBuffer.value(), nullptr);
+                return discard(result);
+            }
+            pStaging = reinterpret_cast<uint8_t*>(p);
+        }
+
+        // workers may write a batch only after GPU finished reading the same half
+        std::mutex mutex;
+        std::condition_variable cv;
+        uint32_t openedBatch = 1;
+        bool aborted         = false;
+        std::vector<uint32_t> finishedCounts(batchCount, 0);
+        std::atomic<size_t> nextJob = 0;
+        std::atomic<bool> failed    = false;
+
+        const auto worker = [&]()
+        {
+            for (size_t j = nextJob++; j < jobs.size(); j = nextJob++)
+            {
+                const Job& job = jobs[j];
+
+                // decoding does not touch the ring, so it runs ahead of GPU
+                int width = 0, height = 0;
+                stbi_uc* pImage = stbi_load(fileNames[job.index].c_str(), &width, &height, nullptr, 4);
+
+                bool skip = false;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&]() { return job.batch <= openedBatch || aborted; });
+                    skip = aborted;
+                }
+
+                if (!pImage || size_t(width) * height * 4 != job.size)
+                {
+                    std::cerr << "failed to load texture file : " << fileNames[job.index] << "\n";
+                    failed = true;
+                }
+                else if (!skip && !failed)
+                    std::memcpy(pStaging + (job.batch % 2) * halfSize + job.offset, pImage, job.size);
+
+                if (pImage)
+                    stbi_image_free(pImage);
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ++finishedCounts[job.batch];
+                }
+                cv.notify_all();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        const size_t workerCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), jobs.size()));
+        for (size_t i = 0; i < workerCount; ++i)
+            workers.emplace_back(worker);
+
+        std::optional<PendingUpload> pendings[2];
+        auto jobItr = jobs.begin();
+        for (uint32_t batch = 0; batch < batchCount && Result::eSuccess == result; ++batch)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return finishedCounts[batch] == jobCounts[batch]; });
+            }
+
+            if (failed)
+            {
+                result = Result::eFailure;
+                break;
             }
 
-            io.extent        = {uint32_t(width), uint32_t(height), 1};
-            io.currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            // one submission for the whole batch
+            VkCommandBuffer command;
+            result = beginUploadCommand(mTransferCommandPool, command);
+            if (Result::eSuccess != result)
+                break;
+
+            std::optional<VkCommandBuffer> acquireCommand;
+            for (; jobItr != jobs.end() && jobItr->batch == batch && Result::eSuccess == result; ++jobItr)
+            {
+                const ImageObject& io = mImageMap[handles_out[jobItr->index]];
+
+                VkBufferImageCopy region{};
+                region.bufferOffset     = (batch % 2) * halfSize + jobItr->offset;
+                region.imageExtent      = io.extent;
+                region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+                result = recordImageUpload(command, acquireCommand, io, stagingBo.mBuffer.value(), {region}, io.mMipLevels > 1, 0, 1);
+            }
+
+            if (Result::eSuccess != result)
+            {
+                vkEndCommandBuffer(command);
+                vkFreeCommandBuffers(mDevice, mTransferCommandPool, 1, &command);
+                if (acquireCommand)
+                {
+                    vkEndCommandBuffer(acquireCommand.value());
+                    vkFreeCommandBuffers(mDevice, mCommandPool, 1, &acquireCommand.value());
+                }
+                break;
+            }
+
+            PendingUpload pending;
+            result = submitUploadCommandAsync(command, acquireCommand, batchSizes[batch], pending);
+            if (Result::eSuccess != result)
+                break;
+            pendings[batch % 2] = pending;
+
+            // the other half is released for the next batch
+            if (batch >= 1)
+            {
+                result = waitUpload(pendings[(batch - 1) % 2].value());
+                pendings[(batch - 1) % 2].reset();
+
+                std::lock_guard<std::mutex> lock(mutex);
+                openedBatch = batch + 1;
+            }
+            cv.notify_all();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            aborted = true;
+        }
+        cv.notify_all();
+        for (auto& w : workers)
+            w.join();
+
+        for (auto& pending : pendings)
+            if (pending)
+            {
+                const Result waitResult = waitUpload(pending.value());
+                if (Result::eSuccess == result)
+                    result = waitResult;
+            }
+
+        vkUnmapMemory(mDevice, stagingBo.mMemory.value());
+        freeMemory(stagingBo.mMemory.value());
+        vkDestroyBuffer(mDevice, stagingBo.mBuffer.value(), nullptr);
+
+        if (Result::eSuccess != result)
+            return discard(result);
+
+        for (const auto& job : jobs)
+            mImageMap[handles_out[job.index]].currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        return Result::eSuccess;
+    }
+
+    bool Context::isCompressedTextureFile(const char* fileName)
+    {
+        std::string extension = fileName;
+        const size_t dot      = extension.find_last_of('.');
+        extension             = dot == std::string::npos ? "" : extension.substr(dot);
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        return extension == ".ktx2" || extension == ".dds";
+    }
+
+    Result Context::createFileImageObject(const uint32_t width, const uint32_t height,
+                                          const bool generateMipmaps, ImageObject& io_out)
+    {
+        Result result;
+
+        io_out.format         = VK_FORMAT_R8G8B8A8_SRGB;  // fixed format
+        io_out.mSizeOfChannel = 4;
+        io_out.usage          = TextureUsage::eShaderResource;
+
+        {
+            VkImageCreateInfo ci{};
+
+            io_out.extent        = {width, height, 1};
+            io_out.currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            io_out.mMipLevels    = generateMipmaps ? getFullMipLevels(io_out.extent.width, io_out.extent.height) : 1;
 
             // image
             ci.sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-            ci.extent      = io.extent;
-            ci.format      = io.format;
+            ci.extent      = io_out.extent;
+            ci.format      = io_out.format;
             ci.imageType   = VK_IMAGE_TYPE_2D;
             ci.arrayLayers = 1;
-            ci.mipLevels   = 1;
+            ci.mipLevels   = io_out.mMipLevels;
             ci.samples     = VK_SAMPLE_COUNT_1_BIT;
             ci.usage       = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+            if (io_out.mMipLevels > 1)
+                ci.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
             ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+            std::vector<uint32_t> queueFamilyIndices;
+            if (getConcurrentQueueFamilies(queueFamilyIndices))
+            {
+                ci.sharingMode            = VK_SHARING_MODE_CONCURRENT;
+                ci.queueFamilyIndexCount  = uint32_t(queueFamilyIndices.size());
+                ci.pQueueFamilyIndices    = queueFamilyIndices.data();
+                io_out.mConcurrentSharing = true;
+            }
+
             {
                 VkImage image;
                 result = checkVkResult(vkCreateImage(mDevice, &ci, nullptr, &image));
@@ -1725,13 +3110,13 @@ namespace Cutlass
                     return result;
                 }
 
-                io.mImage = image;
+                io_out.mImage = image;
             }
         }
 
         // calc memory size
         VkMemoryRequirements reqs;
-        vkGetImageMemoryRequirements(mDevice, io.mImage.value(), &reqs);
+        vkGetImageMemoryRequirements(mDevice, io_out.mImage.value(), &reqs);
         VkMemoryAllocateInfo ai{};
         ai.sType          = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
         ai.allocationSize = reqs.size;
@@ -1740,28 +3125,28 @@ namespace Cutlass
         fb = static_cast<VkMemoryPropertyFlagBits>(
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        io.mIsHostVisible  = true;
+        io_out.mIsHostVisible  = true;
         ai.memoryTypeIndex = getMemoryTypeIndex(reqs.memoryTypeBits, fb);
 
         // allocate device memory
         {
             VkDeviceMemory memory;
-            vkAllocateMemory(mDevice, &ai, nullptr, &memory);
+            allocateMemory(ai, memory);
 
-            io.mMemory = memory;
+            io_out.mMemory = memory;
         }
         // bind device memory
-        vkBindImageMemory(mDevice, io.mImage.value(), io.mMemory.value(), 0);
+        vkBindImageMemory(mDevice, io_out.mImage.value(), io_out.mMemory.value(), 0);
 
         {
             // view
             VkImageViewCreateInfo ci{};
             ci.sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
             ci.viewType = VK_IMAGE_VIEW_TYPE_2D;
-            ci.image    = io.mImage.value();
-            ci.format   = io.format;
+            ci.image    = io_out.mImage.value();
+            ci.format   = io_out.format;
 
-            ci.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+            ci.subresourceRange = io_out.range = {VK_IMAGE_ASPECT_COLOR_BIT, 0, io_out.mMipLevels, 0, 1};
 
             {
                 VkImageView imageView;
@@ -1773,49 +3158,23 @@ namespace Cutlass
                     return result;
                 }
 
-                io.mView = imageView;
+                io_out.mView = imageView;
             }
         }
 
         {
-            VkSamplerCreateInfo sci{};
-            sci.sType     = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-            sci.pNext     = nullptr;
-            sci.minFilter = VK_FILTER_LINEAR;
-            sci.magFilter = VK_FILTER_LINEAR;
-
-            sci.addressModeU     = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-            sci.addressModeV     = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-            sci.addressModeW     = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-            sci.anisotropyEnable = VK_FALSE;
-            sci.maxAnisotropy    = 16.f;
-            sci.borderColor      = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
-            sci.compareOp        = VK_COMPARE_OP_ALWAYS;
-            sci.mipmapMode       = VK_SAMPLER_MIPMAP_MODE_LINEAR;
             VkSampler sampler;
-            result = checkVkResult(vkCreateSampler(mDevice, &sci, nullptr, &sampler));
+            result = getCachedSampler(SamplerInfo(), sampler);
             if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to create VkSampler!\n";
                 return result;
-            }
 
-            io.mSampler = sampler;
+            io_out.mSampler = sampler;
         }
 
-        handle_out = mNextTextureHandle++;
-        mImageMap.emplace(handle_out, io);
-
-        writeTexture(pImage, handle_out);
-
-        if (pImage != nullptr)
-            stbi_image_free(pImage);
-
         return Result::eSuccess;
     }
 
-    Result Context::getTextureSize(const HTexture& handle, uint32_t& width_out,
-                                   uint32_t& height_out, uint32_t& depth_out)
+    Result Context::createTexture(const TextureFile& file, HTexture& handle_out)
     {
         if (!mIsInitialized)
         {
@@ -1823,24 +3182,17 @@ namespace Cutlass
             return Result::eFailure;
         }
 
-        Result result = Result::eFailure;
-
-        if (mImageMap.count(handle) <= 0)
+        if (!file.isLoaded())
         {
-            assert(!"invalid texture handle");
+            std::cerr << "texture file is not loaded!\n";
             return Result::eFailure;
         }
 
-        auto&& extent = mImageMap[handle].extent;
-
-        width_out  = extent.width;
-        height_out = extent.height;
-        depth_out  = extent.depth;
-
-        return Result::eSuccess;
+        return createPackedTexture(file.getFormat(), file.getWidth(), file.getHeight(), file.getMipLevels(),
+                                   file.getData().data(), file.getData().size(), handle_out);
     }
 
-    Result Context::writeTexture(const void* const pData, const HTexture& handle)
+    Result Context::createTexture(const AssetPack& pack, std::string_view name, HTexture& handle_out)
     {
         if (!mIsInitialized)
         {
@@ -1848,206 +3200,248 @@ namespace Cutlass
             return Result::eFailure;
         }
 
-        Result result = Result::eFailure;
+        AssetEntry entry;
+        if (Result::eSuccess != pack.find(name, entry))
+            return Result::eFailure;
 
-        if (mImageMap.count(handle) <= 0)
+        if (entry.type != AssetType::eTexture)
         {
-            assert(!"invalid texture handle!");
+            std::cerr << "asset is not a texture : " << name << "\n";
             return Result::eFailure;
         }
 
-        ImageObject& io = mImageMap[handle];
+        // staging buffer is filled directly from the mapped file
+        return createPackedTexture(entry.format, entry.width, entry.height, entry.mipLevels,
+                                   entry.pData, entry.size, handle_out);
+    }
 
-        BufferObject stagingBo;
+    Result Context::createBuffer(const AssetPack& pack, std::string_view name, HBuffer& handle_out)
+    {
+        if (!mIsInitialized)
         {
-            size_t imageSize = io.extent.width * io.extent.height * io.extent.depth *
-                               io.mSizeOfChannel;
-            VkBufferCreateInfo ci{};
-            ci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            ci.size  = imageSize;
-            ci.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
 
-            {
-                VkBuffer buffer;
-                vkCreateBuffer(mDevice, &ci, nullptr, &buffer);
-                stagingBo.mBuffer = buffer;
-            }
+        AssetEntry entry;
+        if (Result::eSuccess != pack.find(name, entry))
+            return Result::eFailure;
 
-            {
-                VkMemoryRequirements reqs;
-                vkGetBufferMemoryRequirements(mDevice, stagingBo.mBuffer.value(), &reqs);
-                VkMemoryAllocateInfo ai{};
-                ai.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-                ai.allocationSize  = reqs.size;
-                ai.memoryTypeIndex = getMemoryTypeIndex(
-                    reqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-
-                {
-                    VkDeviceMemory memory;
-                    vkAllocateMemory(mDevice, &ai, nullptr, &memory);
-                    stagingBo.mMemory = memory;
-                }
-
-                vkBindBufferMemory(mDevice, stagingBo.mBuffer.value(),
-                                   stagingBo.mMemory.value(), 0);
-            }
+        BufferInfo info;
+        switch (entry.type)
+        {
+            case AssetType::eVertexBuffer:
+                info = BufferInfo(entry.size, BufferUsage::eVertex, false);
+                break;
+            case AssetType::eIndexBuffer:
+                info = BufferInfo(entry.size, BufferUsage::eIndex, false);
+                break;
+            default:
+                std::cerr << "asset is not a vertex or index buffer : " << name << "\n";
+                return Result::eFailure;
+                break;
+        }
 
-            void* p;
-            result = checkVkResult(vkMapMemory(mDevice, stagingBo.mMemory.value(), 0,
-                                               VK_WHOLE_SIZE, 0, &p));
-            if (Result::eSuccess != result)
-                return result;
+        Result result = createBuffer(info, handle_out);
+        if (Result::eSuccess != result)
+            return result;
 
-            memcpy(p, pData, imageSize);
-            vkUnmapMemory(mDevice, stagingBo.mMemory.value());
-        }
+        return writeBuffer(entry.size, entry.pData, handle_out);
+    }
 
-        VkBufferImageCopy copyRegion{};
-        copyRegion.imageExtent      = {static_cast<uint32_t>(io.extent.width),
-                                  static_cast<uint32_t>(io.extent.height),
-                                  static_cast<uint32_t>(io.extent.depth)};
-        copyRegion.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
-        VkCommandBuffer command;
+    Result Context::createSampler(const SamplerInfo& info, HSampler& handle_out)
+    {
+        if (!mIsInitialized)
         {
-            VkCommandBufferAllocateInfo ai{};
-            ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-            ai.commandBufferCount = 1;
-            ai.commandPool        = mCommandPool;
-            ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            vkAllocateCommandBuffers(mDevice, &ai, &command);
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
         }
 
-        VkCommandBufferBeginInfo commandBI{};
-        commandBI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        vkBeginCommandBuffer(command, &commandBI);
-        setImageMemoryBarrier(command, io.mImage.value(), VK_IMAGE_LAYOUT_UNDEFINED,
-                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-        vkCmdCopyBufferToImage(command, stagingBo.mBuffer.value(), io.mImage.value(),
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+        return getCachedSampler(info, handle_out);
+    }
 
-        setImageMemoryBarrier(command, io.mImage.value(),
-                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-        vkEndCommandBuffer(command);
+    Result Context::getCachedSampler(const SamplerInfo& info, HSampler& handle_out)
+    {
+        // the number of distinct samplers is small, so linear search is enough
+        for (const auto& [handle, so] : mSamplerMap)
+            if (so.mInfo == info)
+            {
+                handle_out = handle;
+                return Result::eSuccess;
+            }
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers    = &command;
-        vkQueueSubmit(mDeviceQueue, 1, &submitInfo, VK_NULL_HANDLE);
+        const auto convertFilter = [](Filter filter)
+        {
+            return filter == Filter::eNearest ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
+        };
 
-        // end copying
-        vkDeviceWaitIdle(mDevice);
-        vkFreeCommandBuffers(mDevice, mCommandPool, 1, &command);
+        const auto convertAddressMode = [](AddressMode mode)
+        {
+            switch (mode)
+            {
+                case AddressMode::eRepeat:
+                    return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+                case AddressMode::eMirroredRepeat:
+                    return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+                case AddressMode::eClampToBorder:
+                    return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+                default:
+                    return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+            }
+        };
+
+        VkSamplerCreateInfo sci{};
+        sci.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        sci.magFilter    = convertFilter(info.magFilter);
+        sci.minFilter    = convertFilter(info.minFilter);
+        sci.mipmapMode   = info.mipmapFilter == Filter::eNearest ? VK_SAMPLER_MIPMAP_MODE_NEAREST : VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        sci.addressModeU = convertAddressMode(info.addressU);
+        sci.addressModeV = convertAddressMode(info.addressV);
+        sci.addressModeW = convertAddressMode(info.addressW);
+        sci.mipLodBias   = info.mipLodBias;
+        sci.minLod       = info.minLod;
+        sci.maxLod       = info.maxLod;
+        sci.borderColor  = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+
+        // anisotropy is clamped to the device limit
+        sci.anisotropyEnable = mSamplerAnisotropy && info.maxAnisotropy > 1.f ? VK_TRUE : VK_FALSE;
+        sci.maxAnisotropy    = sci.anisotropyEnable ? std::min(info.maxAnisotropy, mMaxSamplerAnisotropy) : 1.f;
+        if (mDebugFlag && !mSamplerAnisotropy && info.maxAnisotropy > 1.f)
+            std::cerr << "anisotropic filtering is not supported, so it is disabled\n";
+
+        sci.compareEnable = info.compareOp ? VK_TRUE : VK_FALSE;
+        sci.compareOp     = info.compareOp ? static_cast<VkCompareOp>(info.compareOp.value()) : VK_COMPARE_OP_ALWAYS;
+
+        VkSampler sampler;
+        Result result = checkVkResult(vkCreateSampler(mDevice, &sci, nullptr, &sampler));
+        if (result != Result::eSuccess)
+        {
+            std::cerr << "failed to create VkSampler!\n";
+            return result;
+        }
 
-        // release staging buffer
-        vkFreeMemory(mDevice, stagingBo.mMemory.value(), nullptr);
-        vkDestroyBuffer(mDevice, stagingBo.mBuffer.value(), nullptr);
+        handle_out = mNextSamplerHandle++;
+        mSamplerMap.emplace(handle_out, SamplerObject{info, sampler});
 
         return Result::eSuccess;
     }
 
-    Result Context::setImageMemoryBarrier(VkCommandBuffer command, VkImage image,
-                                          VkImageLayout oldLayout,
-                                          VkImageLayout newLayout,
-                                          VkImageAspectFlags aspectFlags)
+    Result Context::getCachedSampler(const SamplerInfo& info, VkSampler& sampler_out)
     {
-        if (!mIsInitialized)
+        HSampler handle;
+        Result result = getCachedSampler(info, handle);
+        if (result != Result::eSuccess)
+            return result;
+
+        sampler_out = mSamplerMap[handle].mSampler;
+        return Result::eSuccess;
+    }
+
+    Result Context::createPackedTexture(const ResourceType format, const uint32_t width, const uint32_t height,
+                                        const std::vector<TextureFile::MipLevel>& mipLevels,
+                                        const void* const pData, const size_t size, HTexture& handle_out)
+    {
+        if (mipLevels.empty())
         {
-            std::cerr << "context did not initialize yet!\n";
+            std::cerr << "texture has no mip level!\n";
             return Result::eFailure;
         }
 
-        VkImageMemoryBarrier imb{};
-        imb.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        imb.oldLayout           = oldLayout;
-        imb.newLayout           = newLayout;
-        imb.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imb.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        imb.subresourceRange    = {aspectFlags, 0, 1, 0, 1};
-        imb.image               = image;
-
-        // final stage that write to resource in pipelines
-        VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-        // next state that write to resource in pipelines
-        VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        ImageObject io;
+        Result result;
 
-        switch (oldLayout)
+        io.mIsCompressed = isBlockCompressed(format);
+        switch (format)
         {
-            case VK_IMAGE_LAYOUT_UNDEFINED:
-                imb.srcAccessMask = 0;
+            case ResourceType::eUNormVec4:
+                io.format         = VK_FORMAT_R8G8B8A8_UNORM;
+                io.mSizeOfChannel = 4;
                 break;
-            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-                imb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-                srcStage          = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            case ResourceType::eBC1UNorm:
+                io.format = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
                 break;
-            case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-                imb.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            case ResourceType::eBC1SRGB:
+                io.format = VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
                 break;
-        }
-
-        switch (newLayout)
-        {
-            case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-                imb.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-                dstStage          = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            case ResourceType::eBC2UNorm:
+                io.format = VK_FORMAT_BC2_UNORM_BLOCK;
                 break;
-            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-                imb.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-                dstStage          = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            case ResourceType::eBC2SRGB:
+                io.format = VK_FORMAT_BC2_SRGB_BLOCK;
                 break;
-            case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-                imb.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-                dstStage          = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            case ResourceType::eBC3UNorm:
+                io.format = VK_FORMAT_BC3_UNORM_BLOCK;
+                break;
+            case ResourceType::eBC3SRGB:
+                io.format = VK_FORMAT_BC3_SRGB_BLOCK;
+                break;
+            case ResourceType::eBC4UNorm:
+                io.format = VK_FORMAT_BC4_UNORM_BLOCK;
+                break;
+            case ResourceType::eBC5UNorm:
+                io.format = VK_FORMAT_BC5_UNORM_BLOCK;
+                break;
+            case ResourceType::eBC6HUFloat:
+                io.format = VK_FORMAT_BC6H_UFLOAT_BLOCK;
+                break;
+            case ResourceType::eBC7UNorm:
+                io.format = VK_FORMAT_BC7_UNORM_BLOCK;
+                break;
+            case ResourceType::eBC7SRGB:
+                io.format = VK_FORMAT_BC7_SRGB_BLOCK;
+                break;
+            default:
+                std::cerr << "invalid type of pixel!\n";
+                return Result::eFailure;
                 break;
         }
 
-        vkCmdPipelineBarrier(command, srcStage, dstStage, 0,
-                             0,  // memoryBarrierCount
-                             nullptr,
-                             0,  // bufferMemoryBarrierCount
-                             nullptr,
-                             1,  // imageMemoryBarrierCount
-                             &imb);
-
-        return Result::eSuccess;
-    }
+        // BC formats are optional (mainly unsupported on mobile GPU)
+        {
+            VkFormatProperties props;
+            vkGetPhysicalDeviceFormatProperties(mPhysDev, io.format, &props);
+            if (!(props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+            {
+                std::cerr << "this device does not support the format of texture file!\n";
+                return Result::eFailure;
+            }
+        }
 
-    Result Context::createDepthBuffer(WindowObject& wo)
-    {
-        Result result;
-        ImageObject io;
+        io.extent         = {width, height, 1};
+        io.mMipLevels     = static_cast<uint32_t>(mipLevels.size());
+        io.usage          = TextureUsage::eShaderResource;
+        io.currentLayout  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        io.mIsHostVisible = false;
 
         {
             VkImageCreateInfo ci{};
             ci.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-            ci.pNext         = nullptr;
+            ci.extent        = io.extent;
+            ci.format        = io.format;
             ci.imageType     = VK_IMAGE_TYPE_2D;
-            ci.format        = VK_FORMAT_D32_SFLOAT;
-            ci.extent.width  = wo.mSwapchainExtent.width;
-            ci.extent.height = wo.mSwapchainExtent.height;
-            ci.extent.depth  = 1;
-            ci.mipLevels     = 1;
-            ci.usage         = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-            ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            ci.samples       = VK_SAMPLE_COUNT_1_BIT;
             ci.arrayLayers   = 1;
+            ci.mipLevels     = io.mMipLevels;
+            ci.samples       = VK_SAMPLE_COUNT_1_BIT;
+            ci.tiling        = VK_IMAGE_TILING_OPTIMAL;
+            ci.usage         = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+            ci.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+            ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-            io.format         = ci.format;
-            io.extent         = ci.extent;
-            io.mSizeOfChannel = 4;
-
+            std::vector<uint32_t> queueFamilyIndices;
+            if (getConcurrentQueueFamilies(queueFamilyIndices))
             {
-                VkImage image;
-                result = checkVkResult(vkCreateImage(mDevice, &ci, nullptr, &image));
-                if (Result::eSuccess != result)
-                {
-                    std::cerr << "failed to create depth buffer's image\n";
-                    return result;
-                }
-
-                io.mImage = image;
+                ci.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+                ci.queueFamilyIndexCount = uint32_t(queueFamilyIndices.size());
+                ci.pQueueFamilyIndices   = queueFamilyIndices.data();
+                io.mConcurrentSharing    = true;
             }
+
+            VkImage image;
+            result = checkVkResult(vkCreateImage(mDevice, &ci, nullptr, &image));
+            if (Result::eSuccess != result)
+                return result;
+
+            io.mImage = image;
         }
 
         {
@@ -2056,47 +3450,31 @@ namespace Cutlass
             VkMemoryAllocateInfo ai{};
             ai.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
             ai.allocationSize  = reqs.size;
-            ai.memoryTypeIndex = getMemoryTypeIndex(
-                reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-            {
-                VkDeviceMemory memory;
-                result = checkVkResult(vkAllocateMemory(mDevice, &ai, nullptr, &memory));
-                if (Result::eSuccess != result)
-                {
-                    return result;
-                }
-
-                io.mMemory = memory;
-            }
+            ai.memoryTypeIndex = getBudgetedMemoryTypeIndex(reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, reqs.size);
 
-            result = checkVkResult(
-                vkBindImageMemory(mDevice, io.mImage.value(), io.mMemory.value(), 0));
+            VkDeviceMemory memory;
+            result = checkVkResult(allocateMemory(ai, memory));
             if (Result::eSuccess != result)
             {
+                vkDestroyImage(mDevice, io.mImage.value(), nullptr);
                 return result;
             }
+
+            io.mMemory = memory;
+            vkBindImageMemory(mDevice, io.mImage.value(), io.mMemory.value(), 0);
         }
 
         {
             VkImageViewCreateInfo ci{};
-            ci.sType      = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-            ci.image      = io.mImage.value();
-            ci.viewType   = VK_IMAGE_VIEW_TYPE_2D;
-            ci.format     = io.format;
-            ci.components = {
-                VK_COMPONENT_SWIZZLE_R,
-                VK_COMPONENT_SWIZZLE_G,
-                VK_COMPONENT_SWIZZLE_B,
-                VK_COMPONENT_SWIZZLE_A,
-            };
-            //ci.subresourceRange = {VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, 0, 1, 0, 1};
-            ci.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+            ci.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            ci.viewType         = VK_IMAGE_VIEW_TYPE_2D;
+            ci.image            = io.mImage.value();
+            ci.format           = io.format;
+            ci.subresourceRange = io.range = {VK_IMAGE_ASPECT_COLOR_BIT, 0, io.mMipLevels, 0, 1};
 
             VkImageView imageView;
-            result =
-                checkVkResult(vkCreateImageView(mDevice, &ci, nullptr, &imageView));
-            if (Result::eSuccess != result)
+            result = checkVkResult(vkCreateImageView(mDevice, &ci, nullptr, &imageView));
+            if (result != Result::eSuccess)
             {
                 std::cerr << "failed to create vkImageView!\n";
                 return result;
@@ -2105,305 +3483,311 @@ namespace Cutlass
             io.mView = imageView;
         }
 
-        io.currentLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        io.usage         = TextureUsage::eDepthStencilTarget;
+        {
+            VkSampler sampler;
+            result = getCachedSampler(SamplerInfo(), sampler);
+            if (result != Result::eSuccess)
+                return result;
 
-        // set image layout
+            io.mSampler = sampler;
+        }
+
+        // every level is copied as it is stored in the file
+        std::vector<VkBufferImageCopy> regions;
+        regions.reserve(mipLevels.size());
+        for (uint32_t i = 0; i < io.mMipLevels; ++i)
         {
-            VkCommandBuffer command;
-            {
-                VkCommandBufferAllocateInfo ai{};
-                ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-                ai.commandBufferCount = 1;
-                ai.commandPool        = mCommandPool;
-                ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-                vkAllocateCommandBuffers(mDevice, &ai, &command);
-            }
+            const auto& level = mipLevels[i];
 
-            VkCommandBufferBeginInfo commandBI{};
-            commandBI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            vkBeginCommandBuffer(command, &commandBI);
+            VkBufferImageCopy region{};
+            region.bufferOffset     = level.offset;
+            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1};
+            region.imageExtent      = {level.width, level.height, 1};
+            regions.emplace_back(region);
+        }
 
-            //setImageMemoryBarrier(command, io.mImage.value(), VK_IMAGE_LAYOUT_UNDEFINED,
-            //                      io.currentLayout, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
-            setImageMemoryBarrier(command, io.mImage.value(), VK_IMAGE_LAYOUT_UNDEFINED,
-                io.currentLayout, VK_IMAGE_ASPECT_DEPTH_BIT);
-            vkEndCommandBuffer(command);
+        handle_out = mNextTextureHandle++;
+        mImageMap.emplace(handle_out, io);
 
-            VkSubmitInfo submitInfo{};
-            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers    = &command;
-            vkQueueSubmit(mDeviceQueue, 1, &submitInfo, VK_NULL_HANDLE);
+        return uploadImage(mImageMap[handle_out], pData, size, regions, false, 0, 1);
+    }
 
-            // end copying
-            vkDeviceWaitIdle(mDevice);
-            vkFreeCommandBuffers(mDevice, mCommandPool, 1, &command);
+    Result Context::getTextureSize(const HTexture& handle, uint32_t& width_out,
+                                   uint32_t& height_out, uint32_t& depth_out)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
         }
 
-        mImageMap.emplace(mNextTextureHandle, io);
-        wo.mHDepthBuffer = mNextTextureHandle++;
+        Result result = Result::eFailure;
+
+        if (mImageMap.count(handle) <= 0)
+        {
+            assert(!"invalid texture handle");
+            return Result::eFailure;
+        }
+
+        const auto& io = mImageMap[handle];
+
+        // depth of array and cube map is the number of layers (same as TextureInfo)
+        width_out  = io.extent.width;
+        height_out = io.extent.height;
+        depth_out  = io.mDimension == Dimension::e3D ? io.extent.depth : io.mArrayLayers;
 
         return Result::eSuccess;
     }
 
-    Result Context::setUpImGui(WindowObject& wo, RenderPassObject& rpo)
+    Result Context::writeTexture(const void* const pData, const HTexture& handle)
     {
-        Result result = Result::eSuccess;
-
-        // Create Descriptor Pool for ImGui
+        if (!mIsInitialized)
         {
-            VkDescriptorPool descriptorPool;
-            constexpr int maxNum              = 100;
-            VkDescriptorPoolSize pool_sizes[] = {
-                {VK_DESCRIPTOR_TYPE_SAMPLER, maxNum},
-                {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxNum},
-                {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, maxNum},
-                {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxNum},
-                {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, maxNum},
-                {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, maxNum},
-                {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, maxNum},
-                {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxNum},
-                {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, maxNum},
-                {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, maxNum},
-                {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, maxNum}};
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
 
-            VkDescriptorPoolCreateInfo pool_info = {};
-            pool_info.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-            pool_info.flags                      = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-            pool_info.maxSets                    = maxNum * IM_ARRAYSIZE(pool_sizes);
-            pool_info.poolSizeCount              = (uint32_t)IM_ARRAYSIZE(pool_sizes);
-            pool_info.pPoolSizes                 = pool_sizes;
-            result                               = checkVkResult(
-                                              vkCreateDescriptorPool(mDevice, &pool_info, NULL, &descriptorPool));
-            if (Result::eSuccess != result)
-            {
-                std::cerr << "failed to create vkDescriptorPool for ImGui!\n";
-                return result;
-            }
-            mImGuiDescriptorPool = descriptorPool;
+        TraceScope trace(mTracer, "writeTexture");
+
+        Result result = Result::eFailure;
+
+        if (mImageMap.count(handle) <= 0)
+        {
+            assert(!"invalid texture handle!");
+            return Result::eFailure;
         }
 
-        IMGUI_CHECKVERSION();
-        ImGui::CreateContext();
-        ImGui_ImplGlfw_InitForVulkan(wo.mpWindow.value(), true);
+        ImageObject& io = mImageMap[handle];
 
-        ImGui_ImplVulkan_InitInfo info = {};
-        info.Instance                  = mInstance;
-        info.PhysicalDevice            = mPhysDev;
-        info.Device                    = mDevice;
-        info.QueueFamily               = mGraphicsQueueIndex;
-        info.Queue                     = mDeviceQueue;
-        info.PipelineCache             = NULL;
-        info.DescriptorPool            = mImGuiDescriptorPool.value();
-        info.Allocator                 = NULL;
-        info.MinImageCount             = std::max(2u, wo.mSurfaceCaps.minImageCount);
-        info.ImageCount                = wo.mMaxFrameNum;
-        info.CheckVkResultFn           = ImGui_check_vk_result;
-        // ImGui_ImplVulkan_Init(&info, mImGuiRenderPass.value());
-        ImGui_ImplVulkan_Init(&info, rpo.mRenderPass.value());
+        if (io.mIsCompressed)
+        {
+            std::cerr << "compressed texture can not be written directly!\n";
+            return Result::eFailure;
+        }
 
-        {  // upload font data
+        // layers (or slices of 3D texture) are packed in order
+        const size_t imageSize = io.extent.width * io.extent.height * io.extent.depth *
+                                 io.mArrayLayers * io.mSizeOfChannel;
+        VkBufferImageCopy copyRegion{};
+        copyRegion.imageExtent      = {static_cast<uint32_t>(io.extent.width),
+                                  static_cast<uint32_t>(io.extent.height),
+                                  static_cast<uint32_t>(io.extent.depth)};
+        copyRegion.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, io.mArrayLayers};
 
-            VkCommandBuffer commandBuffer;
-            {
-                VkCommandBufferAllocateInfo ai{};
-                ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-                ai.commandPool        = mCommandPool;
-                ai.commandBufferCount = 1;
-                ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-                result =
-                    checkVkResult(vkAllocateCommandBuffers(mDevice, &ai, &commandBuffer));
-                if (Result::eSuccess != result)
-                {
-                    std::cerr << "Failed to allocate command buffers!\n";
-                    return result;
-                }
-            }
+        return uploadImage(io, pData, imageSize, {copyRegion}, io.mMipLevels > 1, 0, io.mArrayLayers);
+    }
 
-            VkCommandBufferBeginInfo bi = {};
-            bi.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            bi.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-            result = checkVkResult(vkBeginCommandBuffer(commandBuffer, &bi));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to begin command buffer!\n";
-                return result;
-            }
+    Result Context::writeTexture(const void* const pData, const HTexture& handle, const uint32_t layer)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
 
-            ImGui_ImplVulkan_CreateFontsTexture(commandBuffer);
+        TraceScope trace(mTracer, "writeTexture");
 
-            VkSubmitInfo end_info       = {};
-            end_info.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            end_info.commandBufferCount = 1;
-            end_info.pCommandBuffers    = &commandBuffer;
-            result                      = checkVkResult(vkEndCommandBuffer(commandBuffer));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to end command buffer!\n";
-                return result;
-            }
+        if (mImageMap.count(handle) <= 0)
+        {
+            assert(!"invalid texture handle!");
+            return Result::eFailure;
+        }
 
-            result = checkVkResult(
-                vkQueueSubmit(mDeviceQueue, 1, &end_info, VK_NULL_HANDLE));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to submit command buffer!\n";
-                return result;
-            }
+        ImageObject& io = mImageMap[handle];
 
-            result = checkVkResult(vkDeviceWaitIdle(mDevice));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to wait device idle!\n";
-                return result;
-            }
+        if (io.mIsCompressed)
+        {
+            std::cerr << "compressed texture can not be written directly!\n";
+            return Result::eFailure;
+        }
 
-            ImGui_ImplVulkan_DestroyFontUploadObjects();
+        // slices of 3D texture share one subresource, so they can not be replaced separately
+        if (io.mDimension == Dimension::e3D)
+        {
+            std::cerr << "3D texture must be written at once!\n";
+            return Result::eFailure;
+        }
 
-            vkFreeCommandBuffers(mDevice, mCommandPool, 1, &commandBuffer);
+        if (layer >= io.mArrayLayers)
+        {
+            std::cerr << "layer " << layer << " is out of texture (layer count : " << io.mArrayLayers << ")!\n";
+            return Result::eFailure;
         }
 
-        return Result::eSuccess;
+        // other layers are kept because barriers cover only this layer
+        const size_t imageSize = io.extent.width * io.extent.height * io.mSizeOfChannel;
+        VkBufferImageCopy copyRegion{};
+        copyRegion.imageExtent      = {io.extent.width, io.extent.height, 1};
+        copyRegion.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, layer, 1};
+
+        return uploadImage(io, pData, imageSize, {copyRegion}, io.mMipLevels > 1, layer, 1);
     }
 
-    Result Context::uploadFontFile(const char* fontPath, float fontSize)
+    Result Context::readTexture(const HTexture& handle, HReadback& ticket_out)
     {
-        Result result = Result::eSuccess;
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
 
-        ImGuiIO& io = ImGui::GetIO();
-        (void)io;
-        io.Fonts->AddFontFromFileTTF(fontPath, fontSize);
+        if (mImageMap.count(handle) <= 0)
+        {
+            assert(!"invalid texture handle!");
+            return Result::eFailure;
+        }
 
-        {  // upload font data
+        const ImageObject& io = mImageMap[handle];
 
-            VkCommandBuffer commandBuffer;
-            {
-                VkCommandBufferAllocateInfo ai{};
-                ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-                ai.commandPool        = mCommandPool;
-                ai.commandBufferCount = 1;
-                ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-                result =
-                    checkVkResult(vkAllocateCommandBuffers(mDevice, &ai, &commandBuffer));
-                if (Result::eSuccess != result)
-                {
-                    std::cerr << "Failed to allocate command buffers!\n";
-                    return result;
-                }
-            }
+        if (io.usage == TextureUsage::eSwapchainImage)
+        {
+            std::cerr << "swapchain image can not be read, render to a texture instead!\n";
+            return Result::eFailure;
+        }
 
-            VkCommandBufferBeginInfo bi = {};
-            bi.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            bi.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-            result = checkVkResult(vkBeginCommandBuffer(commandBuffer, &bi));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to begin command buffer!\n";
-                return result;
-            }
+        if (io.mIsCompressed || io.mSampleCount != VK_SAMPLE_COUNT_1_BIT)
+        {
+            std::cerr << "compressed or multisampled texture can not be read!\n";
+            return Result::eFailure;
+        }
 
-            ImGui_ImplVulkan_CreateFontsTexture(commandBuffer);
+        if (io.mIsTransient && (!io.mIsSampled || !io.mView))
+        {
+            std::cerr << "this transient texture has no readable memory!\n";
+            return Result::eFailure;
+        }
 
-            VkSubmitInfo end_info       = {};
-            end_info.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            end_info.commandBufferCount = 1;
-            end_info.pCommandBuffers    = &commandBuffer;
-            result                      = checkVkResult(vkEndCommandBuffer(commandBuffer));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to end command buffer!\n";
-                return result;
-            }
+        const size_t size = io.extent.width * io.extent.height * io.extent.depth *
+                            io.mArrayLayers * io.mSizeOfChannel;
 
-            result = checkVkResult(
-                vkQueueSubmit(mDeviceQueue, 1, &end_info, VK_NULL_HANDLE));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to submit command buffer!\n";
-                return result;
-            }
+        ReadbackObject ro;
+        Result result = beginReadback(size, ro);
+        if (Result::eSuccess != result)
+            return result;
 
-            result = checkVkResult(vkDeviceWaitIdle(mDevice));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to wait device idle!\n";
-                return result;
-            }
+        // every write submitted before (render pass, compute, upload) is made available to the copy
+        VkImageMemoryBarrier imb{};
+        imb.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imb.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imb.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imb.image               = io.mImage.value();
+        imb.subresourceRange    = {io.range.aspectMask, 0, 1, 0, io.mArrayLayers};
+        imb.oldLayout           = io.currentLayout;
+        imb.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        imb.srcAccessMask       = VK_ACCESS_MEMORY_WRITE_BIT;
+        imb.dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(ro.mCommand, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imb);
+
+        VkBufferImageCopy region{};
+        region.bufferOffset     = ro.mOffset;
+        region.imageSubresource = {io.range.aspectMask, 0, 0, io.mArrayLayers};
+        region.imageExtent      = io.extent;
+        vkCmdCopyImageToBuffer(ro.mCommand, io.mImage.value(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               mReadbackRing.mBuffer.value(), 1, &region);
+
+        // back to the layout that following commands expect
+        imb.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        imb.newLayout     = io.currentLayout;
+        imb.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        imb.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        vkCmdPipelineBarrier(ro.mCommand, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imb);
+
+        return submitReadback(ro, ticket_out);
+    }
 
-            ImGui_ImplVulkan_DestroyFontUploadObjects();
+    Result Context::readBuffer(const HBuffer& handle, HReadback& ticket_out)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
 
-            vkFreeCommandBuffers(mDevice, mCommandPool, 1, &commandBuffer);
+        if (mBufferMap.count(handle) <= 0)
+        {
+            assert(!"invalid buffer handle!");
+            return Result::eFailure;
         }
 
-        return result;
+        const BufferObject& bo = mBufferMap[handle];
+
+        ReadbackObject ro;
+        Result result = beginReadback(static_cast<size_t>(bo.mSize), ro);
+        if (Result::eSuccess != result)
+            return result;
+
+        VkMemoryBarrier mb{};
+        mb.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        mb.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        mb.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(ro.mCommand, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &mb, 0, nullptr, 0, nullptr);
+
+        VkBufferCopy region{};
+        region.srcOffset = 0;
+        region.dstOffset = ro.mOffset;
+        region.size      = bo.mSize;
+        vkCmdCopyBuffer(ro.mCommand, bo.mBuffer.value(), mReadbackRing.mBuffer.value(), 1, &region);
+
+        return submitReadback(ro, ticket_out);
     }
 
-    Result Context::createShaderModule(const Shader& shader,
-                                       const VkShaderStageFlagBits& stage,
-                                       VkPipelineShaderStageCreateInfo* pSSCI)
+    bool Context::isReadbackReady(const HReadback& ticket) const
     {
-        Result result;
+        const auto itr = mReadbackMap.find(ticket);
+        if (itr == mReadbackMap.end())
+            return false;
 
-        // std::ifstream infile(shader.path.c_str(), std::ios::binary);
-        // if (!infile)
-        // {
-        //     std::cerr << "failed to load file from " << shader.path << " \n";
-        //     return Result::eFailure;
-        // }
+        return vkGetFenceStatus(mDevice, itr->second.mFence) == VK_SUCCESS;
+    }
 
-        // std::vector<char> filedata;
-        // filedata.resize(uint32_t(infile.seekg(0,
-        // std::ifstream::end).tellg())); infile.seekg(0,
-        // std::ifstream::beg).read(filedata.data(), filedata.size());
-
-        VkShaderModule shaderModule;
-        VkShaderModuleCreateInfo ci{};
-        ci.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        ci.pNext = nullptr;
-        ci.pCode =
-            reinterpret_cast<const uint32_t*>(shader.getShaderByteCode().data());
-        ci.codeSize = shader.getShaderByteCode().size();
-        result =
-            checkVkResult(vkCreateShaderModule(mDevice, &ci, nullptr, &shaderModule));
-        if (result != Result::eSuccess)
+    Result Context::getReadbackData(const HReadback& ticket, const void*& pData_out, size_t& size_out)
+    {
+        if (!mIsInitialized)
         {
-            std::cerr << "failed to create Shader Module\n";
-            return result;
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
         }
 
-        pSSCI->sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        pSSCI->flags  = 0;
-        pSSCI->pNext  = nullptr;
-        pSSCI->stage  = stage;
-        pSSCI->module = shaderModule;
-        pSSCI->pName  = shader.getEntryPoint().data();
+        if (mReadbackMap.count(ticket) <= 0)
+        {
+            std::cerr << "invalid (or released) readback ticket!\n";
+            return Result::eFailure;
+        }
 
-        return Result::eSuccess;
-    }
+        auto& ro = mReadbackMap[ticket];
 
-    Result Context::createRenderPass(const RenderPassInfo& info,
-                                     HRenderPass& handle_out)
-    {
-        if (info.window)
+        Result result = Result::eSuccess;
         {
-            return createRenderPass(info.window.value(), true, handle_out);
+            TraceScope trace(mTracer, "wait readback");
+            result = checkVkResult(vkWaitForFences(mDevice, 1, &ro.mFence, VK_TRUE, UINT64_MAX));
         }
-        else
+        if (Result::eSuccess != result)
+            return result;
+
+        // make device writes visible to host
+        if (!mReadbackRing.mIsCoherent && !ro.mIsInvalidated)
         {
-            if (info.depthTarget)
-                return createRenderPass(info.colorTargets, info.depthTarget.value(),
-                                        info.loadPrevFrame, handle_out);
-            else
-                return createRenderPass(info.colorTargets, info.loadPrevFrame,
-                                        handle_out);
+            VkMappedMemoryRange range{};
+            range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            range.memory = mReadbackRing.mMemory.value();
+            range.offset = ro.mOffset;
+            range.size   = ro.mSize;
+            result       = checkVkResult(vkInvalidateMappedMemoryRanges(mDevice, 1, &range));
+            if (Result::eSuccess != result)
+                return result;
         }
+        ro.mIsInvalidated = true;
 
-        return Result::eFailure;
+        pData_out = mReadbackRing.pMapped + ro.mOffset;
+        size_out  = ro.mDataSize;
+
+        return Result::eSuccess;
     }
 
-    Result Context::createRenderPass(const HWindow& handle, bool depthTestEnable,
-                                     HRenderPass& handle_out)
+    Result Context::releaseReadback(const HReadback& ticket)
     {
         if (!mIsInitialized)
         {
@@ -2411,406 +3795,639 @@ namespace Cutlass
             return Result::eFailure;
         }
 
-        Result result;
-        RenderPassObject rpo;
-        rpo.mFrameBufferIndex = 0;
-        rpo.mDepthTestEnable  = depthTestEnable;
-        rpo.mLoadPrevData     = false;
-
-        // Renderpass, framebuffer
-
-        if (mWindowMap.count(handle) <= 0)
+        if (mReadbackMap.count(ticket) <= 0)
         {
-            std::cerr << "invalid swapchain handle\n";
+            std::cerr << "invalid (or released) readback ticket!\n";
             return Result::eFailure;
         }
-        rpo.mHWindow    = handle;
-        auto& swapchain = mWindowMap[handle];
+
+        auto& ro = mReadbackMap[ticket];
+
+        // the copy may be still in flight if the data was never fetched
+        Result result = checkVkResult(vkWaitForFences(mDevice, 1, &ro.mFence, VK_TRUE, UINT64_MAX));
+        if (Result::eSuccess != result)
+            return result;
+
+        vkFreeCommandBuffers(mDevice, mCommandPool, 1, &ro.mCommand);
+        mReadbackFencePool.emplace_back(ro.mFence);
+        mReadbackMap.erase(ticket);
+
+        // space is reclaimed from the oldest ticket, and from the newest one released out of order
+        while (!mReadbackOrder.empty() && mReadbackMap.count(mReadbackOrder.front()) <= 0)
+            mReadbackOrder.pop_front();
+        while (!mReadbackOrder.empty() && mReadbackMap.count(mReadbackOrder.back()) <= 0)
+            mReadbackOrder.pop_back();
+
+        return Result::eSuccess;
+    }
+
+    Result Context::createReadbackRing(const VkDeviceSize size)
+    {
+        Result result = Result::eFailure;
 
         {
-            VkExtent3D extent;
-            extent.width  = swapchain.mSwapchainExtent.width;
-            extent.height = swapchain.mSwapchainExtent.height;
-            extent.depth  = 1;
-            rpo.mExtent   = extent;
+            VkBufferCreateInfo ci{};
+            ci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            ci.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            ci.size  = size;
+
+            VkBuffer buffer;
+            result = checkVkResult(vkCreateBuffer(mDevice, &ci, nullptr, &buffer));
+            if (Result::eSuccess != result)
+                return result;
+            mReadbackRing.mBuffer = buffer;
         }
 
+        VkMemoryRequirements reqs;
+        vkGetBufferMemoryRequirements(mDevice, mReadbackRing.mBuffer.value(), &reqs);
+
+        // cached memory is much faster to read from CPU, but it may not be coherent
+        std::optional<uint32_t> memoryTypeIndex;
+        for (const auto props : {VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT),
+                                 VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)})
         {
-            VkRenderPassCreateInfo ci{};
-            ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-            std::vector<VkAttachmentDescription> adVec;
-            VkAttachmentReference ar;
-            VkAttachmentReference depthAr;
+            for (uint32_t i = 0; i < mPhysMemProps.memoryTypeCount && !memoryTypeIndex; ++i)
+                if ((reqs.memoryTypeBits & (1u << i)) &&
+                    (mPhysMemProps.memoryTypes[i].propertyFlags & props) == props)
+                    memoryTypeIndex = i;
 
-            adVec.reserve(2);
+            if (memoryTypeIndex)
+                break;
+        }
 
-            const auto& rdst = swapchain.mHSwapchainImages[0];  // only for info
+        if (!memoryTypeIndex)
+        {
+            std::cerr << "no host visible memory for readback!\n";
+            destroyReadbackRing();
+            return Result::eFailure;
+        }
 
-            if (mImageMap.count(rdst) <= 0)
+        {
+            VkMemoryAllocateInfo ai{};
+            ai.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            ai.allocationSize  = reqs.size;
+            ai.memoryTypeIndex = memoryTypeIndex.value();
+
+            VkDeviceMemory memory;
+            result = checkVkResult(allocateMemory(ai, memory));
+            if (Result::eSuccess != result)
             {
-                std::cerr << "invalid swapchain image handle\n";
-                return Result::eFailure;
+                destroyReadbackRing();
+                return result;
             }
+            mReadbackRing.mMemory = memory;
+        }
 
-            auto& io = mImageMap[rdst];
-            adVec.emplace_back();
-            adVec.back().format        = io.format;
-            adVec.back().samples       = VK_SAMPLE_COUNT_1_BIT;
-            adVec.back().loadOp        = VK_ATTACHMENT_LOAD_OP_CLEAR;
-            adVec.back().storeOp       = VK_ATTACHMENT_STORE_OP_STORE;
-            adVec.back().initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            // adVec.back().finalLayout = swapchain.useImGui ?
-            // VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL :
-            // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-            adVec.back().finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-            ar.attachment            = 0;
-            ar.layout                = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        vkBindBufferMemory(mDevice, mReadbackRing.mBuffer.value(), mReadbackRing.mMemory.value(), 0);
 
-            VkSubpassDescription subpassDesc{};
-            subpassDesc.pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
-            subpassDesc.colorAttachmentCount = 1;
-            subpassDesc.pColorAttachments    = &ar;
+        void* pMapped = nullptr;
+        result = checkVkResult(vkMapMemory(mDevice, mReadbackRing.mMemory.value(), 0, VK_WHOLE_SIZE, 0, &pMapped));
+        if (Result::eSuccess != result)
+        {
+            destroyReadbackRing();
+            return result;
+        }
 
-            VkSubpassDependency dependency{};
-            dependency.srcSubpass    = VK_SUBPASS_EXTERNAL;
-            dependency.dstSubpass    = 0;
-            dependency.srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dependency.srcAccessMask = 0;
-            dependency.dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(mPhysDev, &props);
 
-            // if use depthBuffer, create attachment
-            if (depthTestEnable)
-            {
-                rpo.depthTarget = swapchain.mHDepthBuffer;
+        mReadbackRing.pMapped     = reinterpret_cast<uint8_t*>(pMapped);
+        mReadbackRing.mSize       = size;
+        mReadbackRing.mIsCoherent = mPhysMemProps.memoryTypes[memoryTypeIndex.value()].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        // each copy is invalidated separately, so it must not share an atom with others
+        mReadbackRing.mAlignment  = std::max<VkDeviceSize>(256, props.limits.nonCoherentAtomSize);
 
-                adVec.emplace_back();
+        return Result::eSuccess;
+    }
 
-                auto& depthBuffer          = mImageMap[swapchain.mHDepthBuffer];
-                adVec.back().format        = depthBuffer.format;
-                adVec.back().samples       = VK_SAMPLE_COUNT_1_BIT;
-                adVec.back().loadOp        = VK_ATTACHMENT_LOAD_OP_CLEAR;
-                adVec.back().storeOp       = VK_ATTACHMENT_STORE_OP_STORE;
-                adVec.back().initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-                adVec.back().finalLayout =
-                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-                depthAr.attachment                  = 1;
-                depthAr.layout                      = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-                subpassDesc.pDepthStencilAttachment = &depthAr;
-            }
-            else
-            {
-                subpassDesc.pDepthStencilAttachment = nullptr;
-            }
+    void Context::destroyReadbackRing()
+    {
+        if (mReadbackRing.pMapped)
+            vkUnmapMemory(mDevice, mReadbackRing.mMemory.value());
+        if (mReadbackRing.mBuffer)
+            vkDestroyBuffer(mDevice, mReadbackRing.mBuffer.value(), nullptr);
+        if (mReadbackRing.mMemory)
+            freeMemory(mReadbackRing.mMemory.value());
+
+        mReadbackRing = ReadbackRing();
+    }
 
-            ci.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-            ci.attachmentCount = static_cast<uint32_t>(adVec.size());
-            ci.pAttachments    = adVec.data();
-            ci.subpassCount    = 1;
-            ci.pSubpasses      = &subpassDesc;
-            ci.dependencyCount = 1;
-            ci.pDependencies   = &dependency;
-            {
-                VkRenderPass renderPass;
-                result =
-                    checkVkResult(vkCreateRenderPass(mDevice, &ci, nullptr, &renderPass));
-                if (Result::eSuccess != result)
-                {
-                    return result;
-                }
+    Result Context::beginReadback(const size_t size, ReadbackObject& ro_out)
+    {
+        Result result = Result::eSuccess;
 
-                rpo.mRenderPass = renderPass;
-            }
+        if (size == 0)
+        {
+            std::cerr << "nothing to read!\n";
+            return Result::eFailure;
         }
 
-        VkFramebufferCreateInfo fbci{};
-        fbci.sType      = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        fbci.renderPass = rpo.mRenderPass.value();
-        fbci.width      = swapchain.mSwapchainExtent.width;
-        fbci.height     = swapchain.mSwapchainExtent.height;
-        fbci.layers     = 1;
+        const auto align = [this](VkDeviceSize s) { return (s + mReadbackRing.mAlignment - 1) / mReadbackRing.mAlignment * mReadbackRing.mAlignment; };
 
-        if (depthTestEnable)
+        // the ring can be resized only while no ticket refers to it
+        if (mReadbackOrder.empty() && mReadbackRing.mSize < align(size))
         {
-            const auto& depth    = mImageMap[swapchain.mHDepthBuffer];
-            fbci.attachmentCount = 2;
-            for (auto& h : swapchain.mHSwapchainImages)
-            {
-                const auto& img                  = mImageMap[h];
-                std::array<VkImageView, 2> ivArr = {img.mView.value(),
-                                                    depth.mView.value()};
-                fbci.pAttachments                = ivArr.data();
+            VkDeviceSize ringSize = readbackRingSize;
+            while (ringSize < align(size) * 2)
+                ringSize *= 2;
 
-                VkFramebuffer framebuffer;
-                result = checkVkResult(
-                    vkCreateFramebuffer(mDevice, &fbci, nullptr, &framebuffer));
-                if (Result::eSuccess != result)
-                {
-                    std::cerr << "failed to create frame buffer!\n";
-                    return result;
-                }
-                rpo.mFramebuffers.emplace_back(framebuffer);
-            }
+            destroyReadbackRing();
+            result = createReadbackRing(ringSize);
+            if (Result::eSuccess != result)
+                return result;
+        }
+
+        const VkDeviceSize allocSize = align(size);
+
+        // free space is after the newest live ticket (and before the oldest one if wrapped)
+        const auto oldestItr = std::find_if(mReadbackOrder.begin(), mReadbackOrder.end(), [this](const HReadback& h) { return mReadbackMap.count(h) > 0; });
+        const auto newestItr = std::find_if(mReadbackOrder.rbegin(), mReadbackOrder.rend(), [this](const HReadback& h) { return mReadbackMap.count(h) > 0; });
+
+        std::optional<VkDeviceSize> offset;
+        if (oldestItr == mReadbackOrder.end())
+        {
+            mReadbackOrder.clear();
+            offset = 0;
         }
         else
         {
-            fbci.attachmentCount = 1;
-            for (auto& h : swapchain.mHSwapchainImages)
-            {
-                fbci.pAttachments = &mImageMap[h].mView.value();
-
-                VkFramebuffer frameBuffer;
-                result = checkVkResult(
-                    vkCreateFramebuffer(mDevice, &fbci, nullptr, &frameBuffer));
-                if (Result::eSuccess != result)
-                {
-                    std::cerr << "failed to create framebuffer!\n";
-                    return result;
-                }
+            const auto& oldest      = mReadbackMap.find(*oldestItr)->second;
+            const auto& newest      = mReadbackMap.find(*newestItr)->second;
+            const VkDeviceSize head = newest.mOffset + newest.mSize;
 
-                rpo.mFramebuffers.emplace_back(frameBuffer);
+            if (newest.mOffset >= oldest.mOffset)
+            {
+                if (head + allocSize <= mReadbackRing.mSize)
+                    offset = head;
+                else if (allocSize <= oldest.mOffset)
+                    offset = 0;
             }
+            else if (head + allocSize <= oldest.mOffset)
+                offset = head;
         }
 
-        createSyncObjects(rpo);
+        if (!offset)
+        {
+            std::cerr << "readback ring is full, release finished tickets!\n";
+            return Result::eFailure;
+        }
 
-        // ImGuiを使用する場合はここで設定を行う
-        if (swapchain.useImGui)
+        ro_out.mOffset        = offset.value();
+        ro_out.mSize          = allocSize;
+        ro_out.mDataSize      = size;
+        ro_out.mIsInvalidated = false;
+
+        if (!mReadbackFencePool.empty())
         {
-            std::cerr << "set up ImGui\n";
-            result = setUpImGui(swapchain, rpo);
+            ro_out.mFence = mReadbackFencePool.back();
+            mReadbackFencePool.pop_back();
+            vkResetFences(mDevice, 1, &ro_out.mFence);
+        }
+        else
+        {
+            VkFenceCreateInfo ci{};
+            ci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            result   = checkVkResult(vkCreateFence(mDevice, &ci, nullptr, &ro_out.mFence));
+            if (Result::eSuccess != result)
+                return result;
+        }
+
+        {
+            VkCommandBufferAllocateInfo ai{};
+            ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            ai.commandBufferCount = 1;
+            ai.commandPool        = mCommandPool;
+            ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            result = checkVkResult(vkAllocateCommandBuffers(mDevice, &ai, &ro_out.mCommand));
             if (Result::eSuccess != result)
             {
+                mReadbackFencePool.emplace_back(ro_out.mFence);
                 return result;
             }
         }
 
-        handle_out = mNextRenderPassHandle++;
-        mRPMap.emplace(handle_out, rpo);
+        VkCommandBufferBeginInfo bi{};
+        bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(ro_out.mCommand, &bi);
 
         return Result::eSuccess;
     }
 
-    Result Context::createRenderPass(const std::vector<HTexture>& colorTargets,
-                                     const HTexture& depthTarget,
-                                     const bool loadPrevFrame,
-                                     HRenderPass& handle_out)
+    Result Context::submitReadback(ReadbackObject& ro, HReadback& ticket_out)
     {
-        if (!mIsInitialized)
+        // host read of the ring after the fence
+        VkMemoryBarrier mb{};
+        mb.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        mb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        mb.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(ro.mCommand, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &mb, 0, nullptr, 0, nullptr);
+
+        vkEndCommandBuffer(ro.mCommand);
+
+        // graphics queue keeps the order with the frames executed before,
+        // and the async compute queue is waited by its latest timeline value
+        const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        VkTimelineSemaphoreSubmitInfo tssi{};
+        tssi.sType                   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        tssi.waitSemaphoreValueCount = 1;
+        tssi.pWaitSemaphoreValues    = &mComputeTimelineValue;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &ro.mCommand;
+        if (mComputeTimelineValue > 0)
         {
-            std::cerr << "context did not initialize yet!\n";
-            return Result::eFailure;
+            submitInfo.pNext              = &tssi;
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores    = &mComputeTimelineSem;
+            submitInfo.pWaitDstStageMask  = &waitStage;
+        }
+        Result result = checkVkResult(vkQueueSubmit(mDeviceQueue, 1, &submitInfo, ro.mFence));
+        if (Result::eSuccess != result)
+        {
+            vkFreeCommandBuffers(mDevice, mCommandPool, 1, &ro.mCommand);
+            mReadbackFencePool.emplace_back(ro.mFence);
+            return result;
         }
 
-        Result result;
-        RenderPassObject rpo;
-        rpo.mFrameBufferIndex = 0;
-        rpo.mDepthTestEnable  = true;
-        rpo.mLoadPrevData     = loadPrevFrame;
+        ticket_out = mNextReadbackHandle++;
+        mReadbackMap.emplace(ticket_out, ro);
+        mReadbackOrder.emplace_back(ticket_out);
 
-        if (mDebugFlag)
-        {  // for debug mode
-            for (auto& tex : colorTargets)
-            {
-                if (mImageMap.count(tex) <= 0)
-                {
-                    std::cerr << "invalid texture handle\n";
-                    return Result::eFailure;
-                }
-                auto& io = mImageMap[tex];
+        return Result::eSuccess;
+    }
 
-                // usage check
-                if (io.usage != TextureUsage::eColorTarget &&
-                    io.usage != TextureUsage::eUnordered)
-                {
-                    std::cerr << "invalid texture usage\n";
-                    return Result::eFailure;
-                }
+    Result Context::uploadImage(ImageObject& io, const void* const pData, const size_t size,
+                                const std::vector<VkBufferImageCopy>& regions,
+                                const bool generateMips, const uint32_t baseLayer,
+                                const uint32_t layerCount)
+    {
+        Result result = Result::eFailure;
 
-                // extent substitute and check
-                if (!rpo.mExtent)
-                    rpo.mExtent = io.extent;
-                if (rpo.mExtent.value().width != io.extent.width ||
-                    rpo.mExtent.value().height != io.extent.height ||
-                    rpo.mExtent.value().depth != io.extent.depth)
-                {
-                    std::cerr << "invalid color texture extent\n";
-                    return Result::eFailure;
-                }
-            }
+        BufferObject stagingBo;
+        result = createStagingBuffer(size, pData, stagingBo);
+        if (Result::eSuccess != result)
+            return result;
 
-            if (mImageMap.count(depthTarget) <= 0)
+        VkCommandBuffer command;
+        result = beginUploadCommand(mTransferCommandPool, command);
+        if (Result::eSuccess != result)
+        {
+            freeMemory(stagingBo.mMemory.value());
+            vkDestroyBuffer(mDevice, stagingBo.mBuffer.value(), nullptr);
+            return result;
+        }
+
+        std::optional<VkCommandBuffer> acquireCommand;
+        result = recordImageUpload(command, acquireCommand, io, stagingBo.mBuffer.value(), regions, generateMips, baseLayer, layerCount);
+
+        if (Result::eSuccess == result)
+            result = submitUploadCommand(command, acquireCommand, size);
+        else
+        {
+            vkEndCommandBuffer(command);
+            vkFreeCommandBuffers(mDevice, mTransferCommandPool, 1, &command);
+            if (acquireCommand)
             {
-                std::cerr << "invalid texture handle\n";
-                return Result::eFailure;
+                vkEndCommandBuffer(acquireCommand.value());
+                vkFreeCommandBuffers(mDevice, mCommandPool, 1, &acquireCommand.value());
             }
+        }
 
-            auto& io = mImageMap[depthTarget];
-            if (io.usage != TextureUsage::eDepthStencilTarget)
+        // release staging buffer
+        freeMemory(stagingBo.mMemory.value());
+        vkDestroyBuffer(mDevice, stagingBo.mBuffer.value(), nullptr);
+
+        if (Result::eSuccess != result)
+            return result;
+
+        io.currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        return Result::eSuccess;
+    }
+
+    Result Context::recordImageUpload(VkCommandBuffer command,
+                                      std::optional<VkCommandBuffer>& acquireCommand,
+                                      const ImageObject& io, VkBuffer stagingBuffer,
+                                      const std::vector<VkBufferImageCopy>& regions,
+                                      const bool generateMips, const uint32_t baseLayer,
+                                      const uint32_t layerCount)
+    {
+        Result result = Result::eSuccess;
+
+        setImageMemoryBarrier(command, io.mImage.value(), VK_IMAGE_LAYOUT_UNDEFINED,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT,
+                              baseLayer, layerCount);
+        vkCmdCopyBufferToImage(command, stagingBuffer, io.mImage.value(),
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(regions.size()), regions.data());
+
+        // blit for mipmap generation needs graphics queue
+        if (mTransferQueueIndex == mGraphicsQueueIndex)
+        {
+            if (generateMips)
+                result = generateMipmaps(command, io, baseLayer, layerCount);
+            else
+                result = setImageMemoryBarrier(command, io.mImage.value(),
+                                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                               VK_IMAGE_ASPECT_COLOR_BIT, baseLayer, layerCount);
+        }
+        // concurrent images need no ownership transfer, but the layout is changed
+        // (and mipmaps are generated) on graphics queue after the copy
+        else if (io.mConcurrentSharing)
+        {
+            if (!acquireCommand)
             {
-                std::cerr << "invalid texture usage!\n";
-                return Result::eFailure;
+                VkCommandBuffer acquire;
+                result = beginUploadCommand(mCommandPool, acquire);
+                if (Result::eSuccess != result)
+                    return result;
+                acquireCommand = acquire;
             }
 
-            // extent substitute and check
-            if (!rpo.mExtent)
-                rpo.mExtent = io.extent;
-            if (rpo.mExtent.value().width != io.extent.width ||
-                rpo.mExtent.value().height != io.extent.height ||
-                rpo.mExtent.value().depth != io.extent.depth)
-            {
-                std::cerr << "invalid depth texture extent\n";
-                std::cerr << rpo.mExtent.value().width << " : "
-                          << rpo.mExtent.value().height << " : "
-                          << rpo.mExtent.value().depth << "\n";
-                std::cerr << io.extent.width << " : " << io.extent.height << " : "
-                          << io.extent.depth << "\n";
-                return Result::eFailure;
+            if (generateMips)
+                result = generateMipmaps(acquireCommand.value(), io, baseLayer, layerCount);
+            else
+                result = setImageMemoryBarrier(acquireCommand.value(), io.mImage.value(),
+                                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                               VK_IMAGE_ASPECT_COLOR_BIT, baseLayer, layerCount);
+        }
+        else
+        {
+            // queue family ownership transfer, layout is changed at the same time
+            // (kept as transfer destination if mipmaps are generated on graphics queue)
+            VkImageMemoryBarrier imb{};
+            imb.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            imb.oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            imb.newLayout           = generateMips ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imb.srcQueueFamilyIndex = mTransferQueueIndex;
+            imb.dstQueueFamilyIndex = mGraphicsQueueIndex;
+            imb.subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, io.mMipLevels, baseLayer, layerCount};
+            imb.image               = io.mImage.value();
+
+            // release (transfer queue)
+            imb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            imb.dstAccessMask = 0;
+            vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0,
+                                 nullptr, 1, &imb);
+
+            // acquire (graphics queue), a batch of uploads shares one command
+            if (!acquireCommand)
+            {
+                VkCommandBuffer acquire;
+                result = beginUploadCommand(mCommandPool, acquire);
+                if (Result::eSuccess != result)
+                    return result;
+                acquireCommand = acquire;
             }
+            imb.srcAccessMask = 0;
+            imb.dstAccessMask = generateMips ? VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(acquireCommand.value(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                 generateMips ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &imb);
+            if (generateMips)
+                result = generateMipmaps(acquireCommand.value(), io, baseLayer, layerCount);
         }
 
-        rpo.mHWindow     = std::nullopt;
-        rpo.colorTargets = colorTargets;
-        rpo.depthTarget  = depthTarget;
-        VkRenderPassCreateInfo ci{};
-        ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        std::vector<VkAttachmentDescription> adVec;
-        std::vector<VkAttachmentReference> arVec;
+        return result;
+    }
 
-        // Renderpass, Framebuffer
+    Result Context::allocateTransientTextures(RenderGraph& graph)
+    {
+        if (!mIsInitialized)
         {
-            auto&& size = colorTargets.size();
-            for (size_t i = 0; i < size; ++i)
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        Result result = Result::eSuccess;
+
+        // sizes are reported for the latest allocation only
+        mTransientRequestedSize = 0;
+        mTransientAllocatedSize = 0;
+
+        std::unordered_map<HTexture, std::pair<uint32_t, uint32_t>> lifetimes;
+        result = graph.getTextureLifetimes(lifetimes);
+        if (Result::eSuccess != result)
+            return result;
+
+        // memory type that is committed only when it is actually used (mainly tile based GPU)
+        std::optional<uint32_t> lazyMemoryTypeIndex;
+        for (uint32_t i = 0; i < mPhysMemProps.memoryTypeCount; ++i)
+            if (mPhysMemProps.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
             {
-                auto& io  = mImageMap[colorTargets[i]];
-                auto&& ad = adVec.emplace_back(VkAttachmentDescription{});
-                auto&& ar = arVec.emplace_back(VkAttachmentReference{});
+                lazyMemoryTypeIndex = i;
+                break;
+            }
 
-                if (!rpo.mExtent)
-                    rpo.mExtent = io.extent;
+        struct Target
+        {
+            HTexture handle;
+            VkMemoryRequirements reqs;
+            std::pair<uint32_t, uint32_t> lifetime;
+        };
 
-                if (loadPrevFrame)
-                {
-                    ad.loadOp  = VK_ATTACHMENT_LOAD_OP_LOAD;
-                    ad.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        std::vector<Target> targets;
+        std::vector<HTexture> bound;
+        for (auto& [handle, io] : mImageMap)
+        {
+            if (!io.mIsTransient || io.mMemory || io.mView)
+                continue;
 
-                    switch (io.currentLayout)
-                    {
-                        case VK_IMAGE_LAYOUT_UNDEFINED:
-                        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-                            ad.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-                            break;
-                        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-                            ad.initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                            break;
-                        default:
-                            std::cerr << "invalid initial image layout!\n";
-                            return Result::eFailure;
-                            break;
-                    }
-                }
-                else
+            Target target;
+            target.handle = handle;
+            vkGetImageMemoryRequirements(mDevice, io.mImage.value(), &target.reqs);
+            mTransientRequestedSize += target.reqs.size;
+
+            // unused textures in the graph live through the whole graph
+            if (lifetimes.count(handle) > 0)
+                target.lifetime = lifetimes[handle];
+            else
+                target.lifetime = {0, UINT32_MAX};
+
+            // never sampled target does not need any physical memory if possible
+            if (!io.mIsSampled && lazyMemoryTypeIndex &&
+                (target.reqs.memoryTypeBits & (1u << lazyMemoryTypeIndex.value())))
+            {
+                VkMemoryAllocateInfo ai{};
+                ai.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+                ai.allocationSize  = target.reqs.size;
+                ai.memoryTypeIndex = lazyMemoryTypeIndex.value();
+
+                VkDeviceMemory memory;
+                result = checkVkResult(allocateMemory(ai, memory));
+                if (Result::eSuccess != result)
                 {
-                    ad.loadOp        = VK_ATTACHMENT_LOAD_OP_CLEAR;
-                    ad.storeOp       = VK_ATTACHMENT_STORE_OP_STORE;
-                    ad.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                    std::cerr << "failed to allocate lazily allocated memory!\n";
+                    return result;
                 }
 
-                ad.format      = io.format;
-                ad.samples     = VK_SAMPLE_COUNT_1_BIT;
-                ad.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-                ar.attachment  = i;
-                ar.layout      = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                vkBindImageMemory(mDevice, io.mImage.value(), memory, 0);
+                io.mMemory = memory;
+                mTransientAllocatedSize += target.reqs.size;
+                bound.emplace_back(handle);
+                continue;
             }
-        }
 
-        VkSubpassDescription subpassDesc{};
-        subpassDesc.pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        subpassDesc.colorAttachmentCount = static_cast<uint32_t>(arVec.size());
-        subpassDesc.pColorAttachments    = arVec.data();
+            targets.emplace_back(target);
+        }
 
-        VkAttachmentReference depthAr;
-        auto&& depthAd    = adVec.emplace_back();
-        auto& depthBuffer = mImageMap[depthTarget];
+        // greedy assignment from larger texture
+        // each block is shared by textures whose lifetimes do not overlap
+        std::sort(targets.begin(), targets.end(),
+                  [](const Target& l, const Target& r) { return l.reqs.size > r.reqs.size; });
 
-        if (loadPrevFrame)
-        {
-            depthAd.loadOp        = VK_ATTACHMENT_LOAD_OP_LOAD;
-            depthAd.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        }
-        else
+        struct Block
         {
-            depthAd.loadOp        = VK_ATTACHMENT_LOAD_OP_CLEAR;
-            depthAd.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        }
+            VkDeviceSize size;
+            VkDeviceSize alignment;
+            uint32_t memoryTypeBits;
+            std::vector<const Target*> targets;
+        };
 
-        depthAd.format      = depthBuffer.format;
-        depthAd.samples     = VK_SAMPLE_COUNT_1_BIT;
-        depthAd.storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
-        depthAd.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        depthAr.attachment  = colorTargets.size();  // attach to last index
-        depthAr.layout      = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        std::vector<Block> blocks;
+        for (const auto& target : targets)
+        {
+            bool assigned = false;
+            for (auto& block : blocks)
+            {
+                if (!(block.memoryTypeBits & target.reqs.memoryTypeBits))
+                    continue;
 
-        subpassDesc.pDepthStencilAttachment = &depthAr;
+                const bool overlapped = std::any_of(
+                    block.targets.begin(), block.targets.end(),
+                    [&target](const Target* other)
+                    {
+                        return !(target.lifetime.second < other->lifetime.first ||
+                                 other->lifetime.second < target.lifetime.first);
+                    });
+                if (overlapped)
+                    continue;
+
+                block.size = std::max(block.size, target.reqs.size);
+                block.alignment = std::max(block.alignment, target.reqs.alignment);
+                block.memoryTypeBits &= target.reqs.memoryTypeBits;
+                block.targets.emplace_back(&target);
+                assigned = true;
+                break;
+            }
 
-        ci.attachmentCount = static_cast<uint32_t>(adVec.size());
-        ci.pAttachments    = adVec.data();
-        ci.subpassCount    = 1;
-        ci.pSubpasses      = &subpassDesc;
+            if (!assigned)
+                blocks.emplace_back(Block{target.reqs.size, target.reqs.alignment, target.reqs.memoryTypeBits, {&target}});
+        }
 
+        for (uint32_t blockIndex = 0; blockIndex < blocks.size(); ++blockIndex)
         {
-            VkRenderPass renderPass;
-            result =
-                checkVkResult(vkCreateRenderPass(mDevice, &ci, nullptr, &renderPass));
+            const auto& block = blocks[blockIndex];
+
+            VkMemoryAllocateInfo ai{};
+            ai.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            ai.allocationSize  = block.size;
+            ai.memoryTypeIndex = getMemoryTypeIndex(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            VkDeviceMemory memory;
+            result = checkVkResult(allocateMemory(ai, memory));
             if (Result::eSuccess != result)
             {
+                std::cerr << "failed to allocate transient memory!\n";
                 return result;
             }
+            mTransientAllocatedSize += block.size;
 
-            rpo.mRenderPass = renderPass;
-        }
-
-        std::vector<VkImageView> ivVec;
-        ivVec.reserve(colorTargets.size());
-        {
-            for (auto& tex : colorTargets)
-                ivVec.emplace_back(mImageMap[tex].mView.value());
+            auto& transientBlock   = mTransientBlocks.emplace_back();
+            transientBlock.mMemory = memory;
+            for (const auto& target : block.targets)
+            {
+                auto& io = mImageMap[target->handle];
+                vkBindImageMemory(mDevice, io.mImage.value(), memory, 0);
+                bound.emplace_back(target->handle);
+                transientBlock.mTextures.emplace_back(target->handle);
 
-            // depth buffer
-            ivVec.emplace_back(depthBuffer.mView.value());
+                // contents are not kept out of its lifetime
+                if (block.targets.size() > 1)
+                    graph.markAliased(target->handle, blockIndex);
+            }
         }
 
-        VkFramebufferCreateInfo fbci{};
-        fbci.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        fbci.renderPass      = rpo.mRenderPass.value();
-        fbci.width           = rpo.mExtent.value().width;
-        fbci.height          = rpo.mExtent.value().height;
-        fbci.layers          = 1;
-        fbci.attachmentCount = rpo.mTargetNum = static_cast<uint32_t>(ivVec.size());
-        fbci.pAttachments                     = ivVec.data();
+        if (bound.empty())
+            return Result::eSuccess;
 
+        // view (sampler is taken from the cache in createTexture)
+        for (const auto& handle : bound)
         {
-            VkFramebuffer frameBuffer;
-            result = checkVkResult(
-                vkCreateFramebuffer(mDevice, &fbci, nullptr, &frameBuffer));
-            if (Result::eSuccess != result)
+            auto& io = mImageMap[handle];
+
+            VkImageViewCreateInfo ci{};
+            ci.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            ci.viewType         = VK_IMAGE_VIEW_TYPE_2D;
+            ci.image            = io.mImage.value();
+            ci.format           = io.format;
+            ci.components       = {
+                VK_COMPONENT_SWIZZLE_R,
+                VK_COMPONENT_SWIZZLE_G,
+                VK_COMPONENT_SWIZZLE_B,
+                VK_COMPONENT_SWIZZLE_A,
+            };
+            ci.subresourceRange = io.range;
+
+            VkImageView imageView;
+            result = checkVkResult(vkCreateImageView(mDevice, &ci, nullptr, &imageView));
+            if (result != Result::eSuccess)
             {
+                std::cerr << "failed to create vkImageView!\n";
                 return result;
             }
-            rpo.mFramebuffers.emplace_back(frameBuffer);
+            io.mView = imageView;
         }
 
-        createSyncObjects(rpo);
+        // set image layout
+        {
+            VkCommandBuffer command;
+            {
+                VkCommandBufferAllocateInfo ai{};
+                ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                ai.commandBufferCount = 1;
+                ai.commandPool        = mCommandPool;
+                ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                vkAllocateCommandBuffers(mDevice, &ai, &command);
+            }
 
-        handle_out = mNextRenderPassHandle++;
-        mRPMap.emplace(handle_out, rpo);
+            VkCommandBufferBeginInfo commandBI{};
+            commandBI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            vkBeginCommandBuffer(command, &commandBI);
+
+            for (const auto& handle : bound)
+            {
+                auto& io = mImageMap[handle];
+                setImageMemoryBarrier(command, io.mImage.value(), VK_IMAGE_LAYOUT_UNDEFINED,
+                                      io.currentLayout, io.range.aspectMask);
+            }
+            vkEndCommandBuffer(command);
+
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers    = &command;
+            vkQueueSubmit(mDeviceQueue, 1, &submitInfo, VK_NULL_HANDLE);
+
+            vkQueueWaitIdle(mDeviceQueue);
+            vkFreeCommandBuffers(mDevice, mCommandPool, 1, &command);
+        }
+
+        if (mDebugFlag)
+            std::cerr << "allocated transient textures(requested : " << mTransientRequestedSize
+                      << " byte, allocated : " << mTransientAllocatedSize << " byte)\n";
 
         return Result::eSuccess;
     }
 
-    Result Context::createRenderPass(const std::vector<HTexture>& colorTargets,
-                                     const bool loadPrevFrame,
-                                     HRenderPass& handle_out)
+    Result Context::getTransientMemorySize(size_t& requested_out, size_t& allocated_out) const
     {
         if (!mIsInitialized)
         {
@@ -2818,261 +4435,207 @@ namespace Cutlass
             return Result::eFailure;
         }
 
-        Result result;
-        RenderPassObject rpo;
-        rpo.mFrameBufferIndex = 0;
-        rpo.mDepthTestEnable  = false;
-        rpo.mLoadPrevData     = loadPrevFrame;
+        requested_out = mTransientRequestedSize;
+        allocated_out = mTransientAllocatedSize;
 
-        if (mDebugFlag)
-        {
-            for (auto& tex : colorTargets)
-            {
-                if (mImageMap.count(tex) <= 0)
-                {
-                    std::cerr << "invalid texture handle!\n";
-                    return Result::eFailure;
-                }
+        return Result::eSuccess;
+    }
 
-                auto& io = mImageMap[tex];
+    Result Context::getUploadStats(UploadStats& stats_out) const
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
 
-                // usage check
-                if (io.usage != TextureUsage::eColorTarget &&
-                    io.usage != TextureUsage::eUnordered)
-                {
-                    std::cerr << "invalid texture usage!\n";
-                    return Result::eFailure;
-                }
+        stats_out = mUploadStats;
 
-                // extent substitute and check
-                if (!rpo.mExtent)
-                {
-                    rpo.mExtent = io.extent;
+        return Result::eSuccess;
+    }
 
-                    if (rpo.mExtent.value().width != io.extent.width ||
-                        rpo.mExtent.value().height != io.extent.height ||
-                        rpo.mExtent.value().depth != io.extent.depth)
-                    {
-                        std::cerr << "invalid texture extent!\n";
-                        return Result::eFailure;
-                    }
-                }
-            }
+    Result Context::resetUploadStats()
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
         }
 
-        rpo.mHWindow     = std::nullopt;
-        rpo.colorTargets = colorTargets;
+        const bool dedicated = mUploadStats.dedicatedTransferQueue;
+        mUploadStats                        = UploadStats();
+        mUploadStats.dedicatedTransferQueue = dedicated;
 
-        VkRenderPassCreateInfo ci{};
-        ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        std::vector<VkAttachmentDescription> adVec;
-        std::vector<VkAttachmentReference> arVec;
-        std::optional<HTexture> hDepthBuffer = std::nullopt;
+        return Result::eSuccess;
+    }
 
-        // Renderpass, Framebuffer
+    Result Context::enableGPUProfiler(const bool enable)
+    {
+        if (!mIsInitialized)
         {
-            const auto&& size = colorTargets.size();
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
 
-            adVec.reserve(size);
-            arVec.reserve(size);
-            for (size_t i = 0; i < size; ++i)
-            {
-                const auto& io = mImageMap[colorTargets[i]];
-                auto&& ad      = adVec.emplace_back();
-                auto&& ar      = arVec.emplace_back();
+        if (enable && mGraphicsTimestampValidBits == 0)
+        {
+            std::cerr << "graphics queue does not support timestamp queries!\n";
+            return Result::eFailure;
+        }
 
-                if (!rpo.mExtent)
-                    rpo.mExtent = io.extent;
+        mGPUProfilerEnabled = enable;
 
-                ad.format  = io.format;
-                ad.samples = VK_SAMPLE_COUNT_1_BIT;
+        return Result::eSuccess;
+    }
 
-                if (loadPrevFrame)
-                {
-                    ad.loadOp  = VK_ATTACHMENT_LOAD_OP_LOAD;
-                    ad.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    Result Context::getGPUTimings(const HCommandBuffer& handle, std::vector<GPUTiming>& timings_out)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
 
-                    switch (io.currentLayout)
-                    {
-                        case VK_IMAGE_LAYOUT_UNDEFINED:
-                        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-                            ad.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-                            break;
-                        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-                            ad.initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                            break;
-                        default:
-                            std::cerr << "invalid initial image layout!\n";
-                            return Result::eFailure;
-                            break;
-                    }
-                }
-                else
-                {
-                    ad.loadOp        = VK_ATTACHMENT_LOAD_OP_CLEAR;
-                    ad.storeOp       = VK_ATTACHMENT_STORE_OP_STORE;
-                    ad.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-                }
+        if (mCommandBufferMap.count(handle) <= 0)
+        {
+            std::cerr << "invalid command buffer handle!\n";
+            return Result::eFailure;
+        }
 
-                ad.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-                ar.attachment  = i;
-                ar.layout      = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-            }
+        auto& co = mCommandBufferMap[handle];
+        for (size_t i = 0; i < co.mProfilerQueries.size(); ++i)
+        {
+            const Result result = resolveProfilerQueries(co, i);
+            if (result != Result::eSuccess)
+                return result;
         }
 
-        VkSubpassDescription subpassDesc{};
-        subpassDesc.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        subpassDesc.colorAttachmentCount    = static_cast<uint32_t>(arVec.size());
-        subpassDesc.pColorAttachments       = arVec.data();
-        subpassDesc.pDepthStencilAttachment = NULL;
+        timings_out = co.mGPUTimings;
 
-        rpo.mHWindow     = std::nullopt;
-        rpo.colorTargets = colorTargets;
+        return Result::eSuccess;
+    }
 
-        std::array<VkSubpassDependency, 2> dependencies;
+    Result Context::enablePipelineStatistics(const bool enable)
+    {
+        if (!mIsInitialized)
         {
-            dependencies[0].srcSubpass   = VK_SUBPASS_EXTERNAL;
-            dependencies[0].dstSubpass   = 0;
-            dependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-            dependencies[0].dstStageMask =
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-            dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
-                                            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
 
-            dependencies[1].srcSubpass = 0;
-            dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-            dependencies[1].srcStageMask =
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dependencies[1].dstStageMask  = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-            dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
-                                            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            dependencies[1].dstAccessMask   = VK_ACCESS_MEMORY_READ_BIT;
-            dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+        if (enable && !mPipelineStatisticsSupported)
+        {
+            std::cerr << "this device does not support pipeline statistics queries!\n";
+            return Result::eFailure;
         }
 
-        ci.attachmentCount = static_cast<uint32_t>(adVec.size());
-        ci.pAttachments    = adVec.data();
-        ci.dependencyCount = 2;
-        ci.pDependencies   = dependencies.data();
-        ci.subpassCount    = 1;
-        ci.pSubpasses      = &subpassDesc;
+        mPipelineStatisticsEnabled = enable;
 
+        return Result::eSuccess;
+    }
+
+    Result Context::getPipelineStatistics(const HCommandBuffer& handle, std::vector<PipelineStatistics>& statistics_out)
+    {
+        if (!mIsInitialized)
         {
-            VkRenderPass renderPass;
-            result =
-                checkVkResult(vkCreateRenderPass(mDevice, &ci, nullptr, &renderPass));
-            if (Result::eSuccess != result)
-            {
-                return result;
-            }
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
 
-            rpo.mRenderPass = renderPass;
+        if (mCommandBufferMap.count(handle) <= 0)
+        {
+            std::cerr << "invalid command buffer handle!\n";
+            return Result::eFailure;
         }
 
-        std::vector<VkImageView> ivVec;
+        auto& co = mCommandBufferMap[handle];
+        for (size_t i = 0; i < co.mProfilerQueries.size(); ++i)
         {
-            ivVec.reserve(colorTargets.size());
-            for (const auto& tex : colorTargets)
-                ivVec.emplace_back(mImageMap[tex].mView.value());
+            const Result result = resolveProfilerQueries(co, i);
+            if (result != Result::eSuccess)
+                return result;
         }
 
-        VkFramebufferCreateInfo fbci{};
-        fbci.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        fbci.renderPass      = rpo.mRenderPass.value();
-        fbci.width           = rpo.mExtent.value().width;
-        fbci.height          = rpo.mExtent.value().height;
-        fbci.layers          = 1;
-        fbci.attachmentCount = rpo.mTargetNum = static_cast<uint32_t>(ivVec.size());
-        fbci.pAttachments                     = ivVec.data();
+        statistics_out = co.mPipelineStatistics;
+
+        return Result::eSuccess;
+    }
 
+    Result Context::enableTrace(const bool enable)
+    {
+        if (!mIsInitialized)
         {
-            VkFramebuffer frameBuffer;
-            result = checkVkResult(
-                vkCreateFramebuffer(mDevice, &fbci, nullptr, &frameBuffer));
-            if (Result::eSuccess != result)
-            {
-                std::cerr << "Failed to create frame buffer!\n";
-                return result;
-            }
-            rpo.mFramebuffers.emplace_back(frameBuffer);
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
         }
 
-        createSyncObjects(rpo);
+        // GPU scopes are traced only if timestamps are supported
+        if (enable && mGraphicsTimestampValidBits > 0)
+            mGPUProfilerEnabled = true;
 
-        handle_out = mNextRenderPassHandle++;
-        mRPMap.emplace(handle_out, rpo);
+        mTracer.setEnabled(enable);
 
         return Result::eSuccess;
     }
 
-    Result Context::createSyncObjects(RenderPassObject& rpo)
+    Result Context::writeTrace(std::string_view path)
     {
-        Result result = Result::eSuccess;
-
-        uint32_t maxFramesInFlight = rpo.mTargetNum;
-        uint32_t maxFrameNum       = rpo.mTargetNum;
-        if (rpo.mHWindow)
+        if (!mIsInitialized)
         {
-            auto& wo          = mWindowMap[rpo.mHWindow.value()];
-            maxFramesInFlight = wo.mMaxFrameInFlight;
-            maxFrameNum       = wo.mMaxFrameNum;
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
         }
 
-        rpo.mFences.resize(maxFramesInFlight);
-        {
-            VkFenceCreateInfo ci{};
-            ci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-            ci.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-            for (size_t i = 0; i < rpo.mFences.size(); ++i)
+        // GPU scopes which have already finished are collected
+        for (auto& [handle, co] : mCommandBufferMap)
+            for (size_t i = 0; i < co.mProfilerQueries.size(); ++i)
             {
-                result =
-                    checkVkResult(vkCreateFence(mDevice, &ci, nullptr, &rpo.mFences[i]));
-                if (Result::eSuccess != result)
-                {
-                    std::cerr << "Failed to create fence!\n";
+                const Result result = resolveProfilerQueries(co, i);
+                if (result != Result::eSuccess)
                     return result;
-                }
             }
+
+        return mTracer.write(path);
+    }
+
+    Result Context::getFrameStats(FrameStats& stats_out) const
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
         }
 
-        rpo.mPresentCompletedSems.resize(maxFramesInFlight);
-        rpo.mRenderCompletedSems.resize(maxFramesInFlight);
+        stats_out = mLastFrameStats;
 
+        return Result::eSuccess;
+    }
+
+    Result Context::markFrameEnd()
+    {
+        if (!mIsInitialized)
         {
-            VkSemaphoreCreateInfo ci{};
-            ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-            for (size_t i = 0; i < maxFramesInFlight; ++i)
-            {
-                result = checkVkResult(vkCreateSemaphore(mDevice, &ci, nullptr,
-                                                         &rpo.mRenderCompletedSems[i]));
-                if (Result::eSuccess != result)
-                {
-                    std::cerr << "Failed to create render completed semaphore!\n";
-                    return result;
-                }
-            }
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
 
-            for (size_t i = 0; i < maxFramesInFlight; ++i)
-            {
-                result = checkVkResult(vkCreateSemaphore(mDevice, &ci, nullptr,
-                                                         &rpo.mPresentCompletedSems[i]));
-                if (Result::eSuccess != result)
-                {
-                    std::cerr << "Failed to create present completed semaphore!\n";
-                    return result;
-                }
-            }
+        mLastFrameStats = mFrameStats;
+        mFrameStats     = FrameStats();
+
+        const uint64_t now = Tracer::now();
+        if (mLastFrameEndNs != 0)
+        {
+            mFrameTimes[mFrameTimeIndex] = static_cast<float>((now - mLastFrameEndNs) / 1e6);
+            mFrameTimeIndex              = (mFrameTimeIndex + 1) % mFrameTimes.size();
         }
+        mLastFrameEndNs = now;
 
-        rpo.imagesInFlight.resize(maxFrameNum, VK_NULL_HANDLE);
+        updateMemoryBudget();
 
-        return result;
+        return Result::eSuccess;
     }
 
-    Result Context::createGraphicsPipeline(const GraphicsPipelineInfo& info,
-                                           HGraphicsPipeline& handle_out)
+    Result Context::getMemoryBudget(MemoryBudgetReport& report_out)
     {
         if (!mIsInitialized)
         {
@@ -3080,288 +4643,2723 @@ namespace Cutlass
             return Result::eFailure;
         }
 
-        Result result;
-        GraphicsPipelineObject gpo;
+        updateMemoryBudget();
 
-        RenderPassObject& rpo = mRPMap[info.renderPass];
-        gpo.mHRenderPass      = info.renderPass;
-        gpo.mVS               = info.VS;
-        gpo.mFS               = info.FS;
+        report_out.budgetSupported   = mMemoryBudgetSupported;
+        report_out.hostFallbackCount = mHostFallbackCount;
 
+        report_out.heaps.clear();
+        for (uint32_t i = 0; i < mPhysMemProps.memoryHeapCount; ++i)
         {
-            VkVertexInputBindingDescription ib;
+            const auto& heap = mPhysMemProps.memoryHeaps[i];
+            report_out.heaps.emplace_back(MemoryHeapBudget{i, (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0, heap.size, mHeapBudgets[i], mHeapProcessUsages[i], mHeapUsages[i]});
+        }
 
-            std::vector<VkVertexInputAttributeDescription> ia_vec;
+        report_out.types.clear();
+        for (uint32_t i = 0; i < mPhysMemProps.memoryTypeCount; ++i)
+        {
+            const auto& type = mPhysMemProps.memoryTypes[i];
+            report_out.types.emplace_back(MemoryTypeUsage{i, type.heapIndex, type.propertyFlags, mTypeUsages[i], mTypeAllocationCounts[i]});
+        }
 
-            VkPipelineVertexInputStateCreateInfo visci{};
-            const auto& inputVariables = info.VS.getInputVariables();
-            if (!inputVariables.empty())
+        return Result::eSuccess;
+    }
+
+    Result Context::drawPerformanceOverlay(bool* pOpen)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        if (!ImGui::GetCurrentContext())
+        {
+            std::cerr << "ImGui is not used by any window!\n";
+            return Result::eFailure;
+        }
+
+        if (!ImGui::Begin("Performance", pOpen, ImGuiWindowFlags_AlwaysAutoResize))
+        {
+            ImGui::End();
+            return Result::eSuccess;
+        }
+
+        {  // frame time
+            // ring buffer is drawn from the oldest one
+            decltype(mFrameTimes) frameTimes;
+            float sum = 0, peak = 0;
+            uint32_t count = 0;
+            for (size_t i = 0; i < frameTimes.size(); ++i)
             {
+                frameTimes[i] = mFrameTimes[(mFrameTimeIndex + i) % mFrameTimes.size()];
+                if (frameTimes[i] > 0)
                 {
-                    ib.binding   = 0;
-                    ib.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+                    sum += frameTimes[i];
+                    peak = std::max(peak, frameTimes[i]);
+                    ++count;
                 }
+            }
 
-                {
-                    // if (inputVariables.size() == 0)
-                    // {
-                    //     std::cerr << "invalid vertex layout size!\n";
-                    //     return Result::eFailure;
-                    // }
-
-                    uint32_t offset = 0;
-                    for (size_t i = 0; i < inputVariables.size(); ++i)
-                    {
-                        ia_vec.emplace_back();
-                        ia_vec.back().binding  = 0;
-                        ia_vec.back().location = static_cast<uint32_t>(i);
-                        ia_vec.back().offset   = offset;
+            const float last    = frameTimes.back();
+            const float average = count > 0 ? sum / count : 0;
+            ImGui::Text("frame : %.2f ms (avg %.2f ms, max %.2f ms, %.1f fps)", last, average, peak, average > 0 ? 1000.f / average : 0.f);
+            ImGui::PlotLines("##frame time", frameTimes.data(), static_cast<int>(frameTimes.size()), 0, nullptr, 0.f, std::max(peak, 1000.f / 60.f) * 1.2f, ImVec2(360, 60));
+        }
 
-                        switch (inputVariables[i].first)
-                        {
-                            case ResourceType::eUnorm:
-                                ia_vec.back().format = VK_FORMAT_R8_UNORM;
-                                offset += 1;
-                                break;
-                            case ResourceType::eFloat32:
-                                ia_vec.back().format = VK_FORMAT_R32_SFLOAT;
-                                offset += 4;
-                                break;
-                            case ResourceType::eUint32:
-                                ia_vec.back().format = VK_FORMAT_R32_UINT;
-                                offset += 4;
-                                break;
-                            case ResourceType::eInt32:
-                                ia_vec.back().format = VK_FORMAT_R32_SINT;
-                                offset += 4;
-                                break;
+        if (ImGui::CollapsingHeader("Frame stats", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            const auto& fs = mLastFrameStats;
+            ImGui::Text("draw : %llu, dispatch : %llu, submit : %llu", static_cast<unsigned long long>(fs.drawCount), static_cast<unsigned long long>(fs.dispatchCount), static_cast<unsigned long long>(fs.submitCount));
+            ImGui::Text("bind pipeline : %llu, buffer : %llu, descriptor set : %llu", static_cast<unsigned long long>(fs.pipelineBindCount), static_cast<unsigned long long>(fs.bufferBindCount), static_cast<unsigned long long>(fs.descriptorSetBindCount));
+            ImGui::Text("barrier : %llu, descriptor set alloc : %llu", static_cast<unsigned long long>(fs.barrierCount), static_cast<unsigned long long>(fs.descriptorSetAllocCount));
+            ImGui::Text("uploaded : %.2f KiB", fs.uploadedBytes / 1024.);
+        }
 
-                            case ResourceType::eUNormVec2:
-                                ia_vec.back().format = VK_FORMAT_R8G8_UNORM;
-                                offset += 2;
-                                break;
-                            case ResourceType::eF32Vec2:
-                                ia_vec.back().format = VK_FORMAT_R32G32_SFLOAT;
-                                offset += 8;
-                                break;
-                            case ResourceType::eU32Vec2:
-                                ia_vec.back().format = VK_FORMAT_R32G32_UINT;
-                                offset += 8;
-                                break;
-                            case ResourceType::eS32Vec2:
-                                ia_vec.back().format = VK_FORMAT_R32G32_SINT;
-                                offset += 8;
-                                break;
+        if (ImGui::CollapsingHeader("GPU timings", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            if (!mGPUProfilerEnabled)
+                ImGui::TextDisabled("GPU profiler is disabled");
 
-                            case ResourceType::eUNormVec3:
-                                ia_vec.back().format = VK_FORMAT_R8G8B8_UNORM;
-                                offset += 3;
-                                break;
-                            case ResourceType::eF32Vec3:
-                                ia_vec.back().format = VK_FORMAT_R32G32B32_SFLOAT;
-                                offset += 12;
-                                break;
-                            case ResourceType::eU32Vec3:
-                                ia_vec.back().format = VK_FORMAT_R32G32B32_UINT;
-                                offset += 12;
-                                break;
-                            case ResourceType::eS32Vec3:
-                                ia_vec.back().format = VK_FORMAT_R32G32B32_SINT;
-                                offset += 12;
-                                break;
+            for (auto& [handle, co] : mCommandBufferMap)
+            {
+                // pick up results which have finished since the last frame
+                for (size_t i = 0; i < co.mProfilerQueries.size(); ++i)
+                    resolveProfilerQueries(co, i);
 
-                            case ResourceType::eUNormVec4:
-                                ia_vec.back().format = VK_FORMAT_R8G8B8A8_UNORM;
-                                offset += 4;
-                                break;
-                            case ResourceType::eF32Vec4:
-                                ia_vec.back().format = VK_FORMAT_R32G32B32A32_SFLOAT;
-                                offset += 16;
-                                break;
-                            case ResourceType::eU32Vec4:
-                                ia_vec.back().format = VK_FORMAT_R32G32B32A32_UINT;
-                                offset += 16;
-                                break;
-                            case ResourceType::eS32Vec4:
-                                ia_vec.back().format = VK_FORMAT_R32G32B32A32_SINT;
-                                offset += 16;
-                                break;
-                            default:
-                                std::cerr << "Vertex resource type (" << i
-                                          << ") is not described\n";
-                                return Result::eFailure;
-                                break;
-                        }
-                    }
+                if (co.mGPUTimings.empty())
+                    continue;
 
-                    ib.stride = offset;
-                }
+                if (!ImGui::TreeNodeEx(reinterpret_cast<void*>(static_cast<uintptr_t>(handle.getID())), ImGuiTreeNodeFlags_DefaultOpen, "command buffer %u", handle.getID()))
+                    continue;
 
+                for (const auto& timing : co.mGPUTimings)
                 {
-                    visci.sType                         = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-                    visci.pNext                         = nullptr;
-                    visci.vertexBindingDescriptionCount = 1;
-                    visci.pVertexBindingDescriptions    = &ib;
-                    visci.vertexAttributeDescriptionCount =
-                        static_cast<uint32_t>(ia_vec.size());
-                    visci.pVertexAttributeDescriptions = ia_vec.data();
+                    ImGui::Indent(timing.depth * 12.f);
+                    ImGui::Text("%s : %.3f ms", timing.name.c_str(), timing.milliseconds);
+                    ImGui::Unindent(timing.depth * 12.f);
                 }
+                ImGui::TreePop();
             }
-            else  // vertex input state
+        }
+
+        if (ImGui::CollapsingHeader("Memory", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            // budget is refreshed at every frame end
+            for (uint32_t i = 0; i < mPhysMemProps.memoryHeapCount; ++i)
             {
-                visci.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-                visci.pNext                           = nullptr;
-                visci.vertexBindingDescriptionCount   = 0;
-                visci.pVertexBindingDescriptions      = nullptr;
-                visci.vertexAttributeDescriptionCount = 0;
-                visci.pVertexAttributeDescriptions    = nullptr;
+                const auto& heap = mPhysMemProps.memoryHeaps[i];
+                const double usageMiB  = mHeapProcessUsages[i] / (1024. * 1024.);
+                const double budgetMiB = mHeapBudgets[i] / (1024. * 1024.);
+
+                char overlay[64];
+                std::snprintf(overlay, sizeof(overlay), "%.1f / %.1f MiB", usageMiB, budgetMiB);
+                ImGui::Text("heap %u%s : context %.1f MiB, size %.1f MiB", i, heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT ? " (device local)" : "",
+                            mHeapUsages[i] / (1024. * 1024.), heap.size / (1024. * 1024.));
+                ImGui::ProgressBar(mHeapBudgets[i] > 0 ? static_cast<float>(usageMiB / budgetMiB) : 0.f, ImVec2(360, 0), overlay);
             }
+            ImGui::Text("allocations : %zu, host fallbacks : %u%s", mAllocations.size(), mHostFallbackCount, mMemoryBudgetSupported ? "" : " (estimated budget)");
+        }
 
-            // std::cerr << "vertex input\n";
+        if (ImGui::CollapsingHeader("Descriptor pools"))
+        {
+            for (size_t i = 0; i < mDescriptorPools.size(); ++i)
+            {
+                const auto& info = mDescriptorPools[i].first;
+                char overlay[64];
 
-            // color blend
-            std::vector<VkPipelineColorBlendAttachmentState> blendAttachments;
-            blendAttachments.reserve(rpo.colorTargets.size() + 1);
-            VkPipelineColorBlendStateCreateInfo cbci{};
-            cbci.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+                ImGui::Text("pool %zu", i);
+                std::snprintf(overlay, sizeof(overlay), "uniform buffer %u / %u", info.uniformBufferCount, DescriptorPoolInfo::poolUBSize);
+                ImGui::ProgressBar(static_cast<float>(info.uniformBufferCount) / DescriptorPoolInfo::poolUBSize, ImVec2(360, 0), overlay);
+                std::snprintf(overlay, sizeof(overlay), "combined texture %u / %u", info.combinedTextureCount, DescriptorPoolInfo::poolCTSize);
+                ImGui::ProgressBar(static_cast<float>(info.combinedTextureCount) / DescriptorPoolInfo::poolCTSize, ImVec2(360, 0), overlay);
+            }
+        }
 
-            {
-                auto&& size =
-                    (rpo.mHWindow
-                         ? 1
-                         : rpo.colorTargets.size());  // + (rpo.depthTarget ? 1 : 0);
-                for (size_t i = 0; i < size; ++i)
-                {
-                    auto&& blendAttachment = blendAttachments.emplace_back();
+        if (ImGui::CollapsingHeader("Resources"))
+        {
+            ImGui::Text("window : %zu, render pass : %zu", mWindowMap.size(), mRPMap.size());
+            ImGui::Text("buffer : %zu, texture : %zu, sampler : %zu", mBufferMap.size(), mImageMap.size(), mSamplerMap.size());
+            ImGui::Text("graphics pipeline : %zu, compute pipeline : %zu", mGPMap.size(), mCPMap.size());
+            ImGui::Text("command buffer : %zu, readback : %zu", mCommandBufferMap.size(), mReadbackMap.size());
+        }
 
-                    const auto colorWriteAll =
-                        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-                        VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-                    switch (info.colorBlend)
-                    {
-                        case ColorBlend::eNone:
-                            blendAttachment.blendEnable = VK_FALSE;
-                            break;
+        ImGui::End();
 
-                        case ColorBlend::eDefault:
-                            blendAttachment.blendEnable         = VK_TRUE;
-                            blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-                            blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-                            blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-                            blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-                            blendAttachment.alphaBlendOp        = VK_BLEND_OP_ADD;
-                            blendAttachment.colorBlendOp        = VK_BLEND_OP_ADD;
-                            blendAttachment.colorWriteMask      = colorWriteAll;
-                            break;
+        return Result::eSuccess;
+    }
 
-                        case ColorBlend::eAlphaBlend:
-                            blendAttachment.blendEnable         = VK_TRUE;
-                            blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-                            blendAttachment.dstColorBlendFactor =
-                                VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-                            blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-                            blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-                            blendAttachment.colorBlendOp        = VK_BLEND_OP_ADD;
-                            blendAttachment.alphaBlendOp        = VK_BLEND_OP_ADD;
-                            blendAttachment.colorWriteMask      = colorWriteAll;
-                            break;
+    Result Context::createProfilerQueries(CommandObject& co, const size_t index, const InternalCommandList& icl)
+    {
+        Result result = Result::eSuccess;
 
-                        default:
-                            std::cerr << "color blend state is not described\n";
-                            return Result::eFailure;
-                            break;
-                    }
+        if (co.mProfilerQueries.size() <= index)
+            co.mProfilerQueries.resize(index + 1);
 
-                    cbci.sType           = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-                    cbci.logicOpEnable   = VK_FALSE;
-                    cbci.logicOp         = VK_LOGIC_OP_COPY;
-                    cbci.attachmentCount = blendAttachments.size();
-                    cbci.pAttachments    = blendAttachments.data();
-                }
-            }
+        // keep the results of the previous recording if it has already finished
+        result = resolveProfilerQueries(co, index);
+        if (result != Result::eSuccess)
+            return result;
 
-            // viewport and scissor
-            VkPipelineViewportStateCreateInfo vpsci{};
-            VkViewport viewport{};
-            VkRect2D scissor{};
-            {
-                if (info.viewport)
-                {
-                    viewport.x        = info.viewport.value()[0][0];
-                    viewport.y        = info.viewport.value()[0][1];
-                    viewport.minDepth = info.viewport.value()[0][2];
+        auto& pq = co.mProfilerQueries[index];
+        pq.mScopes.clear();
+        pq.mOpenScopes.clear();
+        pq.mStatisticsNames.clear();
+        pq.mStatisticsActive = false;
+        pq.mRecordedStats    = FrameStats();
+        pq.mPending          = false;
 
-                    viewport.width    = info.viewport.value()[1][0];
-                    viewport.height   = info.viewport.value()[1][1];
-                    viewport.maxDepth = info.viewport.value()[1][2];
-                }
-                else
-                {
-                    const VkExtent3D& extent = rpo.mExtent.value();
-                    viewport.x               = 0;
-                    viewport.y               = 0;
-                    viewport.width           = static_cast<float>(extent.width);
-                    viewport.height          = static_cast<float>(extent.height);
-                    viewport.minDepth        = 0;
-                    viewport.maxDepth        = static_cast<float>(extent.depth);
-                }
+        const uint32_t validBits = co.mQueueType == QueueType::eCompute ? mComputeTimestampValidBits : mGraphicsTimestampValidBits;
 
-                if (info.scissor)
-                {
-                    scissor.offset.x = static_cast<int32_t>(info.scissor.value()[0][0]);
-                    scissor.offset.y = static_cast<int32_t>(info.scissor.value()[0][1]);
-                    scissor.extent   = {static_cast<uint32_t>(info.scissor.value()[1][0]),
-                                      static_cast<uint32_t>(info.scissor.value()[1][1])};
-                }
-                else
-                {
-                    scissor.offset = {0, 0};
-                    scissor.extent = {rpo.mExtent.value().width,
-                                      rpo.mExtent.value().height};
-                }
+        uint32_t passCount  = 0;
+        uint32_t scopeCount = 0;
+        for (const auto& command : icl)
+        {
+            if (command.first == CommandType::eBegin)
+                ++passCount;
+            else if (command.first == CommandType::eBeginScope)
+                ++scopeCount;
+        }
 
-                vpsci.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-                vpsci.viewportCount = 1;
-                vpsci.pViewports    = &viewport;
-                vpsci.scissorCount  = 1;
-                vpsci.pScissors     = &scissor;
-            }
+        const uint32_t queryCount      = mGPUProfilerEnabled && validBits > 0 ? (passCount + scopeCount) * 2 : 0;
+        const uint32_t statisticsCount = mPipelineStatisticsEnabled && co.mQueueType == QueueType::eGraphics ? passCount : 0;
 
-            // std::cerr << "color and viewport\n";
+        // pools are reused while they are large enough
+        if (queryCount == 0 || queryCount > pq.mQueryCount)
+        {
+            if (pq.mPool != VK_NULL_HANDLE)
+                vkDestroyQueryPool(mDevice, pq.mPool, nullptr);
+            pq.mPool       = VK_NULL_HANDLE;
+            pq.mQueryCount = 0;
 
-            // input assembly
-            VkPipelineInputAssemblyStateCreateInfo iaci{};
+            if (queryCount > 0)
             {
-                iaci.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-                switch (info.topology)
-                {
-                    case Topology::eTriangleList:
-                        iaci.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-                        break;
-                    case Topology::eTriangleStrip:
-                        iaci.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
-                        break;
-                    case Topology::eTriangleFan:
-                        iaci.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN;
-                        break;
-                    default:
-                        std::cerr << "primitive topology is not described\n";
-                        return Result::eFailure;
-                        break;
-                }
+                result = createQueryPool(VK_QUERY_TYPE_TIMESTAMP, queryCount, pq.mPool);
+                if (result != Result::eSuccess)
+                    return result;
+                pq.mQueryCount = queryCount;
             }
+        }
 
-            // rasterization
-            VkPipelineRasterizationStateCreateInfo rci{};
+        if (statisticsCount == 0 || statisticsCount > pq.mStatisticsCount)
+        {
+            if (pq.mStatisticsPool != VK_NULL_HANDLE)
+                vkDestroyQueryPool(mDevice, pq.mStatisticsPool, nullptr);
+            pq.mStatisticsPool  = VK_NULL_HANDLE;
+            pq.mStatisticsCount = 0;
+
+            if (statisticsCount > 0)
             {
-                rci.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-                switch (info.rasterizerState.polygonMode)
-                {
-                    case PolygonMode::eFill:
-                        rci.polygonMode = VK_POLYGON_MODE_FILL;
-                        break;
-                    case PolygonMode::eLine:
-                        rci.polygonMode = VK_POLYGON_MODE_LINE;
+                result = createQueryPool(VK_QUERY_TYPE_PIPELINE_STATISTICS, statisticsCount, pq.mStatisticsPool);
+                if (result != Result::eSuccess)
+                    return result;
+                pq.mStatisticsCount = statisticsCount;
+            }
+        }
+
+        return Result::eSuccess;
+    }
+
+    Result Context::createQueryPool(const VkQueryType type, const uint32_t count, VkQueryPool& pool_out)
+    {
+        VkQueryPoolCreateInfo qpci{};
+        qpci.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        qpci.queryType  = type;
+        qpci.queryCount = count;
+        // results are written in this bit order (see PipelineStatistics)
+        if (type == VK_QUERY_TYPE_PIPELINE_STATISTICS)
+            qpci.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+                                      VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                                      VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                      VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+                                      VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                                      VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+        const Result result = checkVkResult(vkCreateQueryPool(mDevice, &qpci, nullptr, &pool_out));
+        if (result != Result::eSuccess)
+        {
+            std::cerr << "failed to create query pool!\n";
+            pool_out = VK_NULL_HANDLE;
+        }
+
+        return result;
+    }
+
+    Result Context::resolveProfilerQueries(CommandObject& co, const size_t index)
+    {
+        if (index >= co.mProfilerQueries.size())
+            return Result::eSuccess;
+
+        auto& pq = co.mProfilerQueries[index];
+        if (!pq.mPending || (pq.mScopes.empty() && pq.mStatisticsNames.empty()))
+            return Result::eSuccess;
+
+        // each query is followed by its availability
+        const uint32_t queryCount = static_cast<uint32_t>(pq.mScopes.size() * 2);
+        std::vector<uint64_t> timestamps(queryCount * 2);
+        if (queryCount > 0)
+        {
+            const VkResult vkResult = vkGetQueryPoolResults(mDevice, pq.mPool, 0, queryCount,
+                                                            timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t) * 2,
+                                                            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+            if (vkResult != VK_SUCCESS && vkResult != VK_NOT_READY)
+                return checkVkResult(vkResult);
+        }
+
+        constexpr uint32_t statisticsStride = 7;
+        const uint32_t statisticsCount      = static_cast<uint32_t>(pq.mStatisticsNames.size());
+        std::vector<uint64_t> statistics(statisticsCount * statisticsStride);
+        if (statisticsCount > 0)
+        {
+            const VkResult vkResult = vkGetQueryPoolResults(mDevice, pq.mStatisticsPool, 0, statisticsCount,
+                                                            statistics.size() * sizeof(uint64_t), statistics.data(), sizeof(uint64_t) * statisticsStride,
+                                                            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+            if (vkResult != VK_SUCCESS && vkResult != VK_NOT_READY)
+                return checkVkResult(vkResult);
+        }
+
+        // not finished yet, try again later
+        for (uint32_t i = 0; i < queryCount; ++i)
+            if (timestamps[i * 2 + 1] == 0)
+                return Result::eSuccess;
+        for (uint32_t i = 0; i < statisticsCount; ++i)
+            if (statistics[i * statisticsStride + statisticsStride - 1] == 0)
+                return Result::eSuccess;
+
+        pq.mPending = false;
+
+        // results of an older execution may be resolved later than the newer one
+        if (pq.mSignalValue < co.mGPUTimingValue)
+            return Result::eSuccess;
+
+        const uint32_t validBits = co.mQueueType == QueueType::eCompute ? mComputeTimestampValidBits : mGraphicsTimestampValidBits;
+        const uint64_t mask      = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+        co.mGPUTimings.clear();
+        co.mGPUTimings.reserve(pq.mScopes.size());
+        for (size_t i = 0; i < pq.mScopes.size(); ++i)
+        {
+            // the counter may wrap around within valid bits
+            const uint64_t ticks = ((timestamps[i * 4 + 2] & mask) - (timestamps[i * 4] & mask)) & mask;
+            co.mGPUTimings.emplace_back(GPUTiming{pq.mScopes[i].mName, pq.mScopes[i].mDepth, ticks * mTimestampPeriod / 1e6});
+        }
+
+        if (mTracer.isEnabled() && !pq.mScopes.empty())
+        {
+            // without calibrated timestamps the first scope is placed at the submission
+            uint64_t baseTicks = timestamps[0];
+            uint64_t baseNs    = pq.mSubmitNs;
+            if (mvkGetCalibratedTimestampsEXT && Result::eSuccess != getCalibratedTimestamps(baseTicks, baseNs))
+            {
+                baseTicks = timestamps[0];
+                baseNs    = pq.mSubmitNs;
+            }
+
+            // signed difference within valid bits
+            const uint32_t shift  = 64 - std::min(validBits, 64u);
+            const auto toHostNs = [&](const uint64_t ticks)
+            {
+                const int64_t delta = static_cast<int64_t>(((ticks - baseTicks) & mask) << shift) >> shift;
+                return static_cast<uint64_t>(static_cast<double>(baseNs) + delta * static_cast<double>(mTimestampPeriod));
+            };
+
+            const auto track = co.mQueueType == QueueType::eCompute ? Tracer::Track::eComputeQueue : Tracer::Track::eGraphicsQueue;
+            for (size_t i = 0; i < pq.mScopes.size(); ++i)
+                mTracer.addEvent(pq.mScopes[i].mName, track, toHostNs(timestamps[i * 4]), toHostNs(timestamps[i * 4 + 2]));
+        }
+
+        co.mPipelineStatistics.clear();
+        co.mPipelineStatistics.reserve(statisticsCount);
+        for (uint32_t i = 0; i < statisticsCount; ++i)
+        {
+            const uint64_t* p = &statistics[i * statisticsStride];
+            co.mPipelineStatistics.emplace_back(PipelineStatistics{pq.mStatisticsNames[i], p[0], p[1], p[2], p[3], p[4], p[5]});
+        }
+
+        co.mGPUTimingValue = pq.mSignalValue;
+
+        return Result::eSuccess;
+    }
+
+    void Context::submitProfilerQueries(CommandObject& co, const size_t index)
+    {
+        ++mFrameStats.submitCount;
+
+        if (index >= co.mProfilerQueries.size())
+            return;
+
+        auto& pq = co.mProfilerQueries[index];
+        mFrameStats += pq.mRecordedStats;
+        pq.mPending     = true;
+        pq.mSignalValue = co.mSignalValue;
+        pq.mSubmitNs    = mTracer.isEnabled() ? Tracer::now() : 0;
+    }
+
+    Result Context::getCalibratedTimestamps(uint64_t& ticks_out, uint64_t& hostNs_out)
+    {
+        std::array<VkCalibratedTimestampInfoEXT, 2> infos{};
+        infos[0].sType      = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+        infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+        infos[1].sType      = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+        infos[1].timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+
+        const uint32_t count = mMonotonicTimeDomain ? 2 : 1;
+        std::array<uint64_t, 2> timestamps{};
+        uint64_t maxDeviation = 0;
+
+        const uint64_t before = Tracer::now();
+        const Result result   = checkVkResult(mvkGetCalibratedTimestampsEXT(mDevice, count, infos.data(), timestamps.data(), &maxDeviation));
+        const uint64_t after  = Tracer::now();
+        if (result != Result::eSuccess)
+            return result;
+
+        ticks_out = timestamps[0];
+        // steady_clock is CLOCK_MONOTONIC, otherwise the host clock is sampled around the call
+        hostNs_out = mMonotonicTimeDomain ? timestamps[1] : before + (after - before) / 2;
+
+        return Result::eSuccess;
+    }
+
+    void Context::destroyProfilerQueries(CommandObject& co)
+    {
+        for (auto& pq : co.mProfilerQueries)
+        {
+            if (pq.mPool != VK_NULL_HANDLE)
+                vkDestroyQueryPool(mDevice, pq.mPool, nullptr);
+            if (pq.mStatisticsPool != VK_NULL_HANDLE)
+                vkDestroyQueryPool(mDevice, pq.mStatisticsPool, nullptr);
+        }
+        co.mProfilerQueries.clear();
+    }
+
+    Result Context::createStagingBuffer(const size_t size, const void* const pData,
+                                        BufferObject& bo_out)
+    {
+        Result result = Result::eFailure;
+
+        {
+            VkBufferCreateInfo ci{};
+            ci.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            ci.size        = size;
+            ci.usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+            ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            VkBuffer buffer;
+            result = checkVkResult(vkCreateBuffer(mDevice, &ci, nullptr, &buffer));
+            if (Result::eSuccess != result)
+                return result;
+            bo_out.mBuffer = buffer;
+        }
+
+        {
+            VkMemoryRequirements reqs;
+            vkGetBufferMemoryRequirements(mDevice, bo_out.mBuffer.value(), &reqs);
+            VkMemoryAllocateInfo ai{};
+            ai.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            ai.allocationSize  = reqs.size;
+            ai.memoryTypeIndex = getMemoryTypeIndex(
+                reqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+            VkDeviceMemory memory;
+            result = checkVkResult(allocateMemory(ai, memory));
+            if (Result::eSuccess != result)
+            {
+                vkDestroyBuffer(mDevice, bo_out.mBuffer.value(), nullptr);
+                return result;
+            }
+            bo_out.mMemory = memory;
+
+            vkBindBufferMemory(mDevice, bo_out.mBuffer.value(), bo_out.mMemory.value(), 0);
+        }
+        bo_out.mIsHostVisible = true;
+
+        void* p;
+        result = checkVkResult(
+            vkMapMemory(mDevice, bo_out.mMemory.value(), 0, VK_WHOLE_SIZE, 0, &p));
+        if (Result::eSuccess != result)
+        {
+            freeMemory(bo_out.mMemory.value());
+            vkDestroyBuffer(mDevice, bo_out.mBuffer.value(), nullptr);
+            return result;
+        }
+
+        // contents are left to the caller if no data is given
+        if (pData)
+            memcpy(p, pData, size);
+        vkUnmapMemory(mDevice, bo_out.mMemory.value());
+
+        return Result::eSuccess;
+    }
+
+    Result Context::beginUploadCommand(VkCommandPool commandPool,
+                                       VkCommandBuffer& command_out)
+    {
+        Result result = Result::eFailure;
+
+        {
+            VkCommandBufferAllocateInfo ai{};
+            ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            ai.commandBufferCount = 1;
+            ai.commandPool        = commandPool;
+            ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            result = checkVkResult(vkAllocateCommandBuffers(mDevice, &ai, &command_out));
+            if (Result::eSuccess != result)
+                return result;
+        }
+
+        VkCommandBufferBeginInfo commandBI{};
+        commandBI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        commandBI.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        result = checkVkResult(vkBeginCommandBuffer(command_out, &commandBI));
+        if (Result::eSuccess != result)
+            vkFreeCommandBuffers(mDevice, commandPool, 1, &command_out);
+
+        return result;
+    }
+
+    Result Context::submitUploadCommand(VkCommandBuffer transferCommand,
+                                        std::optional<VkCommandBuffer> acquireCommand,
+                                        const size_t size)
+    {
+        PendingUpload pending;
+        Result result = submitUploadCommandAsync(transferCommand, acquireCommand, size, pending);
+        if (Result::eSuccess != result)
+            return result;
+
+        // wait only for this upload, not the whole device
+        return waitUpload(pending);
+    }
+
+    Result Context::submitUploadCommandAsync(VkCommandBuffer transferCommand,
+                                             std::optional<VkCommandBuffer> acquireCommand,
+                                             const size_t size,
+                                             PendingUpload& pending_out)
+    {
+        Result result = Result::eFailure;
+
+        pending_out.begin           = std::chrono::high_resolution_clock::now();
+        pending_out.transferCommand = transferCommand;
+        pending_out.acquireCommand  = acquireCommand;
+        pending_out.size            = size;
+
+        vkEndCommandBuffer(transferCommand);
+        if (acquireCommand)
+            vkEndCommandBuffer(acquireCommand.value());
+
+        {
+            VkFenceCreateInfo ci{};
+            ci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            result   = checkVkResult(vkCreateFence(mDevice, &ci, nullptr, &pending_out.fence));
+            if (Result::eSuccess != result)
+                return result;
+        }
+
+        pending_out.transferCompletedSem.reset();
+        if (acquireCommand)
+        {
+            VkSemaphoreCreateInfo ci{};
+            ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            VkSemaphore sem;
+            result = checkVkResult(vkCreateSemaphore(mDevice, &ci, nullptr, &sem));
+            if (Result::eSuccess != result)
+            {
+                vkDestroyFence(mDevice, pending_out.fence, nullptr);
+                return result;
+            }
+            pending_out.transferCompletedSem = sem;
+        }
+
+        {
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers    = &transferCommand;
+            if (pending_out.transferCompletedSem)
+            {
+                submitInfo.signalSemaphoreCount = 1;
+                submitInfo.pSignalSemaphores    = &pending_out.transferCompletedSem.value();
+            }
+
+            result = checkVkResult(vkQueueSubmit(
+                mTransferQueue, 1, &submitInfo, acquireCommand ? VK_NULL_HANDLE : pending_out.fence));
+        }
+
+        if (Result::eSuccess == result && acquireCommand)
+        {
+            const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores    = &pending_out.transferCompletedSem.value();
+            submitInfo.pWaitDstStageMask  = &waitStage;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers    = &acquireCommand.value();
+
+            result = checkVkResult(vkQueueSubmit(mDeviceQueue, 1, &submitInfo, pending_out.fence));
+        }
+
+        if (Result::eSuccess != result)
+        {
+            // nothing may be in flight, so the objects are released after the queues are idle
+            vkDeviceWaitIdle(mDevice);
+            releaseUpload(pending_out);
+        }
+
+        return result;
+    }
+
+    Result Context::waitUpload(PendingUpload& pending)
+    {
+        // end copying
+        Result result = checkVkResult(vkWaitForFences(mDevice, 1, &pending.fence, VK_TRUE, UINT64_MAX));
+
+        releaseUpload(pending);
+
+        if (Result::eSuccess != result)
+            return result;
+
+        const std::chrono::duration<double> elapsed =
+            std::chrono::high_resolution_clock::now() - pending.begin;
+        ++mUploadStats.uploadCount;
+        mUploadStats.uploadedBytes += pending.size;
+        mFrameStats.uploadedBytes += pending.size;
+        mUploadStats.totalSeconds += elapsed.count();
+
+        return Result::eSuccess;
+    }
+
+    void Context::releaseUpload(PendingUpload& pending)
+    {
+        vkDestroyFence(mDevice, pending.fence, nullptr);
+        if (pending.transferCompletedSem)
+            vkDestroySemaphore(mDevice, pending.transferCompletedSem.value(), nullptr);
+        vkFreeCommandBuffers(mDevice, mTransferCommandPool, 1, &pending.transferCommand);
+        if (pending.acquireCommand)
+            vkFreeCommandBuffers(mDevice, mCommandPool, 1, &pending.acquireCommand.value());
+    }
+
+    Result Context::generateMipmaps(VkCommandBuffer command, const ImageObject& io,
+                                    const uint32_t baseLayer, const uint32_t layerCount)
+    {
+        VkFormatProperties props;
+        vkGetPhysicalDeviceFormatProperties(mPhysDev, io.format, &props);
+        if (!(props.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT) ||
+            !(props.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT))
+        {
+            std::cerr << "this texture format does not support mipmap generation!\n";
+            return Result::eFailure;
+        }
+
+        const VkFilter filter = (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)
+                                    ? VK_FILTER_LINEAR
+                                    : VK_FILTER_NEAREST;
+
+        VkImageMemoryBarrier imb{};
+        imb.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imb.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imb.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imb.subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, baseLayer, layerCount};
+        imb.image               = io.mImage.value();
+
+        // all layers in the range are blitted at once
+        int32_t width  = static_cast<int32_t>(io.extent.width);
+        int32_t height = static_cast<int32_t>(io.extent.height);
+        int32_t depth  = static_cast<int32_t>(io.extent.depth);
+        for (uint32_t level = 1; level < io.mMipLevels; ++level)
+        {
+            // upper level becomes blit source
+            imb.subresourceRange.baseMipLevel = level - 1;
+            imb.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            imb.newLayout                     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            imb.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+            imb.dstAccessMask                 = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                                 nullptr, 1, &imb);
+
+            VkImageBlit blit{};
+            blit.srcOffsets[0]  = {0, 0, 0};
+            blit.srcOffsets[1]  = {width, height, depth};
+            blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, baseLayer, layerCount};
+            width               = std::max(width / 2, 1);
+            height              = std::max(height / 2, 1);
+            depth               = std::max(depth / 2, 1);
+            blit.dstOffsets[0]  = {0, 0, 0};
+            blit.dstOffsets[1]  = {width, height, depth};
+            blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, baseLayer, layerCount};
+            vkCmdBlitImage(command, io.mImage.value(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           io.mImage.value(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
+                           filter);
+
+            // upper level is no longer touched
+            imb.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            imb.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imb.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            imb.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0,
+                                 nullptr, 1, &imb);
+        }
+
+        // last level was only written
+        imb.subresourceRange.baseMipLevel = io.mMipLevels - 1;
+        imb.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        imb.newLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imb.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+        imb.dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0,
+                             nullptr, 1, &imb);
+
+        return Result::eSuccess;
+    }
+
+    void Context::setStorageImageBarrier(VkCommandBuffer command, VkImage image,
+                                         VkImageLayout oldLayout, VkImageLayout newLayout)
+    {
+        VkImageMemoryBarrier imb{};
+        imb.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imb.oldLayout           = oldLayout;
+        imb.newLayout           = newLayout;
+        imb.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imb.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imb.subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+        imb.image               = image;
+
+        // stages and accesses that every queue supports
+        const bool toStorage = newLayout == VK_IMAGE_LAYOUT_GENERAL;
+        imb.srcAccessMask    = toStorage ? VK_ACCESS_MEMORY_WRITE_BIT : VK_ACCESS_SHADER_WRITE_BIT;
+        imb.dstAccessMask    = toStorage ? VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+                                         : VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        vkCmdPipelineBarrier(command,
+                             toStorage ? VK_PIPELINE_STAGE_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             toStorage ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &imb);
+    }
+
+    Result Context::setImageMemoryBarrier(VkCommandBuffer command, VkImage image,
+                                          VkImageLayout oldLayout,
+                                          VkImageLayout newLayout,
+                                          VkImageAspectFlags aspectFlags,
+                                          const uint32_t baseLayer,
+                                          const uint32_t layerCount)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        VkImageMemoryBarrier imb{};
+        imb.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imb.oldLayout           = oldLayout;
+        imb.newLayout           = newLayout;
+        imb.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imb.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imb.subresourceRange    = {aspectFlags, 0, VK_REMAINING_MIP_LEVELS, baseLayer, layerCount};
+        imb.image               = image;
+
+        // final stage that write to resource in pipelines
+        VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        // next state that write to resource in pipelines
+        VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+        switch (oldLayout)
+        {
+            case VK_IMAGE_LAYOUT_UNDEFINED:
+                imb.srcAccessMask = 0;
+                break;
+            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+                imb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                srcStage          = VK_PIPELINE_STAGE_TRANSFER_BIT;
+                break;
+            case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+                imb.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+                break;
+        }
+
+        switch (newLayout)
+        {
+            case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+                imb.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+                dstStage          = VK_PIPELINE_STAGE_TRANSFER_BIT;
+                break;
+            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+                imb.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                dstStage          = VK_PIPELINE_STAGE_TRANSFER_BIT;
+                break;
+            case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+                imb.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                dstStage          = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+                break;
+        }
+
+        vkCmdPipelineBarrier(command, srcStage, dstStage, 0,
+                             0,  // memoryBarrierCount
+                             nullptr,
+                             0,  // bufferMemoryBarrierCount
+                             nullptr,
+                             1,  // imageMemoryBarrierCount
+                             &imb);
+
+        return Result::eSuccess;
+    }
+
+    Result Context::createDepthBuffer(WindowObject& wo)
+    {
+        Result result;
+        ImageObject io;
+
+        {
+            VkImageCreateInfo ci{};
+            ci.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            ci.pNext         = nullptr;
+            ci.imageType     = VK_IMAGE_TYPE_2D;
+            ci.format        = VK_FORMAT_D32_SFLOAT;
+            ci.extent.width  = wo.mSwapchainExtent.width;
+            ci.extent.height = wo.mSwapchainExtent.height;
+            ci.extent.depth  = 1;
+            ci.mipLevels     = 1;
+            ci.usage         = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            ci.samples       = VK_SAMPLE_COUNT_1_BIT;
+            ci.arrayLayers   = 1;
+
+            io.format         = ci.format;
+            io.extent         = ci.extent;
+            io.mSizeOfChannel = 4;
+
+            {
+                VkImage image;
+                result = checkVkResult(vkCreateImage(mDevice, &ci, nullptr, &image));
+                if (Result::eSuccess != result)
+                {
+                    std::cerr << "failed to create depth buffer's image\n";
+                    return result;
+                }
+
+                io.mImage = image;
+            }
+        }
+
+        {
+            VkMemoryRequirements reqs;
+            vkGetImageMemoryRequirements(mDevice, io.mImage.value(), &reqs);
+            VkMemoryAllocateInfo ai{};
+            ai.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            ai.allocationSize  = reqs.size;
+            ai.memoryTypeIndex = getMemoryTypeIndex(
+                reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            {
+                VkDeviceMemory memory;
+                result = checkVkResult(allocateMemory(ai, memory));
+                if (Result::eSuccess != result)
+                {
+                    return result;
+                }
+
+                io.mMemory = memory;
+            }
+
+            result = checkVkResult(
+                vkBindImageMemory(mDevice, io.mImage.value(), io.mMemory.value(), 0));
+            if (Result::eSuccess != result)
+            {
+                return result;
+            }
+        }
+
+        {
+            VkImageViewCreateInfo ci{};
+            ci.sType      = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            ci.image      = io.mImage.value();
+            ci.viewType   = VK_IMAGE_VIEW_TYPE_2D;
+            ci.format     = io.format;
+            ci.components = {
+                VK_COMPONENT_SWIZZLE_R,
+                VK_COMPONENT_SWIZZLE_G,
+                VK_COMPONENT_SWIZZLE_B,
+                VK_COMPONENT_SWIZZLE_A,
+            };
+            //ci.subresourceRange = {VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, 0, 1, 0, 1};
+            ci.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+
+            VkImageView imageView;
+            result =
+                checkVkResult(vkCreateImageView(mDevice, &ci, nullptr, &imageView));
+            if (Result::eSuccess != result)
+            {
+                std::cerr << "failed to create vkImageView!\n";
+                return result;
+            }
+
+            io.mView = imageView;
+        }
+
+        io.currentLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        io.usage         = TextureUsage::eDepthStencilTarget;
+
+        // set image layout
+        {
+            VkCommandBuffer command;
+            {
+                VkCommandBufferAllocateInfo ai{};
+                ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                ai.commandBufferCount = 1;
+                ai.commandPool        = mCommandPool;
+                ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                vkAllocateCommandBuffers(mDevice, &ai, &command);
+            }
+
+            VkCommandBufferBeginInfo commandBI{};
+            commandBI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            vkBeginCommandBuffer(command, &commandBI);
+
+            //setImageMemoryBarrier(command, io.mImage.value(), VK_IMAGE_LAYOUT_UNDEFINED,
+            //                      io.currentLayout, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
+            setImageMemoryBarrier(command, io.mImage.value(), VK_IMAGE_LAYOUT_UNDEFINED,
+                io.currentLayout, VK_IMAGE_ASPECT_DEPTH_BIT);
+            vkEndCommandBuffer(command);
+
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers    = &command;
+            vkQueueSubmit(mDeviceQueue, 1, &submitInfo, VK_NULL_HANDLE);
+
+            // end copying
+            vkDeviceWaitIdle(mDevice);
+            vkFreeCommandBuffers(mDevice, mCommandPool, 1, &command);
+        }
+
+        mImageMap.emplace(mNextTextureHandle, io);
+        wo.mHDepthBuffer = mNextTextureHandle++;
+
+        return Result::eSuccess;
+    }
+
+    Result Context::setUpImGui(WindowObject& wo, RenderPassObject& rpo)
+    {
+        Result result = Result::eSuccess;
+
+        // Create Descriptor Pool for ImGui
+        {
+            VkDescriptorPool descriptorPool;
+            constexpr int maxNum              = 100;
+            VkDescriptorPoolSize pool_sizes[] = {
+                {VK_DESCRIPTOR_TYPE_SAMPLER, maxNum},
+                {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxNum},
+                {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, maxNum},
+                {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxNum},
+                {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, maxNum},
+                {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, maxNum},
+                {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, maxNum},
+                {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxNum},
+                {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, maxNum},
+                {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, maxNum},
+                {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, maxNum}};
+
+            VkDescriptorPoolCreateInfo pool_info = {};
+            pool_info.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            pool_info.flags                      = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+            pool_info.maxSets                    = maxNum * IM_ARRAYSIZE(pool_sizes);
+            pool_info.poolSizeCount              = (uint32_t)IM_ARRAYSIZE(pool_sizes);
+            pool_info.pPoolSizes                 = pool_sizes;
+            result                               = checkVkResult(
+                                              vkCreateDescriptorPool(mDevice, &pool_info, NULL, &descriptorPool));
+            if (Result::eSuccess != result)
+            {
+                std::cerr << "failed to create vkDescriptorPool for ImGui!\n";
+                return result;
+            }
+            mImGuiDescriptorPool = descriptorPool;
+        }
+
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGui_ImplGlfw_InitForVulkan(wo.mpWindow.value(), true);
+
+        ImGui_ImplVulkan_InitInfo info = {};
+        info.Instance                  = mInstance;
+        info.PhysicalDevice            = mPhysDev;
+        info.Device                    = mDevice;
+        info.QueueFamily               = mGraphicsQueueIndex;
+        info.Queue                     = mDeviceQueue;
+        info.PipelineCache             = NULL;
+        info.DescriptorPool            = mImGuiDescriptorPool.value();
+        info.Allocator                 = NULL;
+        info.MinImageCount             = std::max(2u, wo.mSurfaceCaps.minImageCount);
+        info.ImageCount                = wo.mMaxFrameNum;
+        info.CheckVkResultFn           = ImGui_check_vk_result;
+        // ImGui is rendered in the last subpass
+        info.Subpass = static_cast<uint32_t>(rpo.mSubpassColorCounts.size() - 1);
+        info.MSAASamples = rpo.mSampleCount;
+        // ImGui_ImplVulkan_Init(&info, mImGuiRenderPass.value());
+        ImGui_ImplVulkan_Init(&info, rpo.mRenderPass.value());
+
+        {  // upload font data
+
+            VkCommandBuffer commandBuffer;
+            {
+                VkCommandBufferAllocateInfo ai{};
+                ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                ai.commandPool        = mCommandPool;
+                ai.commandBufferCount = 1;
+                ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                result =
+                    checkVkResult(vkAllocateCommandBuffers(mDevice, &ai, &commandBuffer));
+                if (Result::eSuccess != result)
+                {
+                    std::cerr << "Failed to allocate command buffers!\n";
+                    return result;
+                }
+            }
+
+            VkCommandBufferBeginInfo bi = {};
+            bi.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            bi.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            result = checkVkResult(vkBeginCommandBuffer(commandBuffer, &bi));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to begin command buffer!\n";
+                return result;
+            }
+
+            ImGui_ImplVulkan_CreateFontsTexture(commandBuffer);
+
+            VkSubmitInfo end_info       = {};
+            end_info.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            end_info.commandBufferCount = 1;
+            end_info.pCommandBuffers    = &commandBuffer;
+            result                      = checkVkResult(vkEndCommandBuffer(commandBuffer));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to end command buffer!\n";
+                return result;
+            }
+
+            result = checkVkResult(
+                vkQueueSubmit(mDeviceQueue, 1, &end_info, VK_NULL_HANDLE));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to submit command buffer!\n";
+                return result;
+            }
+
+            result = checkVkResult(vkDeviceWaitIdle(mDevice));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to wait device idle!\n";
+                return result;
+            }
+
+            ImGui_ImplVulkan_DestroyFontUploadObjects();
+
+            vkFreeCommandBuffers(mDevice, mCommandPool, 1, &commandBuffer);
+        }
+
+        return Result::eSuccess;
+    }
+
+    Result Context::uploadFontFile(const char* fontPath, float fontSize)
+    {
+        Result result = Result::eSuccess;
+
+        ImGuiIO& io = ImGui::GetIO();
+        (void)io;
+        io.Fonts->AddFontFromFileTTF(fontPath, fontSize);
+
+        {  // upload font data
+
+            VkCommandBuffer commandBuffer;
+            {
+                VkCommandBufferAllocateInfo ai{};
+                ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                ai.commandPool        = mCommandPool;
+                ai.commandBufferCount = 1;
+                ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                result =
+                    checkVkResult(vkAllocateCommandBuffers(mDevice, &ai, &commandBuffer));
+                if (Result::eSuccess != result)
+                {
+                    std::cerr << "Failed to allocate command buffers!\n";
+                    return result;
+                }
+            }
+
+            VkCommandBufferBeginInfo bi = {};
+            bi.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            bi.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            result = checkVkResult(vkBeginCommandBuffer(commandBuffer, &bi));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to begin command buffer!\n";
+                return result;
+            }
+
+            ImGui_ImplVulkan_CreateFontsTexture(commandBuffer);
+
+            VkSubmitInfo end_info       = {};
+            end_info.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            end_info.commandBufferCount = 1;
+            end_info.pCommandBuffers    = &commandBuffer;
+            result                      = checkVkResult(vkEndCommandBuffer(commandBuffer));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to end command buffer!\n";
+                return result;
+            }
+
+            result = checkVkResult(
+                vkQueueSubmit(mDeviceQueue, 1, &end_info, VK_NULL_HANDLE));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to submit command buffer!\n";
+                return result;
+            }
+
+            result = checkVkResult(vkDeviceWaitIdle(mDevice));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to wait device idle!\n";
+                return result;
+            }
+
+            ImGui_ImplVulkan_DestroyFontUploadObjects();
+
+            vkFreeCommandBuffers(mDevice, mCommandPool, 1, &commandBuffer);
+        }
+
+        return result;
+    }
+
+    Result Context::createShaderModule(const Shader& shader,
+                                       const VkShaderStageFlagBits& stage,
+                                       VkPipelineShaderStageCreateInfo* pSSCI)
+    {
+        Result result;
+
+        // std::ifstream infile(shader.path.c_str(), std::ios::binary);
+        // if (!infile)
+        // {
+        //     std::cerr << "failed to load file from " << shader.path << " \n";
+        //     return Result::eFailure;
+        // }
+
+        // std::vector<char> filedata;
+        // filedata.resize(uint32_t(infile.seekg(0,
+        // std::ifstream::end).tellg())); infile.seekg(0,
+        // std::ifstream::beg).read(filedata.data(), filedata.size());
+
+        VkShaderModule shaderModule;
+        VkShaderModuleCreateInfo ci{};
+        ci.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        ci.pNext = nullptr;
+        ci.pCode =
+            reinterpret_cast<const uint32_t*>(shader.getShaderByteCode().data());
+        ci.codeSize = shader.getShaderByteCode().size();
+        result =
+            checkVkResult(vkCreateShaderModule(mDevice, &ci, nullptr, &shaderModule));
+        if (result != Result::eSuccess)
+        {
+            std::cerr << "failed to create Shader Module\n";
+            return result;
+        }
+
+        pSSCI->sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pSSCI->flags  = 0;
+        pSSCI->pNext  = nullptr;
+        pSSCI->stage  = stage;
+        pSSCI->module = shaderModule;
+        pSSCI->pName  = shader.getEntryPoint().data();
+
+        return Result::eSuccess;
+    }
+
+    Result Context::createRenderPass(const RenderPassInfo& info,
+                                     HRenderPass& handle_out)
+    {
+        if (info.framesInFlight == 0)
+        {
+            std::cerr << "frames in flight must be at least 1!\n";
+            return Result::eFailure;
+        }
+
+        if (info.window)
+        {
+            if (info.framesInFlight != 1 || !info.frameColorTargets.empty())
+            {
+                std::cerr << "frames in flight of window render pass is specified by WindowInfo!\n";
+                return Result::eFailure;
+            }
+
+            return createRenderPass(info.window.value(), true, info, handle_out);
+        }
+        else
+        {
+            // per-frame targets must be interchangeable with the first frame
+            if (!info.frameColorTargets.empty())
+            {
+                if (info.frameColorTargets.size() != info.framesInFlight)
+                {
+                    std::cerr << "frame color targets must be specified for each frame in flight!\n";
+                    return Result::eFailure;
+                }
+
+                const auto& firstTargets = info.frameColorTargets.front();
+                for (const auto& targets : info.frameColorTargets)
+                {
+                    if (targets.size() != firstTargets.size())
+                    {
+                        std::cerr << "frame color target count mismatch!\n";
+                        return Result::eFailure;
+                    }
+
+                    for (size_t i = 0; i < targets.size(); ++i)
+                    {
+                        if (mImageMap.count(targets[i]) <= 0)
+                        {
+                            std::cerr << "invalid texture handle!\n";
+                            return Result::eFailure;
+                        }
+
+                        const auto& io    = mImageMap[targets[i]];
+                        const auto& first = mImageMap[firstTargets[i]];
+                        if (io.format != first.format || io.mSampleCount != first.mSampleCount ||
+                            io.extent.width != first.extent.width || io.extent.height != first.extent.height ||
+                            io.extent.depth != first.extent.depth)
+                        {
+                            std::cerr << "frame color targets must have same format and extent as the first frame!\n";
+                            return Result::eFailure;
+                        }
+                    }
+                }
+            }
+
+            const auto& colorTargets = info.frameColorTargets.empty() ? info.colorTargets : info.frameColorTargets.front();
+            if (info.depthTarget)
+                return createRenderPass(colorTargets, info.depthTarget.value(),
+                                        info, handle_out);
+            else
+                return createRenderPass(colorTargets, info, handle_out);
+        }
+
+        return Result::eFailure;
+    }
+
+    Result Context::createRenderPass(const HWindow& handle, bool depthTestEnable,
+                                     const RenderPassInfo& info,
+                                     HRenderPass& handle_out)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        Result result;
+        RenderPassObject rpo;
+        rpo.mFrameBufferIndex = 0;
+        rpo.mDepthTestEnable  = depthTestEnable;
+        rpo.mLoadPrevData     = false;
+
+        // Renderpass, framebuffer
+
+        if (mWindowMap.count(handle) <= 0)
+        {
+            std::cerr << "invalid swapchain handle\n";
+            return Result::eFailure;
+        }
+        rpo.mHWindow    = handle;
+        auto& swapchain = mWindowMap[handle];
+
+        {
+            VkExtent3D extent;
+            extent.width  = swapchain.mSwapchainExtent.width;
+            extent.height = swapchain.mSwapchainExtent.height;
+            extent.depth  = 1;
+            rpo.mExtent   = extent;
+        }
+
+        // intermediate targets are used only by subpasses before presenting
+        if (!info.subpasses.empty())
+            rpo.mIntermediateTargets = info.colorTargets;
+
+        for (const auto& tex : rpo.mIntermediateTargets)
+        {
+            if (mImageMap.count(tex) <= 0)
+            {
+                std::cerr << "invalid texture handle\n";
+                return Result::eFailure;
+            }
+
+            const auto& io = mImageMap[tex];
+            if (io.usage != TextureUsage::eColorTarget || io.mSampleCount != VK_SAMPLE_COUNT_1_BIT)
+            {
+                std::cerr << "invalid texture usage\n";
+                return Result::eFailure;
+            }
+
+            if (io.extent.width != rpo.mExtent.value().width ||
+                io.extent.height != rpo.mExtent.value().height)
+            {
+                std::cerr << "intermediate target extent must be same as window!\n";
+                return Result::eFailure;
+            }
+        }
+
+        result = getSampleCountFlag(info.sampleCount, depthTestEnable, rpo.mSampleCount);
+        if (Result::eSuccess != result)
+            return result;
+
+        std::vector<VkAttachmentDescription> adVec;
+        // swapchain image, depth buffer, intermediate targets (and resolve targets)
+        std::vector<uint32_t> colorAttachments;
+        std::vector<uint32_t> resolveAttachments;
+        std::optional<uint32_t> depthAttachment;
+
+        {
+            VkRenderPassCreateInfo ci{};
+            ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+
+            adVec.reserve(2 + rpo.mIntermediateTargets.size() * 2);
+
+            const auto& rdst = swapchain.mHSwapchainImages[0];  // only for info
+
+            if (mImageMap.count(rdst) <= 0)
+            {
+                std::cerr << "invalid swapchain image handle\n";
+                return Result::eFailure;
+            }
+
+            AttachmentOps ops;
+            result = getColorOps(info, 0, ops);
+            if (Result::eSuccess != result)
+                return result;
+
+            auto& io = mImageMap[rdst];
+            adVec.emplace_back();
+            adVec.back().format  = io.format;
+            adVec.back().samples = VK_SAMPLE_COUNT_1_BIT;
+            // swapchain image is always acquired with undefined contents
+            adVec.back().loadOp        = ops.load == LoadOp::eDontCare ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_CLEAR;
+            adVec.back().storeOp       = convertStoreOp(ops.store);
+            adVec.back().initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            // adVec.back().finalLayout = swapchain.useImGui ?
+            // VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL :
+            // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            adVec.back().finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            colorAttachments.emplace_back(0);
+
+            // if use depthBuffer, create attachment
+            if (depthTestEnable)
+            {
+                AttachmentOps depthOps = info.depthOps ? info.depthOps.value() : AttachmentOps(LoadOp::eClear);
+
+                if (rpo.mSampleCount == VK_SAMPLE_COUNT_1_BIT)
+                    rpo.depthTarget = swapchain.mHDepthBuffer;
+                else
+                {  // multisampled depth buffer lives only in the render pass
+                    if (depthOps.load == LoadOp::eLoad)
+                    {
+                        std::cerr << "multisampled render pass can not load previous depth (use eClear or eDontCare)!\n";
+                        return Result::eFailure;
+                    }
+
+                    HTexture depthBuffer;
+                    result = createMultiSampleTarget(rpo.mExtent.value(), mImageMap[swapchain.mHDepthBuffer].format,
+                                                     rpo.mSampleCount, true, depthBuffer);
+                    if (Result::eSuccess != result)
+                        return result;
+
+                    rpo.depthTarget = depthBuffer;
+                    depthOps        = AttachmentOps(depthOps.load, StoreOp::eDontCare);
+                }
+
+                adVec.emplace_back();
+
+                auto& depthBuffer          = mImageMap[rpo.depthTarget.value()];
+                adVec.back().format        = depthBuffer.format;
+                adVec.back().samples       = rpo.mSampleCount;
+                adVec.back().loadOp        = convertLoadOp(depthOps.load);
+                adVec.back().storeOp       = convertStoreOp(depthOps.store);
+                adVec.back().initialLayout = depthOps.load == LoadOp::eLoad ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+                adVec.back().finalLayout =
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+                depthAttachment = 1;
+            }
+
+            for (size_t i = 0; i < rpo.mIntermediateTargets.size(); ++i)
+            {
+                result = getColorOps(info, i + 1, ops);
+                if (Result::eSuccess != result)
+                    return result;
+
+                auto&& ad        = adVec.emplace_back(VkAttachmentDescription{});
+                ad.format        = mImageMap[rpo.mIntermediateTargets[i]].format;
+                ad.samples       = VK_SAMPLE_COUNT_1_BIT;
+                ad.loadOp        = convertLoadOp(ops.load);
+                ad.storeOp       = convertStoreOp(ops.store);
+                ad.initialLayout = ops.load == LoadOp::eLoad ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+                ad.finalLayout   = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                colorAttachments.emplace_back(static_cast<uint32_t>(adVec.size() - 1));
+            }
+
+            if (rpo.mSampleCount != VK_SAMPLE_COUNT_1_BIT)
+            {
+                result = createMultiSampleAttachments(rpo, colorAttachments, adVec, resolveAttachments);
+                if (Result::eSuccess != result)
+                    return result;
+            }
+
+            SubpassDescriptions sd;
+            result = createSubpassDescriptions(info.subpasses, colorAttachments, resolveAttachments, depthAttachment, sd);
+            if (Result::eSuccess != result)
+                return result;
+            rpo.mSubpassColorCounts = sd.colorCounts;
+
+            // wait for the swapchain image before the first subpass writing it
+            const uint32_t swapchainAttachment = resolveAttachments.empty() ? 0 : resolveAttachments[0];
+            uint32_t presentSubpass            = 0;
+            for (uint32_t i = 0; i < sd.descs.size(); ++i)
+            {
+                const auto& refs = resolveAttachments.empty() ? sd.colorRefs[i] : sd.resolveRefs[i];
+                if (std::any_of(refs.begin(), refs.end(), [&](const VkAttachmentReference& ar) { return ar.attachment == swapchainAttachment; }))
+                {
+                    presentSubpass = i;
+                    break;
+                }
+            }
+
+            VkSubpassDependency dependency{};
+            dependency.srcSubpass    = VK_SUBPASS_EXTERNAL;
+            dependency.dstSubpass    = presentSubpass;
+            dependency.srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            dependency.srcAccessMask = 0;
+            dependency.dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            sd.deps.emplace_back(dependency);
+
+            ci.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+            ci.attachmentCount = static_cast<uint32_t>(adVec.size());
+            ci.pAttachments    = adVec.data();
+            ci.subpassCount    = static_cast<uint32_t>(sd.descs.size());
+            ci.pSubpasses      = sd.descs.data();
+            ci.dependencyCount = static_cast<uint32_t>(sd.deps.size());
+            ci.pDependencies   = sd.deps.data();
+            {
+                VkRenderPass renderPass;
+                result =
+                    checkVkResult(vkCreateRenderPass(mDevice, &ci, nullptr, &renderPass));
+                if (Result::eSuccess != result)
+                {
+                    return result;
+                }
+
+                rpo.mRenderPass = renderPass;
+            }
+        }
+
+        rpo.mColorAttachments   = colorAttachments;
+        rpo.mResolveAttachments = resolveAttachments;
+        rpo.mDepthAttachment    = depthAttachment;
+        rpo.mAttachmentCount    = static_cast<uint32_t>(adVec.size());
+
+        result = createWindowFramebuffers(rpo, swapchain);
+        if (Result::eSuccess != result)
+            return result;
+
+        createSyncObjects(rpo);
+
+        // ImGuiを使用する場合はここで設定を行う
+        if (swapchain.useImGui)
+        {
+            std::cerr << "set up ImGui\n";
+            result = setUpImGui(swapchain, rpo);
+            if (Result::eSuccess != result)
+            {
+                return result;
+            }
+        }
+
+        handle_out = mNextRenderPassHandle++;
+        mRPMap.emplace(handle_out, rpo);
+
+        return Result::eSuccess;
+    }
+
+    Result Context::createRenderPass(const std::vector<HTexture>& colorTargets,
+                                     const HTexture& depthTarget,
+                                     const RenderPassInfo& info,
+                                     HRenderPass& handle_out)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        Result result;
+        RenderPassObject rpo;
+        rpo.mFrameBufferIndex = 0;
+        rpo.mDepthTestEnable  = true;
+        rpo.mLoadPrevData     = info.loadPrevFrame;
+
+        // without sampleCount, multisampled targets are rendered directly
+        if (info.sampleCount > 1)
+        {
+            result = getSampleCountFlag(info.sampleCount, true, rpo.mSampleCount);
+            if (Result::eSuccess != result)
+                return result;
+        }
+        else
+            rpo.mSampleCount = mImageMap[depthTarget].mSampleCount;
+
+        if (mDebugFlag)
+        {  // for debug mode
+            for (auto& tex : colorTargets)
+            {
+                if (mImageMap.count(tex) <= 0)
+                {
+                    std::cerr << "invalid texture handle\n";
+                    return Result::eFailure;
+                }
+                auto& io = mImageMap[tex];
+
+                // usage check
+                if (io.usage != TextureUsage::eColorTarget &&
+                    io.usage != TextureUsage::eUnordered)
+                {
+                    std::cerr << "invalid texture usage\n";
+                    return Result::eFailure;
+                }
+
+                // extent substitute and check
+                if (!rpo.mExtent)
+                    rpo.mExtent = io.extent;
+                if (rpo.mExtent.value().width != io.extent.width ||
+                    rpo.mExtent.value().height != io.extent.height ||
+                    rpo.mExtent.value().depth != io.extent.depth)
+                {
+                    std::cerr << "invalid color texture extent\n";
+                    return Result::eFailure;
+                }
+            }
+
+            if (mImageMap.count(depthTarget) <= 0)
+            {
+                std::cerr << "invalid texture handle\n";
+                return Result::eFailure;
+            }
+
+            auto& io = mImageMap[depthTarget];
+            if (io.usage != TextureUsage::eDepthStencilTarget)
+            {
+                std::cerr << "invalid texture usage!\n";
+                return Result::eFailure;
+            }
+
+            // extent substitute and check
+            if (!rpo.mExtent)
+                rpo.mExtent = io.extent;
+            if (rpo.mExtent.value().width != io.extent.width ||
+                rpo.mExtent.value().height != io.extent.height ||
+                rpo.mExtent.value().depth != io.extent.depth)
+            {
+                std::cerr << "invalid depth texture extent\n";
+                std::cerr << rpo.mExtent.value().width << " : "
+                          << rpo.mExtent.value().height << " : "
+                          << rpo.mExtent.value().depth << "\n";
+                std::cerr << io.extent.width << " : " << io.extent.height << " : "
+                          << io.extent.depth << "\n";
+                return Result::eFailure;
+            }
+        }
+
+        rpo.mHWindow           = std::nullopt;
+        rpo.colorTargets       = colorTargets;
+        rpo.depthTarget        = depthTarget;
+        rpo.mFramesInFlight    = info.framesInFlight;
+        rpo.mFrameColorTargets = info.frameColorTargets;
+        VkRenderPassCreateInfo ci{};
+        ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        std::vector<VkAttachmentDescription> adVec;
+
+        // Renderpass, Framebuffer
+        {
+            auto&& size = colorTargets.size();
+            for (size_t i = 0; i < size; ++i)
+            {
+                auto& io  = mImageMap[colorTargets[i]];
+                auto&& ad = adVec.emplace_back(VkAttachmentDescription{});
+
+                if (!rpo.mExtent)
+                    rpo.mExtent = io.extent;
+
+                AttachmentOps ops;
+                result = getColorOps(info, i, ops);
+                if (Result::eSuccess != result)
+                    return result;
+
+                ad.loadOp  = convertLoadOp(ops.load);
+                ad.storeOp = convertStoreOp(ops.store);
+
+                if (ops.load == LoadOp::eLoad)
+                {
+                    rpo.mLoadPrevData = true;
+
+                    switch (io.currentLayout)
+                    {
+                        case VK_IMAGE_LAYOUT_UNDEFINED:
+                        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+                            ad.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                            break;
+                        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+                            ad.initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                            break;
+                        default:
+                            std::cerr << "invalid initial image layout!\n";
+                            return Result::eFailure;
+                            break;
+                    }
+                }
+                else
+                {
+                    ad.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                }
+
+                // color targets are resolve targets of multisampled render pass
+                const VkSampleCountFlagBits samples = info.sampleCount > 1 ? VK_SAMPLE_COUNT_1_BIT : rpo.mSampleCount;
+                if (io.mSampleCount != samples)
+                {
+                    std::cerr << "sample count of render targets mismatch!\n";
+                    return Result::eFailure;
+                }
+
+                ad.format      = io.format;
+                ad.samples     = samples;
+                ad.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            }
+        }
+
+        auto&& depthAd    = adVec.emplace_back();
+        auto& depthBuffer = mImageMap[depthTarget];
+
+        const AttachmentOps depthOps =
+            info.depthOps ? info.depthOps.value()
+                          : AttachmentOps(info.loadPrevFrame ? LoadOp::eLoad : LoadOp::eClear);
+
+        if (depthOps.load == LoadOp::eLoad)
+        {
+            rpo.mLoadPrevData     = true;
+            depthAd.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        }
+        else
+        {
+            depthAd.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+
+        if (depthBuffer.mSampleCount != rpo.mSampleCount)
+        {
+            std::cerr << "depth target must have same sample count as render pass!\n";
+            return Result::eFailure;
+        }
+
+        depthAd.format      = depthBuffer.format;
+        depthAd.samples     = rpo.mSampleCount;
+        depthAd.loadOp      = convertLoadOp(depthOps.load);
+        depthAd.storeOp     = convertStoreOp(depthOps.store);
+        depthAd.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        std::vector<uint32_t> colorAttachments(colorTargets.size());
+        for (uint32_t i = 0; i < colorAttachments.size(); ++i)
+            colorAttachments[i] = i;
+
+        std::vector<uint32_t> resolveAttachments;
+        if (info.sampleCount > 1)
+        {
+            result = createMultiSampleAttachments(rpo, colorAttachments, adVec, resolveAttachments);
+            if (Result::eSuccess != result)
+                return result;
+        }
+
+        SubpassDescriptions sd;
+        {
+            // attach to last index
+            result = createSubpassDescriptions(info.subpasses, colorAttachments, resolveAttachments,
+                                               static_cast<uint32_t>(colorTargets.size()), sd);
+            if (Result::eSuccess != result)
+                return result;
+            rpo.mSubpassColorCounts = sd.colorCounts;
+        }
+
+        // frames in flight share the targets (always the depth one), so wait for attachment writes of the previous frame
+        {
+            auto& dep         = sd.deps.emplace_back();
+            dep.srcSubpass    = VK_SUBPASS_EXTERNAL;
+            dep.dstSubpass    = 0;
+            dep.srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            dep.dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+            dep.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            dep.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        }
+
+        ci.attachmentCount = static_cast<uint32_t>(adVec.size());
+        ci.pAttachments    = adVec.data();
+        ci.subpassCount    = static_cast<uint32_t>(sd.descs.size());
+        ci.pSubpasses      = sd.descs.data();
+        ci.dependencyCount = static_cast<uint32_t>(sd.deps.size());
+        ci.pDependencies   = sd.deps.empty() ? nullptr : sd.deps.data();
+
+        {
+            VkRenderPass renderPass;
+            result =
+                checkVkResult(vkCreateRenderPass(mDevice, &ci, nullptr, &renderPass));
+            if (Result::eSuccess != result)
+            {
+                return result;
+            }
+
+            rpo.mRenderPass = renderPass;
+        }
+
+        std::vector<VkImageView> ivVec(adVec.size());
+        {
+            for (size_t i = 0; i < colorTargets.size(); ++i)
+            {
+                if (resolveAttachments.empty())
+                {
+                    ivVec[i] = mImageMap[colorTargets[i]].mView.value();
+                    continue;
+                }
+
+                ivVec[i] = mImageMap[rpo.mMultiSampleTargets[i]].mView.value();
+                if (resolveAttachments[i] != VK_ATTACHMENT_UNUSED)
+                    ivVec[resolveAttachments[i]] = mImageMap[colorTargets[i]].mView.value();
+            }
+
+            // depth buffer
+            ivVec[colorTargets.size()] = depthBuffer.mView.value();
+        }
+
+        VkFramebufferCreateInfo fbci{};
+        fbci.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        fbci.renderPass      = rpo.mRenderPass.value();
+        fbci.width           = rpo.mExtent.value().width;
+        fbci.height          = rpo.mExtent.value().height;
+        fbci.layers          = 1;
+        fbci.attachmentCount = static_cast<uint32_t>(ivVec.size());
+        fbci.pAttachments    = ivVec.data();
+        rpo.mTargetNum       = static_cast<uint32_t>(colorTargets.size() + 1);
+
+        result = createOffscreenFramebuffers(rpo, ivVec, resolveAttachments, fbci);
+        if (Result::eSuccess != result)
+            return result;
+
+        createSyncObjects(rpo);
+
+        handle_out = mNextRenderPassHandle++;
+        mRPMap.emplace(handle_out, rpo);
+
+        return Result::eSuccess;
+    }
+
+    Result Context::createRenderPass(const std::vector<HTexture>& colorTargets,
+                                     const RenderPassInfo& info,
+                                     HRenderPass& handle_out)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        Result result;
+        RenderPassObject rpo;
+        rpo.mFrameBufferIndex = 0;
+        rpo.mDepthTestEnable  = false;
+        rpo.mLoadPrevData     = info.loadPrevFrame;
+
+        if (colorTargets.empty())
+        {
+            std::cerr << "render pass has no target!\n";
+            return Result::eFailure;
+        }
+
+        // without sampleCount, multisampled targets are rendered directly
+        if (info.sampleCount > 1)
+        {
+            result = getSampleCountFlag(info.sampleCount, false, rpo.mSampleCount);
+            if (Result::eSuccess != result)
+                return result;
+        }
+        else
+            rpo.mSampleCount = mImageMap[colorTargets.front()].mSampleCount;
+
+        if (mDebugFlag)
+        {
+            for (auto& tex : colorTargets)
+            {
+                if (mImageMap.count(tex) <= 0)
+                {
+                    std::cerr << "invalid texture handle!\n";
+                    return Result::eFailure;
+                }
+
+                auto& io = mImageMap[tex];
+
+                // usage check
+                if (io.usage != TextureUsage::eColorTarget &&
+                    io.usage != TextureUsage::eUnordered)
+                {
+                    std::cerr << "invalid texture usage!\n";
+                    return Result::eFailure;
+                }
+
+                // extent substitute and check
+                if (!rpo.mExtent)
+                {
+                    rpo.mExtent = io.extent;
+
+                    if (rpo.mExtent.value().width != io.extent.width ||
+                        rpo.mExtent.value().height != io.extent.height ||
+                        rpo.mExtent.value().depth != io.extent.depth)
+                    {
+                        std::cerr << "invalid texture extent!\n";
+                        return Result::eFailure;
+                    }
+                }
+            }
+        }
+
+        rpo.mHWindow           = std::nullopt;
+        rpo.colorTargets       = colorTargets;
+        rpo.mFramesInFlight    = info.framesInFlight;
+        rpo.mFrameColorTargets = info.frameColorTargets;
+
+        VkRenderPassCreateInfo ci{};
+        ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        std::vector<VkAttachmentDescription> adVec;
+        std::optional<HTexture> hDepthBuffer = std::nullopt;
+
+        // Renderpass, Framebuffer
+        {
+            const auto&& size = colorTargets.size();
+
+            adVec.reserve(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                const auto& io = mImageMap[colorTargets[i]];
+                auto&& ad      = adVec.emplace_back();
+
+                if (!rpo.mExtent)
+                    rpo.mExtent = io.extent;
+
+                // color targets are resolve targets of multisampled render pass
+                const VkSampleCountFlagBits samples = info.sampleCount > 1 ? VK_SAMPLE_COUNT_1_BIT : rpo.mSampleCount;
+                if (io.mSampleCount != samples)
+                {
+                    std::cerr << "sample count of render targets mismatch!\n";
+                    return Result::eFailure;
+                }
+
+                ad.format  = io.format;
+                ad.samples = samples;
+
+                AttachmentOps ops;
+                result = getColorOps(info, i, ops);
+                if (Result::eSuccess != result)
+                    return result;
+
+                ad.loadOp  = convertLoadOp(ops.load);
+                ad.storeOp = convertStoreOp(ops.store);
+
+                if (ops.load == LoadOp::eLoad)
+                {
+                    rpo.mLoadPrevData = true;
+
+                    switch (io.currentLayout)
+                    {
+                        case VK_IMAGE_LAYOUT_UNDEFINED:
+                        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+                            ad.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                            break;
+                        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+                            ad.initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                            break;
+                        default:
+                            std::cerr << "invalid initial image layout!\n";
+                            return Result::eFailure;
+                            break;
+                    }
+                }
+                else
+                {
+                    ad.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                }
+
+                ad.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            }
+        }
+
+        std::vector<uint32_t> colorAttachments(colorTargets.size());
+        for (uint32_t i = 0; i < colorAttachments.size(); ++i)
+            colorAttachments[i] = i;
+
+        std::vector<uint32_t> resolveAttachments;
+        if (info.sampleCount > 1)
+        {
+            result = createMultiSampleAttachments(rpo, colorAttachments, adVec, resolveAttachments);
+            if (Result::eSuccess != result)
+                return result;
+        }
+
+        SubpassDescriptions sd;
+        {
+            result = createSubpassDescriptions(info.subpasses, colorAttachments, resolveAttachments, std::nullopt, sd);
+            if (Result::eSuccess != result)
+                return result;
+            rpo.mSubpassColorCounts = sd.colorCounts;
+        }
+
+        rpo.mHWindow     = std::nullopt;
+        rpo.colorTargets = colorTargets;
+
+        std::array<VkSubpassDependency, 2> dependencies;
+        {
+            // frames in flight may share the targets, so wait for attachment writes of the previous frame
+            dependencies[0].srcSubpass   = VK_SUBPASS_EXTERNAL;
+            dependencies[0].dstSubpass   = 0;
+            dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            dependencies[0].dstStageMask =
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                                            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            dependencies[0].dependencyFlags = 0;
+
+            dependencies[1].srcSubpass = static_cast<uint32_t>(sd.descs.size() - 1);
+            dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+            dependencies[1].srcStageMask =
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            dependencies[1].dstStageMask  = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+            dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                                            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            dependencies[1].dstAccessMask   = VK_ACCESS_MEMORY_READ_BIT;
+            dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+        }
+
+        sd.deps.insert(sd.deps.end(), dependencies.begin(), dependencies.end());
+
+        ci.attachmentCount = static_cast<uint32_t>(adVec.size());
+        ci.pAttachments    = adVec.data();
+        ci.dependencyCount = static_cast<uint32_t>(sd.deps.size());
+        ci.pDependencies   = sd.deps.data();
+        ci.subpassCount    = static_cast<uint32_t>(sd.descs.size());
+        ci.pSubpasses      = sd.descs.data();
+
+        {
+            VkRenderPass renderPass;
+            result =
+                checkVkResult(vkCreateRenderPass(mDevice, &ci, nullptr, &renderPass));
+            if (Result::eSuccess != result)
+            {
+                return result;
+            }
+
+            rpo.mRenderPass = renderPass;
+        }
+
+        std::vector<VkImageView> ivVec(adVec.size());
+        {
+            for (size_t i = 0; i < colorTargets.size(); ++i)
+            {
+                if (resolveAttachments.empty())
+                {
+                    ivVec[i] = mImageMap[colorTargets[i]].mView.value();
+                    continue;
+                }
+
+                ivVec[i] = mImageMap[rpo.mMultiSampleTargets[i]].mView.value();
+                if (resolveAttachments[i] != VK_ATTACHMENT_UNUSED)
+                    ivVec[resolveAttachments[i]] = mImageMap[colorTargets[i]].mView.value();
+            }
+        }
+
+        VkFramebufferCreateInfo fbci{};
+        fbci.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        fbci.renderPass      = rpo.mRenderPass.value();
+        fbci.width           = rpo.mExtent.value().width;
+        fbci.height          = rpo.mExtent.value().height;
+        fbci.layers          = 1;
+        fbci.attachmentCount = static_cast<uint32_t>(ivVec.size());
+        fbci.pAttachments    = ivVec.data();
+        rpo.mTargetNum       = static_cast<uint32_t>(colorTargets.size());
+
+        result = createOffscreenFramebuffers(rpo, ivVec, resolveAttachments, fbci);
+        if (Result::eSuccess != result)
+            return result;
+
+        createSyncObjects(rpo);
+
+        handle_out = mNextRenderPassHandle++;
+        mRPMap.emplace(handle_out, rpo);
+
+        return Result::eSuccess;
+    }
+
+    Result Context::getColorOps(const RenderPassInfo& info, const size_t index, AttachmentOps& ops_out) const
+    {
+        if (info.colorOps.empty())
+        {
+            ops_out = AttachmentOps(info.loadPrevFrame ? LoadOp::eLoad : LoadOp::eClear);
+            return Result::eSuccess;
+        }
+
+        if (index >= info.colorOps.size())
+        {
+            std::cerr << "load/store ops are not specified for all color attachments!\n";
+            return Result::eFailure;
+        }
+
+        ops_out = info.colorOps[index];
+        return Result::eSuccess;
+    }
+
+    Result Context::createSubpassDescriptions(const std::vector<SubpassInfo>& subpasses,
+                                              const std::vector<uint32_t>& colorAttachments,
+                                              const std::vector<uint32_t>& resolveAttachments,
+                                              const std::optional<uint32_t>& depthAttachment,
+                                              SubpassDescriptions& sd_out)
+    {
+        std::vector<SubpassInfo> infos = subpasses;
+        if (infos.empty())
+        {  // single subpass writing all color targets
+            auto& info = infos.emplace_back();
+            for (uint32_t i = 0; i < colorAttachments.size(); ++i)
+                info.colorTargets.emplace_back(i);
+            info.useDepth = depthAttachment.has_value();
+        }
+
+        const size_t subpassCount = infos.size();
+        sd_out.colorRefs.assign(subpassCount, std::vector<VkAttachmentReference>());
+        sd_out.resolveRefs.assign(subpassCount, std::vector<VkAttachmentReference>());
+        sd_out.inputRefs.assign(subpassCount, std::vector<VkAttachmentReference>());
+        sd_out.preserves.assign(subpassCount, std::vector<uint32_t>());
+        sd_out.descs.assign(subpassCount, VkSubpassDescription{});
+        sd_out.deps.clear();
+        sd_out.colorCounts.clear();
+
+        if (depthAttachment)
+            sd_out.depthRef = VkAttachmentReference{depthAttachment.value(), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+
+        // first and last subpass using each color attachment
+        std::vector<std::pair<size_t, size_t>> usedRanges(colorAttachments.size(), {SIZE_MAX, 0});
+        // last subpass writing each color attachment, multisampled contents are resolved there
+        std::vector<size_t> lastWrites(colorAttachments.size(), SIZE_MAX);
+        const auto use = [&usedRanges](uint32_t index, size_t subpass)
+        {
+            usedRanges[index].first  = std::min(usedRanges[index].first, subpass);
+            usedRanges[index].second = std::max(usedRanges[index].second, subpass);
+        };
+
+        for (size_t i = 0; i < subpassCount; ++i)
+        {
+            const auto& info = infos[i];
+
+            for (const auto& index : info.colorTargets)
+            {
+                if (index >= colorAttachments.size())
+                {
+                    std::cerr << "invalid subpass color target index!\n";
+                    return Result::eFailure;
+                }
+
+                // feedback loop is not supported
+                if (std::find(info.inputTargets.begin(), info.inputTargets.end(), index) != info.inputTargets.end())
+                {
+                    std::cerr << "same attachment can not be written and read in a subpass!\n";
+                    return Result::eFailure;
+                }
+
+                sd_out.colorRefs[i].emplace_back(VkAttachmentReference{colorAttachments[index], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+                use(index, i);
+                lastWrites[index] = i;
+            }
+
+            for (const auto& index : info.inputTargets)
+            {
+                if (index >= colorAttachments.size())
+                {
+                    std::cerr << "invalid subpass input target index!\n";
+                    return Result::eFailure;
+                }
+
+                sd_out.inputRefs[i].emplace_back(VkAttachmentReference{colorAttachments[index], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+                use(index, i);
+            }
+
+            if (info.useDepth && !depthAttachment)
+            {
+                std::cerr << "subpass uses depth but render pass has no depth target!\n";
+                return Result::eFailure;
+            }
+        }
+
+        if (!resolveAttachments.empty())
+            for (size_t i = 0; i < subpassCount; ++i)
+                for (const auto& index : infos[i].colorTargets)
+                {
+                    const bool resolve = lastWrites[index] == i && resolveAttachments[index] != VK_ATTACHMENT_UNUSED;
+                    sd_out.resolveRefs[i].emplace_back(VkAttachmentReference{resolve ? resolveAttachments[index] : VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+                }
+
+        for (size_t i = 0; i < subpassCount; ++i)
+        {
+            // contents used by later subpasses must be preserved
+            for (uint32_t index = 0; index < colorAttachments.size(); ++index)
+            {
+                const auto& range = usedRanges[index];
+                if (range.first >= i || range.second <= i)
+                    continue;
+
+                const auto& colorTargets = infos[i].colorTargets;
+                const auto& inputTargets = infos[i].inputTargets;
+                if (std::find(colorTargets.begin(), colorTargets.end(), index) == colorTargets.end() &&
+                    std::find(inputTargets.begin(), inputTargets.end(), index) == inputTargets.end())
+                    sd_out.preserves[i].emplace_back(colorAttachments[index]);
+            }
+
+            auto& desc                   = sd_out.descs[i];
+            desc.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+            desc.colorAttachmentCount    = static_cast<uint32_t>(sd_out.colorRefs[i].size());
+            desc.pColorAttachments       = sd_out.colorRefs[i].empty() ? nullptr : sd_out.colorRefs[i].data();
+            desc.pResolveAttachments     = sd_out.resolveRefs[i].empty() ? nullptr : sd_out.resolveRefs[i].data();
+            desc.inputAttachmentCount    = static_cast<uint32_t>(sd_out.inputRefs[i].size());
+            desc.pInputAttachments       = sd_out.inputRefs[i].empty() ? nullptr : sd_out.inputRefs[i].data();
+            desc.preserveAttachmentCount = static_cast<uint32_t>(sd_out.preserves[i].size());
+            desc.pPreserveAttachments    = sd_out.preserves[i].empty() ? nullptr : sd_out.preserves[i].data();
+            desc.pDepthStencilAttachment = infos[i].useDepth ? &sd_out.depthRef.value() : nullptr;
+
+            sd_out.colorCounts.emplace_back(desc.colorAttachmentCount);
+
+            if (i == 0)
+                continue;
+
+            // outputs of the previous subpass are read at the same pixel, so the dependency is by region
+            auto& dep           = sd_out.deps.emplace_back();
+            dep.srcSubpass      = static_cast<uint32_t>(i - 1);
+            dep.dstSubpass      = static_cast<uint32_t>(i);
+            dep.srcStageMask    = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            dep.dstStageMask    = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            dep.srcAccessMask   = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            dep.dstAccessMask   = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                  VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            dep.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+        }
+
+        return Result::eSuccess;
+    }
+
+    Result Context::getSampleCountFlag(const uint32_t sampleCount, const bool depth, VkSampleCountFlagBits& flag_out) const
+    {
+        switch (sampleCount)
+        {
+            case 1:
+                flag_out = VK_SAMPLE_COUNT_1_BIT;
+                return Result::eSuccess;
+            case 2:
+                flag_out = VK_SAMPLE_COUNT_2_BIT;
+                break;
+            case 4:
+                flag_out = VK_SAMPLE_COUNT_4_BIT;
+                break;
+            case 8:
+                flag_out = VK_SAMPLE_COUNT_8_BIT;
+                break;
+            case 16:
+                flag_out = VK_SAMPLE_COUNT_16_BIT;
+                break;
+            case 32:
+                flag_out = VK_SAMPLE_COUNT_32_BIT;
+                break;
+            case 64:
+                flag_out = VK_SAMPLE_COUNT_64_BIT;
+                break;
+            default:
+                std::cerr << "sample count must be power of 2 (up to 64)!\n";
+                return Result::eFailure;
+                break;
+        }
+
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(mPhysDev, &props);
+        // depth (and color) attachments of a render pass must have same sample count
+        VkSampleCountFlags supported = props.limits.framebufferColorSampleCounts;
+        if (depth)
+            supported &= props.limits.framebufferDepthSampleCounts;
+
+        if (!(supported & flag_out))
+        {
+            std::cerr << "sample count " << sampleCount << " is not supported by this device!\n";
+            return Result::eFailure;
+        }
+
+        return Result::eSuccess;
+    }
+
+    Result Context::createMultiSampleTarget(const VkExtent3D& extent, const VkFormat format,
+                                            const VkSampleCountFlagBits samples, const bool depth,
+                                            HTexture& handle_out)
+    {
+        Result result;
+        ImageObject io;
+
+        {
+            VkImageCreateInfo ci{};
+            ci.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            ci.pNext         = nullptr;
+            ci.imageType     = VK_IMAGE_TYPE_2D;
+            ci.format        = format;
+            ci.extent        = {extent.width, extent.height, 1};
+            ci.mipLevels     = 1;
+            ci.arrayLayers   = 1;
+            ci.samples       = samples;
+            ci.tiling        = VK_IMAGE_TILING_OPTIMAL;
+            ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            // contents never leave the render pass
+            ci.usage = (depth ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT) |
+                       VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+            io.format         = ci.format;
+            io.extent         = ci.extent;
+            io.mSizeOfChannel = 0;
+
+            VkImage image;
+            result = checkVkResult(vkCreateImage(mDevice, &ci, nullptr, &image));
+            if (Result::eSuccess != result)
+            {
+                std::cerr << "failed to create multisampled image!\n";
+                return result;
+            }
+
+            io.mImage = image;
+        }
+
+        {
+            VkMemoryRequirements reqs;
+            vkGetImageMemoryRequirements(mDevice, io.mImage.value(), &reqs);
+            VkMemoryAllocateInfo ai{};
+            ai.sType          = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            ai.allocationSize = reqs.size;
+            // tile based GPU does not commit physical memory for lazily allocated memory
+            ai.memoryTypeIndex = getMemoryTypeIndex(reqs.memoryTypeBits, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+            if (!(mPhysMemProps.memoryTypes[ai.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT))
+                ai.memoryTypeIndex = getMemoryTypeIndex(reqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            VkDeviceMemory memory;
+            result = checkVkResult(allocateMemory(ai, memory));
+            if (Result::eSuccess != result)
+            {
+                std::cerr << "failed to allocate multisampled image memory!\n";
+                return result;
+            }
+
+            io.mMemory = memory;
+
+            result = checkVkResult(vkBindImageMemory(mDevice, io.mImage.value(), io.mMemory.value(), 0));
+            if (Result::eSuccess != result)
+                return result;
+        }
+
+        io.range = {depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+        {
+            VkImageViewCreateInfo ci{};
+            ci.sType      = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            ci.image      = io.mImage.value();
+            ci.viewType   = VK_IMAGE_VIEW_TYPE_2D;
+            ci.format     = io.format;
+            ci.components = {
+                VK_COMPONENT_SWIZZLE_R,
+                VK_COMPONENT_SWIZZLE_G,
+                VK_COMPONENT_SWIZZLE_B,
+                VK_COMPONENT_SWIZZLE_A,
+            };
+            ci.subresourceRange = io.range;
+
+            VkImageView imageView;
+            result = checkVkResult(vkCreateImageView(mDevice, &ci, nullptr, &imageView));
+            if (Result::eSuccess != result)
+            {
+                std::cerr << "failed to create vkImageView!\n";
+                return result;
+            }
+
+            io.mView = imageView;
+        }
+
+        // always used with undefined initial layout in the render pass
+        io.currentLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        io.usage          = depth ? TextureUsage::eDepthStencilTarget : TextureUsage::eColorTarget;
+        io.mIsHostVisible = false;
+        io.mIsSampled     = false;
+        io.mSampleCount   = samples;
+
+        handle_out = mNextTextureHandle++;
+        mImageMap.emplace(handle_out, io);
+
+        return Result::eSuccess;
+    }
+
+    Result Context::createMultiSampleAttachments(RenderPassObject& rpo, const std::vector<uint32_t>& colorAttachments,
+                                                 std::vector<VkAttachmentDescription>& adVec,
+                                                 std::vector<uint32_t>& resolveAttachments_out)
+    {
+        Result result = Result::eSuccess;
+
+        resolveAttachments_out.clear();
+        rpo.mMultiSampleTargets.clear();
+
+        for (const auto& attachment : colorAttachments)
+        {
+            // previous contents can not be loaded into transient attachment
+            if (adVec[attachment].loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+            {
+                std::cerr << "multisampled render pass can not load previous contents (use eClear or eDontCare)!\n";
+                return Result::eFailure;
+            }
+
+            // original attachment receives the resolved result only if it is stored
+            if (adVec[attachment].storeOp == VK_ATTACHMENT_STORE_OP_STORE)
+            {
+                VkAttachmentDescription resolveAd = adVec[attachment];
+                resolveAd.loadOp                  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+                resolveAd.initialLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+                adVec.emplace_back(resolveAd);
+                resolveAttachments_out.emplace_back(static_cast<uint32_t>(adVec.size() - 1));
+            }
+            else
+                resolveAttachments_out.emplace_back(VK_ATTACHMENT_UNUSED);
+
+            auto& ad         = adVec[attachment];
+            ad.samples       = rpo.mSampleCount;
+            ad.storeOp       = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            ad.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            ad.finalLayout   = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+            HTexture handle;
+            result = createMultiSampleTarget(rpo.mExtent.value(), ad.format, rpo.mSampleCount, false, handle);
+            if (Result::eSuccess != result)
+                return result;
+
+            rpo.mMultiSampleTargets.emplace_back(handle);
+        }
+
+        return result;
+    }
+
+    Result Context::createSyncObjects(RenderPassObject& rpo)
+    {
+        Result result = Result::eSuccess;
+
+        uint32_t maxFramesInFlight = rpo.mFramesInFlight;
+        uint32_t maxFrameNum       = rpo.mFramesInFlight;
+        if (rpo.mHWindow)
+        {
+            auto& wo          = mWindowMap[rpo.mHWindow.value()];
+            maxFramesInFlight = wo.mMaxFrameInFlight;
+            maxFrameNum       = wo.mMaxFrameNum;
+        }
+
+        // window frames are waited on the graphics timeline (several windows are submitted at once),
+        // offscreen executions are waited by the fences of each command buffer
+        rpo.mFrameSignalValues.assign(rpo.mHWindow ? maxFramesInFlight : 0, 0);
+
+        rpo.mPresentCompletedSems.resize(maxFramesInFlight);
+        rpo.mRenderCompletedSems.resize(maxFramesInFlight);
+
+        {
+            VkSemaphoreCreateInfo ci{};
+            ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            for (size_t i = 0; i < maxFramesInFlight; ++i)
+            {
+                result = checkVkResult(vkCreateSemaphore(mDevice, &ci, nullptr,
+                                                         &rpo.mRenderCompletedSems[i]));
+                if (Result::eSuccess != result)
+                {
+                    std::cerr << "Failed to create render completed semaphore!\n";
+                    return result;
+                }
+            }
+
+            for (size_t i = 0; i < maxFramesInFlight; ++i)
+            {
+                result = checkVkResult(vkCreateSemaphore(mDevice, &ci, nullptr,
+                                                         &rpo.mPresentCompletedSems[i]));
+                if (Result::eSuccess != result)
+                {
+                    std::cerr << "Failed to create present completed semaphore!\n";
+                    return result;
+                }
+            }
+        }
+
+        rpo.imagesInFlight.resize(maxFrameNum, 0);
+
+        return result;
+    }
+
+    Result Context::createOffscreenFramebuffers(RenderPassObject& rpo, std::vector<VkImageView> ivVec, const std::vector<uint32_t>& resolveAttachments, VkFramebufferCreateInfo fbci)
+    {
+        const size_t frameCount = rpo.mFrameColorTargets.empty() ? 1 : rpo.mFrameColorTargets.size();
+        for (size_t frame = 0; frame < frameCount; ++frame)
+        {
+            // color targets are resolve targets of multisampled render pass
+            const auto& targets = getFrameColorTargets(rpo, frame);
+            for (size_t i = 0; i < targets.size(); ++i)
+            {
+                const VkImageView view = mImageMap[targets[i]].mView.value();
+                if (resolveAttachments.empty())
+                    ivVec[i] = view;
+                else if (resolveAttachments[i] != VK_ATTACHMENT_UNUSED)
+                    ivVec[resolveAttachments[i]] = view;
+            }
+
+            fbci.pAttachments = ivVec.data();
+
+            VkFramebuffer frameBuffer;
+            const Result result = checkVkResult(vkCreateFramebuffer(mDevice, &fbci, nullptr, &frameBuffer));
+            if (Result::eSuccess != result)
+            {
+                std::cerr << "Failed to create frame buffer!\n";
+                return result;
+            }
+            rpo.mFramebuffers.emplace_back(frameBuffer);
+        }
+
+        return Result::eSuccess;
+    }
+
+    const std::vector<HTexture>& Context::getFrameColorTargets(const RenderPassObject& rpo, const size_t frameBufferIndex) const
+    {
+        if (rpo.mFrameColorTargets.empty())
+            return rpo.colorTargets;
+
+        return rpo.mFrameColorTargets[frameBufferIndex % rpo.mFrameColorTargets.size()];
+    }
+
+    Result Context::createGraphicsPipeline(const GraphicsPipelineInfo& info,
+                                           HGraphicsPipeline& handle_out)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        TraceScope trace(mTracer, "createGraphicsPipeline");
+
+        Result result;
+        GraphicsPipelineObject gpo;
+
+        RenderPassObject& rpo = mRPMap[info.renderPass];
+        gpo.mHRenderPass      = info.renderPass;
+        gpo.mVS               = info.VS;
+        gpo.mFS               = info.FS;
+
+        if (info.subpass >= rpo.mSubpassColorCounts.size())
+        {
+            std::cerr << "invalid subpass index!\n";
+            return Result::eFailure;
+        }
+
+        {
+            VkVertexInputBindingDescription ib;
+
+            std::vector<VkVertexInputAttributeDescription> ia_vec;
+
+            VkPipelineVertexInputStateCreateInfo visci{};
+            const auto& inputVariables = info.VS.getInputVariables();
+            if (!inputVariables.empty())
+            {
+                {
+                    ib.binding   = 0;
+                    ib.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+                }
+
+                {
+                    // if (inputVariables.size() == 0)
+                    // {
+                    //     std::cerr << "invalid vertex layout size!\n";
+                    //     return Result::eFailure;
+                    // }
+
+                    uint32_t offset = 0;
+                    for (size_t i = 0; i < inputVariables.size(); ++i)
+                    {
+                        ia_vec.emplace_back();
+                        ia_vec.back().binding  = 0;
+                        ia_vec.back().location = static_cast<uint32_t>(i);
+                        ia_vec.back().offset   = offset;
+
+                        switch (inputVariables[i].first)
+                        {
+                            case ResourceType::eUnorm:
+                                ia_vec.back().format = VK_FORMAT_R8_UNORM;
+                                offset += 1;
+                                break;
+                            case ResourceType::eFloat32:
+                                ia_vec.back().format = VK_FORMAT_R32_SFLOAT;
+                                offset += 4;
+                                break;
+                            case ResourceType::eUint32:
+                                ia_vec.back().format = VK_FORMAT_R32_UINT;
+                                offset += 4;
+                                break;
+                            case ResourceType::eInt32:
+                                ia_vec.back().format = VK_FORMAT_R32_SINT;
+                                offset += 4;
+                                break;
+
+                            case ResourceType::eUNormVec2:
+                                ia_vec.back().format = VK_FORMAT_R8G8_UNORM;
+                                offset += 2;
+                                break;
+                            case ResourceType::eF32Vec2:
+                                ia_vec.back().format = VK_FORMAT_R32G32_SFLOAT;
+                                offset += 8;
+                                break;
+                            case ResourceType::eU32Vec2:
+                                ia_vec.back().format = VK_FORMAT_R32G32_UINT;
+                                offset += 8;
+                                break;
+                            case ResourceType::eS32Vec2:
+                                ia_vec.back().format = VK_FORMAT_R32G32_SINT;
+                                offset += 8;
+                                break;
+
+                            case ResourceType::eUNormVec3:
+                                ia_vec.back().format = VK_FORMAT_R8G8B8_UNORM;
+                                offset += 3;
+                                break;
+                            case ResourceType::eF32Vec3:
+                                ia_vec.back().format = VK_FORMAT_R32G32B32_SFLOAT;
+                                offset += 12;
+                                break;
+                            case ResourceType::eU32Vec3:
+                                ia_vec.back().format = VK_FORMAT_R32G32B32_UINT;
+                                offset += 12;
+                                break;
+                            case ResourceType::eS32Vec3:
+                                ia_vec.back().format = VK_FORMAT_R32G32B32_SINT;
+                                offset += 12;
+                                break;
+
+                            case ResourceType::eUNormVec4:
+                                ia_vec.back().format = VK_FORMAT_R8G8B8A8_UNORM;
+                                offset += 4;
+                                break;
+                            case ResourceType::eF32Vec4:
+                                ia_vec.back().format = VK_FORMAT_R32G32B32A32_SFLOAT;
+                                offset += 16;
+                                break;
+                            case ResourceType::eU32Vec4:
+                                ia_vec.back().format = VK_FORMAT_R32G32B32A32_UINT;
+                                offset += 16;
+                                break;
+                            case ResourceType::eS32Vec4:
+                                ia_vec.back().format = VK_FORMAT_R32G32B32A32_SINT;
+                                offset += 16;
+                                break;
+                            default:
+                                std::cerr << "Vertex resource type (" << i
+                                          << ") is not described\n";
+                                return Result::eFailure;
+                                break;
+                        }
+                    }
+
+                    ib.stride = offset;
+                }
+
+                {
+                    visci.sType                         = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+                    visci.pNext                         = nullptr;
+                    visci.vertexBindingDescriptionCount = 1;
+                    visci.pVertexBindingDescriptions    = &ib;
+                    visci.vertexAttributeDescriptionCount =
+                        static_cast<uint32_t>(ia_vec.size());
+                    visci.pVertexAttributeDescriptions = ia_vec.data();
+                }
+            }
+            else  // vertex input state
+            {
+                visci.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+                visci.pNext                           = nullptr;
+                visci.vertexBindingDescriptionCount   = 0;
+                visci.pVertexBindingDescriptions      = nullptr;
+                visci.vertexAttributeDescriptionCount = 0;
+                visci.pVertexAttributeDescriptions    = nullptr;
+            }
+
+            // std::cerr << "vertex input\n";
+
+            // color blend
+            std::vector<VkPipelineColorBlendAttachmentState> blendAttachments;
+            blendAttachments.reserve(rpo.colorTargets.size() + 1);
+            VkPipelineColorBlendStateCreateInfo cbci{};
+            cbci.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+
+            {
+                // only color attachments written by the subpass
+                auto&& size = rpo.mSubpassColorCounts[info.subpass];
+                for (size_t i = 0; i < size; ++i)
+                {
+                    auto&& blendAttachment = blendAttachments.emplace_back();
+
+                    const auto colorWriteAll =
+                        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                        VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+                    switch (info.colorBlend)
+                    {
+                        case ColorBlend::eNone:
+                            blendAttachment.blendEnable = VK_FALSE;
+                            break;
+
+                        case ColorBlend::eDefault:
+                            blendAttachment.blendEnable         = VK_TRUE;
+                            blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                            blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+                            blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                            blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+                            blendAttachment.alphaBlendOp        = VK_BLEND_OP_ADD;
+                            blendAttachment.colorBlendOp        = VK_BLEND_OP_ADD;
+                            blendAttachment.colorWriteMask      = colorWriteAll;
+                            break;
+
+                        case ColorBlend::eAlphaBlend:
+                            blendAttachment.blendEnable         = VK_TRUE;
+                            blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+                            blendAttachment.dstColorBlendFactor =
+                                VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                            blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                            blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+                            blendAttachment.colorBlendOp        = VK_BLEND_OP_ADD;
+                            blendAttachment.alphaBlendOp        = VK_BLEND_OP_ADD;
+                            blendAttachment.colorWriteMask      = colorWriteAll;
+                            break;
+
+                        default:
+                            std::cerr << "color blend state is not described\n";
+                            return Result::eFailure;
+                            break;
+                    }
+
+                    cbci.sType           = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+                    cbci.logicOpEnable   = VK_FALSE;
+                    cbci.logicOp         = VK_LOGIC_OP_COPY;
+                    cbci.attachmentCount = blendAttachments.size();
+                    cbci.pAttachments    = blendAttachments.data();
+                }
+            }
+
+            // viewport and scissor
+            VkPipelineViewportStateCreateInfo vpsci{};
+            VkViewport viewport{};
+            VkRect2D scissor{};
+            {
+                if (info.viewport)
+                {
+                    viewport.x        = info.viewport.value()[0][0];
+                    viewport.y        = info.viewport.value()[0][1];
+                    viewport.minDepth = info.viewport.value()[0][2];
+
+                    viewport.width    = info.viewport.value()[1][0];
+                    viewport.height   = info.viewport.value()[1][1];
+                    viewport.maxDepth = info.viewport.value()[1][2];
+                    gpo.mViewport     = viewport;
+                }
+                else
+                {
+                    const VkExtent3D& extent = rpo.mExtent.value();
+                    viewport.x               = 0;
+                    viewport.y               = 0;
+                    viewport.width           = static_cast<float>(extent.width);
+                    viewport.height          = static_cast<float>(extent.height);
+                    viewport.minDepth        = 0;
+                    viewport.maxDepth        = static_cast<float>(extent.depth);
+                }
+
+                if (info.scissor)
+                {
+                    scissor.offset.x = static_cast<int32_t>(info.scissor.value()[0][0]);
+                    scissor.offset.y = static_cast<int32_t>(info.scissor.value()[0][1]);
+                    scissor.extent   = {static_cast<uint32_t>(info.scissor.value()[1][0]),
+                                      static_cast<uint32_t>(info.scissor.value()[1][1])};
+                    gpo.mScissor     = scissor;
+                }
+                else
+                {
+                    scissor.offset = {0, 0};
+                    scissor.extent = {rpo.mExtent.value().width,
+                                      rpo.mExtent.value().height};
+                }
+
+                vpsci.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+                vpsci.viewportCount = 1;
+                vpsci.pViewports    = &viewport;
+                vpsci.scissorCount  = 1;
+                vpsci.pScissors     = &scissor;
+            }
+
+            // set when bound, so that pipelines survive resizing of the window
+            const std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+            VkPipelineDynamicStateCreateInfo dyci{};
+            dyci.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+            dyci.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+            dyci.pDynamicStates    = dynamicStates.data();
+
+            // std::cerr << "color and viewport\n";
+
+            // input assembly
+            VkPipelineInputAssemblyStateCreateInfo iaci{};
+            {
+                iaci.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+                switch (info.topology)
+                {
+                    case Topology::eTriangleList:
+                        iaci.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+                        break;
+                    case Topology::eTriangleStrip:
+                        iaci.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+                        break;
+                    case Topology::eTriangleFan:
+                        iaci.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN;
+                        break;
+                    default:
+                        std::cerr << "primitive topology is not described\n";
+                        return Result::eFailure;
+                        break;
+                }
+            }
+
+            // rasterization
+            VkPipelineRasterizationStateCreateInfo rci{};
+            {
+                rci.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+                switch (info.rasterizerState.polygonMode)
+                {
+                    case PolygonMode::eFill:
+                        rci.polygonMode = VK_POLYGON_MODE_FILL;
+                        break;
+                    case PolygonMode::eLine:
+                        rci.polygonMode = VK_POLYGON_MODE_LINE;
                         break;
                     case PolygonMode::ePoint:
                         rci.polygonMode = VK_POLYGON_MODE_POINT;
@@ -3372,1673 +7370,3065 @@ namespace Cutlass
                         break;
                 }
 
-                switch (info.rasterizerState.cullMode)
+                switch (info.rasterizerState.cullMode)
+                {
+                    case CullMode::eNone:
+                        rci.cullMode = VK_CULL_MODE_NONE;
+                        break;
+                    case CullMode::eBack:
+                        rci.cullMode = VK_CULL_MODE_BACK_BIT;
+                        break;
+                    case CullMode::eFront:
+                        rci.cullMode = VK_CULL_MODE_FRONT_BIT;
+                        break;
+                    default:
+                        std::cerr << "invalid culling mode!\n";
+                        return Result::eFailure;
+                        break;
+                }
+
+                switch (info.rasterizerState.frontFace)
+                {
+                    case FrontFace::eClockwise:
+                        rci.frontFace = VK_FRONT_FACE_CLOCKWISE;
+                        break;
+                    case FrontFace::eCounterClockwise:
+                        rci.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+                        break;
+                    default:
+                        std::cerr << "invalid front face mode!\n";
+                        return Result::eFailure;
+                        break;
+                }
+
+                rci.lineWidth = info.rasterizerState.lineWidth;
+            }
+
+            // multi sampling
+            VkPipelineMultisampleStateCreateInfo msci{};
+            {
+                msci.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+                switch (info.multiSampleState)
+                {
+                    case MultiSampleState::eDefault:
+                        msci.rasterizationSamples = rpo.mSampleCount;
+                        break;
+                    case MultiSampleState::eMSAA2:
+                        msci.rasterizationSamples = VK_SAMPLE_COUNT_2_BIT;
+                        break;
+                    case MultiSampleState::eMSAA4:
+                        msci.rasterizationSamples = VK_SAMPLE_COUNT_4_BIT;
+                        break;
+                    case MultiSampleState::eMSAA8:
+                        msci.rasterizationSamples = VK_SAMPLE_COUNT_8_BIT;
+                        break;
+                    default:
+                        std::cerr << "multisampling state is not described\n";
+                        return Result::eFailure;
+                        break;
+                }
+
+                if (msci.rasterizationSamples != rpo.mSampleCount)
+                {
+                    std::cerr << "sample count of pipeline and render pass mismatch!\n";
+                    return Result::eFailure;
+                }
+            }
+
+            // std::cerr << "multi sample topology rasterizer state\n";
+
+            // depth stencil
+            VkPipelineDepthStencilStateCreateInfo dsci{};
+            {
+                dsci.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+                switch (info.depthStencilState)
+                {
+                    case DepthStencilState::eNone:
+                        dsci.depthTestEnable = dsci.stencilTestEnable = VK_FALSE;
+                        dsci.depthWriteEnable                         = VK_FALSE;
+                        break;
+                    case DepthStencilState::eDepth:
+                        dsci.depthTestEnable       = VK_TRUE;
+                        dsci.depthWriteEnable      = VK_TRUE;
+                        dsci.stencilTestEnable     = VK_FALSE;
+                        dsci.depthCompareOp        = VK_COMPARE_OP_LESS;
+                        dsci.depthBoundsTestEnable = VK_FALSE;
+                        break;
+                    case DepthStencilState::eStencil:
+                        dsci.depthTestEnable       = VK_FALSE;
+                        dsci.depthWriteEnable      = VK_FALSE;
+                        dsci.stencilTestEnable     = VK_TRUE;
+                        dsci.depthCompareOp        = VK_COMPARE_OP_LESS;
+                        dsci.depthBoundsTestEnable = VK_FALSE;
+                        break;
+                    case DepthStencilState::eBoth:
+                        dsci.depthTestEnable = dsci.stencilTestEnable = VK_TRUE;
+                        dsci.depthWriteEnable                         = VK_TRUE;
+                        break;
+                    default:
+                        std::cerr << "depth stencil state is not described\n";
+                        return Result::eFailure;
+                        break;
+                }
+            }
+            std::array<VkPipelineShaderStageCreateInfo, 2> ssciArr{};
+            result =
+                createShaderModule(info.VS, VK_SHADER_STAGE_VERTEX_BIT, &ssciArr[0]);
+            if (Result::eSuccess != result)
+            {
+                std::cerr << "Failed to create vertex shader module!\n";
+                return Result::eFailure;
+            }
+            result =
+                createShaderModule(info.FS, VK_SHADER_STAGE_FRAGMENT_BIT, &ssciArr[1]);
+            if (Result::eSuccess != result)
+            {
+                std::cerr << "Failed to create fragment shader module!\n";
+                return Result::eFailure;
+            }
+
+            auto layoutTable = info.VS.getLayoutTable();
+            {  // integrate VS and FS layout
+                auto fsLayoutTable = info.FS.getLayoutTable();
+                layoutTable.merge(fsLayoutTable);
+            }
+
+            if (mDebugFlag)
+            {
+                for (const auto& p : layoutTable)
+                {
+                    std::cerr << "set: " << static_cast<int>(p.first.first)
+                              << ", binding: " << static_cast<int>(p.first.second) << "\n";
+
+                    switch (p.second)
+                    {
+                        case Shader::ShaderResourceType::eUniformBuffer:
+                            std::cerr << " UniformBuffer\n";
+                            break;
+                        case Shader::ShaderResourceType::eCombinedTexture:
+                            std::cerr << " CombinedTexture\n";
+                            break;
+                        case Shader::ShaderResourceType::eSampler:
+                            std::cerr << " sampler\n";
+                            break;
+                        case Shader::ShaderResourceType::eStorageTexture:
+                            std::cerr << " StorageTexture\n";
+                            break;
+                        case Shader::ShaderResourceType::eInputAttachment:
+                            std::cerr << " InputAttachment\n";
+                            break;
+                    }
+                }
+            }
+
+            uint32_t ubcount = 0;
+            uint32_t ctcount = 0;
+            {  // DescriptorSetLayout
+
+                std::vector<std::vector<VkDescriptorSetLayoutBinding>> allBindings;
+                allBindings.reserve(8);
+                {  // HACK
+                    uint32_t nowSet = UINT32_MAX;
+                    for (const auto& [sb, srt] : layoutTable)
+                    {
+                        if (sb.first != nowSet)
+                        {
+                            allBindings.emplace_back();
+                            nowSet = sb.first;
+                        }
+
+                        auto&& b          = allBindings.back().emplace_back();
+                        b.binding         = sb.second;
+                        b.descriptorCount = 1;
+                        switch (srt)
+                        {
+                            case Shader::ShaderResourceType::eUniformBuffer:
+                                b.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                                ++ubcount;
+                                break;
+
+                            case Shader::ShaderResourceType::eCombinedTexture:
+                                b.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                                ++ctcount;
+                                break;
+
+                            case Shader::ShaderResourceType::eSampler:
+                                assert(!"not supported");
+                                break;
+
+                            case Shader::ShaderResourceType::eStorageTexture:
+                                b.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                                ++ctcount;
+                                break;
+
+                            case Shader::ShaderResourceType::eInputAttachment:
+                                b.descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                                ++ctcount;
+                                break;
+                        }
+
+                        b.pImmutableSamplers = nullptr;
+                        // input attachments are readable only from fragment shader
+                        b.stageFlags = srt == Shader::ShaderResourceType::eInputAttachment ? VK_SHADER_STAGE_FRAGMENT_BIT : VK_SHADER_STAGE_ALL;
+                    }
+                }
+
+                VkDescriptorSetLayoutCreateInfo descLayoutci{};
+                descLayoutci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+                for (auto& bindings : allBindings)
+                {
+                    descLayoutci.bindingCount = static_cast<uint32_t>(bindings.size());
+                    descLayoutci.pBindings    = bindings.data();
+
+                    {
+                        VkDescriptorSetLayout descriptorSetLayout;
+                        result = checkVkResult(vkCreateDescriptorSetLayout(
+                            mDevice, &descLayoutci, nullptr, &descriptorSetLayout));
+                        if (result != Result::eSuccess)
+                        {
+                            std::cerr << "failed to create descriptor set layout\n";
+                            return result;
+                        }
+
+                        gpo.mDescriptorSetLayouts.emplace_back(descriptorSetLayout);
+                        gpo.mSetSizes.emplace_back(bindings.size());
+                    }
+                }
+            }
+
+            // if (layoutTable.size() > 0)
+            //{ //DescriptorPool
+            //    std::vector<VkDescriptorPoolSize> sizes;
+            //    sizes.reserve(ubcount + ctcount);
+
+            //    if(ubcount > 0)
+            //    {
+            //        sizes.emplace_back();
+            //        sizes.back().descriptorCount = ubcount * mMaxFrame;//here
+            //        sizes.back().type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            //    }
+
+            //    if(ctcount > 0)
+            //    {
+            //        sizes.emplace_back();
+            //        sizes.back().descriptorCount = ctcount * mMaxFrame;//here
+            //        PART2 sizes.back().type =
+            //        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            //    }
+            //
+            //    VkDescriptorPoolCreateInfo dpci{};
+            //    dpci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            //    dpci.flags =
+            //    VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+
+            //    dpci.maxSets = layoutTable.size() * mMaxFrame;
+            //
+            //    dpci.poolSizeCount = static_cast<uint32_t>(sizes.size());
+            //    dpci.pPoolSizes = sizes.data();
+            //    {
+            //        VkDescriptorPool descriptorPool;
+            //        result = checkVkResult(vkCreateDescriptorPool(mDevice,
+            //        &dpci, nullptr, &descriptorPool)); if (result !=
+            //        Result::eSuccess)
+            //        {
+            //            std::cerr << "failed to create Descriptor Pool\n";
+            //            return result;
+            //        }
+            //        gpo.mDescriptorPool = descriptorPool;
+            //    }
+            //}
+
+            {  // pipeline layout
+                VkPipelineLayoutCreateInfo ci{};
+                ci.sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+                ci.setLayoutCount = gpo.mDescriptorSetLayouts.size();
+                // VkDescriptorSetLayout dslayout =
+                // gpo.mDescriptorSetLayout.value();
+                ci.pSetLayouts = gpo.mDescriptorSetLayouts.data();
+
+                {
+                    VkPipelineLayout pipelineLayout;
+                    result = checkVkResult(
+                        vkCreatePipelineLayout(mDevice, &ci, nullptr, &pipelineLayout));
+                    if (result != Result::eSuccess)
+                    {
+                        std::cerr << "failed to create pipeline layout\n";
+                        return result;
+                    }
+
+                    gpo.mPipelineLayout = pipelineLayout;
+                }
+            }
+
+            {  // graphics pipeline layout
+                VkGraphicsPipelineCreateInfo ci{};
+                ci.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+                ci.stageCount          = static_cast<uint32_t>(ssciArr.size());
+                ci.pStages             = ssciArr.data();
+                ci.pInputAssemblyState = &iaci;
+                ci.pVertexInputState   = &visci;
+                ci.pRasterizationState = &rci;
+                ci.pDepthStencilState  = &dsci;
+                ci.pMultisampleState   = &msci;
+                ci.pViewportState      = &vpsci;
+                ci.pColorBlendState    = &cbci;
+                ci.pDynamicState       = &dyci;
+                ci.renderPass          = rpo.mRenderPass.value();
+                ci.subpass             = info.subpass;
+                ci.layout              = gpo.mPipelineLayout.value();
+                {
+                    VkPipeline pipeline;
+                    result = checkVkResult(vkCreateGraphicsPipelines(
+                        mDevice, VK_NULL_HANDLE, 1, &ci, nullptr, &pipeline));
+                    if (result != Result::eSuccess)
+                    {
+                        std::cerr << "failed to create graphics pipeline\n";
+                        return result;
+                    }
+
+                    gpo.mPipeline = pipeline;
+                }
+            }
+
+            // won't be used
+            for (auto& ssci : ssciArr)
+                vkDestroyShaderModule(mDevice, ssci.module, nullptr);
+        }
+
+        handle_out = mNextGPHandle++;
+        mGPMap.emplace(handle_out, gpo);
+
+        return Result::eSuccess;
+    }
+
+    Result Context::createComputePipeline(const ComputePipelineInfo& info,
+                                          HComputePipeline& handle_out)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        Result result;
+        ComputePipelineObject cpo;
+        cpo.mCS = info.CS;
+
+        {  // DescriptorSetLayout
+            std::vector<std::vector<VkDescriptorSetLayoutBinding>> allBindings;
+            {
+                uint32_t nowSet = UINT32_MAX;
+                for (const auto& [sb, srt] : info.CS.getLayoutTable())
+                {
+                    if (sb.first != nowSet)
+                    {
+                        allBindings.emplace_back();
+                        nowSet = sb.first;
+                    }
+
+                    auto&& b          = allBindings.back().emplace_back();
+                    b.binding         = sb.second;
+                    b.descriptorCount = 1;
+                    switch (srt)
+                    {
+                        case Shader::ShaderResourceType::eUniformBuffer:
+                            b.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                            break;
+                        case Shader::ShaderResourceType::eCombinedTexture:
+                            b.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                            break;
+                        case Shader::ShaderResourceType::eStorageTexture:
+                            b.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                            break;
+                        case Shader::ShaderResourceType::eSampler:
+                        case Shader::ShaderResourceType::eInputAttachment:
+                            assert(!"not supported");
+                            break;
+                    }
+
+                    b.pImmutableSamplers = nullptr;
+                    b.stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+                }
+            }
+
+            VkDescriptorSetLayoutCreateInfo descLayoutci{};
+            descLayoutci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            for (auto& bindings : allBindings)
+            {
+                descLayoutci.bindingCount = static_cast<uint32_t>(bindings.size());
+                descLayoutci.pBindings    = bindings.data();
+
+                VkDescriptorSetLayout descriptorSetLayout;
+                result = checkVkResult(vkCreateDescriptorSetLayout(
+                    mDevice, &descLayoutci, nullptr, &descriptorSetLayout));
+                if (result != Result::eSuccess)
+                {
+                    std::cerr << "failed to create descriptor set layout\n";
+                    return result;
+                }
+
+                cpo.mDescriptorSetLayouts.emplace_back(descriptorSetLayout);
+                cpo.mSetSizes.emplace_back(bindings.size());
+            }
+        }
+
+        {  // pipeline layout
+            VkPipelineLayoutCreateInfo ci{};
+            ci.sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            ci.setLayoutCount = static_cast<uint32_t>(cpo.mDescriptorSetLayouts.size());
+            ci.pSetLayouts    = cpo.mDescriptorSetLayouts.data();
+
+            VkPipelineLayout pipelineLayout;
+            result = checkVkResult(
+                vkCreatePipelineLayout(mDevice, &ci, nullptr, &pipelineLayout));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to create pipeline layout\n";
+                return result;
+            }
+
+            cpo.mPipelineLayout = pipelineLayout;
+        }
+
+        {  // compute pipeline
+            VkComputePipelineCreateInfo ci{};
+            ci.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            result   = createShaderModule(info.CS, VK_SHADER_STAGE_COMPUTE_BIT, &ci.stage);
+            if (Result::eSuccess != result)
+            {
+                std::cerr << "Failed to create compute shader module!\n";
+                return Result::eFailure;
+            }
+            ci.layout = cpo.mPipelineLayout.value();
+
+            VkPipeline pipeline;
+            result = checkVkResult(vkCreateComputePipelines(
+                mDevice, VK_NULL_HANDLE, 1, &ci, nullptr, &pipeline));
+
+            // won't be used
+            vkDestroyShaderModule(mDevice, ci.stage.module, nullptr);
+
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to create compute pipeline\n";
+                return result;
+            }
+
+            cpo.mPipeline = pipeline;
+        }
+
+        handle_out = mNextCPHandle++;
+        mCPMap.emplace(handle_out, cpo);
+
+        return Result::eSuccess;
+    }
+
+    Result
+    Context::createCommandBuffer(const std::vector<CommandList>& commandLists,
+                                 HCommandBuffer& handle_out)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        Result result = Result::eSuccess;
+
+        CommandObject co;
+        co.mPresentFlag = false;  // preset
+        co.mHRenderPasses.clear();
+
+        {  // queue to submit
+            co.mQueueType = commandLists.empty() ? QueueType::eGraphics : commandLists.front().getQueueType();
+            for (const auto& commandList : commandLists)
+                if (commandList.getQueueType() != co.mQueueType)
+                {
+                    std::cerr << "all commandlists in a command buffer must have the same queue type!\n";
+                    return Result::eFailure;
+                }
+        }
+
+        {  // allocate Descriptor from pool
+            for (const auto& commandList : commandLists)
+            {
+                co.mUBCount += commandList.getUniformBufferCount();
+                co.mCTCount += commandList.getCombinedTextureCount();
+            }
+
+            bool poolConfirmed = false;
+            for (size_t i = 0; i < mDescriptorPools.size(); ++i)
+                if (co.mUBCount + mDescriptorPools[i].first.uniformBufferCount <=
+                        DescriptorPoolInfo::poolUBSize ||
+                    co.mCTCount + mDescriptorPools[i].first.combinedTextureCount <=
+                        DescriptorPoolInfo::poolCTSize)
+                {
+                    co.mDescriptorPoolIndex = i;
+                    mDescriptorPools[i].first.uniformBufferCount += co.mUBCount;
+                    mDescriptorPools[i].first.combinedTextureCount += co.mCTCount;
+                    poolConfirmed = true;
+                    break;
+                }
+
+            if (!poolConfirmed)
+            {
+                co.mDescriptorPoolIndex = mDescriptorPools.size();
+                addDescriptorPool();
+                mDescriptorPools.back().first.uniformBufferCount += co.mUBCount;
+                mDescriptorPools.back().first.combinedTextureCount += co.mCTCount;
+            }
+
+            // resize descriptor sets
+            co.mDescriptorSets.resize(commandLists.size());
+        }
+
+        uint32_t index = 0;
+        co.mCommandBuffers.resize(commandLists.size());
+        // get internal(public) command info vector
+        for (const auto& commandList : commandLists)
+        {
+            {
+                VkCommandBufferAllocateInfo ai{};
+                ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                ai.commandPool        = co.mQueueType == QueueType::eCompute ? mComputeCommandPool : mCommandPool;
+                ai.commandBufferCount = 1;
+                ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                result                = checkVkResult(
+                                   vkAllocateCommandBuffers(mDevice, &ai, &co.mCommandBuffers[index]));
+                if (Result::eSuccess != result)
+                {
+                    std::cerr << "Failed to allocate command buffers!\n";
+                    return result;
+                }
+            }
+
+            const auto& cmdData = commandList.getInternalCommandData();
+
+            result = createProfilerQueries(co, index, cmdData);
+            if (result != Result::eSuccess)
+                return result;
+
+            {  // begin command buffer
+                VkCommandBufferBeginInfo commandBI{};
+                commandBI.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                commandBI.flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+                commandBI.pInheritanceInfo = nullptr;
+
+                result = checkVkResult(
+                    vkBeginCommandBuffer(co.mCommandBuffers[index], &commandBI));
+                if (result != Result::eSuccess)
+                {
+                    std::cerr << "Failed to begin command buffer!\n";
+                    return result;
+                }
+            }
+
+            writeCommandInternal(co, index, cmdData, commandList.useSubCommand());
+
+            {  // end command buffer
+                result = checkVkResult(vkEndCommandBuffer(co.mCommandBuffers[index]));
+
+                if (result != Result::eSuccess)
+                {
+                    std::cerr << "Failed to end command buffer!\n";
+                    return result;
+                }
+            }
+
+            ++index;  // next command
+        }
+
+        // each command buffer waits its own previous execution, not the one of the render pass
+        // (several command buffers may render with the same pass, and compute commands have no pass)
+        {
+            VkFenceCreateInfo fci{};
+            fci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            fci.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+            co.mFences.resize(co.mCommandBuffers.size());
+            for (auto& f : co.mFences)
+            {
+                result = checkVkResult(vkCreateFence(mDevice, &fci, nullptr, &f));
+                if (result != Result::eSuccess)
+                {
+                    std::cerr << "Failed to create fence!\n";
+                    return result;
+                }
+            }
+        }
+
+        co.mCommandLists = commandLists;
+
+        handle_out = mNextCBHandle++;
+        mCommandBufferMap.emplace(handle_out, co);
+
+        return result;
+    }
+
+    Result Context::createCommandBuffer(const CommandList& commandList,
+                                        HCommandBuffer& handle_out)
+    {
+        return createCommandBuffer(std::vector<CommandList>(1, commandList),
+                                   handle_out);
+    }
+
+    Result Context::createSubCommandBuffer(const SubCommandList& subCommandList,
+                                           HCommandBuffer& handle_out)
+    {
+        return createSubCommandBuffer(std::vector<SubCommandList>(1, subCommandList),
+                                      handle_out);
+    }
+
+    Result Context::createSubCommandBuffer(
+        const std::vector<SubCommandList>& subCommandLists,
+        HCommandBuffer& handle_out)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        Result result = Result::eSuccess;
+
+        CommandObject co;
+        co.mPresentFlag = false;  // preset
+        co.mHRenderPasses.clear();
+        co.mSubCommand  = true;
+
+        {  // allocate Descriptor from pool
+            for (const auto& commandList : subCommandLists)
+            {
+                co.mUBCount += commandList.getUniformBufferCount();
+                co.mCTCount += commandList.getCombinedTextureCount();
+            }
+
+            bool poolConfirmed = false;
+            for (size_t i = 0; i < mDescriptorPools.size(); ++i)
+                if (co.mUBCount + mDescriptorPools[i].first.uniformBufferCount <=
+                        DescriptorPoolInfo::poolUBSize ||
+                    co.mCTCount + mDescriptorPools[i].first.combinedTextureCount <=
+                        DescriptorPoolInfo::poolCTSize)
+                {
+                    co.mDescriptorPoolIndex = i;
+                    mDescriptorPools[i].first.uniformBufferCount += co.mUBCount;
+                    mDescriptorPools[i].first.combinedTextureCount += co.mCTCount;
+                    poolConfirmed = true;
+                    break;
+                }
+
+            if (!poolConfirmed)
+            {
+                co.mDescriptorPoolIndex = mDescriptorPools.size();
+                addDescriptorPool();
+                mDescriptorPools.back().first.uniformBufferCount += co.mUBCount;
+                mDescriptorPools.back().first.combinedTextureCount += co.mCTCount;
+            }
+
+            // resize descriptor sets
+            co.mDescriptorSets.resize(subCommandLists.size());
+        }
+
+        uint32_t index = 0;
+        co.mCommandBuffers.resize(subCommandLists.size());
+        // get internal(public) command info vector
+        for (const auto& subCommandList : subCommandLists)
+        {
+            {
+                VkCommandBufferAllocateInfo ai{};
+                ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                ai.commandPool        = mCommandPool;
+                ai.commandBufferCount = 1;
+                ai.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+                result                = checkVkResult(
+                                   vkAllocateCommandBuffers(mDevice, &ai, &co.mCommandBuffers[index]));
+                if (Result::eSuccess != result)
+                {
+                    std::cerr << "Failed to allocate command buffers!\n";
+                    return result;
+                }
+            }
+
+            const auto& cmdData = subCommandList.getInternalCommandData();
+
+            {  // begin command buffer
+                if (mDebugFlag && mRPMap.count(subCommandList.getRenderPass()) <= 0)
+                {
+                    std::cerr << "invalid render pass handle!\n";
+                    return Result::eFailure;
+                }
+                auto& rpo = mRPMap[subCommandList.getRenderPass()];
+
+                VkCommandBufferInheritanceInfo commandii{};
+                commandii.sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+                commandii.pNext                = nullptr;
+                commandii.renderPass           = rpo.mRenderPass.value();
+                commandii.framebuffer          = rpo.mFramebuffers[index].value();
+                commandii.subpass              = 0;
+                commandii.occlusionQueryEnable = VK_FALSE;
+                commandii.queryFlags           = 0;
+                commandii.pipelineStatistics   = 0;
+
+                VkCommandBufferBeginInfo commandBI{};
+                commandBI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                commandBI.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+                                  VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+                commandBI.pInheritanceInfo = &commandii;
+
+                result = checkVkResult(
+                    vkBeginCommandBuffer(co.mCommandBuffers[index], &commandBI));
+                if (result != Result::eSuccess)
+                {
+                    std::cerr << "Failed to begin command buffer!\n";
+                    return result;
+                }
+            }
+
+            writeCommandInternal(co, index, cmdData);
+
+            {  // end command buffer
+                result = checkVkResult(vkEndCommandBuffer(co.mCommandBuffers[index]));
+
+                if (result != Result::eSuccess)
+                {
+                    std::cerr << "Failed to end command buffer!\n";
+                    return result;
+                }
+            }
+
+            ++index;  // next command
+        }
+
+        co.mSubCommandLists = subCommandLists;
+
+        handle_out = mNextCBHandle++;
+        mCommandBufferMap.emplace(handle_out, co);
+
+        return result;
+    }
+
+    Result Context::updateCommandBuffer(const std::vector<CommandList>& commandLists, const HCommandBuffer& handle)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        Result result = Result::eSuccess;
+
+        if (mCommandBufferMap.count(handle) <= 0)
+        {
+            std::cerr << "create command buffer first!\n";
+            return Result::eFailure;
+        }
+
+        CommandObject& co = mCommandBufferMap[handle];
+        co.mPresentFlag   = false;
+        co.mHRenderPasses.clear();
+
+        uint32_t index = 0;
+        if (co.mCommandBuffers.size() != commandLists.size())
+        {
+            std::cerr << "invalid rewriting commandlist size!\n";
+            return Result::eFailure;
+        }
+
+        for (const auto& commandList : commandLists)
+            if (commandList.getQueueType() != co.mQueueType)
+            {
+                std::cerr << "invalid rewriting commandlist queue type!\n";
+                return Result::eFailure;
+            }
+
+        // offscreen and compute command
+        if (!co.mFences.empty())
+        {
+            TraceScope trace(mTracer, "wait fence");
+            result = checkVkResult(
+                vkWaitForFences(mDevice, uint32_t(co.mFences.size()), co.mFences.data(), VK_TRUE, UINT64_MAX));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "Failed to wait fence!\n";
+                return result;
+            }
+        }
+
+        // for present command
+        if (co.mHRenderPass && mRPMap.count(co.mHRenderPass.value()) > 0)
+        {
+            auto& rpo = mRPMap[co.mHRenderPass.value()];
+            if (rpo.mHWindow)
+            {
+                for (const auto& value : rpo.mFrameSignalValues)
+                {
+                    result = waitGraphicsTimeline(value);
+                    if (result != Result::eSuccess)
+                        return result;
+                }
+            }
+        }
+
+        {  // free previous descriptor sets
+            if (!co.mDescriptorSets.empty())
+            {
+                uint32_t time = 0;
+                for (const auto& ds_vec : co.mDescriptorSets)
+                {
+                    std::vector<VkDescriptorSet> sets;
+                    sets.reserve(ds_vec.size());
+                    for (const auto& e : ds_vec)
+                        sets.emplace_back(e.value());
+
+                    if (!sets.empty())
+                        vkFreeDescriptorSets(mDevice,
+                                         mDescriptorPools[co.mDescriptorPoolIndex].second,
+                                         sets.size(), sets.data());
+
+                    auto& ubc = mDescriptorPools[co.mDescriptorPoolIndex].first.uniformBufferCount;
+                    auto& ctc = mDescriptorPools[co.mDescriptorPoolIndex].first.combinedTextureCount;
+                    ubc = (ubc >= co.mUBCount) ? ubc - co.mUBCount : 0;
+                    ctc = (ctc >= co.mCTCount) ? ctc - co.mCTCount : 0;
+
+                    co.mUBCount = 0;
+                    co.mCTCount = 0;
+                }
+
+            }
+        }
+
+        {  // allocate Descriptor from pool
+            for (const auto& commandList : commandLists)
+            {
+                co.mUBCount += commandList.getUniformBufferCount();
+                co.mCTCount += commandList.getCombinedTextureCount();
+            }
+
+            bool poolConfirmed = false;
+            for (size_t i = 0; i < mDescriptorPools.size(); ++i)
+                if (co.mUBCount + mDescriptorPools[i].first.uniformBufferCount <=
+                        DescriptorPoolInfo::poolUBSize &&
+                    co.mCTCount + mDescriptorPools[i].first.combinedTextureCount <=
+                        DescriptorPoolInfo::poolCTSize)
                 {
-                    case CullMode::eNone:
-                        rci.cullMode = VK_CULL_MODE_NONE;
-                        break;
-                    case CullMode::eBack:
-                        rci.cullMode = VK_CULL_MODE_BACK_BIT;
-                        break;
-                    case CullMode::eFront:
-                        rci.cullMode = VK_CULL_MODE_FRONT_BIT;
-                        break;
-                    default:
-                        std::cerr << "invalid culling mode!\n";
-                        return Result::eFailure;
-                        break;
+                    co.mDescriptorPoolIndex = i;
+                    mDescriptorPools[i].first.uniformBufferCount += co.mUBCount;
+                    mDescriptorPools[i].first.combinedTextureCount += co.mCTCount;
+                    poolConfirmed = true;
+                    break;
                 }
 
-                switch (info.rasterizerState.frontFace)
+            if (!poolConfirmed)
+            {
+                co.mDescriptorPoolIndex = mDescriptorPools.size();
+                addDescriptorPool();
+                mDescriptorPools.back().first.uniformBufferCount += co.mUBCount;
+                mDescriptorPools.back().first.combinedTextureCount += co.mCTCount;
+            }
+        }
+
+        // clear barriered textures
+        // co.mBarrieredTextures.clear();
+
+        // get internal(public) command info vector
+        for (const auto& commandList : commandLists)
+        {
+            const auto& cmdData = commandList.getInternalCommandData();
+
+            result = createProfilerQueries(co, index, cmdData);
+            if (result != Result::eSuccess)
+                return result;
+
+            vkResetCommandBuffer(co.mCommandBuffers[index], 0);
+
+            {  // begin command buffer
+
+                VkCommandBufferBeginInfo commandBI{};
+                commandBI.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                commandBI.flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+                commandBI.pInheritanceInfo = nullptr;
+
+                result = checkVkResult(
+                    vkBeginCommandBuffer(co.mCommandBuffers[index], &commandBI));
+                if (result != Result::eSuccess)
                 {
-                    case FrontFace::eClockwise:
-                        rci.frontFace = VK_FRONT_FACE_CLOCKWISE;
-                        break;
-                    case FrontFace::eCounterClockwise:
-                        rci.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-                        break;
-                    default:
-                        std::cerr << "invalid front face mode!\n";
-                        return Result::eFailure;
-                        break;
+                    std::cerr << "Failed to begin command buffer!\n";
+                    return result;
                 }
+            }
 
-                rci.lineWidth = info.rasterizerState.lineWidth;
+            writeCommandInternal(co, index, cmdData, commandList.useSubCommand());
+
+            {  // end command buffer
+                result = checkVkResult(vkEndCommandBuffer(co.mCommandBuffers[index]));
+                if (result != Result::eSuccess)
+                {
+                    std::cerr << "Failed to end command buffer!\n";
+                    return result;
+                }
             }
 
-            // multi sampling
-            VkPipelineMultisampleStateCreateInfo msci{};
+            ++index;
+        }
+
+        co.mCommandLists  = commandLists;
+        co.mNeedsRerecord = false;
+
+        // mCommandBufferMap.at(handle) = co;
+
+        return result;
+    }
+
+    Result Context::updateCommandBuffer(const CommandList& commandList, const HCommandBuffer& handle)
+    {
+        return updateCommandBuffer(std::vector<CommandList>(1, commandList), handle);
+    }
+
+    Result Context::updateSubCommandBuffer(const SubCommandList& subCommandList, const HCommandBuffer& handle)
+    {
+        return updateSubCommandBuffer(std::vector<SubCommandList>(1, subCommandList), handle);
+    }
+
+    Result Context::updateSubCommandBuffer(const std::vector<SubCommandList>& subCommandLists, const HCommandBuffer& handle)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        Result result = Result::eSuccess;
+
+        if (mCommandBufferMap.count(handle) <= 0)
+        {
+            std::cerr << "create command buffer first!\n";
+            return Result::eFailure;
+        }
+
+        CommandObject& co = mCommandBufferMap[handle];
+        co.mPresentFlag   = false;
+        co.mHRenderPasses.clear();
+
+        {  // free previous descriptor sets
+            if (!co.mDescriptorSets.empty())
             {
-                msci.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-                switch (info.multiSampleState)
+                for (const auto& ds_vec : co.mDescriptorSets)
                 {
-                    case MultiSampleState::eDefault:
-                        msci.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-                        break;
-                    default:
-                        std::cerr << "multisampling state is not described\n";
-                        return Result::eFailure;
-                        break;
+                    std::vector<VkDescriptorSet> sets;
+                    sets.reserve(ds_vec.size());
+                    for (const auto& e : ds_vec)
+                        sets.emplace_back(e.value());
+
+                    if (!sets.empty())
+                    vkFreeDescriptorSets(mDevice,
+                                         mDescriptorPools[co.mDescriptorPoolIndex].second,
+                                         sets.size(), sets.data());
+
+                    auto& ubc =
+                        mDescriptorPools[co.mDescriptorPoolIndex].first.uniformBufferCount;
+                    auto& ctc = mDescriptorPools[co.mDescriptorPoolIndex]
+                                    .first.combinedTextureCount;
+                    ubc = ubc >= co.mUBCount ? ubc - co.mUBCount : 0;
+                    ctc = ctc >= co.mCTCount ? ctc - co.mCTCount : 0;
                 }
             }
 
-            // std::cerr << "multi sample topology rasterizer state\n";
+            // co.mDescriptorSets.clear();
+        }
 
-            // depth stencil
-            VkPipelineDepthStencilStateCreateInfo dsci{};
+        {  // allocate Descriptor from pool
+            for (const auto& commandList : subCommandLists)
             {
-                dsci.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-                switch (info.depthStencilState)
+                co.mUBCount += commandList.getUniformBufferCount();
+                co.mCTCount += commandList.getCombinedTextureCount();
+            }
+
+            bool poolConfirmed = false;
+            for (size_t i = 0; i < mDescriptorPools.size(); ++i)
+                if (co.mUBCount + mDescriptorPools[i].first.uniformBufferCount <=
+                        DescriptorPoolInfo::poolUBSize ||
+                    co.mCTCount + mDescriptorPools[i].first.combinedTextureCount <=
+                        DescriptorPoolInfo::poolCTSize)
                 {
-                    case DepthStencilState::eNone:
-                        dsci.depthTestEnable = dsci.stencilTestEnable = VK_FALSE;
-                        dsci.depthWriteEnable                         = VK_FALSE;
-                        break;
-                    case DepthStencilState::eDepth:
-                        dsci.depthTestEnable       = VK_TRUE;
-                        dsci.depthWriteEnable      = VK_TRUE;
-                        dsci.stencilTestEnable     = VK_FALSE;
-                        dsci.depthCompareOp        = VK_COMPARE_OP_LESS;
-                        dsci.depthBoundsTestEnable = VK_FALSE;
-                        break;
-                    case DepthStencilState::eStencil:
-                        dsci.depthTestEnable       = VK_FALSE;
-                        dsci.depthWriteEnable      = VK_FALSE;
-                        dsci.stencilTestEnable     = VK_TRUE;
-                        dsci.depthCompareOp        = VK_COMPARE_OP_LESS;
-                        dsci.depthBoundsTestEnable = VK_FALSE;
-                        break;
-                    case DepthStencilState::eBoth:
-                        dsci.depthTestEnable = dsci.stencilTestEnable = VK_TRUE;
-                        dsci.depthWriteEnable                         = VK_TRUE;
-                        break;
-                    default:
-                        std::cerr << "depth stencil state is not described\n";
-                        return Result::eFailure;
-                        break;
+                    co.mDescriptorPoolIndex = i;
+                    mDescriptorPools[i].first.uniformBufferCount += co.mUBCount;
+                    mDescriptorPools[i].first.combinedTextureCount += co.mCTCount;
+                    poolConfirmed = true;
+                    break;
                 }
+
+            if (!poolConfirmed)
+            {
+                co.mDescriptorPoolIndex = mDescriptorPools.size();
+                addDescriptorPool();
+                mDescriptorPools.back().first.uniformBufferCount += co.mUBCount;
+                mDescriptorPools.back().first.combinedTextureCount += co.mCTCount;
             }
-            std::array<VkPipelineShaderStageCreateInfo, 2> ssciArr{};
-            result =
-                createShaderModule(info.VS, VK_SHADER_STAGE_VERTEX_BIT, &ssciArr[0]);
-            if (Result::eSuccess != result)
+        }
+
+        // clear barriered textures
+        // co.mBarrieredTextures.clear();
+
+        if (co.mCommandBuffers.size() != subCommandLists.size())
+        {
+            std::cerr << "invalid rewriting commandlist size!\n";
+            return Result::eFailure;
+        }
+
+        // for present command
+        if (co.mHRenderPass && mRPMap.count(co.mHRenderPass.value()) > 0)
+        {
+            auto& rpo = mRPMap[co.mHRenderPass.value()];
+            if (rpo.mHWindow)
             {
-                std::cerr << "Failed to create vertex shader module!\n";
-                return Result::eFailure;
+                for (const auto& value : rpo.mFrameSignalValues)
+                {
+                    result = waitGraphicsTimeline(value);
+                    if (result != Result::eSuccess)
+                        return result;
+                }
             }
-            result =
-                createShaderModule(info.FS, VK_SHADER_STAGE_FRAGMENT_BIT, &ssciArr[1]);
-            if (Result::eSuccess != result)
+            else
             {
-                std::cerr << "Failed to create fragment shader module!\n";
-                return Result::eFailure;
+                vkDeviceWaitIdle(mDevice);
             }
+        }
 
-            auto layoutTable = info.VS.getLayoutTable();
-            {  // integrate VS and FS layout
-                auto fsLayoutTable = info.FS.getLayoutTable();
-                layoutTable.merge(fsLayoutTable);
-            }
+        uint32_t index = 0;
+        // get internal(public) command info vector
+        for (const auto& subCommandList : subCommandLists)
+        {
+            const auto& cmdData = subCommandList.getInternalCommandData();
 
-            if (mDebugFlag)
-            {
-                for (const auto& p : layoutTable)
-                {
-                    std::cerr << "set: " << static_cast<int>(p.first.first)
-                              << ", binding: " << static_cast<int>(p.first.second) << "\n";
+            vkResetCommandBuffer(co.mCommandBuffers[index], 0);
 
-                    switch (p.second)
-                    {
-                        case Shader::ShaderResourceType::eUniformBuffer:
-                            std::cerr << " UniformBuffer\n";
-                            break;
-                        case Shader::ShaderResourceType::eCombinedTexture:
-                            std::cerr << " CombinedTexture\n";
-                            break;
-                        case Shader::ShaderResourceType::eSampler:
-                            std::cerr << " sampler\n";
-                            break;
-                    }
+            {  // begin command buffer
+                auto& rpo = mRPMap[subCommandList.getRenderPass()];
+                VkCommandBufferInheritanceInfo commandii{};
+                commandii.sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+                commandii.pNext                = nullptr;
+                commandii.renderPass           = rpo.mRenderPass.value();
+                commandii.framebuffer          = rpo.mFramebuffers[index].value();
+                commandii.subpass              = 0;
+                commandii.occlusionQueryEnable = VK_FALSE;
+                commandii.queryFlags           = 0;
+                commandii.pipelineStatistics   = 0;
+
+                VkCommandBufferBeginInfo commandBI{};
+                commandBI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                commandBI.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+                                  VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+                commandBI.pInheritanceInfo = &commandii;
+
+                result = checkVkResult(
+                    vkBeginCommandBuffer(co.mCommandBuffers[index], &commandBI));
+                if (result != Result::eSuccess)
+                {
+                    std::cerr << "Failed to begin command buffer!\n";
+                    return result;
                 }
             }
 
-            uint32_t ubcount = 0;
-            uint32_t ctcount = 0;
-            {  // DescriptorSetLayout
+            writeCommandInternal(co, index, cmdData);
 
-                std::vector<std::vector<VkDescriptorSetLayoutBinding>> allBindings;
-                allBindings.reserve(8);
-                {  // HACK
-                    uint32_t nowSet = UINT32_MAX;
-                    for (const auto& [sb, srt] : layoutTable)
-                    {
-                        if (sb.first != nowSet)
-                        {
-                            allBindings.emplace_back();
-                            nowSet = sb.first;
-                        }
+            {  // end command buffer
+                result = checkVkResult(vkEndCommandBuffer(co.mCommandBuffers[index]));
+                if (result != Result::eSuccess)
+                {
+                    std::cerr << "Failed to end command buffer!\n";
+                    return result;
+                }
+            }
 
-                        auto&& b          = allBindings.back().emplace_back();
-                        b.binding         = sb.second;
-                        b.descriptorCount = 1;
-                        switch (srt)
-                        {
-                            case Shader::ShaderResourceType::eUniformBuffer:
-                                b.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                                ++ubcount;
-                                break;
+            ++index;
+        }
 
-                            case Shader::ShaderResourceType::eCombinedTexture:
-                                b.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                                ++ctcount;
-                                break;
+        co.mSubCommandLists = subCommandLists;
+        co.mNeedsRerecord   = false;
 
-                            case Shader::ShaderResourceType::eSampler:
-                                assert(!"not supported");
-                                break;
-                        }
+        // mCommandBufferMap.at(handle) = co;
 
-                        b.pImmutableSamplers = nullptr;
-                        b.stageFlags         = VK_SHADER_STAGE_ALL;
-                    }
-                }
+        return result;
+    }
 
-                VkDescriptorSetLayoutCreateInfo descLayoutci{};
-                descLayoutci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-                for (auto& bindings : allBindings)
-                {
-                    descLayoutci.bindingCount = static_cast<uint32_t>(bindings.size());
-                    descLayoutci.pBindings    = bindings.data();
+    Result Context::rerecordCommandBuffer(const HCommandBuffer& handle)
+    {
+        auto& co = mCommandBufferMap[handle];
 
-                    {
-                        VkDescriptorSetLayout descriptorSetLayout;
-                        result = checkVkResult(vkCreateDescriptorSetLayout(
-                            mDevice, &descLayoutci, nullptr, &descriptorSetLayout));
-                        if (result != Result::eSuccess)
-                        {
-                            std::cerr << "failed to create descriptor set layout\n";
-                            return result;
-                        }
+        // copied because they are assigned again while updating
+        if (co.mSubCommand)
+        {
+            const auto subCommandLists = co.mSubCommandLists;
+            return updateSubCommandBuffer(subCommandLists, handle);
+        }
 
-                        gpo.mDescriptorSetLayouts.emplace_back(descriptorSetLayout);
-                        gpo.mSetSizes.emplace_back(bindings.size());
-                    }
-                }
-            }
+        const auto commandLists = co.mCommandLists;
+        return updateCommandBuffer(commandLists, handle);
+    }
 
-            // if (layoutTable.size() > 0)
-            //{ //DescriptorPool
-            //    std::vector<VkDescriptorPoolSize> sizes;
-            //    sizes.reserve(ubcount + ctcount);
+    Result Context::writeCommandInternal(CommandObject& co, size_t index,
+                                         const InternalCommandList& icl,
+                                         const bool useSecondary)
+    {
+        TraceScope trace(mTracer, "writeCommandInternal");
 
-            //    if(ubcount > 0)
-            //    {
-            //        sizes.emplace_back();
-            //        sizes.back().descriptorCount = ubcount * mMaxFrame;//here
-            //        sizes.back().type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            //    }
+        Result result = Result::eSuccess;
 
-            //    if(ctcount > 0)
-            //    {
-            //        sizes.emplace_back();
-            //        sizes.back().descriptorCount = ctcount * mMaxFrame;//here
-            //        PART2 sizes.back().type =
-            //        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            //    }
-            //
-            //    VkDescriptorPoolCreateInfo dpci{};
-            //    dpci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-            //    dpci.flags =
-            //    VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+        uint32_t debug = 0;
 
-            //    dpci.maxSets = layoutTable.size() * mMaxFrame;
-            //
-            //    dpci.poolSizeCount = static_cast<uint32_t>(sizes.size());
-            //    dpci.pPoolSizes = sizes.data();
-            //    {
-            //        VkDescriptorPool descriptorPool;
-            //        result = checkVkResult(vkCreateDescriptorPool(mDevice,
-            //        &dpci, nullptr, &descriptorPool)); if (result !=
-            //        Result::eSuccess)
-            //        {
-            //            std::cerr << "failed to create Descriptor Pool\n";
-            //            return result;
-            //        }
-            //        gpo.mDescriptorPool = descriptorPool;
-            //    }
-            //}
+        co.mStorageLayouts.clear();
 
-            {  // pipeline layout
-                VkPipelineLayoutCreateInfo ci{};
-                ci.sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-                ci.setLayoutCount = gpo.mDescriptorSetLayouts.size();
-                // VkDescriptorSetLayout dslayout =
-                // gpo.mDescriptorSetLayout.value();
-                ci.pSetLayouts = gpo.mDescriptorSetLayouts.data();
+        // queries are reset in every execution (outside of render pass)
+        if (index < co.mProfilerQueries.size())
+        {
+            const auto& pq = co.mProfilerQueries[index];
+            if (pq.mPool != VK_NULL_HANDLE)
+                vkCmdResetQueryPool(co.mCommandBuffers[index], pq.mPool, 0, pq.mQueryCount);
+            if (pq.mStatisticsPool != VK_NULL_HANDLE)
+                vkCmdResetQueryPool(co.mCommandBuffers[index], pq.mStatisticsPool, 0, pq.mStatisticsCount);
+        }
 
-                {
-                    VkPipelineLayout pipelineLayout;
-                    result = checkVkResult(
-                        vkCreatePipelineLayout(mDevice, &ci, nullptr, &pipelineLayout));
+        for (const auto& command : icl)
+        {
+            // if (mDebugFlag)
+            // std::cerr << "now command : " << debug++ << "\n";
+            switch (command.first)  // RIP RTTI
+            {
+                case CommandType::eBegin:
+                    if (!std::holds_alternative<CmdBegin>(command.second))
+                        return Result::eFailure;
+                    // each render pass is measured automatically
+                    result = beginPassQueries(co, index, std::get<CmdBegin>(command.second).handle);
                     if (result != Result::eSuccess)
-                    {
-                        std::cerr << "failed to create pipeline layout\n";
                         return result;
-                    }
-
-                    gpo.mPipelineLayout = pipelineLayout;
-                }
+                    result = cmdBegin(co, index, std::get<CmdBegin>(command.second), useSecondary);
+                    break;
+                case CommandType::eEnd:
+                    if (!std::holds_alternative<CmdEnd>(command.second))
+                        return Result::eFailure;
+                    result = cmdEnd(co, index, std::get<CmdEnd>(command.second));
+                    if (result != Result::eSuccess)
+                        return result;
+                    result = endPassQueries(co, index);
+                    break;
+                case CommandType::eBindGraphicsPipeline:
+                    if (!std::holds_alternative<CmdBindGraphicsPipeline>(command.second))
+                        return Result::eFailure;
+                    result = cmdBindGraphicsPipeline(
+                        co, index, std::get<CmdBindGraphicsPipeline>(command.second));
+                    break;
+                case CommandType::ePresent:
+                    if (!std::holds_alternative<CmdPresent>(command.second))
+                        return Result::eFailure;
+                    co.mPresentFlag = true;
+                    break;
+                case CommandType::eBindVB:
+                    if (!std::holds_alternative<CmdBindVB>(command.second))
+                        return Result::eFailure;
+                    result = cmdBindVB(co, index, std::get<CmdBindVB>(command.second));
+                    break;
+                case CommandType::eBindIB:
+                    if (!std::holds_alternative<CmdBindIB>(command.second))
+                        return Result::eFailure;
+                    result = cmdBindIB(co, index, std::get<CmdBindIB>(command.second));
+                    break;
+                case CommandType::eBindSRSet:
+                    if (!std::holds_alternative<CmdBindSRSet>(command.second))
+                        return Result::eFailure;
+                    result = cmdBindSRSet(co, index, std::get<CmdBindSRSet>(command.second));
+                    break;
+                case CommandType::eRender:
+                    if (!std::holds_alternative<CmdRender>(command.second))
+                        return Result::eFailure;
+                    result = cmdRender(co, index, std::get<CmdRender>(command.second));
+                    break;
+                case CommandType::eRenderIndexed:
+                    if (!std::holds_alternative<CmdRenderIndexed>(command.second))
+                        return Result::eFailure;
+                    result = cmdRenderIndexed(co, index,
+                                              std::get<CmdRenderIndexed>(command.second));
+                    break;
+                case CommandType::eBarrier:
+                    if (!std::holds_alternative<CmdBarrier>(command.second))
+                        return Result::eFailure;
+                    result = cmdBarrier(co, index, std::get<CmdBarrier>(command.second));
+                    break;
+                case CommandType::eRenderImGui:
+                    if (!std::holds_alternative<CmdRenderImGui>(command.second))
+                        return Result::eFailure;
+                    result = cmdRenderImGui(co, index);
+                    break;
+                case CommandType::eExecuteSubCommand:
+                    if (!std::holds_alternative<CmdExecuteSubCommand>(command.second))
+                        return Result::eFailure;
+                    result = cmdExecuteSubCommand(
+                        co, index, std::get<CmdExecuteSubCommand>(command.second));
+                    break;
+                case CommandType::eBindComputePipeline:
+                    if (!std::holds_alternative<CmdBindComputePipeline>(command.second))
+                        return Result::eFailure;
+                    result = cmdBindComputePipeline(
+                        co, index, std::get<CmdBindComputePipeline>(command.second));
+                    break;
+                case CommandType::eDispatch:
+                    if (!std::holds_alternative<CmdDispatch>(command.second))
+                        return Result::eFailure;
+                    result = cmdDispatch(co, index, std::get<CmdDispatch>(command.second));
+                    break;
+                case CommandType::eTransition:
+                    if (!std::holds_alternative<CmdTransition>(command.second))
+                        return Result::eFailure;
+                    result = cmdTransition(co, index, std::get<CmdTransition>(command.second));
+                    break;
+                case CommandType::eNextSubpass:
+                    if (!std::holds_alternative<CmdNextSubpass>(command.second))
+                        return Result::eFailure;
+                    result = cmdNextSubpass(co, index, std::get<CmdNextSubpass>(command.second));
+                    break;
+                case CommandType::eBeginScope:
+                    if (!std::holds_alternative<CmdBeginScope>(command.second))
+                        return Result::eFailure;
+                    result = cmdBeginScope(co, index, std::get<CmdBeginScope>(command.second));
+                    break;
+                case CommandType::eEndScope:
+                    if (!std::holds_alternative<CmdEndScope>(command.second))
+                        return Result::eFailure;
+                    result = cmdEndScope(co, index, std::get<CmdEndScope>(command.second));
+                    break;
+                default:
+                    std::cerr << "invalid command!\nrequested command : "
+                              << static_cast<int>(command.first) << "\n";
+                    return Result::eFailure;
+                    break;
             }
 
-            {  // graphics pipeline layout
-                VkGraphicsPipelineCreateInfo ci{};
-                ci.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-                ci.stageCount          = static_cast<uint32_t>(ssciArr.size());
-                ci.pStages             = ssciArr.data();
-                ci.pInputAssemblyState = &iaci;
-                ci.pVertexInputState   = &visci;
-                ci.pRasterizationState = &rci;
-                ci.pDepthStencilState  = &dsci;
-                ci.pMultisampleState   = &msci;
-                ci.pViewportState      = &vpsci;
-                ci.pColorBlendState    = &cbci;
-                ci.renderPass          = rpo.mRenderPass.value();
-                ci.layout              = gpo.mPipelineLayout.value();
-                {
-                    VkPipeline pipeline;
-                    result = checkVkResult(vkCreateGraphicsPipelines(
-                        mDevice, VK_NULL_HANDLE, 1, &ci, nullptr, &pipeline));
-                    if (result != Result::eSuccess)
-                    {
-                        std::cerr << "failed to create graphics pipeline\n";
-                        return result;
-                    }
+            if (result != Result::eSuccess)
+                return result;
 
-                    gpo.mPipeline = pipeline;
+            // added to the frame statistics in every execution
+            if (index < co.mProfilerQueries.size())
+            {
+                auto& stats = co.mProfilerQueries[index].mRecordedStats;
+                switch (command.first)
+                {
+                    case CommandType::eRender:
+                    case CommandType::eRenderIndexed:
+                        ++stats.drawCount;
+                        break;
+                    case CommandType::eDispatch:
+                        ++stats.dispatchCount;
+                        break;
+                    case CommandType::eBindGraphicsPipeline:
+                    case CommandType::eBindComputePipeline:
+                        ++stats.pipelineBindCount;
+                        break;
+                    case CommandType::eBindVB:
+                    case CommandType::eBindIB:
+                        ++stats.bufferBindCount;
+                        break;
+                    case CommandType::eBindSRSet:
+                        ++stats.descriptorSetBindCount;
+                        break;
+                    case CommandType::eBarrier:
+                    case CommandType::eTransition:
+                        ++stats.barrierCount;
+                        break;
+                    default:
+                        break;
                 }
             }
+        }
 
-            // won't be used
-            for (auto& ssci : ssciArr)
-                vkDestroyShaderModule(mDevice, ssci.module, nullptr);
+        // close scopes which the user forgot to end
+        if (index < co.mProfilerQueries.size() && !co.mProfilerQueries[index].mOpenScopes.empty())
+        {
+            std::cerr << "some scopes in the command list are not ended!\n";
+            while (!co.mProfilerQueries[index].mOpenScopes.empty())
+                cmdEndScope(co, index, CmdEndScope{});
         }
 
-        handle_out = mNextGPHandle++;
-        mGPMap.emplace(handle_out, gpo);
+        // storage images go back to the layout they had at the beginning of the command list
+        for (auto itr = co.mStorageLayouts.rbegin(); itr != co.mStorageLayouts.rend(); ++itr)
+        {
+            auto& io = mImageMap[itr->first];
+            if (io.currentLayout != VK_IMAGE_LAYOUT_GENERAL)
+                continue;
+            setStorageImageBarrier(co.mCommandBuffers[index], io.mImage.value(),
+                                   VK_IMAGE_LAYOUT_GENERAL, itr->second);
+            io.currentLayout = itr->second;
+        }
+        co.mStorageLayouts.clear();
 
         return Result::eSuccess;
     }
 
-    Result
-    Context::createCommandBuffer(const std::vector<CommandList>& commandLists,
-                                 HCommandBuffer& handle_out)
+    Result Context::cmdBegin(CommandObject& co, size_t frameBufferIndex, const CmdBegin& info, const bool useSecondary)
     {
-        if (!mIsInitialized)
+        Result result = Result::eSuccess;
+
+        auto& command = co.mCommandBuffers[frameBufferIndex];
+        if (mDebugFlag && mRPMap.count(info.handle) <= 0)
         {
-            std::cerr << "context did not initialize yet!\n";
+            std::cerr << "invalid render pass!\n";
             return Result::eFailure;
         }
 
-        Result result = Result::eSuccess;
+        auto& rpo = mRPMap[info.handle];
 
-        CommandObject co;
-        co.mPresentFlag = false;  // preset
+        co.mHRenderPass = info.handle;
+        if (std::find(co.mHRenderPasses.begin(), co.mHRenderPasses.end(), info.handle) == co.mHRenderPasses.end())
+            co.mHRenderPasses.emplace_back(info.handle);
 
-        {  // allocate Descriptor from pool
-            for (const auto& commandList : commandLists)
+        VkRenderPassBeginInfo bi{};
+
+        std::vector<VkClearValue> clearValues;
+        if (!rpo.mHWindow)
+        {
+            clearValues.reserve(rpo.colorTargets.size() + 1);
+
+            for (size_t i = 0; i < rpo.colorTargets.size(); ++i)
             {
-                co.mUBCount += commandList.getUniformBufferCount();
-                co.mCTCount += commandList.getCombinedTextureCount();
+                clearValues.emplace_back();
+                auto& cv = clearValues.back();
+                auto& io = mImageMap[rpo.colorTargets[i]];
+                switch (io.format)
+                {
+                    case VK_FORMAT_R32_UINT:
+                    case VK_FORMAT_R32G32_UINT:
+                    case VK_FORMAT_R32G32B32_UINT:
+                    case VK_FORMAT_R32G32B32A32_UINT:
+                        cv.color.uint32[0] = static_cast<uint32_t>(info.ccv[0] * 255);
+                        cv.color.uint32[1] = static_cast<uint32_t>(info.ccv[1] * 255);
+                        cv.color.uint32[2] = static_cast<uint32_t>(info.ccv[2] * 255);
+                        cv.color.uint32[3] = static_cast<uint32_t>(info.ccv[3] * 255);
+                        break;
+
+                    case VK_FORMAT_R8_UNORM:
+                    case VK_FORMAT_R8G8_UNORM:
+                    case VK_FORMAT_R8G8B8_UNORM:
+                    case VK_FORMAT_R8G8B8A8_UNORM:
+                    case VK_FORMAT_R32_SFLOAT:
+                    case VK_FORMAT_R32G32_SFLOAT:
+                    case VK_FORMAT_R32G32B32_SFLOAT:
+                    case VK_FORMAT_R32G32B32A32_SFLOAT:
+                        cv.color.float32[0] = info.ccv[0];
+                        cv.color.float32[1] = info.ccv[1];
+                        cv.color.float32[2] = info.ccv[2];
+                        cv.color.float32[3] = info.ccv[3];
+                        break;
+
+                    case VK_FORMAT_R32_SINT:
+                    case VK_FORMAT_R32G32_SINT:
+                    case VK_FORMAT_R32G32B32_SINT:
+                    case VK_FORMAT_R32G32B32A32_SINT:
+                        cv.color.int32[0] = static_cast<int32_t>(info.ccv[0] * 127);
+                        cv.color.int32[1] = static_cast<int32_t>(info.ccv[1] * 127);
+                        cv.color.int32[2] = static_cast<int32_t>(info.ccv[2] * 127);
+                        cv.color.int32[3] = static_cast<int32_t>(info.ccv[3] * 127);
+                        break;
+                    default:
+                        std::cerr << "invalid type of pixel!\n";
+                        return Result::eFailure;
+                        break;
+                }
             }
 
-            bool poolConfirmed = false;
-            for (size_t i = 0; i < mDescriptorPools.size(); ++i)
-                if (co.mUBCount + mDescriptorPools[i].first.uniformBufferCount <=
-                        DescriptorPoolInfo::poolUBSize ||
-                    co.mCTCount + mDescriptorPools[i].first.combinedTextureCount <=
-                        DescriptorPoolInfo::poolCTSize)
+            if (rpo.mDepthTestEnable)
+            {
+                clearValues.emplace_back().depthStencil = {std::get<0>(info.dcv),
+                                                           std::get<1>(info.dcv)};
+            }
+        }
+        else
+        {
+            // swapchain image, depth buffer, intermediate targets
+            clearValues.emplace_back().color = {info.ccv[0], info.ccv[1], info.ccv[2], info.ccv[3]};
+            if (rpo.mDepthTestEnable)
+                clearValues.emplace_back().depthStencil = {std::get<0>(info.dcv),
+                                                           std::get<1>(info.dcv)};
+            for (size_t i = 0; i < rpo.mIntermediateTargets.size(); ++i)
+                clearValues.emplace_back().color = {info.ccv[0], info.ccv[1], info.ccv[2], info.ccv[3]};
+        }
+
+        for (const auto& tex : rpo.mIntermediateTargets)
+        {
+            auto& io = mImageMap[tex];
+            if (io.currentLayout != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
+            {
+                setImageMemoryBarrier(command, io.mImage.value(), io.currentLayout,
+                                      VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+                io.currentLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            }
+        }
+
+        bi.clearValueCount = clearValues.size();
+        bi.pClearValues    = clearValues.data();
+
+        if (!rpo.mHWindow && info.clear && !rpo.mLoadPrevData)
+        {
+            if (rpo.depthTarget)
+            {
+                auto& io = mImageMap[rpo.depthTarget.value()];
+                if (io.currentLayout !=
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
                 {
-                    co.mDescriptorPoolIndex = i;
-                    mDescriptorPools[i].first.uniformBufferCount += co.mUBCount;
-                    mDescriptorPools[i].first.combinedTextureCount += co.mCTCount;
-                    poolConfirmed = true;
-                    break;
+                    // vkCmdClearDepthStencilImage(command, io.mImage.value(), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                    //                             &clearValues[1].depthStencil, 1, &io.range);
+
+                    setImageMemoryBarrier(command, io.mImage.value(), io.currentLayout,
+                                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                          io.range.aspectMask);
+                    io.currentLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
                 }
+                // else
+                //{
+                //     setImageMemoryBarrier(command, io.mImage.value(),
+                //     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                //     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                //     io.range.aspectMask);
+                //     vkCmdClearDepthStencilImage(command, io.mImage.value(),
+                //     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                //     &clearValues[1].depthStencil, 1, &io.range);
+                //     setImageMemoryBarrier(command, io.mImage.value(),
+                //     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                //     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                //     io.range.aspectMask); io.currentLayout =
+                //     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+                // }
+            }
 
-            if (!poolConfirmed)
+            for (const auto& tex : getFrameColorTargets(rpo, frameBufferIndex))
             {
-                co.mDescriptorPoolIndex = mDescriptorPools.size();
-                addDescriptorPool();
-                mDescriptorPools.back().first.uniformBufferCount += co.mUBCount;
-                mDescriptorPools.back().first.combinedTextureCount += co.mCTCount;
+                auto& io = mImageMap[tex];
+                // VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+
+                // setImageMemoryBarrier(command, io.mImage.value(),
+                // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                // VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+                // vkCmdClearColorImage(command, io.mImage.value(),
+                //                      VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                //                      &clearValues[0].color, 1, &io.range);
+                // setImageMemoryBarrier(command,
+                //  io.mImage.value(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                //  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+                if (io.currentLayout != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
+                {
+                    setImageMemoryBarrier(command, io.mImage.value(), io.currentLayout,
+                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                          io.range.aspectMask);
+                    io.currentLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                }
+            }
+        }
+        else if (info.clear && !rpo.mLoadPrevData)
+        {
+            for (const auto& tex : rpo.colorTargets)
+            {
+                auto& io = mImageMap[tex];
+                if (io.currentLayout != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
+                {
+                    setImageMemoryBarrier(
+                        command, io.mImage.value(), VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, io.range.aspectMask);
+                    io.currentLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                }
             }
-
-            // resize descriptor sets
-            co.mDescriptorSets.resize(commandLists.size());
         }
-
-        uint32_t index = 0;
-        co.mCommandBuffers.resize(commandLists.size());
-        // get internal(public) command info vector
-        for (const auto& commandList : commandLists)
+        else
         {
+            if (rpo.depthTarget)
             {
-                VkCommandBufferAllocateInfo ai{};
-                ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-                ai.commandPool        = mCommandPool;
-                ai.commandBufferCount = 1;
-                ai.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-                result                = checkVkResult(
-                                   vkAllocateCommandBuffers(mDevice, &ai, &co.mCommandBuffers[index]));
-                if (Result::eSuccess != result)
+                auto& io = mImageMap[rpo.depthTarget.value()];
+                if (io.currentLayout !=
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
                 {
-                    std::cerr << "Failed to allocate command buffers!\n";
-                    return result;
+                    setImageMemoryBarrier(command, io.mImage.value(), io.currentLayout,
+                                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                          io.range.aspectMask);
+                    io.currentLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
                 }
             }
 
-            const auto& cmdData = commandList.getInternalCommandData();
-
-            {  // begin command buffer
-                VkCommandBufferBeginInfo commandBI{};
-                commandBI.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-                commandBI.flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-                commandBI.pInheritanceInfo = nullptr;
-
-                result = checkVkResult(
-                    vkBeginCommandBuffer(co.mCommandBuffers[index], &commandBI));
-                if (result != Result::eSuccess)
+            for (const auto& img : getFrameColorTargets(rpo, frameBufferIndex))
+            {
+                auto& io = mImageMap[img];
+                if (io.currentLayout != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
                 {
-                    std::cerr << "Failed to begin command buffer!\n";
-                    return result;
+                    setImageMemoryBarrier(command, io.mImage.value(), io.currentLayout,
+                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+                    io.currentLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
                 }
             }
+        }
 
-            writeCommandInternal(co, index, cmdData, commandList.useSubCommand());
+        bi.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        bi.renderPass        = rpo.mRenderPass.value();
+        bi.renderArea.offset = {0, 0};
+        bi.renderArea.extent = {rpo.mExtent.value().width,
+                                rpo.mExtent.value().height};
+        bi.framebuffer =
+            rpo.mFramebuffers[frameBufferIndex % rpo.mFramebuffers.size()].value();
 
-            {  // end command buffer
-                result = checkVkResult(vkEndCommandBuffer(co.mCommandBuffers[index]));
+        if (useSecondary)
+            vkCmdBeginRenderPass(command, &bi,
+                                 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        else
+            vkCmdBeginRenderPass(command, &bi, VK_SUBPASS_CONTENTS_INLINE);
 
-                if (result != Result::eSuccess)
-                {
-                    std::cerr << "Failed to end command buffer!\n";
-                    return result;
-                }
-            }
+        return Result::eSuccess;
+    }
 
-            ++index;  // next command
+    Result Context::cmdEnd(CommandObject& co, size_t index, const CmdEnd& info)
+    {
+        auto& command = co.mCommandBuffers[index];
+        auto& rpo     = mRPMap[co.mHRenderPass.value()];
+
+        if (rpo.mHWindow)
+        {
+            for (auto& htex : rpo.colorTargets)
+            {
+                auto& io = mImageMap[htex];
+                setImageMemoryBarrier(command, io.mImage.value(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                      VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+            }
         }
 
-        handle_out = mNextCBHandle++;
-        mCommandBufferMap.emplace(handle_out, co);
+        vkCmdEndRenderPass(command);
 
-        return result;
+        return Result::eSuccess;
     }
 
-    Result Context::createCommandBuffer(const CommandList& commandList,
-                                        HCommandBuffer& handle_out)
+    Result Context::cmdNextSubpass(CommandObject& co, size_t index, const CmdNextSubpass& info)
     {
-        return createCommandBuffer(std::vector<CommandList>(1, commandList),
-                                   handle_out);
+        vkCmdNextSubpass(co.mCommandBuffers[index], VK_SUBPASS_CONTENTS_INLINE);
+
+        return Result::eSuccess;
     }
 
-    Result Context::createSubCommandBuffer(const SubCommandList& subCommandList,
-                                           HCommandBuffer& handle_out)
+    Result Context::cmdBeginScope(CommandObject& co, size_t index, const CmdBeginScope& info)
     {
-        return createSubCommandBuffer(std::vector<SubCommandList>(1, subCommandList),
-                                      handle_out);
+        // scopes are ignored unless the profiler was enabled when recording
+        if (index >= co.mProfilerQueries.size() || co.mProfilerQueries[index].mPool == VK_NULL_HANDLE)
+            return Result::eSuccess;
+
+        auto& pq             = co.mProfilerQueries[index];
+        const uint32_t scope = static_cast<uint32_t>(pq.mScopes.size());
+        if (scope * 2 + 1 >= pq.mQueryCount)
+        {
+            std::cerr << "timestamp query pool overflowed!\n";
+            return Result::eFailure;
+        }
+
+        pq.mScopes.emplace_back(TimestampScope{info.name, static_cast<uint32_t>(pq.mOpenScopes.size())});
+        pq.mOpenScopes.emplace_back(scope);
+
+        vkCmdWriteTimestamp(co.mCommandBuffers[index], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pq.mPool, scope * 2);
+
+        return Result::eSuccess;
     }
 
-    Result Context::createSubCommandBuffer(
-        const std::vector<SubCommandList>& subCommandLists,
-        HCommandBuffer& handle_out)
+    Result Context::cmdEndScope(CommandObject& co, size_t index, const CmdEndScope& info)
     {
-        if (!mIsInitialized)
+        if (index >= co.mProfilerQueries.size() || co.mProfilerQueries[index].mPool == VK_NULL_HANDLE)
+            return Result::eSuccess;
+
+        auto& pq = co.mProfilerQueries[index];
+        if (pq.mOpenScopes.empty())
         {
-            std::cerr << "context did not initialize yet!\n";
+            std::cerr << "endScope was called without beginScope!\n";
             return Result::eFailure;
         }
 
-        Result result = Result::eSuccess;
+        vkCmdWriteTimestamp(co.mCommandBuffers[index], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pq.mPool, pq.mOpenScopes.back() * 2 + 1);
+        pq.mOpenScopes.pop_back();
 
-        CommandObject co;
-        co.mPresentFlag = false;  // preset
-        co.mSubCommand  = true;
+        return Result::eSuccess;
+    }
 
-        {  // allocate Descriptor from pool
-            for (const auto& commandList : subCommandLists)
-            {
-                co.mUBCount += commandList.getUniformBufferCount();
-                co.mCTCount += commandList.getCombinedTextureCount();
-            }
+    Result Context::beginPassQueries(CommandObject& co, size_t index, const HRenderPass& handle)
+    {
+        const std::string name = "render pass " + std::to_string(handle.getID());
 
-            bool poolConfirmed = false;
-            for (size_t i = 0; i < mDescriptorPools.size(); ++i)
-                if (co.mUBCount + mDescriptorPools[i].first.uniformBufferCount <=
-                        DescriptorPoolInfo::poolUBSize ||
-                    co.mCTCount + mDescriptorPools[i].first.combinedTextureCount <=
-                        DescriptorPoolInfo::poolCTSize)
-                {
-                    co.mDescriptorPoolIndex = i;
-                    mDescriptorPools[i].first.uniformBufferCount += co.mUBCount;
-                    mDescriptorPools[i].first.combinedTextureCount += co.mCTCount;
-                    poolConfirmed = true;
-                    break;
-                }
+        Result result = cmdBeginScope(co, index, CmdBeginScope{name});
+        if (result != Result::eSuccess)
+            return result;
 
-            if (!poolConfirmed)
-            {
-                co.mDescriptorPoolIndex = mDescriptorPools.size();
-                addDescriptorPool();
-                mDescriptorPools.back().first.uniformBufferCount += co.mUBCount;
-                mDescriptorPools.back().first.combinedTextureCount += co.mCTCount;
-            }
+        if (index >= co.mProfilerQueries.size() || co.mProfilerQueries[index].mStatisticsPool == VK_NULL_HANDLE)
+            return Result::eSuccess;
 
-            // resize descriptor sets
-            co.mDescriptorSets.resize(subCommandLists.size());
+        auto& pq             = co.mProfilerQueries[index];
+        const uint32_t query = static_cast<uint32_t>(pq.mStatisticsNames.size());
+        if (query >= pq.mStatisticsCount)
+        {
+            std::cerr << "pipeline statistics query pool overflowed!\n";
+            return Result::eFailure;
         }
 
-        uint32_t index = 0;
-        co.mCommandBuffers.resize(subCommandLists.size());
-        // get internal(public) command info vector
-        for (const auto& subCommandList : subCommandLists)
+        // begun outside of the render pass to cover all subpasses
+        vkCmdBeginQuery(co.mCommandBuffers[index], pq.mStatisticsPool, query, 0);
+        pq.mStatisticsNames.emplace_back(name);
+        pq.mStatisticsActive = true;
+
+        return Result::eSuccess;
+    }
+
+    Result Context::endPassQueries(CommandObject& co, size_t index)
+    {
+        if (index < co.mProfilerQueries.size() && co.mProfilerQueries[index].mStatisticsActive)
         {
-            {
-                VkCommandBufferAllocateInfo ai{};
-                ai.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-                ai.commandPool        = mCommandPool;
-                ai.commandBufferCount = 1;
-                ai.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
-                result                = checkVkResult(
-                                   vkAllocateCommandBuffers(mDevice, &ai, &co.mCommandBuffers[index]));
-                if (Result::eSuccess != result)
-                {
-                    std::cerr << "Failed to allocate command buffers!\n";
-                    return result;
-                }
-            }
+            auto& pq = co.mProfilerQueries[index];
+            vkCmdEndQuery(co.mCommandBuffers[index], pq.mStatisticsPool, static_cast<uint32_t>(pq.mStatisticsNames.size() - 1));
+            pq.mStatisticsActive = false;
+        }
 
-            const auto& cmdData = subCommandList.getInternalCommandData();
+        return cmdEndScope(co, index, CmdEndScope{});
+    }
 
-            {  // begin command buffer
-                if (mDebugFlag && mRPMap.count(subCommandList.getRenderPass()) <= 0)
-                {
-                    std::cerr << "invalid render pass handle!\n";
-                    return Result::eFailure;
-                }
-                auto& rpo = mRPMap[subCommandList.getRenderPass()];
+    Result Context::cmdBindVB(CommandObject& co, size_t index,
+                              const CmdBindVB& info)
+    {
+        if (mBufferMap.count(info.VBHandle) <= 0)
+            return Result::eFailure;
+        auto& vbo = mBufferMap[info.VBHandle];
 
-                VkCommandBufferInheritanceInfo commandii{};
-                commandii.sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
-                commandii.pNext                = nullptr;
-                commandii.renderPass           = rpo.mRenderPass.value();
-                commandii.framebuffer          = rpo.mFramebuffers[index].value();
-                commandii.subpass              = 0;
-                commandii.occlusionQueryEnable = VK_FALSE;
-                commandii.queryFlags           = 0;
-                commandii.pipelineStatistics   = 0;
+        VkDeviceSize offsets[] = {0};
 
-                VkCommandBufferBeginInfo commandBI{};
-                commandBI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-                commandBI.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
-                                  VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-                commandBI.pInheritanceInfo = &commandii;
+        vkCmdBindVertexBuffers(co.mCommandBuffers[index], 0, 1, &vbo.mBuffer.value(),
+                               offsets);
 
-                result = checkVkResult(
-                    vkBeginCommandBuffer(co.mCommandBuffers[index], &commandBI));
-                if (result != Result::eSuccess)
-                {
-                    std::cerr << "Failed to begin command buffer!\n";
-                    return result;
-                }
-            }
+        return Result::eSuccess;
+    }
 
-            writeCommandInternal(co, index, cmdData);
+    Result Context::cmdBindIB(CommandObject& co, size_t index,
+                              const CmdBindIB& info)
+    {
+        if (mBufferMap.count(info.IBHandle) <= 0)
+            return Result::eFailure;
+        auto& ibo = mBufferMap[info.IBHandle];
 
-            {  // end command buffer
-                result = checkVkResult(vkEndCommandBuffer(co.mCommandBuffers[index]));
+        vkCmdBindIndexBuffer(co.mCommandBuffers[index], ibo.mBuffer.value(), 0,
+                             VK_INDEX_TYPE_UINT32);
 
-                if (result != Result::eSuccess)
-                {
-                    std::cerr << "Failed to end command buffer!\n";
-                    return result;
-                }
-            }
+        return Result::eSuccess;
+    }
 
-            ++index;  // next command
+    Result Context::cmdBindGraphicsPipeline(CommandObject& co, size_t index,
+                                            const CmdBindGraphicsPipeline& info)
+    {
+        auto& gpo     = mGPMap[info.handle];
+        co.mHGPO      = info.handle;
+        auto& command = co.mCommandBuffers[index];
+        vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          gpo.mPipeline.value());
+
+        // viewport and scissor follow the current extent of the render pass unless specified
+        {
+            const VkExtent3D& extent = mRPMap[gpo.mHRenderPass].mExtent.value();
+            const VkViewport viewport = gpo.mViewport ? gpo.mViewport.value() : VkViewport{0, 0, static_cast<float>(extent.width), static_cast<float>(extent.height), 0, static_cast<float>(extent.depth)};
+            const VkRect2D scissor    = gpo.mScissor ? gpo.mScissor.value() : VkRect2D{{0, 0}, {extent.width, extent.height}};
+            vkCmdSetViewport(command, 0, 1, &viewport);
+            vkCmdSetScissor(command, 0, 1, &scissor);
         }
 
-        handle_out = mNextCBHandle++;
-        mCommandBufferMap.emplace(handle_out, co);
+        // allocate descriptor sets
+        co.mDescriptorSets[index].resize(gpo.mDescriptorSetLayouts.size());
 
-        return result;
+        return Result::eSuccess;
     }
 
-    Result Context::updateCommandBuffer(const std::vector<CommandList>& commandLists, const HCommandBuffer& handle)
+    Result Context::cmdBindComputePipeline(CommandObject& co, size_t index,
+                                           const CmdBindComputePipeline& info)
     {
-        if (!mIsInitialized)
+        if (mDebugFlag && mCPMap.count(info.handle) <= 0)
         {
-            std::cerr << "context did not initialize yet!\n";
+            std::cerr << "invalid compute pipeline handle!\n";
             return Result::eFailure;
         }
 
+        auto& cpo     = mCPMap[info.handle];
+        co.mHCPO      = info.handle;
+        auto& command = co.mCommandBuffers[index];
+        vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          cpo.mPipeline.value());
+
+        // allocate descriptor sets
+        co.mDescriptorSets[index].resize(cpo.mDescriptorSetLayouts.size());
+
+        return Result::eSuccess;
+    }
+
+    Result Context::cmdBindSRSet(CommandObject& co, size_t index,
+                                 const CmdBindSRSet& info)
+    {
         Result result = Result::eSuccess;
 
-        if (mCommandBufferMap.count(handle) <= 0)
+        const bool compute = co.mQueueType == QueueType::eCompute;
+        if ((compute && !co.mHCPO) || (!compute && !co.mHGPO))
         {
-            std::cerr << "create command buffer first!\n";
+            std::cerr << "pipeline object is not registered yet!\n";
             return Result::eFailure;
         }
 
-        CommandObject& co = mCommandBufferMap[handle];
-        co.mPresentFlag   = false;
+        // layouts of bound pipeline
+        const auto& setLayouts = compute ? mCPMap[co.mHCPO.value()].mDescriptorSetLayouts
+                                         : mGPMap[co.mHGPO.value()].mDescriptorSetLayouts;
+        const auto& setSizes   = compute ? mCPMap[co.mHCPO.value()].mSetSizes
+                                         : mGPMap[co.mHGPO.value()].mSetSizes;
 
-        uint32_t index = 0;
-        if (co.mCommandBuffers.size() != commandLists.size())
+        if (mDescriptorPools.size() <= co.mDescriptorPoolIndex)
         {
-            std::cerr << "invalid rewriting commandlist size!\n";
+            std::cerr << "descriptor pool is nothing!\n";
             return Result::eFailure;
         }
 
-        // for present command
-        if (co.mHRenderPass && mRPMap.count(co.mHRenderPass.value()) > 0)
+        auto&& UBs = info.SRSet.getUniformBuffers();
+        auto&& CTs = info.SRSet.getCombinedTextures();
+        auto&& Ss  = info.SRSet.getSamplers();
+
+        std::vector<VkDescriptorBufferInfo> dbi_vec;
+        dbi_vec.reserve(UBs.size());
+        std::vector<VkDescriptorImageInfo> dii_vec;
+        dii_vec.reserve(CTs.size());
+        std::vector<VkWriteDescriptorSet> writeDescriptors;
         {
-            auto& rpo = mRPMap[co.mHRenderPass.value()];
-            if (rpo.mHWindow)
+            VkDescriptorSetAllocateInfo dsai{};
+            dsai.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            dsai.descriptorPool     = mDescriptorPools[co.mDescriptorPoolIndex].second;
+            dsai.descriptorSetCount = 1;
+            dsai.pSetLayouts        = &setLayouts[info.set];
+
             {
-                auto& wo = mWindowMap[rpo.mHWindow.value()];
-                for (size_t i = 0; i < wo.mMaxFrameInFlight; ++i)
+                VkDescriptorSet set;
+                result = checkVkResult(vkAllocateDescriptorSets(mDevice, &dsai, &set));
+                if (Result::eSuccess != result)
                 {
-                    result = checkVkResult(
-                        vkWaitForFences(mDevice, 1, &rpo.mFences[i], VK_TRUE, UINT64_MAX));
-                    if (result != Result::eSuccess)
-                    {
-                        std::cerr << "Failed to wait fence!\n";
-                        return result;
-                    }
+                    std::cerr << "failed to allocate VkDescriptorSet!\n";
+                    return Result::eFailure;
                 }
+
+                co.mDescriptorSets[index][info.set] = set;
+                ++mFrameStats.descriptorSetAllocCount;
             }
-            else
+
+            if (result != Result::eSuccess)
             {
-                vkDeviceWaitIdle(mDevice);
+                std::cerr << "failed to allocate descriptor set\n";
+                return result;
             }
-        }
 
-        {  // free previous descriptor sets
-            if (!co.mDescriptorSets.empty())
+            writeDescriptors.reserve(setSizes[info.set]);
+
+            for (const auto& dub : UBs)
             {
-                uint32_t time = 0;
-                for (const auto& ds_vec : co.mDescriptorSets)
-                {
-                    std::vector<VkDescriptorSet> sets;
-                    sets.reserve(ds_vec.size());
-                    for (const auto& e : ds_vec)
-                        sets.emplace_back(e.value());
+                auto& ubo  = mBufferMap[dub.second];
+                auto&& dbi = dbi_vec.emplace_back();
+                dbi.buffer = ubo.mBuffer.value();
+                dbi.offset = 0;
+                dbi.range  = VK_WHOLE_SIZE;
 
-                    if (!sets.empty())
-                        vkFreeDescriptorSets(mDevice,
-                                         mDescriptorPools[co.mDescriptorPoolIndex].second,
-                                         sets.size(), sets.data());
+                auto&& wdi     = writeDescriptors.emplace_back(VkWriteDescriptorSet{});
+                wdi.sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                wdi.dstBinding = dub.first;
+                //if (mDebugFlag)
+                //    std::cerr << "buffer dstBinding : " << wdi.dstBinding << "\n";
+                wdi.dstArrayElement = 0;
+                wdi.descriptorCount = 1;
+                wdi.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                wdi.pBufferInfo     = &dbi_vec.back();
+                wdi.dstSet          = co.mDescriptorSets[index][info.set].value();
+            }
 
-                    auto& ubc = mDescriptorPools[co.mDescriptorPoolIndex].first.uniformBufferCount;
-                    auto& ctc = mDescriptorPools[co.mDescriptorPoolIndex].first.combinedTextureCount;
-                    ubc = (ubc >= co.mUBCount) ? ubc - co.mUBCount : 0;
-                    ctc = (ctc >= co.mCTCount) ? ctc - co.mCTCount : 0;
+            for (const auto& dct : CTs)
+            {
+                auto& cto = mImageMap[dct.second];
 
-                    co.mUBCount = 0;
-                    co.mCTCount = 0;
+                // storage texture is written from compute shader
+                bool storage = false;
+                // input attachment is read from fragment shader in the same render pass
+                bool input = false;
+                const Shader& shader = compute ? mCPMap[co.mHCPO.value()].mCS.value() : mGPMap[co.mHGPO.value()].mFS.value();
+                if (compute)
+                {
+                    const auto& layoutTable = shader.getLayoutTable();
+                    const auto itr = layoutTable.find({info.set, dct.first});
+                    storage = itr != layoutTable.end() &&
+                              itr->second == Shader::ShaderResourceType::eStorageTexture;
+                }
+                else
+                {
+                    const auto& layoutTable = shader.getLayoutTable();
+                    const auto itr = layoutTable.find({info.set, dct.first});
+                    input = itr != layoutTable.end() &&
+                            itr->second == Shader::ShaderResourceType::eInputAttachment;
                 }
 
-            }
-        }
+                // view type must match the dimension declared in shader
+                if (mDebugFlag)
+                {
+                    const auto& dimensionTable = shader.getTextureDimensionTable();
+                    const auto itr = dimensionTable.find({info.set, dct.first});
+                    if (itr != dimensionTable.end() && itr->second != cto.mDimension)
+                    {
+                        std::cerr << "dimension of texture bound to binding " << static_cast<uint32_t>(dct.first) << " does not match the shader!\n";
+                        return Result::eFailure;
+                    }
+                }
 
-        {  // allocate Descriptor from pool
-            for (const auto& commandList : commandLists)
-            {
-                co.mUBCount += commandList.getUniformBufferCount();
-                co.mCTCount += commandList.getCombinedTextureCount();
-            }
+                auto&& dii    = dii_vec.emplace_back();
+                dii.imageView = cto.mView.value();
+                dii.sampler   = VK_NULL_HANDLE;
+                if (!storage && !input)
+                {
+                    // sampler bound with the texture takes priority over the default one
+                    const auto itr = Ss.find(dct.first);
+                    if (itr != Ss.end() && mSamplerMap.count(itr->second) > 0)
+                        dii.sampler = mSamplerMap[itr->second].mSampler;
+                    else if (cto.mSampler)
+                        dii.sampler = cto.mSampler.value();
+                    else
+                    {
+                        std::cerr << "texture bound to binding " << static_cast<uint32_t>(dct.first) << " has no sampler!\n";
+                        return Result::eFailure;
+                    }
+                }
+                // dii.imageLayout = cto.currentLayout;
+                dii.imageLayout = storage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                // std::cerr << static_cast<int>(cto.currentLayout) << "\n";
 
-            bool poolConfirmed = false;
-            for (size_t i = 0; i < mDescriptorPools.size(); ++i)
-                if (co.mUBCount + mDescriptorPools[i].first.uniformBufferCount <=
-                        DescriptorPoolInfo::poolUBSize &&
-                    co.mCTCount + mDescriptorPools[i].first.combinedTextureCount <=
-                        DescriptorPoolInfo::poolCTSize)
+                // only unordered textures are created with storage usage
+                if (storage && cto.usage != TextureUsage::eUnordered)
                 {
-                    co.mDescriptorPoolIndex = i;
-                    mDescriptorPools[i].first.uniformBufferCount += co.mUBCount;
-                    mDescriptorPools[i].first.combinedTextureCount += co.mCTCount;
-                    poolConfirmed = true;
-                    break;
+                    std::cerr << "texture bound to storage binding " << static_cast<uint32_t>(dct.first) << " is not unordered!\n";
+                    return Result::eFailure;
                 }
 
-            if (!poolConfirmed)
-            {
-                co.mDescriptorPoolIndex = mDescriptorPools.size();
-                addDescriptorPool();
-                mDescriptorPools.back().first.uniformBufferCount += co.mUBCount;
-                mDescriptorPools.back().first.combinedTextureCount += co.mCTCount;
+                // the layout is restored at the end of the command list, so it does not depend on
+                // the order in which command lists are recorded
+                if (storage && cto.currentLayout != VK_IMAGE_LAYOUT_GENERAL)
+                {
+                    co.mStorageLayouts.emplace_back(dct.second, cto.currentLayout);
+                    setStorageImageBarrier(co.mCommandBuffers[index], cto.mImage.value(),
+                                           cto.currentLayout, VK_IMAGE_LAYOUT_GENERAL);
+                    cto.currentLayout = VK_IMAGE_LAYOUT_GENERAL;
+                }
+
+                auto&& wdi     = writeDescriptors.emplace_back(VkWriteDescriptorSet{});
+                wdi.sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                wdi.dstBinding = dct.first;
+                //if (mDebugFlag)
+                //    std::cerr << "image dstBinding : " << wdi.dstBinding << "\n";
+                wdi.dstArrayElement = 0;
+                wdi.descriptorCount = 1;
+                wdi.descriptorType  = storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+                                      : input ? VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT
+                                              : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                wdi.pImageInfo      = &dii_vec.back();
+                wdi.dstSet          = co.mDescriptorSets[index][info.set].value();
             }
+
+            vkUpdateDescriptorSets(mDevice,
+                                   static_cast<uint32_t>(writeDescriptors.size()),
+                                   writeDescriptors.data(), 0, nullptr);
         }
 
-        // clear barriered textures
-        // co.mBarrieredTextures.clear();
+        return Result::eSuccess;
+    }
 
-        // get internal(public) command info vector
-        for (const auto& commandList : commandLists)
+    Result Context::cmdRenderIndexed(CommandObject& co, size_t index,
+                                     const CmdRenderIndexed& info)
+    {
+        auto& gpo = mGPMap[co.mHGPO.value()];
+        std::vector<VkDescriptorSet> sets;
+        sets.reserve(co.mDescriptorSets[index].size());
+        for (const auto& e : co.mDescriptorSets[index])
         {
-            const auto& cmdData = commandList.getInternalCommandData();
+            sets.emplace_back(e.value());
+        }
 
-            vkResetCommandBuffer(co.mCommandBuffers[index], 0);
+        vkCmdBindDescriptorSets(
+            co.mCommandBuffers[index], VK_PIPELINE_BIND_POINT_GRAPHICS,
+            gpo.mPipelineLayout.value(), 0, sets.size(), sets.data(), 0, nullptr);
 
-            {  // begin command buffer
+        vkCmdDrawIndexed(co.mCommandBuffers[index], info.indexCount,
+                         info.instanceCount, info.firstIndex, info.vertexOffset,
+                         info.firstInstance);
 
-                VkCommandBufferBeginInfo commandBI{};
-                commandBI.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-                commandBI.flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-                commandBI.pInheritanceInfo = nullptr;
+        return Result::eSuccess;
+    }
 
-                result = checkVkResult(
-                    vkBeginCommandBuffer(co.mCommandBuffers[index], &commandBI));
-                if (result != Result::eSuccess)
-                {
-                    std::cerr << "Failed to begin command buffer!\n";
-                    return result;
-                }
-            }
+    Result Context::cmdDispatch(CommandObject& co, size_t index,
+                                const CmdDispatch& info)
+    {
+        auto& cpo = mCPMap[co.mHCPO.value()];
+        std::vector<VkDescriptorSet> sets;
+        sets.reserve(co.mDescriptorSets[index].size());
+        for (const auto& e : co.mDescriptorSets[index])
+        {
+            sets.emplace_back(e.value());
+        }
 
-            writeCommandInternal(co, index, cmdData, commandList.useSubCommand());
+        if (!sets.empty())
+            vkCmdBindDescriptorSets(
+                co.mCommandBuffers[index], VK_PIPELINE_BIND_POINT_COMPUTE,
+                cpo.mPipelineLayout.value(), 0, sets.size(), sets.data(), 0, nullptr);
 
-            {  // end command buffer
-                result = checkVkResult(vkEndCommandBuffer(co.mCommandBuffers[index]));
-                if (result != Result::eSuccess)
-                {
-                    std::cerr << "Failed to end command buffer!\n";
-                    return result;
-                }
-            }
+        vkCmdDispatch(co.mCommandBuffers[index], info.groupCountX, info.groupCountY,
+                      info.groupCountZ);
 
-            ++index;
+        return Result::eSuccess;
+    }
+
+    Result Context::cmdRender(CommandObject& co, size_t index,
+                              const CmdRender& info)
+    {
+        auto& gpo = mGPMap[co.mHGPO.value()];
+
+        std::vector<VkDescriptorSet> sets;
+        sets.reserve(co.mDescriptorSets[index].size());
+        for (const auto& e : co.mDescriptorSets[index])
+        {
+            sets.emplace_back(e.value());
         }
 
-        // mCommandBufferMap.at(handle) = co;
+        vkCmdBindDescriptorSets(
+            co.mCommandBuffers[index], VK_PIPELINE_BIND_POINT_GRAPHICS,
+            gpo.mPipelineLayout.value(), 0, sets.size(), sets.data(), 0, nullptr);
 
-        return result;
+        vkCmdDraw(co.mCommandBuffers[index], info.vertexCount, info.instanceCount,
+                  info.vertexOffset, info.firstInstance);
+
+        return Result::eSuccess;
     }
 
-    Result Context::updateCommandBuffer(const CommandList& commandList, const HCommandBuffer& handle)
+    Result Context::cmdBarrier(CommandObject& co, size_t index,
+                               const CmdBarrier& info)
     {
-        return updateCommandBuffer(std::vector<CommandList>(1, commandList), handle);
-    }
+        if (mDebugFlag && mImageMap.count(info.handle) <= 0)
+        {
+            std::cerr << "invalid texture handle!\n";
+            return Result::eFailure;
+        }
+
+        auto& io = mImageMap[info.handle];
+        setImageMemoryBarrier(co.mCommandBuffers[index], io.mImage.value(),
+                              io.currentLayout,
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        io.currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        // co.mBarrieredTextures.emplace_back(info.handle);
 
-    Result Context::updateSubCommandBuffer(const SubCommandList& subCommandList, const HCommandBuffer& handle)
-    {
-        return updateSubCommandBuffer(std::vector<SubCommandList>(1, subCommandList), handle);
+        return Result::eSuccess;
     }
 
-    Result Context::updateSubCommandBuffer(const std::vector<SubCommandList>& subCommandLists, const HCommandBuffer& handle)
+    Result Context::cmdTransition(CommandObject& co, size_t index,
+                                  const CmdTransition& info)
     {
-        if (!mIsInitialized)
+        if (mDebugFlag && mImageMap.count(info.handle) <= 0)
         {
-            std::cerr << "context did not initialize yet!\n";
+            std::cerr << "invalid texture handle!\n";
             return Result::eFailure;
         }
 
-        Result result = Result::eSuccess;
-
-        if (mCommandBufferMap.count(handle) <= 0)
-        {
-            std::cerr << "create command buffer first!\n";
-            return Result::eFailure;
-        }
+        auto& io = mImageMap[info.handle];
 
-        CommandObject& co = mCommandBufferMap[handle];
-        co.mPresentFlag   = false;
+        // fragment stage is not supported on compute queue
+        const VkPipelineStageFlags shaderStages =
+            co.mQueueType == QueueType::eCompute
+                ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+                : VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
 
-        {  // free previous descriptor sets
-            if (!co.mDescriptorSets.empty())
+        const auto convert = [&](TextureAccess access, VkImageLayout& layout,
+                                 VkAccessFlags& accessMask, VkPipelineStageFlags& stage)
+        {
+            switch (access)
             {
-                for (const auto& ds_vec : co.mDescriptorSets)
-                {
-                    std::vector<VkDescriptorSet> sets;
-                    sets.reserve(ds_vec.size());
-                    for (const auto& e : ds_vec)
-                        sets.emplace_back(e.value());
+                case TextureAccess::eUndefined:
+                    layout     = VK_IMAGE_LAYOUT_UNDEFINED;
+                    accessMask = 0;
+                    stage      = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                    break;
+                case TextureAccess::eColorAttachment:
+                    layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                    accessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                                 VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+                    stage      = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                    break;
+                case TextureAccess::eDepthAttachment:
+                    layout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+                    accessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                 VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+                    stage      = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+                    break;
+                case TextureAccess::eShaderRead:
+                    layout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                    accessMask = VK_ACCESS_SHADER_READ_BIT;
+                    stage      = shaderStages;
+                    break;
+                case TextureAccess::eStorage:
+                    layout     = VK_IMAGE_LAYOUT_GENERAL;
+                    accessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                    stage      = shaderStages;
+                    break;
+            }
+        };
 
-                    if (!sets.empty())
-                    vkFreeDescriptorSets(mDevice,
-                                         mDescriptorPools[co.mDescriptorPoolIndex].second,
-                                         sets.size(), sets.data());
+        VkImageMemoryBarrier imb{};
+        imb.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imb.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imb.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imb.subresourceRange    = io.range;
+        imb.image               = io.mImage.value();
 
-                    auto& ubc =
-                        mDescriptorPools[co.mDescriptorPoolIndex].first.uniformBufferCount;
-                    auto& ctc = mDescriptorPools[co.mDescriptorPoolIndex]
-                                    .first.combinedTextureCount;
-                    ubc = ubc >= co.mUBCount ? ubc - co.mUBCount : 0;
-                    ctc = ctc >= co.mCTCount ? ctc - co.mCTCount : 0;
-                }
-            }
+        VkPipelineStageFlags srcStage, dstStage;
+        convert(info.src, imb.oldLayout, imb.srcAccessMask, srcStage);
+        convert(info.dst, imb.newLayout, imb.dstAccessMask, dstStage);
 
-            // co.mDescriptorSets.clear();
+        // aliased memory is handed over from the previous texture (WAR/WAW on the same memory)
+        VkMemoryBarrier mb{};
+        mb.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        uint32_t memoryBarrierCount = 0;
+        if (info.src == TextureAccess::eUndefined && info.discarded != TextureAccess::eUndefined)
+        {
+            VkImageLayout discardedLayout;
+            convert(info.discarded, discardedLayout, mb.srcAccessMask, srcStage);
+            mb.dstAccessMask   = imb.dstAccessMask;
+            memoryBarrierCount = 1;
         }
 
-        {  // allocate Descriptor from pool
-            for (const auto& commandList : subCommandLists)
-            {
-                co.mUBCount += commandList.getUniformBufferCount();
-                co.mCTCount += commandList.getCombinedTextureCount();
-            }
-
-            bool poolConfirmed = false;
-            for (size_t i = 0; i < mDescriptorPools.size(); ++i)
-                if (co.mUBCount + mDescriptorPools[i].first.uniformBufferCount <=
-                        DescriptorPoolInfo::poolUBSize ||
-                    co.mCTCount + mDescriptorPools[i].first.combinedTextureCount <=
-                        DescriptorPoolInfo::poolCTSize)
-                {
-                    co.mDescriptorPoolIndex = i;
-                    mDescriptorPools[i].first.uniformBufferCount += co.mUBCount;
-                    mDescriptorPools[i].first.combinedTextureCount += co.mCTCount;
-                    poolConfirmed = true;
-                    break;
-                }
+        vkCmdPipelineBarrier(co.mCommandBuffers[index], srcStage, dstStage, 0, memoryBarrierCount,
+                             &mb, 0, nullptr, 1, &imb);
 
-            if (!poolConfirmed)
-            {
-                co.mDescriptorPoolIndex = mDescriptorPools.size();
-                addDescriptorPool();
-                mDescriptorPools.back().first.uniformBufferCount += co.mUBCount;
-                mDescriptorPools.back().first.combinedTextureCount += co.mCTCount;
-            }
-        }
+        // following render pass begin does not need to transition again
+        io.currentLayout = imb.newLayout;
 
-        // clear barriered textures
-        // co.mBarrieredTextures.clear();
+        return Result::eSuccess;
+    }
 
-        if (co.mCommandBuffers.size() != subCommandLists.size())
+    Result Context::cmdExecuteSubCommand(CommandObject& co, size_t frameBufferIndex,
+                                         const CmdExecuteSubCommand& info)
+    {
+        if (mDebugFlag && mCommandBufferMap.count(info.handle) <= 0)
         {
-            std::cerr << "invalid rewriting commandlist size!\n";
+            std::cerr << "invalid sub command buffer handle!\n";
             return Result::eFailure;
         }
 
-        // for present command
-        if (co.mHRenderPass && mRPMap.count(co.mHRenderPass.value()) > 0)
+        auto&& subCO = mCommandBufferMap[info.handle];
+        if (mDebugFlag && !subCO.mSubCommand)
         {
-            auto& rpo = mRPMap[co.mHRenderPass.value()];
-            if (rpo.mHWindow)
-            {
-                auto& wo = mWindowMap[rpo.mHWindow.value()];
-                for (size_t i = 0; i < wo.mMaxFrameInFlight; ++i)
-                {
-                    result = checkVkResult(
-                        vkWaitForFences(mDevice, 1, &rpo.mFences[i], VK_TRUE, UINT64_MAX));
-                    if (result != Result::eSuccess)
-                    {
-                        std::cerr << "Failed to wait fence!\n";
-                        return result;
-                    }
-                }
-            }
-            else
-            {
-                vkDeviceWaitIdle(mDevice);
-            }
+            std::cerr << "thi command buffer is primary!\n";
+            return Result::eFailure;
         }
 
-        uint32_t index = 0;
-        // get internal(public) command info vector
-        for (const auto& subCommandList : subCommandLists)
+        if (subCO.mNeedsRerecord)
         {
-            const auto& cmdData = subCommandList.getInternalCommandData();
-
-            vkResetCommandBuffer(co.mCommandBuffers[index], 0);
-
-            {  // begin command buffer
-                auto& rpo = mRPMap[subCommandList.getRenderPass()];
-                VkCommandBufferInheritanceInfo commandii{};
-                commandii.sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
-                commandii.pNext                = nullptr;
-                commandii.renderPass           = rpo.mRenderPass.value();
-                commandii.framebuffer          = rpo.mFramebuffers[index].value();
-                commandii.subpass              = 0;
-                commandii.occlusionQueryEnable = VK_FALSE;
-                commandii.queryFlags           = 0;
-                commandii.pipelineStatistics   = 0;
-
-                VkCommandBufferBeginInfo commandBI{};
-                commandBI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-                commandBI.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
-                                  VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-                commandBI.pInheritanceInfo = &commandii;
-
-                result = checkVkResult(
-                    vkBeginCommandBuffer(co.mCommandBuffers[index], &commandBI));
-                if (result != Result::eSuccess)
-                {
-                    std::cerr << "Failed to begin command buffer!\n";
-                    return result;
-                }
-            }
-
-            writeCommandInternal(co, index, cmdData);
-
-            {  // end command buffer
-                result = checkVkResult(vkEndCommandBuffer(co.mCommandBuffers[index]));
-                if (result != Result::eSuccess)
-                {
-                    std::cerr << "Failed to end command buffer!\n";
-                    return result;
-                }
-            }
-
-            ++index;
+            const Result result = rerecordCommandBuffer(info.handle);
+            if (Result::eSuccess != result)
+                return result;
         }
 
-        // mCommandBufferMap.at(handle) = co;
+        vkCmdExecuteCommands(co.mCommandBuffers[frameBufferIndex], 1,
+                             &subCO.mCommandBuffers[frameBufferIndex]);
 
-        return result;
+        return Result::eSuccess;
     }
 
-    Result Context::writeCommandInternal(CommandObject& co, size_t index,
-                                         const InternalCommandList& icl,
-                                         const bool useSecondary)
+    uint32_t Context::getFrameBufferIndex(const HRenderPass& handle) const
     {
-        Result result = Result::eSuccess;
-
-        uint32_t debug = 0;
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return 0;
+        }
 
-        for (const auto& command : icl)
+        if (mRPMap.count(handle) <= 0)
         {
-            // if (mDebugFlag)
-            // std::cerr << "now command : " << debug++ << "\n";
-            switch (command.first)  // RIP RTTI
-            {
-                case CommandType::eBegin:
-                    if (!std::holds_alternative<CmdBegin>(command.second))
-                        return Result::eFailure;
-                    result = cmdBegin(co, index, std::get<CmdBegin>(command.second), useSecondary);
-                    break;
-                case CommandType::eEnd:
-                    if (!std::holds_alternative<CmdEnd>(command.second))
-                        return Result::eFailure;
-                    result = cmdEnd(co, index, std::get<CmdEnd>(command.second));
-                    break;
-                case CommandType::eBindGraphicsPipeline:
-                    if (!std::holds_alternative<CmdBindGraphicsPipeline>(command.second))
-                        return Result::eFailure;
-                    result = cmdBindGraphicsPipeline(
-                        co, index, std::get<CmdBindGraphicsPipeline>(command.second));
-                    break;
-                case CommandType::ePresent:
-                    if (!std::holds_alternative<CmdPresent>(command.second))
-                        return Result::eFailure;
-                    co.mPresentFlag = true;
-                    break;
-                case CommandType::eBindVB:
-                    if (!std::holds_alternative<CmdBindVB>(command.second))
-                        return Result::eFailure;
-                    result = cmdBindVB(co, index, std::get<CmdBindVB>(command.second));
-                    break;
-                case CommandType::eBindIB:
-                    if (!std::holds_alternative<CmdBindIB>(command.second))
-                        return Result::eFailure;
-                    result = cmdBindIB(co, index, std::get<CmdBindIB>(command.second));
-                    break;
-                case CommandType::eBindSRSet:
-                    if (!std::holds_alternative<CmdBindSRSet>(command.second))
-                        return Result::eFailure;
-                    result = cmdBindSRSet(co, index, std::get<CmdBindSRSet>(command.second));
-                    break;
-                case CommandType::eRender:
-                    if (!std::holds_alternative<CmdRender>(command.second))
-                        return Result::eFailure;
-                    result = cmdRender(co, index, std::get<CmdRender>(command.second));
-                    break;
-                case CommandType::eRenderIndexed:
-                    if (!std::holds_alternative<CmdRenderIndexed>(command.second))
-                        return Result::eFailure;
-                    result = cmdRenderIndexed(co, index,
-                                              std::get<CmdRenderIndexed>(command.second));
-                    break;
-                case CommandType::eBarrier:
-                    if (!std::holds_alternative<CmdBarrier>(command.second))
-                        return Result::eFailure;
-                    result = cmdBarrier(co, index, std::get<CmdBarrier>(command.second));
-                    break;
-                case CommandType::eRenderImGui:
-                    if (!std::holds_alternative<CmdRenderImGui>(command.second))
-                        return Result::eFailure;
-                    result = cmdRenderImGui(co, index);
-                    break;
-                case CommandType::eExecuteSubCommand:
-                    if (!std::holds_alternative<CmdExecuteSubCommand>(command.second))
-                        return Result::eFailure;
-                    result = cmdExecuteSubCommand(
-                        co, index, std::get<CmdExecuteSubCommand>(command.second));
-                    break;
-                default:
-                    std::cerr << "invalid command!\nrequested command : "
-                              << static_cast<int>(command.first) << "\n";
-                    return Result::eFailure;
-                    break;
-            }
+            std::cerr << "invalid renderpass handle!\n";
+            return 0;
+        }
+
+        return mRPMap.at(handle).mFrameBufferIndex;
+    }
 
-            if (result != Result::eSuccess)
-                return result;
+    Result Context::cmdRenderImGui(CommandObject& co, size_t frameBufferIndex)
+    {
+        Result result = Result::eSuccess;
+
+        // Record dear imgui primitives into command buffer
+        auto* pData = ImGui::GetDrawData();
+        if (!pData)
+        {
+            std::cerr << "invalid ImGui command call!\n";
+            return Result::eFailure;
         }
 
-        return Result::eSuccess;
+        ImGui_ImplVulkan_RenderDrawData(pData, co.mCommandBuffers[frameBufferIndex]);
+
+        return result;
     }
 
-    Result Context::cmdBegin(CommandObject& co, size_t frameBufferIndex, const CmdBegin& info, const bool useSecondary)
+    Result Context::execute(const HCommandBuffer& handle)
     {
+        return execute(handle, {});
+    }
+
+    Result Context::execute(const HCommandBuffer& handle, const std::vector<HCommandBuffer>& waitCommandBuffers)
+    {
+        if (!mIsInitialized)
+        {
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
+        }
+
+        TraceScope trace(mTracer, "execute");
+
         Result result = Result::eSuccess;
 
-        auto& command = co.mCommandBuffers[frameBufferIndex];
-        if (mDebugFlag && mRPMap.count(info.handle) <= 0)
+        if (mDebugFlag && mCommandBufferMap.count(handle) <= 0)
         {
-            std::cerr << "invalid render pass!\n";
+            std::cerr << "invalid commandbuffer handle!\n";
             return Result::eFailure;
         }
 
-        auto& rpo = mRPMap[info.handle];
+        auto& co = mCommandBufferMap[handle];
+        if (co.mQueueType == QueueType::eCompute)
+            return executeCompute(co, waitCommandBuffers);
 
-        co.mHRenderPass = info.handle;
+        if (!co.mHRenderPass)
+        {
+            std::cerr << "render pass of this command is invalid!\n";
+            return Result::eFailure;
+        }
 
-        VkRenderPassBeginInfo bi{};
+        if (co.mSubCommand)
+        {
+            std::cerr << "this command buffer is sub(secondary)!\n";
+            return Result::eFailure;
+        }
 
-        std::vector<VkClearValue> clearValues;
-        if (!rpo.mHWindow)
+        // control transition of texture layout by barrier
+        //{
+        //    for (auto& handle : co.mBarrieredTextures)
+        //        mImageMap[handle].currentLayout =
+        //        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        //}
+
+        // vkQueueWaitIdle(mDeviceQueue);
+        // vkDeviceWaitIdle(mDevice);
+
+        auto& rpo = mRPMap[co.mHRenderPass.value()];
+
+        // cross queue dependencies
+        std::vector<VkSemaphore> waitSems;
+        std::vector<uint64_t> waitValues;
+        std::vector<VkPipelineStageFlags> waitStages;
+        result = getWaitSemaphores(waitCommandBuffers, waitSems, waitValues, waitStages);
+        if (result != Result::eSuccess)
+            return result;
+
+        if (rpo.mHWindow && co.mPresentFlag)
         {
-            clearValues.reserve(rpo.colorTargets.size() + 1);
+            auto& wo = mWindowMap[rpo.mHWindow.value()];
 
-            for (size_t i = 0; i < rpo.colorTargets.size(); ++i)
-            {
-                clearValues.emplace_back();
-                auto& cv = clearValues.back();
-                auto& io = mImageMap[rpo.colorTargets[i]];
-                switch (io.format)
-                {
-                    case VK_FORMAT_R32_UINT:
-                    case VK_FORMAT_R32G32_UINT:
-                    case VK_FORMAT_R32G32B32_UINT:
-                    case VK_FORMAT_R32G32B32A32_UINT:
-                        cv.color.uint32[0] = static_cast<uint32_t>(info.ccv[0] * 255);
-                        cv.color.uint32[1] = static_cast<uint32_t>(info.ccv[1] * 255);
-                        cv.color.uint32[2] = static_cast<uint32_t>(info.ccv[2] * 255);
-                        cv.color.uint32[3] = static_cast<uint32_t>(info.ccv[3] * 255);
-                        break;
+            bool acquired   = false;
+            uint64_t waitNs = 0;
+            result          = acquireWindowImage(handle, acquired, waitNs);
+            if (result != Result::eSuccess || !acquired)
+                return result;
 
-                    case VK_FORMAT_R8_UNORM:
-                    case VK_FORMAT_R8G8_UNORM:
-                    case VK_FORMAT_R8G8B8_UNORM:
-                    case VK_FORMAT_R8G8B8A8_UNORM:
-                    case VK_FORMAT_R32_SFLOAT:
-                    case VK_FORMAT_R32G32_SFLOAT:
-                    case VK_FORMAT_R32G32B32_SFLOAT:
-                    case VK_FORMAT_R32G32B32A32_SFLOAT:
-                        cv.color.float32[0] = info.ccv[0];
-                        cv.color.float32[1] = info.ccv[1];
-                        cv.color.float32[2] = info.ccv[2];
-                        cv.color.float32[3] = info.ccv[3];
-                        break;
+            // nothing is signaled for skipped frames
+            const uint64_t prevSignalValue = co.mSignalValue;
+            co.mSignalValue                = ++mGraphicsTimelineValue;
+            const size_t commandIndex      = rpo.mFrameBufferIndex % co.mCommandBuffers.size();
 
-                    case VK_FORMAT_R32_SINT:
-                    case VK_FORMAT_R32G32_SINT:
-                    case VK_FORMAT_R32G32B32_SINT:
-                    case VK_FORMAT_R32G32B32A32_SINT:
-                        cv.color.int32[0] = static_cast<int32_t>(info.ccv[0] * 127);
-                        cv.color.int32[1] = static_cast<int32_t>(info.ccv[1] * 127);
-                        cv.color.int32[2] = static_cast<int32_t>(info.ccv[2] * 127);
-                        cv.color.int32[3] = static_cast<int32_t>(info.ccv[3] * 127);
-                        break;
-                    default:
-                        std::cerr << "invalid type of pixel!\n";
-                        return Result::eFailure;
-                        break;
-                }
+            // submit command
+            // binary semaphores ignore their values
+            waitSems.emplace_back(rpo.mPresentCompletedSems[wo.mCurrentFrame]);
+            waitValues.emplace_back(0);
+            waitStages.emplace_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+            const std::array<VkSemaphore, 2> signalSems = {rpo.mRenderCompletedSems[wo.mCurrentFrame], mGraphicsTimelineSem};
+            const std::array<uint64_t, 2> signalValues  = {0, co.mSignalValue};
+
+            VkTimelineSemaphoreSubmitInfo tssi{};
+            tssi.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            tssi.waitSemaphoreValueCount   = static_cast<uint32_t>(waitValues.size());
+            tssi.pWaitSemaphoreValues      = waitValues.data();
+            tssi.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+            tssi.pSignalSemaphoreValues    = signalValues.data();
+
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.pNext              = &tssi;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers    = &co.mCommandBuffers[commandIndex];
+            submitInfo.pWaitDstStageMask    = waitStages.data();
+            submitInfo.waitSemaphoreCount   = static_cast<uint32_t>(waitSems.size());
+            submitInfo.pWaitSemaphores      = waitSems.data();
+            submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSems.size());
+            submitInfo.pSignalSemaphores    = signalSems.data();
+
+            result = checkVkResult(vkQueueSubmit(mDeviceQueue, 1, &submitInfo, VK_NULL_HANDLE));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to submit cmd to queue!\n";
+
+                // the value is never signaled, so it must not be waited
+                --mGraphicsTimelineValue;
+                co.mSignalValue = prevSignalValue;
+                return result;
             }
 
-            if (rpo.mDepthTestEnable)
+            rpo.mFrameSignalValues[wo.mCurrentFrame]  = co.mSignalValue;
+            rpo.imagesInFlight[rpo.mFrameBufferIndex] = co.mSignalValue;
+
+            submitProfilerQueries(co, commandIndex);
+
+            // present
+            VkPresentInfoKHR presentInfo{};
+            presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+            presentInfo.swapchainCount     = 1;
+            presentInfo.pSwapchains        = &wo.mSwapchain.value();
+            presentInfo.pImageIndices      = &rpo.mFrameBufferIndex;
+            presentInfo.waitSemaphoreCount = 1;
+            presentInfo.pWaitSemaphores    = &rpo.mRenderCompletedSems[wo.mCurrentFrame];
+
+            const VkResult vkResult = vkQueuePresentKHR(mDeviceQueue, &presentInfo);
+            if (vkResult == VK_ERROR_OUT_OF_DATE_KHR || vkResult == VK_SUBOPTIMAL_KHR)
+                wo.mNeedsRecreate = true;
+            else if (vkResult != VK_SUCCESS)
             {
-                clearValues.emplace_back().depthStencil = {std::get<0>(info.dcv),
-                                                           std::get<1>(info.dcv)};
+                std::cerr << "Failed to present queue!\n";
+                return checkVkResult(vkResult);
             }
+
+            markFrameEnd();
+
+            updateFramePacing(wo, waitNs, co.mSignalValue);
+
+            wo.mCurrentFrame = (wo.mCurrentFrame + 1) % wo.mMaxFrameInFlight;
         }
         else
         {
-            clearValues.resize(2);
-            clearValues[0].color        = {info.ccv[0], info.ccv[1], info.ccv[2], info.ccv[3]};
-            clearValues[1].depthStencil = {std::get<0>(info.dcv),
-                                           std::get<1>(info.dcv)};
-        }
-
-        bi.clearValueCount = clearValues.size();
-        bi.pClearValues    = clearValues.data();
+            // only the previous execution of the same command buffer is waited
+            // (its query pool is reset and it is submitted again), independent of the render passes in it
+            const size_t commandIndex = co.mExecuteIndex;
+            {
+                TraceScope trace(mTracer, "wait fence");
+                result = checkVkResult(
+                    vkWaitForFences(mDevice, 1, &co.mFences[commandIndex], VK_TRUE, UINT64_MAX));
+            }
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "Failed to wait fence!\n";
+                return result;
+            }
 
-        if (!rpo.mHWindow && info.clear && !rpo.mLoadPrevData)
-        {
-            if (rpo.depthTarget)
+            // command list i has been recorded with the framebuffer of frame i in every render pass
+            for (const auto& hRenderPass : co.mHRenderPasses)
             {
-                auto& io = mImageMap[rpo.depthTarget.value()];
-                if (io.currentLayout !=
-                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-                {
-                    // vkCmdClearDepthStencilImage(command, io.mImage.value(), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                    //                             &clearValues[1].depthStencil, 1, &io.range);
+                if (mRPMap.count(hRenderPass) <= 0)
+                    continue;
+                auto& passRpo = mRPMap[hRenderPass];
+                if (passRpo.mHWindow || passRpo.mFramebuffers.empty())
+                    continue;
 
-                    setImageMemoryBarrier(command, io.mImage.value(), io.currentLayout,
-                                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                                          io.range.aspectMask);
-                    io.currentLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-                }
-                // else
-                //{
-                //     setImageMemoryBarrier(command, io.mImage.value(),
-                //     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                //     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                //     io.range.aspectMask);
-                //     vkCmdClearDepthStencilImage(command, io.mImage.value(),
-                //     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                //     &clearValues[1].depthStencil, 1, &io.range);
-                //     setImageMemoryBarrier(command, io.mImage.value(),
-                //     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                //     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                //     io.range.aspectMask); io.currentLayout =
-                //     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-                // }
+                if (mDebugFlag && co.mCommandBuffers.size() < passRpo.mFramebuffers.size())
+                    std::cerr << "command lists are fewer than frame color targets, some targets are never rendered!\n";
+                passRpo.mFrameBufferIndex = static_cast<uint32_t>(commandIndex % passRpo.mFramebuffers.size());
             }
 
-            for (const auto& tex : rpo.colorTargets)
+            result = resolveProfilerQueries(co, commandIndex);
+            if (result != Result::eSuccess)
+                return result;
+
+            // reset just before the submit, so no early return leaves it unsignaled
+            result = checkVkResult(vkResetFences(mDevice, 1, &co.mFences[commandIndex]));
+            if (result != Result::eSuccess)
             {
-                auto& io = mImageMap[tex];
-                // VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                std::cerr << "failed to reset fence!\n";
+                return result;
+            }
 
-                // setImageMemoryBarrier(command, io.mImage.value(),
-                // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                // VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-                // vkCmdClearColorImage(command, io.mImage.value(),
-                //                      VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                //                      &clearValues[0].color, 1, &io.range);
-                // setImageMemoryBarrier(command,
-                //  io.mImage.value(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                //  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-                if (io.currentLayout != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-                {
-                    setImageMemoryBarrier(command, io.mImage.value(), io.currentLayout,
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                          io.range.aspectMask);
-                    io.currentLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-                }
+            const uint64_t prevSignalValue = co.mSignalValue;
+            co.mSignalValue                = ++mGraphicsTimelineValue;
+
+            // submit command
+            VkTimelineSemaphoreSubmitInfo tssi{};
+            tssi.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            tssi.waitSemaphoreValueCount   = static_cast<uint32_t>(waitValues.size());
+            tssi.pWaitSemaphoreValues      = waitValues.data();
+            tssi.signalSemaphoreValueCount = 1;
+            tssi.pSignalSemaphoreValues    = &co.mSignalValue;
+
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.pNext              = &tssi;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers    = &co.mCommandBuffers[commandIndex];
+            submitInfo.pWaitDstStageMask    = waitStages.data();
+            submitInfo.waitSemaphoreCount   = static_cast<uint32_t>(waitSems.size());
+            submitInfo.pWaitSemaphores      = waitSems.data();
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores    = &mGraphicsTimelineSem;
+
+            result = checkVkResult(vkQueueSubmit(mDeviceQueue, 1, &submitInfo,
+                                                 co.mFences[commandIndex]));
+            if (result != Result::eSuccess)
+            {
+                std::cerr << "failed to submit cmd to queue!\n";
+
+                // the value is never signaled and the fence would never be signaled again
+                --mGraphicsTimelineValue;
+                co.mSignalValue = prevSignalValue;
+                restoreFence(co.mFences[commandIndex]);
+                return result;
             }
+
+            co.mExecuteIndex = static_cast<uint32_t>((commandIndex + 1) % co.mCommandBuffers.size());
+
+            submitProfilerQueries(co, commandIndex);
         }
-        else if (info.clear && !rpo.mLoadPrevData)
+
+        return Result::eSuccess;
+    }
+
+    Result Context::executeWindows(const std::vector<HCommandBuffer>& handles, const std::vector<HCommandBuffer>& waitCommandBuffers)
+    {
+        if (!mIsInitialized)
         {
-            for (const auto& tex : rpo.colorTargets)
-            {
-                auto& io = mImageMap[tex];
-                if (io.currentLayout != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-                {
-                    setImageMemoryBarrier(
-                        command, io.mImage.value(), VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, io.range.aspectMask);
-                    io.currentLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-                }
-            }
+            std::cerr << "context did not initialize yet!\n";
+            return Result::eFailure;
         }
-        else
+
+        TraceScope trace(mTracer, "executeWindows");
+
+        Result result = Result::eSuccess;
+
+        std::vector<HWindow> windows;
+        windows.reserve(handles.size());
+        for (const auto& handle : handles)
         {
-            if (rpo.depthTarget)
+            if (mCommandBufferMap.count(handle) <= 0)
+            {
+                std::cerr << "invalid commandbuffer handle!\n";
+                return Result::eFailure;
+            }
+
+            const auto& co = mCommandBufferMap[handle];
+            if (co.mQueueType != QueueType::eGraphics || co.mSubCommand || !co.mHRenderPass || !co.mPresentFlag ||
+                !mRPMap[co.mHRenderPass.value()].mHWindow)
             {
-                auto& io = mImageMap[rpo.depthTarget.value()];
-                if (io.currentLayout !=
-                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-                {
-                    setImageMemoryBarrier(command, io.mImage.value(), io.currentLayout,
-                                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                                          io.range.aspectMask);
-                    io.currentLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-                }
+                std::cerr << "command buffer does not present to any window!\n";
+                return Result::eFailure;
             }
 
-            for (const auto& img : rpo.colorTargets)
+            const HWindow window = mRPMap[co.mHRenderPass.value()].mHWindow.value();
+            if (std::find(windows.begin(), windows.end(), window) != windows.end())
             {
-                auto& io = mImageMap[img];
-                if (io.currentLayout != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-                {
-                    setImageMemoryBarrier(command, io.mImage.value(), io.currentLayout,
-                                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-                    io.currentLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-                }
+                std::cerr << "each window can be presented only once in a frame!\n";
+                return Result::eFailure;
             }
+            windows.emplace_back(window);
         }
 
-        bi.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        bi.renderPass        = rpo.mRenderPass.value();
-        bi.renderArea.offset = {0, 0};
-        bi.renderArea.extent = {rpo.mExtent.value().width,
-                                rpo.mExtent.value().height};
-        bi.framebuffer =
-            rpo.mFramebuffers[frameBufferIndex % rpo.mFramebuffers.size()].value();
+        // cross queue dependencies
+        std::vector<VkSemaphore> waitSems;
+        std::vector<uint64_t> waitValues;
+        std::vector<VkPipelineStageFlags> waitStages;
+        result = getWaitSemaphores(waitCommandBuffers, waitSems, waitValues, waitStages);
+        if (result != Result::eSuccess)
+            return result;
 
-        if (useSecondary)
-            vkCmdBeginRenderPass(command, &bi,
-                                 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
-        else
-            vkCmdBeginRenderPass(command, &bi, VK_SUBPASS_CONTENTS_INLINE);
+        // acquire images of all windows first, minimized (or out of date) windows are skipped
+        std::vector<HCommandBuffer> acquiredHandles;
+        std::vector<uint64_t> waitNs;
 
-        return Result::eSuccess;
-    }
+        // on failure, images already acquired must not be left with pending semaphore signals
+        // (wait them with an empty batch, and the swapchains are recreated to return the images)
+        const auto releaseAcquired = [this, &acquiredHandles]()
+        {
+            if (acquiredHandles.empty())
+                return;
 
-    Result Context::cmdEnd(CommandObject& co, size_t index, const CmdEnd& info)
-    {
-        auto& command = co.mCommandBuffers[index];
-        auto& rpo     = mRPMap[co.mHRenderPass.value()];
+            std::vector<VkSemaphore> sems;
+            for (const auto& handle : acquiredHandles)
+            {
+                auto& rpo = mRPMap[mCommandBufferMap[handle].mHRenderPass.value()];
+                auto& wo  = mWindowMap[rpo.mHWindow.value()];
+                sems.emplace_back(rpo.mPresentCompletedSems[wo.mCurrentFrame]);
+                wo.mNeedsRecreate = true;
+            }
+            const std::vector<VkPipelineStageFlags> stages(sems.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
 
-        if (rpo.mHWindow)
-        {
-            for (auto& htex : rpo.colorTargets)
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.waitSemaphoreCount = static_cast<uint32_t>(sems.size());
+            submitInfo.pWaitSemaphores    = sems.data();
+            submitInfo.pWaitDstStageMask  = stages.data();
+            if (vkQueueSubmit(mDeviceQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+                std::cerr << "failed to wait acquired images!\n";
+        };
+
+        for (const auto& handle : handles)
+        {
+            bool acquired        = false;
+            uint64_t frameWaitNs = 0;
+            result               = acquireWindowImage(handle, acquired, frameWaitNs);
+            if (result != Result::eSuccess)
             {
-                auto& io = mImageMap[htex];
-                setImageMemoryBarrier(command, io.mImage.value(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+                if (acquired)
+                    acquiredHandles.emplace_back(handle);
+                releaseAcquired();
+                return result;
+            }
+
+            if (acquired)
+            {
+                acquiredHandles.emplace_back(handle);
+                waitNs.emplace_back(frameWaitNs);
             }
         }
 
-        vkCmdEndRenderPass(command);
+        if (acquiredHandles.empty())
+            return Result::eSuccess;
 
-        return Result::eSuccess;
-    }
+        // one batch per window so that each window waits only its own image
+        const size_t count = acquiredHandles.size();
+        std::vector<std::vector<VkSemaphore>> batchWaitSems(count, waitSems);
+        std::vector<std::vector<uint64_t>> batchWaitValues(count, waitValues);
+        std::vector<std::vector<VkPipelineStageFlags>> batchWaitStages(count, waitStages);
+        std::vector<std::array<VkSemaphore, 2>> signalSems(count);
+        std::vector<std::array<uint64_t, 2>> signalValues(count);
+        std::vector<VkTimelineSemaphoreSubmitInfo> tssis(count);
+        std::vector<VkSubmitInfo> submitInfos(count);
+        std::vector<uint64_t> prevSignalValues(count);
+        const uint64_t prevTimelineValue = mGraphicsTimelineValue;
+        std::vector<VkSwapchainKHR> swapchains(count);
+        std::vector<uint32_t> imageIndices(count);
+        std::vector<VkSemaphore> renderCompletedSems(count);
+        std::vector<size_t> commandIndices(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto& co  = mCommandBufferMap[acquiredHandles[i]];
+            auto& rpo = mRPMap[co.mHRenderPass.value()];
+            auto& wo  = mWindowMap[rpo.mHWindow.value()];
+
+            prevSignalValues[i] = co.mSignalValue;
+            co.mSignalValue     = ++mGraphicsTimelineValue;
+            commandIndices[i]   = rpo.mFrameBufferIndex % co.mCommandBuffers.size();
+
+            // binary semaphores ignore their values
+            batchWaitSems[i].emplace_back(rpo.mPresentCompletedSems[wo.mCurrentFrame]);
+            batchWaitValues[i].emplace_back(0);
+            batchWaitStages[i].emplace_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+            signalSems[i]   = {rpo.mRenderCompletedSems[wo.mCurrentFrame], mGraphicsTimelineSem};
+            signalValues[i] = {0, co.mSignalValue};
+
+            auto& tssi                     = tssis[i];
+            tssi.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            tssi.waitSemaphoreValueCount   = static_cast<uint32_t>(batchWaitValues[i].size());
+            tssi.pWaitSemaphoreValues      = batchWaitValues[i].data();
+            tssi.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues[i].size());
+            tssi.pSignalSemaphoreValues    = signalValues[i].data();
+
+            auto& submitInfo                = submitInfos[i];
+            submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.pNext                = &tssi;
+            submitInfo.commandBufferCount   = 1;
+            submitInfo.pCommandBuffers      = &co.mCommandBuffers[commandIndices[i]];
+            submitInfo.pWaitDstStageMask    = batchWaitStages[i].data();
+            submitInfo.waitSemaphoreCount   = static_cast<uint32_t>(batchWaitSems[i].size());
+            submitInfo.pWaitSemaphores      = batchWaitSems[i].data();
+            submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSems[i].size());
+            submitInfo.pSignalSemaphores    = signalSems[i].data();
+
+            swapchains[i]          = wo.mSwapchain.value();
+            imageIndices[i]        = rpo.mFrameBufferIndex;
+            renderCompletedSems[i] = rpo.mRenderCompletedSems[wo.mCurrentFrame];
+        }
+
+        // each window waits its frame by the timeline value of its own batch, so no fence is needed
+        result = checkVkResult(vkQueueSubmit(mDeviceQueue, static_cast<uint32_t>(count), submitInfos.data(), VK_NULL_HANDLE));
+        if (result != Result::eSuccess)
+        {
+            std::cerr << "failed to submit cmd to queue!\n";
 
-    Result Context::cmdBindVB(CommandObject& co, size_t index,
-                              const CmdBindVB& info)
-    {
-        if (mBufferMap.count(info.VBHandle) <= 0)
-            return Result::eFailure;
-        auto& vbo = mBufferMap[info.VBHandle];
+            // values that are never signaled must not be waited
+            mGraphicsTimelineValue = prevTimelineValue;
+            for (size_t i = 0; i < count; ++i)
+                mCommandBufferMap[acquiredHandles[i]].mSignalValue = prevSignalValues[i];
 
-        VkDeviceSize offsets[] = {0};
+            releaseAcquired();
+            return result;
+        }
 
-        vkCmdBindVertexBuffers(co.mCommandBuffers[index], 0, 1, &vbo.mBuffer.value(),
-                               offsets);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto& co  = mCommandBufferMap[acquiredHandles[i]];
+            auto& rpo = mRPMap[co.mHRenderPass.value()];
+            auto& wo  = mWindowMap[rpo.mHWindow.value()];
 
-        return Result::eSuccess;
-    }
+            rpo.mFrameSignalValues[wo.mCurrentFrame]  = co.mSignalValue;
+            rpo.imagesInFlight[rpo.mFrameBufferIndex] = co.mSignalValue;
 
-    Result Context::cmdBindIB(CommandObject& co, size_t index,
-                              const CmdBindIB& info)
-    {
-        if (mBufferMap.count(info.IBHandle) <= 0)
-            return Result::eFailure;
-        auto& ibo = mBufferMap[info.IBHandle];
+            submitProfilerQueries(co, commandIndices[i]);
+        }
 
-        vkCmdBindIndexBuffer(co.mCommandBuffers[index], ibo.mBuffer.value(), 0,
-                             VK_INDEX_TYPE_UINT32);
+        // present all swapchains at once
+        std::vector<VkResult> presentResults(count, VK_SUCCESS);
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.swapchainCount     = static_cast<uint32_t>(count);
+        presentInfo.pSwapchains        = swapchains.data();
+        presentInfo.pImageIndices      = imageIndices.data();
+        presentInfo.waitSemaphoreCount = static_cast<uint32_t>(count);
+        presentInfo.pWaitSemaphores    = renderCompletedSems.data();
+        presentInfo.pResults           = presentResults.data();
 
-        return Result::eSuccess;
-    }
+        // errors such as device or surface lost may not be written to pResults
+        const VkResult presentResult = vkQueuePresentKHR(mDeviceQueue, &presentInfo);
+        if (presentResult != VK_SUCCESS && presentResult != VK_SUBOPTIMAL_KHR && presentResult != VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            std::cerr << "Failed to present queue!\n";
+            result = checkVkResult(presentResult);
+        }
 
-    Result Context::cmdBindGraphicsPipeline(CommandObject& co, size_t index,
-                                            const CmdBindGraphicsPipeline& info)
-    {
-        auto& gpo     = mGPMap[info.handle];
-        co.mHGPO      = info.handle;
-        auto& command = co.mCommandBuffers[index];
-        vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                          gpo.mPipeline.value());
+        markFrameEnd();
 
-        // allocate descriptor sets
-        co.mDescriptorSets[index].resize(gpo.mDescriptorSetLayouts.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto& co = mCommandBufferMap[acquiredHandles[i]];
+            auto& wo       = mWindowMap[mRPMap[co.mHRenderPass.value()].mHWindow.value()];
 
-        return Result::eSuccess;
+            if (presentResults[i] == VK_ERROR_OUT_OF_DATE_KHR || presentResults[i] == VK_SUBOPTIMAL_KHR)
+                wo.mNeedsRecreate = true;
+            else if (presentResults[i] != VK_SUCCESS)
+            {
+                std::cerr << "Failed to present queue!\n";
+                result = checkVkResult(presentResults[i]);
+            }
+
+            updateFramePacing(wo, waitNs[i], co.mSignalValue);
+
+            wo.mCurrentFrame = (wo.mCurrentFrame + 1) % wo.mMaxFrameInFlight;
+        }
+
+        return result;
     }
 
-    Result Context::cmdBindSRSet(CommandObject& co, size_t index,
-                                 const CmdBindSRSet& info)
+    Result Context::acquireWindowImage(const HCommandBuffer& handle, bool& acquired_out, uint64_t& waitNs_out)
     {
         Result result = Result::eSuccess;
+        acquired_out  = false;
+        waitNs_out    = 0;
+
+        auto& co  = mCommandBufferMap[handle];
+        auto& rpo = mRPMap[co.mHRenderPass.value()];
+        auto& wo  = mWindowMap[rpo.mHWindow.value()];
+
+        {  // resized (or out of date at the last presentation)
+            int width = 0, height = 0;
+            glfwGetFramebufferSize(wo.mpWindow.value(), &width, &height);
+            if (wo.mNeedsRecreate || static_cast<uint32_t>(width) != wo.mSwapchainExtent.width ||
+                static_cast<uint32_t>(height) != wo.mSwapchainExtent.height)
+            {
+                result = recreateSwapchain(rpo.mHWindow.value());
+                if (result != Result::eSuccess)
+                {
+                    std::cerr << "failed to recreate swapchain!\n";
+                    return result;
+                }
+            }
+
+            // minimized, skip this frame
+            if (wo.mNeedsRecreate)
+                return Result::eSuccess;
+        }
 
-        if (!co.mHGPO)
+        if (co.mNeedsRerecord)
         {
-            std::cerr << "graphics pipeline object is not registered yet!\n";
-            return Result::eFailure;
+            result = rerecordCommandBuffer(handle);
+            if (result != Result::eSuccess)
+                return result;
         }
 
-        auto& gpo = mGPMap[co.mHGPO.value()];
+        const uint64_t waitBeginNs = Tracer::now();
+        result                     = waitGraphicsTimeline(rpo.mFrameSignalValues[wo.mCurrentFrame]);
+        if (result != Result::eSuccess)
+            return result;
 
-        if (mDescriptorPools.size() <= co.mDescriptorPoolIndex)
+        VkResult vkResult = VK_SUCCESS;
         {
-            std::cerr << "descriptor pool is nothing!\n";
-            return Result::eFailure;
+            TraceScope trace(mTracer, "vkAcquireNextImageKHR");
+            vkResult = vkAcquireNextImageKHR(mDevice, wo.mSwapchain.value(), UINT64_MAX,
+                                             rpo.mPresentCompletedSems[wo.mCurrentFrame],
+                                             VK_NULL_HANDLE, &rpo.mFrameBufferIndex);
         }
 
-        auto&& UBs = info.SRSet.getUniformBuffers();
-        auto&& CTs = info.SRSet.getCombinedTextures();
+        // nothing has been acquired, recreate at the next execution
+        if (vkResult == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            wo.mNeedsRecreate = true;
+            return Result::eSuccess;
+        }
 
-        std::vector<VkDescriptorBufferInfo> dbi_vec;
-        dbi_vec.reserve(UBs.size());
-        std::vector<VkDescriptorImageInfo> dii_vec;
-        dii_vec.reserve(CTs.size());
-        std::vector<VkWriteDescriptorSet> writeDescriptors;
+        // suboptimal image can still be presented
+        if (vkResult != VK_SUCCESS && vkResult != VK_SUBOPTIMAL_KHR)
         {
-            VkDescriptorSetAllocateInfo dsai{};
-            dsai.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-            dsai.descriptorPool     = mDescriptorPools[co.mDescriptorPoolIndex].second;
-            dsai.descriptorSetCount = 1;
-            dsai.pSetLayouts        = &gpo.mDescriptorSetLayouts[info.set];
+            std::cerr << "failed to acquire next swapchain image!\n";
+            return checkVkResult(vkResult);
+        }
 
-            {
-                VkDescriptorSet set;
-                result = checkVkResult(vkAllocateDescriptorSets(mDevice, &dsai, &set));
-                if (Result::eSuccess != result)
-                {
-                    std::cerr << "failed to allocate VkDescriptorSet!\n";
-                    return Result::eFailure;
-                }
+        // the image is acquired even if the following fails (the caller has to release it)
+        acquired_out = true;
 
-                co.mDescriptorSets[index][info.set] = set;
-            }
+        // the image may be still rendered by another frame
+        result = waitGraphicsTimeline(rpo.imagesInFlight[rpo.mFrameBufferIndex]);
+        if (result != Result::eSuccess)
+            return result;
 
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to allocate descriptor set\n";
-                return result;
-            }
+        waitNs_out = Tracer::now() - waitBeginNs;
 
-            writeDescriptors.reserve(gpo.mSetSizes[info.set]);
+        // the previous execution of this command buffer has finished here
+        return resolveProfilerQueries(co, rpo.mFrameBufferIndex % co.mCommandBuffers.size());
+    }
 
-            for (const auto& dub : UBs)
-            {
-                auto& ubo  = mBufferMap[dub.second];
-                auto&& dbi = dbi_vec.emplace_back();
-                dbi.buffer = ubo.mBuffer.value();
-                dbi.offset = 0;
-                dbi.range  = VK_WHOLE_SIZE;
+    Result Context::restoreFence(VkFence& fence)
+    {
+        vkDestroyFence(mDevice, fence, nullptr);
+        fence = VK_NULL_HANDLE;
 
-                auto&& wdi     = writeDescriptors.emplace_back(VkWriteDescriptorSet{});
-                wdi.sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                wdi.dstBinding = dub.first;
-                //if (mDebugFlag)
-                //    std::cerr << "buffer dstBinding : " << wdi.dstBinding << "\n";
-                wdi.dstArrayElement = 0;
-                wdi.descriptorCount = 1;
-                wdi.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                wdi.pBufferInfo     = &dbi_vec.back();
-                wdi.dstSet          = co.mDescriptorSets[index][info.set].value();
-            }
+        VkFenceCreateInfo ci{};
+        ci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        ci.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        return checkVkResult(vkCreateFence(mDevice, &ci, nullptr, &fence));
+    }
 
-            for (const auto& dct : CTs)
-            {
-                auto& cto = mImageMap[dct.second];
+    Result Context::waitGraphicsTimeline(const uint64_t value)
+    {
+        // nothing has been submitted yet
+        if (value == 0)
+            return Result::eSuccess;
 
-                auto&& dii    = dii_vec.emplace_back();
-                dii.imageView = cto.mView.value();
-                dii.sampler   = cto.mSampler.value();
-                // dii.imageLayout = cto.currentLayout;
-                dii.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                // std::cerr << static_cast<int>(cto.currentLayout) << "\n";
+        TraceScope trace(mTracer, "wait timeline");
+        VkSemaphoreWaitInfo wi{};
+        wi.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        wi.semaphoreCount = 1;
+        wi.pSemaphores    = &mGraphicsTimelineSem;
+        wi.pValues        = &value;
 
-                auto&& wdi     = writeDescriptors.emplace_back(VkWriteDescriptorSet{});
-                wdi.sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                wdi.dstBinding = dct.first;
-                //if (mDebugFlag)
-                //    std::cerr << "image dstBinding : " << wdi.dstBinding << "\n";
-                wdi.dstArrayElement = 0;
-                wdi.descriptorCount = 1;
-                wdi.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                wdi.pImageInfo      = &dii_vec.back();
-                wdi.dstSet          = co.mDescriptorSets[index][info.set].value();
-            }
+        const Result result = checkVkResult(vkWaitSemaphores(mDevice, &wi, UINT64_MAX));
+        if (result != Result::eSuccess)
+            std::cerr << "failed to wait graphics timeline!\n";
 
-            vkUpdateDescriptorSets(mDevice,
-                                   static_cast<uint32_t>(writeDescriptors.size()),
-                                   writeDescriptors.data(), 0, nullptr);
-        }
+        return result;
+    }
 
-        return Result::eSuccess;
+    void Context::updateFramePacing(WindowObject& wo, const uint64_t waitNs, const uint64_t signalValue)
+    {
+        const uint64_t now = Tracer::now();
+        const auto smooth  = [](const double average, const double sample)
+        { return average > 0 ? average + (sample - average) * framePacingSmoothing : sample; };
+
+        if (wo.mFrameBeginNs && now > wo.mFrameBeginNs + waitNs)
+            wo.mFrameCPUTime = smooth(wo.mFrameCPUTime, static_cast<double>(now - wo.mFrameBeginNs - waitNs));
+        if (wo.mLastPresentNs)
+            wo.mPresentInterval = smooth(wo.mPresentInterval, static_cast<double>(now - wo.mLastPresentNs));
+
+        // presented before the expected vsync, it is displayed at that time
+        wo.mNextPresentNs      = std::max(now, wo.mNextPresentNs) + static_cast<uint64_t>(getRefreshPeriod(wo));
+        wo.mLastPresentNs      = now;
+        wo.mLastPresentedValue = signalValue;
+        wo.mFrameBeginNs       = 0;
     }
 
-    Result Context::cmdRenderIndexed(CommandObject& co, size_t index,
-                                     const CmdRenderIndexed& info)
+    Result Context::executeCompute(CommandObject& co, const std::vector<HCommandBuffer>& waitCommandBuffers)
     {
-        auto& gpo = mGPMap[co.mHGPO.value()];
-        std::vector<VkDescriptorSet> sets;
-        sets.reserve(co.mDescriptorSets[index].size());
-        for (const auto& e : co.mDescriptorSets[index])
+        Result result = Result::eSuccess;
+
+        const uint32_t index = co.mExecuteIndex;
+
         {
-            sets.emplace_back(e.value());
+            TraceScope trace(mTracer, "wait fence");
+            result = checkVkResult(
+                vkWaitForFences(mDevice, 1, &co.mFences[index], VK_TRUE, UINT64_MAX));
+        }
+        if (result != Result::eSuccess)
+        {
+            std::cerr << "Failed to wait fence!\n";
+            return result;
         }
 
-        vkCmdBindDescriptorSets(
-            co.mCommandBuffers[index], VK_PIPELINE_BIND_POINT_GRAPHICS,
-            gpo.mPipelineLayout.value(), 0, sets.size(), sets.data(), 0, nullptr);
+        result = checkVkResult(vkResetFences(mDevice, 1, &co.mFences[index]));
+        if (result != Result::eSuccess)
+        {
+            std::cerr << "failed to reset fence!\n";
+            return result;
+        }
 
-        vkCmdDrawIndexed(co.mCommandBuffers[index], info.indexCount,
-                         info.instanceCount, info.firstIndex, info.vertexOffset,
-                         info.firstInstance);
+        result = resolveProfilerQueries(co, index);
+        if (result != Result::eSuccess)
+            return result;
 
-        return Result::eSuccess;
-    }
+        // cross queue dependencies
+        std::vector<VkSemaphore> waitSems;
+        std::vector<uint64_t> waitValues;
+        std::vector<VkPipelineStageFlags> waitStages;
+        result = getWaitSemaphores(waitCommandBuffers, waitSems, waitValues, waitStages);
+        if (result != Result::eSuccess)
+            return result;
 
-    Result Context::cmdRender(CommandObject& co, size_t index,
-                              const CmdRender& info)
-    {
-        auto& gpo = mGPMap[co.mHGPO.value()];
+        const uint64_t prevSignalValue = co.mSignalValue;
+        co.mSignalValue                = ++mComputeTimelineValue;
 
-        std::vector<VkDescriptorSet> sets;
-        sets.reserve(co.mDescriptorSets[index].size());
-        for (const auto& e : co.mDescriptorSets[index])
+        VkTimelineSemaphoreSubmitInfo tssi{};
+        tssi.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        tssi.waitSemaphoreValueCount   = static_cast<uint32_t>(waitValues.size());
+        tssi.pWaitSemaphoreValues      = waitValues.data();
+        tssi.signalSemaphoreValueCount = 1;
+        tssi.pSignalSemaphoreValues    = &co.mSignalValue;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext                = &tssi;
+        submitInfo.commandBufferCount   = 1;
+        submitInfo.pCommandBuffers      = &co.mCommandBuffers[index];
+        submitInfo.waitSemaphoreCount   = static_cast<uint32_t>(waitSems.size());
+        submitInfo.pWaitSemaphores      = waitSems.data();
+        submitInfo.pWaitDstStageMask    = waitStages.data();
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores    = &mComputeTimelineSem;
+
+        result = checkVkResult(vkQueueSubmit(mComputeQueue, 1, &submitInfo, co.mFences[index]));
+        if (result != Result::eSuccess)
         {
-            sets.emplace_back(e.value());
+            std::cerr << "failed to submit cmd to compute queue!\n";
+
+            // the value is never signaled, so it must not be waited
+            --mComputeTimelineValue;
+            co.mSignalValue = prevSignalValue;
+            return result;
         }
 
-        vkCmdBindDescriptorSets(
-            co.mCommandBuffers[index], VK_PIPELINE_BIND_POINT_GRAPHICS,
-            gpo.mPipelineLayout.value(), 0, sets.size(), sets.data(), 0, nullptr);
+        submitProfilerQueries(co, index);
 
-        vkCmdDraw(co.mCommandBuffers[index], info.vertexCount, info.instanceCount,
-                  info.vertexOffset, info.firstInstance);
+        co.mExecuteIndex = (index + 1) % co.mCommandBuffers.size();
 
         return Result::eSuccess;
     }
 
-    Result Context::cmdBarrier(CommandObject& co, size_t index,
-                               const CmdBarrier& info)
+    Result Context::getWaitSemaphores(const std::vector<HCommandBuffer>& waitCommandBuffers,
+                                      std::vector<VkSemaphore>& semaphores_out,
+                                      std::vector<uint64_t>& values_out,
+                                      std::vector<VkPipelineStageFlags>& stages_out)
     {
-        if (mDebugFlag && mImageMap.count(info.handle) <= 0)
+        for (const auto& handle : waitCommandBuffers)
         {
-            std::cerr << "invalid texture handle!\n";
-            return Result::eFailure;
-        }
+            if (mDebugFlag && mCommandBufferMap.count(handle) <= 0)
+            {
+                std::cerr << "invalid wait commandbuffer handle!\n";
+                return Result::eFailure;
+            }
 
-        auto& io = mImageMap[info.handle];
-        setImageMemoryBarrier(co.mCommandBuffers[index], io.mImage.value(),
-                              io.currentLayout,
-                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-        io.currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        // co.mBarrieredTextures.emplace_back(info.handle);
+            const auto& wco = mCommandBufferMap[handle];
+            if (wco.mSignalValue == 0)  // never executed
+                continue;
+
+            semaphores_out.emplace_back(wco.mQueueType == QueueType::eCompute ? mComputeTimelineSem : mGraphicsTimelineSem);
+            values_out.emplace_back(wco.mSignalValue);
+            stages_out.emplace_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        }
 
         return Result::eSuccess;
     }
 
-    Result Context::cmdExecuteSubCommand(CommandObject& co, size_t frameBufferIndex,
-                                         const CmdExecuteSubCommand& info)
-    {
-        if (mDebugFlag && mCommandBufferMap.count(info.handle) <= 0)
-        {
-            std::cerr << "invalid sub command buffer handle!\n";
-            return Result::eFailure;
-        }
+    // I/O-----------------------------------
 
-        auto&& subCO = mCommandBufferMap[info.handle];
-        if (mDebugFlag && !subCO.mSubCommand)
+    Result Context::setPresentMode(const HWindow& handle, const PresentMode mode)
+    {
+        const auto itr = mWindowMap.find(handle);
+        if (itr == mWindowMap.end())
         {
-            std::cerr << "thi command buffer is primary!\n";
+            std::cerr << "invalid window handle!\n";
             return Result::eFailure;
         }
 
-        vkCmdExecuteCommands(co.mCommandBuffers[frameBufferIndex], 1,
-                             &subCO.mCommandBuffers[frameBufferIndex]);
+        // applied at the next execution
+        itr->second.mRequestedPresentMode = mode;
+        itr->second.mNeedsRecreate        = true;
 
         return Result::eSuccess;
     }
 
-    uint32_t Context::getFrameBufferIndex(const HRenderPass& handle) const
+    Result Context::getPresentMode(const HWindow& handle, PresentMode& mode_out) const
     {
-        if (!mIsInitialized)
+        const auto itr = mWindowMap.find(handle);
+        if (itr == mWindowMap.end())
         {
-            std::cerr << "context did not initialize yet!\n";
-            return 0;
+            std::cerr << "invalid window handle!\n";
+            return Result::eFailure;
         }
 
-        if (mRPMap.count(handle) <= 0)
+        switch (itr->second.mPresentMode)
         {
-            std::cerr << "invalid renderpass handle!\n";
-            return 0;
+            case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+                mode_out = PresentMode::eFIFORelaxed;
+                break;
+            case VK_PRESENT_MODE_MAILBOX_KHR:
+                mode_out = PresentMode::eMailbox;
+                break;
+            case VK_PRESENT_MODE_IMMEDIATE_KHR:
+                mode_out = PresentMode::eImmediate;
+                break;
+            default:
+                mode_out = PresentMode::eFIFO;
+                break;
         }
 
-        return mRPMap.at(handle).mFrameBufferIndex;
+        return Result::eSuccess;
     }
 
-    Result Context::cmdRenderImGui(CommandObject& co, size_t frameBufferIndex)
+    Result Context::setFramePacing(const HWindow& handle, const FramePacing pacing)
     {
-        Result result = Result::eSuccess;
-
-        // Record dear imgui primitives into command buffer
-        auto* pData = ImGui::GetDrawData();
-        if (!pData)
+        const auto itr = mWindowMap.find(handle);
+        if (itr == mWindowMap.end())
         {
-            std::cerr << "invalid ImGui command call!\n";
+            std::cerr << "invalid window handle!\n";
             return Result::eFailure;
         }
 
-        ImGui_ImplVulkan_RenderDrawData(pData, co.mCommandBuffers[frameBufferIndex]);
+        itr->second.mFramePacing  = pacing;
+        itr->second.mFrameBeginNs = 0;
 
-        return result;
+        return Result::eSuccess;
     }
 
-    Result Context::execute(const HCommandBuffer& handle)
+    double Context::getRefreshPeriod(const WindowObject& wo) const
     {
-        if (!mIsInitialized)
-        {
-            std::cerr << "context did not initialize yet!\n";
-            return Result::eFailure;
-        }
+        // windowed mode is assumed to be on the primary monitor
+        GLFWmonitor* pMonitor = glfwGetWindowMonitor(wo.mpWindow.value());
+        if (!pMonitor)
+            pMonitor = glfwGetPrimaryMonitor();
+
+        const GLFWvidmode* pMode = pMonitor ? glfwGetVideoMode(pMonitor) : nullptr;
+        if (pMode && pMode->refreshRate > 0)
+            return 1e9 / pMode->refreshRate;
 
+        return wo.mPresentInterval;
+    }
+
+    Result Context::waitFramePacing()
+    {
         Result result = Result::eSuccess;
 
-        if (mDebugFlag && mCommandBufferMap.count(handle) <= 0)
+        // the earliest wake-up time of the paced windows
+        uint64_t wakeNs = UINT64_MAX;
+        std::vector<WindowObject*> pacedWindows;
+        for (auto& [handle, wo] : mWindowMap)
         {
-            std::cerr << "invalid commandbuffer handle!\n";
-            return Result::eFailure;
-        }
+            if (wo.mFramePacing != FramePacing::eJustInTime)
+                continue;
+            pacedWindows.emplace_back(&wo);
+
+            // keep only one frame queued on the GPU
+            if (wo.mLastPresentedValue)
+            {
+                TraceScope trace(mTracer, "wait previous frame");
+                VkSemaphoreWaitInfo wi{};
+                wi.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+                wi.semaphoreCount = 1;
+                wi.pSemaphores    = &mGraphicsTimelineSem;
+                wi.pValues        = &wo.mLastPresentedValue;
+                result            = checkVkResult(vkWaitSemaphores(mDevice, &wi, UINT64_MAX));
+                if (result != Result::eSuccess)
+                {
+                    std::cerr << "failed to wait previous frame!\n";
+                    return result;
+                }
+            }
 
-        auto& co = mCommandBufferMap[handle];
-        if (!co.mHRenderPass)
-        {
-            std::cerr << "render pass of this command is invalid!\n";
-            return Result::eFailure;
+            // no estimation yet
+            const double period = getRefreshPeriod(wo);
+            if (!wo.mNextPresentNs || period <= 0)
+                continue;
+
+            // start the frame just in time for the expected presentation
+            const double wake = static_cast<double>(wo.mNextPresentNs) - wo.mFrameCPUTime - framePacingMarginNs;
+            const uint64_t now = Tracer::now();
+            if (wake > now)
+                wakeNs = std::min(wakeNs, std::min(static_cast<uint64_t>(wake), now + static_cast<uint64_t>(period)));
         }
 
-        if (co.mSubCommand)
+        if (wakeNs != UINT64_MAX)
         {
-            std::cerr << "this command buffer is sub(secondary)!\n";
-            return Result::eFailure;
+            TraceScope trace(mTracer, "frame pacing");
+            // sleep is coarse, yield for the last millisecond
+            constexpr uint64_t spinNs = 1'000'000;
+            const uint64_t now        = Tracer::now();
+            if (wakeNs > now + spinNs)
+                std::this_thread::sleep_for(std::chrono::nanoseconds(wakeNs - now - spinNs));
+            while (Tracer::now() < wakeNs)
+                std::this_thread::yield();
         }
 
-        // control transition of texture layout by barrier
-        //{
-        //    for (auto& handle : co.mBarrieredTextures)
-        //        mImageMap[handle].currentLayout =
-        //        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        //}
-
-        // vkQueueWaitIdle(mDeviceQueue);
-        // vkDeviceWaitIdle(mDevice);
+        const uint64_t beginNs = Tracer::now();
+        for (auto* pWO : pacedWindows)
+            pWO->mFrameBeginNs = beginNs;
 
-        auto& rpo = mRPMap[co.mHRenderPass.value()];
+        return Result::eSuccess;
+    }
 
-        if (rpo.mHWindow && co.mPresentFlag)
-        {
-            auto& wo = mWindowMap[rpo.mHWindow.value()];
+    Result Context::updateInput()
+    {
+        if (mIsHeadless)
+            return Result::eSuccess;
 
-            result = checkVkResult(vkWaitForFences(
-                mDevice, 1, &rpo.mFences[wo.mCurrentFrame], VK_TRUE, UINT64_MAX));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "Failed to wait fence!\n";
-                return result;
-            }
+        // input is sampled after waiting, as late as possible
+        const Result result = waitFramePacing();
+        if (result != Result::eSuccess)
+            return result;
 
-            result = checkVkResult(
-                vkAcquireNextImageKHR(mDevice, wo.mSwapchain.value(), UINT64_MAX,
-                                      rpo.mPresentCompletedSems[wo.mCurrentFrame],
-                                      VK_NULL_HANDLE, &rpo.mFrameBufferIndex));
+        glfwPollEvents();
 
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to acquire next swapchain image!\n";
-                return result;
-            }
+        // take snapshots, queries never call into the window system
+        mFocusedWindow = std::nullopt;
+        for (auto& [handle, wo] : mWindowMap)
+        {
+            wo.mEvent.update();
+            if (!mFocusedWindow && glfwGetWindowAttrib(wo.mpWindow.value(), GLFW_FOCUSED))
+                mFocusedWindow = handle;
+        }
 
-            if (rpo.imagesInFlight[rpo.mFrameBufferIndex] != VK_NULL_HANDLE)
-                vkWaitForFences(mDevice, 1, &rpo.imagesInFlight[rpo.mFrameBufferIndex],
-                                VK_TRUE, UINT64_MAX);
+        return Result::eSuccess;
+    }
 
-            rpo.imagesInFlight[rpo.mFrameBufferIndex] = rpo.mFences[wo.mCurrentFrame];
+    bool Context::getKey(const Key& key) const
+    {
+        if (!mFocusedWindow)
+            return false;
 
-            // submit command
+        return mWindowMap.at(mFocusedWindow.value()).mEvent.getKey(key);
+    }
 
-            VkSubmitInfo submitInfo{};
-            VkPipelineStageFlags waitStageMask =
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers =
-                &co.mCommandBuffers[rpo.mFrameBufferIndex % co.mCommandBuffers.size()];
-            submitInfo.pWaitDstStageMask    = &waitStageMask;
-            submitInfo.waitSemaphoreCount   = 1;
-            submitInfo.pWaitSemaphores      = &rpo.mPresentCompletedSems[wo.mCurrentFrame];
-            submitInfo.signalSemaphoreCount = 1;
-            submitInfo.pSignalSemaphores    = &rpo.mRenderCompletedSems[wo.mCurrentFrame];
-            result                          = checkVkResult(
-                                         vkResetFences(mDevice, 1, &rpo.mFences[wo.mCurrentFrame]));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to reset fence!\n";
-                return result;
-            }
+    bool Context::getKey(const HWindow& handle, const Key& key) const
+    {
+        if (mDebugFlag && mWindowMap.count(handle) <= 0)
+        {
+            std::cerr << "invalid window handle!\n";
+            return false;
+        }
 
-            result = checkVkResult(vkQueueSubmit(mDeviceQueue, 1, &submitInfo,
-                                                 rpo.mFences[wo.mCurrentFrame]));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to submit cmd to queue!\n";
-                return result;
-            }
+        return mWindowMap.at(handle).mEvent.getKey(key);
+    }
 
-            // present
-            VkPresentInfoKHR presentInfo{};
-            presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-            presentInfo.swapchainCount     = 1;
-            presentInfo.pSwapchains        = &wo.mSwapchain.value();
-            presentInfo.pImageIndices      = &rpo.mFrameBufferIndex;
-            presentInfo.waitSemaphoreCount = 1;
-            presentInfo.pWaitSemaphores    = &rpo.mRenderCompletedSems[wo.mCurrentFrame];
+    KeyState Context::getKeyState(const Key& key) const
+    {
+        if (!mFocusedWindow)
+            return KeyState::eNone;
 
-            result = checkVkResult(vkQueuePresentKHR(mDeviceQueue, &presentInfo));
-            if (Result::eSuccess != result)
-            {
-                std::cerr << "Failed to present queue!\n";
-                return result;
-            }
+        return mWindowMap.at(mFocusedWindow.value()).mEvent.getKeyState(key);
+    }
 
-            wo.mCurrentFrame = (wo.mCurrentFrame + 1) % wo.mMaxFrameInFlight;
-        }
-        else
+    KeyState Context::getKeyState(const HWindow& handle, const Key& key) const
+    {
+        if (mDebugFlag && mWindowMap.count(handle) <= 0)
         {
-            result = checkVkResult(
-                vkWaitForFences(mDevice, 1, &rpo.mFences[0], VK_TRUE, UINT64_MAX));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "Failed to wait fence!\n";
-                return result;
-            }
+            std::cerr << "invalid window handle!\n";
+            return KeyState::eNone;
+        }
 
-            result = checkVkResult(vkResetFences(mDevice, 1, &rpo.mFences[0]));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to reset fence!\n";
-                return result;
-            }
+        return mWindowMap.at(handle).mEvent.getKeyState(key);
+    }
 
-            // Maybe it will be useless
-            rpo.mFrameBufferIndex =
-                (rpo.mFrameBufferIndex + 1) % rpo.mFramebuffers.size();
+    Result Context::getMousePos(double& x, double& y) const
+    {
+        // all windows were not focused
+        if (!mFocusedWindow)
+        {
+            x = 0;
+            y = 0;
+            return Result::eFailure;
+        }
 
-            // submit command
-            VkSubmitInfo submitInfo{};
-            VkPipelineStageFlags waitStageMask =
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers    = &(
-                co.mCommandBuffers[rpo.mFrameBufferIndex % co.mCommandBuffers.size()]);
-            submitInfo.pWaitDstStageMask    = &waitStageMask;
-            submitInfo.waitSemaphoreCount   = 0;
-            submitInfo.pWaitSemaphores      = nullptr;
-            submitInfo.signalSemaphoreCount = 0;
-            submitInfo.pSignalSemaphores    = nullptr;
+        return getMousePos(mFocusedWindow.value(), x, y);
+    }
 
-            result = checkVkResult(vkQueueSubmit(mDeviceQueue, 1, &submitInfo,
-                                                 rpo.mFences[rpo.mFrameBufferIndex]));
-            if (result != Result::eSuccess)
-            {
-                std::cerr << "failed to submit cmd to queue!\n";
-                return result;
-            }
+    Result Context::getMousePos(const HWindow& handle, double& x, double& y) const
+    {
+        if (mDebugFlag && mWindowMap.count(handle) <= 0)
+        {
+            std::cerr << "invalid window handle!\n";
+            return Result::eFailure;
         }
 
+        mWindowMap.at(handle).mEvent.getMousePos(x, y);
         return Result::eSuccess;
     }
 
-    // I/O-----------------------------------
+    Result Context::getMouseDelta(double& x, double& y) const
+    {
+        if (!mFocusedWindow)
+        {
+            x = 0;
+            y = 0;
+            return Result::eFailure;
+        }
+
+        return getMouseDelta(mFocusedWindow.value(), x, y);
+    }
 
-    Result Context::updateInput() const
+    Result Context::getMouseDelta(const HWindow& handle, double& x, double& y) const
     {
-        glfwPollEvents();
+        if (mDebugFlag && mWindowMap.count(handle) <= 0)
+        {
+            std::cerr << "invalid window handle!\n";
+            return Result::eFailure;
+        }
+
+        mWindowMap.at(handle).mEvent.getMouseDelta(x, y);
         return Result::eSuccess;
     }
 
-    bool Context::getKey(const Key& key) const
+    Result Context::getScroll(double& x, double& y) const
     {
-        static bool rtn = false;
-
-        for (const auto& wo : mWindowMap)
+        if (!mFocusedWindow)
         {
-            // continue if hided
-            if (!glfwGetWindowAttrib(wo.second.mpWindow.value(), GLFW_VISIBLE))
-                continue;
-
-            if (rtn = glfwGetKey(wo.second.mpWindow.value(), static_cast<int>(key)) > 0)
-                return rtn;
+            x = 0;
+            y = 0;
+            return Result::eFailure;
         }
 
-        return false;
+        return getScroll(mFocusedWindow.value(), x, y);
     }
 
-    bool Context::getKey(const HWindow& handle, const Key& key) const
+    Result Context::getScroll(const HWindow& handle, double& x, double& y) const
     {
         if (mDebugFlag && mWindowMap.count(handle) <= 0)
         {
             std::cerr << "invalid window handle!\n";
-            return 0;
+            return Result::eFailure;
         }
 
-        const auto& wo = mWindowMap.at(handle);
-        return glfwGetKey(wo.mpWindow.value(), static_cast<int>(key)) == GLFW_PRESS;
+        mWindowMap.at(handle).mEvent.getScroll(x, y);
+        return Result::eSuccess;
     }
 
-    Result Context::getMousePos(double& x, double& y) const
+    Result Context::getTextInput(std::u32string& text_out) const
     {
-        for (const auto& wo : mWindowMap)
+        if (!mFocusedWindow)
         {
-            // continue if not focused
-            if (!glfwGetWindowAttrib(wo.second.mpWindow.value(), GLFW_FOCUSED))
-                continue;
-
-            glfwGetCursorPos(wo.second.mpWindow.value(), &x, &y);
-            return Result::eSuccess;
+            text_out.clear();
+            return Result::eFailure;
         }
 
-        // all windows were not focused
-        x = 0;
-        y = 0;
-        return Result::eFailure;
+        return getTextInput(mFocusedWindow.value(), text_out);
     }
 
-    Result Context::getMousePos(const HWindow& handle, double& x, double& y) const
+    Result Context::getTextInput(const HWindow& handle, std::u32string& text_out) const
     {
         if (mDebugFlag && mWindowMap.count(handle) <= 0)
         {
@@ -5046,8 +10436,7 @@ namespace Cutlass
             return Result::eFailure;
         }
 
-        const auto& wo = mWindowMap.at(handle);
-        glfwGetCursorPos(wo.mpWindow.value(), &x, &y);
+        text_out = mWindowMap.at(handle).mEvent.getText();
         return Result::eSuccess;
     }
 
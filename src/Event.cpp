@@ -1,72 +1,128 @@
-//不要、現在凍結中
-
-// #include "../include/Event.hpp"
-
-// #include <iostream>
-
-// namespace Cutlass
-// {
-//     Event::Event()
-//     {
-//         int i = 0;
-//         while(keyIndex[i] == static_cast<uint16_t>(Key::LAST))
-//             mKeys.emplace(static_cast<Key>(keyIndex[i++]), 0);
-
-//         mMouseX = mMouseY = 0;
-
-//         mWindowShouldClose = false;
-//         mQueries.reserve(50);
-//     }
-
-//     KeyState Event::getKeyState(Key key)
-//     {
-//         mQueries.emplace_back(key);
-
-//         if(mKeys[key] == 1)
-//             return KeyState::ePressed;
-//         if (mKeys[key] > 1)
-//             return KeyState::eHeld;
-//         if (mKeys[key] == UINT32_MAX)
-//             return KeyState::eReleased;
-//         if (mKeys[key] == 0)
-//             return KeyState::eNone;
-
-//         std::cerr << "ERROR!\n";
-//         return KeyState::eNone;
-//     }
-
-//     uint32_t Event::getKeyFrame(Key key)
-//     {
-//         mQueries.emplace_back(key);
-//         return mKeys[key] == UINT32_MAX ? 0 : mKeys[key];
-//     }
-
-//     void Event::getMousePos(double &x, double &y)
-//     {
-//         x = mMouseX;
-//         y = mMouseY;
-//     }
-
-//     bool Event::windowShouldClose()
-//     {
-//         return mWindowShouldClose;
-//     }
-
-//     std::vector<Key>& Event::getKeyQueries()
-//     {
-//         return mQueries;
-//     }
-
-//     std::unordered_map<Key, uint32_t>& Event::getKeyRefInternal()
-//     {
-//         return mKeys;
-//     }
-
-//     void Event::updateInternal(double mouseX, double mouseY, bool windowShouldClose)
-//     {
-//         mMouseX = mouseX;
-//         mMouseY = mouseY;
-//         mWindowShouldClose = windowShouldClose;
-//     }
-
-// };// namespace Cutlass
+#include "../include/Event.hpp"
+
+#include <GLFW/glfw3.h>
+
+namespace Cutlass
+{
+    Event::Event()
+        : mCursorX(0)
+        , mCursorY(0)
+        , mHasCursor(false)
+        , mScrollAccumX(0)
+        , mScrollAccumY(0)
+        , mMouseX(0)
+        , mMouseY(0)
+        , mMouseDeltaX(0)
+        , mMouseDeltaY(0)
+        , mScrollX(0)
+        , mScrollY(0)
+    {
+
+    }
+
+    KeyState Event::getKeyState(const Key key) const
+    {
+        const std::size_t index = getKeyIndex(key);
+        if (index >= keyNum)
+            return KeyState::eNone;
+
+        if (mKeys[index])
+            return mPrevKeys[index] ? KeyState::eHeld : KeyState::ePressed;
+
+        return mPrevKeys[index] ? KeyState::eReleased : KeyState::eNone;
+    }
+
+    bool Event::getKey(const Key key) const
+    {
+        const std::size_t index = getKeyIndex(key);
+        return index < keyNum && mKeys[index];
+    }
+
+    void Event::getMousePos(double& x, double& y) const
+    {
+        x = mMouseX;
+        y = mMouseY;
+    }
+
+    void Event::getMouseDelta(double& x, double& y) const
+    {
+        x = mMouseDeltaX;
+        y = mMouseDeltaY;
+    }
+
+    void Event::getScroll(double& x, double& y) const
+    {
+        x = mScrollX;
+        y = mScrollY;
+    }
+
+    const std::u32string& Event::getText() const
+    {
+        return mText;
+    }
+
+    void Event::onKey(const int key, const int action)
+    {
+        // unknown key is negative
+        if (key < 0)
+            return;
+
+        const std::size_t index = getKeyIndex(static_cast<Key>(key));
+        if (index >= keyNum)
+            return;
+
+        // repeats do not change the state
+        if (action == GLFW_PRESS)
+        {
+            mDownKeys.set(index);
+            mPressedKeys.set(index);
+        }
+        else if (action == GLFW_RELEASE)
+            mDownKeys.reset(index);
+    }
+
+    void Event::onCursorPos(const double x, const double y)
+    {
+        // the first position is not a movement
+        if (!mHasCursor)
+        {
+            mMouseX    = x;
+            mMouseY    = y;
+            mHasCursor = true;
+        }
+
+        mCursorX = x;
+        mCursorY = y;
+    }
+
+    void Event::onScroll(const double x, const double y)
+    {
+        mScrollAccumX += x;
+        mScrollAccumY += y;
+    }
+
+    void Event::onChar(const uint32_t codepoint)
+    {
+        mTextAccum.push_back(static_cast<char32_t>(codepoint));
+    }
+
+    void Event::update()
+    {
+        mPrevKeys = mKeys;
+        mKeys     = mDownKeys | mPressedKeys;
+        mPressedKeys.reset();
+
+        mMouseDeltaX = mCursorX - mMouseX;
+        mMouseDeltaY = mCursorY - mMouseY;
+        mMouseX      = mCursorX;
+        mMouseY      = mCursorY;
+
+        mScrollX      = mScrollAccumX;
+        mScrollY      = mScrollAccumY;
+        mScrollAccumX = 0;
+        mScrollAccumY = 0;
+
+        mText.swap(mTextAccum);
+        mTextAccum.clear();
+    }
+}
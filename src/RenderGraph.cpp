@@ -0,0 +1,427 @@
+#include "../include/RenderGraph.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <queue>
+
+namespace Cutlass
+{
+    RenderGraph::RenderGraph()
+    : mCulledPassCount(0)
+    , mTransitionCount(0)
+    {
+
+    }
+
+    uint32_t RenderGraph::addPass(const RenderGraphPassInfo& info)
+    {
+        mPasses.emplace_back(info);
+        return static_cast<uint32_t>(mPasses.size() - 1);
+    }
+
+    Result RenderGraph::setCommandLists(const uint32_t pass, const std::vector<CommandList>& commandLists)
+    {
+        if (pass >= mPasses.size())
+        {
+            std::cerr << "invalid render graph pass index!\n";
+            return Result::eFailure;
+        }
+
+        mPasses[pass].commandLists = commandLists;
+        return Result::eSuccess;
+    }
+
+    Result RenderGraph::setCommandList(const uint32_t pass, const CommandList& commandList)
+    {
+        return setCommandLists(pass, std::vector<CommandList>(1, commandList));
+    }
+
+    void RenderGraph::markOutput(const HTexture& handle)
+    {
+        mOutputs.emplace_back(handle);
+    }
+
+    void RenderGraph::markAliased(const HTexture& handle, const uint32_t group)
+    {
+        mAliased[handle] = group;
+    }
+
+    Result RenderGraph::getTextureLifetimes(std::unordered_map<HTexture, std::pair<uint32_t, uint32_t>>& lifetimes_out)
+    {
+        if (mPasses.empty())
+        {
+            std::cerr << "render graph has no pass!\n";
+            return Result::eFailure;
+        }
+
+        Result result = sortPasses();
+        if (Result::eSuccess != result)
+            return result;
+
+        cullPasses();
+
+        lifetimes_out.clear();
+        for (uint32_t i = 0; i < mExecutionOrder.size(); ++i)
+        {
+            const auto& pass = mPasses[mExecutionOrder[i]];
+
+            std::vector<HTexture> used = pass.reads;
+            used.insert(used.end(), pass.writes.begin(), pass.writes.end());
+            if (pass.depthWrite)
+                used.emplace_back(pass.depthWrite.value());
+
+            for (const auto& tex : used)
+            {
+                if (lifetimes_out.count(tex) <= 0)
+                    lifetimes_out.emplace(tex, std::make_pair(i, i));
+                else
+                    lifetimes_out[tex].second = i;
+            }
+        }
+
+        // outputs are used outside of the graph (even before the next execution writes them again),
+        // so they live through the whole graph and never share memory
+        for (const auto& tex : mOutputs)
+            lifetimes_out[tex] = std::make_pair(0u, static_cast<uint32_t>(mExecutionOrder.size() - 1));
+
+        return Result::eSuccess;
+    }
+
+    void RenderGraph::clear()
+    {
+        mPasses.clear();
+        mOutputs.clear();
+        mAliased.clear();
+        mExecutionOrder.clear();
+        mCulledPassCount = 0;
+        mTransitionCount = 0;
+    }
+
+    Result RenderGraph::compile(CommandList& commandList_out)
+    {
+        std::vector<CommandList> commandLists;
+        Result result = compile(commandLists);
+        if (Result::eSuccess != result)
+            return result;
+
+        if (commandLists.size() != 1)
+        {
+            std::cerr << "this render graph has per-frame command lists!\n";
+            return Result::eFailure;
+        }
+
+        commandList_out = commandLists.front();
+        return Result::eSuccess;
+    }
+
+    Result RenderGraph::compile(std::vector<CommandList>& commandLists_out)
+    {
+        if (mPasses.empty())
+        {
+            std::cerr << "render graph has no pass!\n";
+            return Result::eFailure;
+        }
+
+        for (const auto& pass : mPasses)
+        {
+            if (pass.commandLists.empty())
+            {
+                std::cerr << "render graph pass has no command list!\n";
+                return Result::eFailure;
+            }
+
+            for (const auto& commandList : pass.commandLists)
+                if (commandList.getQueueType() != mPasses.front().commandLists.front().getQueueType())
+                {
+                    std::cerr << "all passes in a render graph must have the same queue type!\n";
+                    return Result::eFailure;
+                }
+        }
+
+        Result result = sortPasses();
+        if (Result::eSuccess != result)
+            return result;
+
+        cullPasses();
+
+        // simulate access of each texture in execution order
+        // a transition is recorded only when the access actually changes
+        std::vector<std::vector<CmdTransition>> transitions(mExecutionOrder.size());
+        std::unordered_map<HTexture, TextureState> states;
+        std::vector<HTexture> firstUsed;
+        mTransitionCount = 0;
+
+        // last access to each aliased memory, the first occupant takes over it from the end of the previous execution
+        std::unordered_map<uint32_t, TextureAccess> aliasedLast;
+        std::vector<std::pair<size_t, size_t>> wrappedDiscards;
+
+        for (size_t i = 0; i < mExecutionOrder.size(); ++i)
+        {
+            const auto& pass = mPasses[mExecutionOrder[i]];
+
+            std::vector<std::pair<HTexture, TextureAccess>> accesses;
+            for (const auto& tex : pass.writes)
+                accesses.emplace_back(tex, getWriteAccess(pass));
+            if (pass.depthWrite)
+                accesses.emplace_back(pass.depthWrite.value(), TextureAccess::eDepthAttachment);
+            for (const auto& tex : pass.reads)
+                if (std::none_of(accesses.begin(), accesses.end(),
+                                 [&tex](const auto& p) { return p.first == tex; }))
+                    accesses.emplace_back(tex, TextureAccess::eShaderRead);
+
+            for (const auto& [tex, access] : accesses)
+            {
+                const auto aliased = mAliased.find(tex);
+                if (aliased != mAliased.end())
+                {
+                    std::optional<TextureAccess> last;
+                    if (aliasedLast.count(aliased->second) > 0)
+                        last = aliasedLast[aliased->second];
+                    aliasedLast[aliased->second] = access;
+
+                    // aliased memory was overwritten by other textures, so it is always discarded here
+                    // (after the last access of the previous occupant)
+                    if (states.count(tex) <= 0)
+                    {
+                        if (!last)
+                            wrappedDiscards.emplace_back(i, transitions[i].size());
+
+                        transitions[i].emplace_back(CmdTransition{tex, TextureAccess::eUndefined, access,
+                                                                  last.value_or(TextureAccess::eUndefined)});
+                        states.emplace(tex, TextureState{access, access, true});
+                        continue;
+                    }
+                }
+
+                if (states.count(tex) <= 0)
+                {
+                    // read-modify-write needs previous contents
+                    const bool write = access != TextureAccess::eShaderRead &&
+                                       std::find(pass.reads.begin(), pass.reads.end(), tex) == pass.reads.end();
+                    states.emplace(tex, TextureState{access, access, write});
+                    firstUsed.emplace_back(tex);
+                    continue;
+                }
+
+                auto& state = states[tex];
+                // storage to storage still needs memory dependency
+                if (state.current != access || access == TextureAccess::eStorage)
+                {
+                    transitions[i].emplace_back(CmdTransition{tex, state.current, access});
+                    state.current = access;
+                }
+            }
+        }
+
+        for (const auto& [pass, index] : wrappedDiscards)
+        {
+            auto& t     = transitions[pass][index];
+            t.discarded = aliasedLast[mAliased[t.handle]];
+        }
+
+        // return each texture from the access at the end of graph to the first one
+        // so that the graph can be executed repeatedly
+        std::vector<CmdTransition> startTransitions;
+        for (const auto& tex : firstUsed)
+        {
+            const auto& state = states[tex];
+            if (state.current == state.first)
+                continue;
+
+            startTransitions.emplace_back(CmdTransition{tex, state.firstIsWrite ? TextureAccess::eUndefined : state.current, state.first});
+        }
+
+        size_t frameCount = 1;
+        for (const auto& index : mExecutionOrder)
+            frameCount = std::max(frameCount, mPasses[index].commandLists.size());
+
+        commandLists_out.clear();
+        commandLists_out.reserve(frameCount);
+        for (size_t frame = 0; frame < frameCount; ++frame)
+        {
+            auto& commandList = commandLists_out.emplace_back(mPasses.front().commandLists.front().getQueueType());
+
+            for (const auto& t : startTransitions)
+                commandList.transition(t.handle, t.src, t.dst);
+
+            for (size_t i = 0; i < mExecutionOrder.size(); ++i)
+            {
+                for (const auto& t : transitions[i])
+                    commandList.transition(t.handle, t.src, t.dst, t.discarded);
+
+                auto& passCommandLists = mPasses[mExecutionOrder[i]].commandLists;
+                commandList.append(passCommandLists[frame % passCommandLists.size()]);
+            }
+        }
+
+        mTransitionCount = static_cast<uint32_t>(startTransitions.size());
+        for (const auto& t : transitions)
+            mTransitionCount += static_cast<uint32_t>(t.size());
+
+        return Result::eSuccess;
+    }
+
+    const std::vector<uint32_t>& RenderGraph::getExecutionOrder() const
+    {
+        return mExecutionOrder;
+    }
+
+    uint32_t RenderGraph::getCulledPassCount() const
+    {
+        return mCulledPassCount;
+    }
+
+    uint32_t RenderGraph::getTransitionCount() const
+    {
+        return mTransitionCount;
+    }
+
+    Result RenderGraph::sortPasses()
+    {
+        const size_t passCount = mPasses.size();
+        std::vector<std::vector<uint32_t>> edges(passCount);
+        std::vector<uint32_t> inDegrees(passCount, 0);
+
+        const auto addEdge = [&](uint32_t from, uint32_t to)
+        {
+            if (from == to || std::find(edges[from].begin(), edges[from].end(), to) != edges[from].end())
+                return;
+            edges[from].emplace_back(to);
+            ++inDegrees[to];
+        };
+
+        {  // writers of each texture (in declaration order)
+            std::unordered_map<HTexture, std::vector<uint32_t>> writers;
+            for (uint32_t i = 0; i < passCount; ++i)
+            {
+                for (const auto& tex : mPasses[i].writes)
+                    writers[tex].emplace_back(i);
+                if (mPasses[i].depthWrite)
+                    writers[mPasses[i].depthWrite.value()].emplace_back(i);
+            }
+
+            for (const auto& [tex, w] : writers)
+                for (size_t i = 1; i < w.size(); ++i)
+                    addEdge(w[i - 1], w[i]);
+
+            // readers see the result of all writers
+            for (uint32_t i = 0; i < passCount; ++i)
+                for (const auto& tex : mPasses[i].reads)
+                {
+                    if (writers.count(tex) <= 0)
+                        continue;
+                    const auto& w = writers[tex];
+                    if (std::find(w.begin(), w.end(), i) != w.end())
+                        continue;
+                    for (const auto& writer : w)
+                        addEdge(writer, i);
+                }
+        }
+
+        // Kahn's algorithm, declaration order is used for tie-breaking
+        std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+        for (uint32_t i = 0; i < passCount; ++i)
+            if (inDegrees[i] == 0)
+                ready.emplace(i);
+
+        mExecutionOrder.clear();
+        mExecutionOrder.reserve(passCount);
+        while (!ready.empty())
+        {
+            const uint32_t now = ready.top();
+            ready.pop();
+            mExecutionOrder.emplace_back(now);
+
+            for (const auto& next : edges[now])
+                if (--inDegrees[next] == 0)
+                    ready.emplace(next);
+        }
+
+        if (mExecutionOrder.size() != passCount)
+        {
+            std::cerr << "render graph has cyclic dependency!\n";
+            return Result::eFailure;
+        }
+
+        return Result::eSuccess;
+    }
+
+    void RenderGraph::cullPasses()
+    {
+        const size_t passCount = mPasses.size();
+        std::vector<bool> alive(passCount, false);
+
+        const auto writes = [this](uint32_t index, const HTexture& tex)
+        {
+            const auto& pass = mPasses[index];
+            return std::find(pass.writes.begin(), pass.writes.end(), tex) != pass.writes.end() ||
+                   (pass.depthWrite && pass.depthWrite.value() == tex);
+        };
+
+        // passes that output outside of the graph
+        bool rootFound = false;
+        for (uint32_t i = 0; i < passCount; ++i)
+        {
+            const auto& pass = mPasses[i];
+            alive[i]         = pass.writes.empty() && !pass.depthWrite;
+            rootFound        = rootFound || alive[i];
+        }
+
+        // only the last writer of each output leaves its contents outside of the graph
+        for (const auto& tex : mOutputs)
+            for (auto itr = mExecutionOrder.rbegin(); itr != mExecutionOrder.rend(); ++itr)
+                if (writes(*itr, tex))
+                {
+                    alive[*itr] = true;
+                    rootFound   = true;
+                    break;
+                }
+
+        if (!rootFound)
+        {
+            mCulledPassCount = 0;
+            return;
+        }
+
+        // walk back from the last pass so that every producer is visited after its consumers
+        for (auto itr = mExecutionOrder.rbegin(); itr != mExecutionOrder.rend(); ++itr)
+        {
+            if (!alive[*itr])
+                continue;
+
+            // only the last writer before the read is needed, earlier ones are overwritten by it
+            // (a writer that also reads the target keeps its own previous writer alive in turn)
+            // depth is tested against the previous contents, so it is always read as well
+            const auto& pass = mPasses[*itr];
+            std::vector<HTexture> needs = pass.reads;
+            if (pass.depthWrite)
+                needs.emplace_back(pass.depthWrite.value());
+
+            for (const auto& tex : needs)
+                for (auto producer = std::next(itr); producer != mExecutionOrder.rend(); ++producer)
+                    if (writes(*producer, tex))
+                    {
+                        alive[*producer] = true;
+                        break;
+                    }
+        }
+
+        std::vector<uint32_t> order;
+        order.reserve(mExecutionOrder.size());
+        for (const auto& index : mExecutionOrder)
+            if (alive[index])
+                order.emplace_back(index);
+
+        mCulledPassCount = static_cast<uint32_t>(mExecutionOrder.size() - order.size());
+        mExecutionOrder  = std::move(order);
+    }
+
+    TextureAccess RenderGraph::getWriteAccess(const RenderGraphPassInfo& pass) const
+    {
+        if (pass.commandLists.front().getQueueType() == QueueType::eCompute)
+            return TextureAccess::eStorage;
+
+        return TextureAccess::eColorAttachment;
+    }
+}
@@ -26,13 +26,27 @@ namespace Cutlass
         mFileData.resize(uint32_t(infile.seekg(0, std::ifstream::end).tellg()));
         infile.seekg(0, std::ifstream::beg).read(mFileData.data(), mFileData.size());
 
+        reflect(entryPoint);
+    }
+
+    void Shader::load(const void* pData, const size_t size, std::string_view name, std::string_view entryPoint)
+    {
+        mPath = std::string(name);
+
+        mFileData.assign(reinterpret_cast<const char*>(pData), reinterpret_cast<const char*>(pData) + size);
+
+        reflect(entryPoint);
+    }
+
+    void Shader::reflect(std::string_view entryPoint)
+    {
         //load shader module
         SpvReflectShaderModule module = {};
         SpvReflectResult result       = spvReflectCreateShaderModule(sizeof(mFileData[0]) * mFileData.size(), mFileData.data(), &module);
         assert(result == SPV_REFLECT_RESULT_SUCCESS);
 
-        std::cout << "loaded shader : " << path << "\n";
-        std::cout << "stage : ";
+        std::cerr << "loaded shader : " << mPath << "\n";
+        std::cerr << "stage : ";
 
         if (strcmp(entryPoint.data(), "") == 0)
             mEntryPoint = std::string(module.entry_point_name);
@@ -42,27 +56,27 @@ namespace Cutlass
         switch (module.shader_stage)
         {
             case SPV_REFLECT_SHADER_STAGE_VERTEX_BIT:
-                std::cout << "VS";
+                std::cerr << "VS";
                 break;
             case SPV_REFLECT_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
-                std::cout << "HS";
+                std::cerr << "HS";
                 break;
             case SPV_REFLECT_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
-                std::cout << "DS";
+                std::cerr << "DS";
                 break;
             case SPV_REFLECT_SHADER_STAGE_GEOMETRY_BIT:
-                std::cout << "GS";
+                std::cerr << "GS";
                 break;
             case SPV_REFLECT_SHADER_STAGE_FRAGMENT_BIT:
-                std::cout << "PS";
+                std::cerr << "PS";
                 break;
             case SPV_REFLECT_SHADER_STAGE_COMPUTE_BIT:
-                std::cout << "CS";
+                std::cerr << "CS";
                 break;
             default:
                 break;
         }
-        std::cout << "\n";
+        std::cerr << "\n";
 
         //get desecriptor set layout
         {
@@ -94,7 +108,9 @@ namespace Cutlass
                         case SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
                             srt = ShaderResourceType::eCombinedTexture;
                             break;
-                        //case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_IMAGE              : ; break;
+                        case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                            srt = ShaderResourceType::eStorageTexture;
+                            break;
                         //case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER       : ; break;
                         //case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER       : ; break;
                         case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
@@ -103,13 +119,31 @@ namespace Cutlass
                         //case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER             : ; break;
                         //case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC     : ; break;
                         //case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC     : ; break;
-                        //case SPV_REFLECT_DESCRIPTOR_TYPE_INPUT_ATTACHMENT           : ; break;
+                        case SPV_REFLECT_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+                            srt = ShaderResourceType::eInputAttachment;
+                            break;
                         //case SPV_REFLECT_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR : ; break;
                         default:
-                            std::cout << "ERROR!\nparam : " << sets[i]->bindings[j]->descriptor_type << "\n";
+                            std::cerr << "ERROR!\nparam : " << sets[i]->bindings[j]->descriptor_type << "\n";
                             break;
                     }
                     mResourceLayoutTable.emplace(std::pair<uint8_t, uint8_t>(sets[i]->set, sets[i]->bindings[j]->binding), srt);
+
+                    //テクスチャの次元(1D, キューブマップ配列などは対応していない)
+                    if (srt == ShaderResourceType::eCombinedTexture || srt == ShaderResourceType::eStorageTexture)
+                    {
+                        const auto& image = sets[i]->bindings[j]->image;
+                        std::optional<Dimension> dimension;
+                        if (image.dim == SpvDim2D)
+                            dimension = image.arrayed ? Dimension::e2DArray : Dimension::e2D;
+                        else if (image.dim == SpvDimCube && !image.arrayed)
+                            dimension = Dimension::eCube;
+                        else if (image.dim == SpvDim3D)
+                            dimension = Dimension::e3D;
+
+                        if (dimension)
+                            mTextureDimensionTable.emplace(std::pair<uint8_t, uint8_t>(sets[i]->set, sets[i]->bindings[j]->binding), dimension.value());
+                    }
                 }
             }
         }
@@ -300,6 +334,11 @@ namespace Cutlass
         return mResourceLayoutTable;
     }
 
+    const std::map<std::pair<uint8_t, uint8_t>, Dimension>& Shader::getTextureDimensionTable() const
+    {
+        return mTextureDimensionTable;
+    }
+
     const std::vector<std::pair<ResourceType, std::optional<std::string>>>& Shader::getInputVariables() const
     {
         return mInputVariables;
@@ -318,6 +357,13 @@ namespace Cutlass
     void ShaderResourceSet::bind(uint8_t binding, const HTexture& handle)
     {
         combinedTextures[binding] = handle;
+        samplers.erase(binding);
+    }
+
+    void ShaderResourceSet::bind(uint8_t binding, const HTexture& handle, const HSampler& sampler)
+    {
+        combinedTextures[binding] = handle;
+        samplers[binding]         = sampler;
     }
 
     const std::map<uint8_t, HBuffer>& ShaderResourceSet::getUniformBuffers() const
@@ -329,4 +375,9 @@ namespace Cutlass
     {
         return combinedTextures;
     }
+
+    const std::map<uint8_t, HSampler>& ShaderResourceSet::getSamplers() const
+    {
+        return samplers;
+    }
 };  // namespace Cutlass
\ No newline at end of file
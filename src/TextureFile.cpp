@@ -0,0 +1,449 @@
+#include "../include/TextureFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace Cutlass
+{
+    namespace
+    {
+        uint32_t readU32(const uint8_t* p)
+        {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        uint64_t readU64(const uint8_t* p)
+        {
+            uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        constexpr uint32_t makeFourCC(const char a, const char b, const char c, const char d)
+        {
+            return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+        }
+
+        // bytes of a 4x4 block (or a texel for uncompressed format)
+        uint32_t getBlockBytes(const ResourceType format)
+        {
+            switch (format)
+            {
+                case ResourceType::eBC1UNorm:
+                case ResourceType::eBC1SRGB:
+                case ResourceType::eBC4UNorm:
+                    return 8;
+                case ResourceType::eBC2UNorm:
+                case ResourceType::eBC2SRGB:
+                case ResourceType::eBC3UNorm:
+                case ResourceType::eBC3SRGB:
+                case ResourceType::eBC5UNorm:
+                case ResourceType::eBC6HUFloat:
+                case ResourceType::eBC7UNorm:
+                case ResourceType::eBC7SRGB:
+                    return 16;
+                case ResourceType::eUNormVec4:
+                    return 4;
+                default:
+                    return 0;
+            }
+        }
+
+        // VkFormat values stored in KTX2 header
+        bool convertKTX2Format(const uint32_t vkFormat, ResourceType& format_out)
+        {
+            switch (vkFormat)
+            {
+                case 37:  // VK_FORMAT_R8G8B8A8_UNORM
+                    format_out = ResourceType::eUNormVec4;
+                    return true;
+                case 133:  // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+                    format_out = ResourceType::eBC1UNorm;
+                    return true;
+                case 134:  // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+                    format_out = ResourceType::eBC1SRGB;
+                    return true;
+                case 135:  // VK_FORMAT_BC2_UNORM_BLOCK
+                    format_out = ResourceType::eBC2UNorm;
+                    return true;
+                case 136:  // VK_FORMAT_BC2_SRGB_BLOCK
+                    format_out = ResourceType::eBC2SRGB;
+                    return true;
+                case 137:  // VK_FORMAT_BC3_UNORM_BLOCK
+                    format_out = ResourceType::eBC3UNorm;
+                    return true;
+                case 138:  // VK_FORMAT_BC3_SRGB_BLOCK
+                    format_out = ResourceType::eBC3SRGB;
+                    return true;
+                case 139:  // VK_FORMAT_BC4_UNORM_BLOCK
+                    format_out = ResourceType::eBC4UNorm;
+                    return true;
+                case 141:  // VK_FORMAT_BC5_UNORM_BLOCK
+                    format_out = ResourceType::eBC5UNorm;
+                    return true;
+                case 143:  // VK_FORMAT_BC6H_UFLOAT_BLOCK
+                    format_out = ResourceType::eBC6HUFloat;
+                    return true;
+                case 145:  // VK_FORMAT_BC7_UNORM_BLOCK
+                    format_out = ResourceType::eBC7UNorm;
+                    return true;
+                case 146:  // VK_FORMAT_BC7_SRGB_BLOCK
+                    format_out = ResourceType::eBC7SRGB;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // DXGI_FORMAT values stored in DX10 extended header
+        bool convertDXGIFormat(const uint32_t dxgiFormat, ResourceType& format_out)
+        {
+            switch (dxgiFormat)
+            {
+                case 28:  // DXGI_FORMAT_R8G8B8A8_UNORM
+                    format_out = ResourceType::eUNormVec4;
+                    return true;
+                case 71:  // DXGI_FORMAT_BC1_UNORM
+                    format_out = ResourceType::eBC1UNorm;
+                    return true;
+                case 72:  // DXGI_FORMAT_BC1_UNORM_SRGB
+                    format_out = ResourceType::eBC1SRGB;
+                    return true;
+                case 74:  // DXGI_FORMAT_BC2_UNORM
+                    format_out = ResourceType::eBC2UNorm;
+                    return true;
+                case 75:  // DXGI_FORMAT_BC2_UNORM_SRGB
+                    format_out = ResourceType::eBC2SRGB;
+                    return true;
+                case 77:  // DXGI_FORMAT_BC3_UNORM
+                    format_out = ResourceType::eBC3UNorm;
+                    return true;
+                case 78:  // DXGI_FORMAT_BC3_UNORM_SRGB
+                    format_out = ResourceType::eBC3SRGB;
+                    return true;
+                case 80:  // DXGI_FORMAT_BC4_UNORM
+                    format_out = ResourceType::eBC4UNorm;
+                    return true;
+                case 83:  // DXGI_FORMAT_BC5_UNORM
+                    format_out = ResourceType::eBC5UNorm;
+                    return true;
+                case 95:  // DXGI_FORMAT_BC6H_UF16
+                    format_out = ResourceType::eBC6HUFloat;
+                    return true;
+                case 98:  // DXGI_FORMAT_BC7_UNORM
+                    format_out = ResourceType::eBC7UNorm;
+                    return true;
+                case 99:  // DXGI_FORMAT_BC7_UNORM_SRGB
+                    format_out = ResourceType::eBC7SRGB;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        const uint8_t ktx2Identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+        constexpr uint32_t ddsMagic      = makeFourCC('D', 'D', 'S', ' ');
+    }
+
+    bool isBlockCompressed(const ResourceType format)
+    {
+        switch (format)
+        {
+            case ResourceType::eBC1UNorm:
+            case ResourceType::eBC1SRGB:
+            case ResourceType::eBC2UNorm:
+            case ResourceType::eBC2SRGB:
+            case ResourceType::eBC3UNorm:
+            case ResourceType::eBC3SRGB:
+            case ResourceType::eBC4UNorm:
+            case ResourceType::eBC5UNorm:
+            case ResourceType::eBC6HUFloat:
+            case ResourceType::eBC7UNorm:
+            case ResourceType::eBC7SRGB:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    size_t getTextureLevelSize(const ResourceType format, const uint32_t width, const uint32_t height)
+    {
+        if (!isBlockCompressed(format))
+            return size_t(width) * height * getBlockBytes(format);
+
+        return size_t((width + 3) / 4) * ((height + 3) / 4) * getBlockBytes(format);
+    }
+
+    Result TextureFile::load(std::string_view path)
+    {
+        mPath = std::string(path);
+
+        std::ifstream infile(mPath, std::ios::binary);
+        if (!infile)
+        {
+            std::cerr << "failed to open texture file : " << path << "\n";
+            return Result::eFailure;
+        }
+
+        std::vector<uint8_t> fileData(size_t(infile.seekg(0, std::ifstream::end).tellg()));
+        infile.seekg(0, std::ifstream::beg).read(reinterpret_cast<char*>(fileData.data()), fileData.size());
+
+        return parse(fileData.data(), fileData.size());
+    }
+
+    Result TextureFile::parse(const void* pData, const size_t size)
+    {
+        mIsLoaded = false;
+        mMipLevels.clear();
+        mData.clear();
+
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(pData);
+        if (!p || size < 4)
+        {
+            std::cerr << "invalid texture file data!\n";
+            return Result::eFailure;
+        }
+
+        Result result = Result::eFailure;
+        if (size >= sizeof(ktx2Identifier) && std::memcmp(p, ktx2Identifier, sizeof(ktx2Identifier)) == 0)
+            result = parseKTX2(p, size);
+        else if (readU32(p) == ddsMagic)
+            result = parseDDS(p, size);
+        else
+            std::cerr << "unknown texture container (only KTX2 and DDS are supported)!\n";
+
+        if (Result::eSuccess != result)
+        {
+            mMipLevels.clear();
+            mData.clear();
+            return result;
+        }
+
+        mIsLoaded = true;
+        return Result::eSuccess;
+    }
+
+    Result TextureFile::parseKTX2(const uint8_t* p, const size_t size)
+    {
+        // identifier(12) + header(36) + index(32)
+        constexpr size_t levelIndexOffset = 80;
+        if (size < levelIndexOffset)
+        {
+            std::cerr << "KTX2 header is broken!\n";
+            return Result::eFailure;
+        }
+
+        const uint32_t vkFormat         = readU32(p + 12);
+        mWidth                          = readU32(p + 20);
+        mHeight                         = readU32(p + 24);
+        const uint32_t depth            = readU32(p + 28);
+        const uint32_t layerCount       = readU32(p + 32);
+        const uint32_t faceCount        = readU32(p + 36);
+        const uint32_t levelCount       = std::max(readU32(p + 40), 1u);
+        const uint32_t supercompression = readU32(p + 44);
+
+        if (!convertKTX2Format(vkFormat, mFormat))
+        {
+            std::cerr << "unsupported KTX2 format : " << vkFormat << "\n";
+            return Result::eFailure;
+        }
+
+        if (supercompression != 0)
+        {
+            std::cerr << "supercompressed KTX2 is not supported!\n";
+            return Result::eFailure;
+        }
+
+        if (mWidth == 0 || mHeight == 0 || depth > 1 || layerCount > 1 || faceCount != 1)
+        {
+            std::cerr << "only 2D KTX2 texture is supported!\n";
+            return Result::eFailure;
+        }
+
+        if (levelCount > getFullMipLevels(mWidth, mHeight))
+        {
+            std::cerr << "KTX2 level count exceeds the full mip chain!\n";
+            return Result::eFailure;
+        }
+
+        if (size < levelIndexOffset + size_t(levelCount) * 24)
+        {
+            std::cerr << "KTX2 level index is broken!\n";
+            return Result::eFailure;
+        }
+
+        // levels are stored from the smallest one, but the index starts from level 0
+        mData.resize(setMipLevels(levelCount));
+        for (uint32_t i = 0; i < levelCount; ++i)
+        {
+            const uint8_t* entry      = p + levelIndexOffset + size_t(i) * 24;
+            const uint64_t byteOffset = readU64(entry);
+            const uint64_t byteLength = readU64(entry + 8);
+
+            if (byteLength < mMipLevels[i].size || byteOffset > size || size - byteOffset < mMipLevels[i].size)
+            {
+                std::cerr << "KTX2 level " << i << " is broken!\n";
+                return Result::eFailure;
+            }
+
+            std::memcpy(mData.data() + mMipLevels[i].offset, p + byteOffset, mMipLevels[i].size);
+        }
+
+        return Result::eSuccess;
+    }
+
+    Result TextureFile::parseDDS(const uint8_t* p, const size_t size)
+    {
+        // magic(4) + DDS_HEADER(124)
+        constexpr size_t headerSize     = 128;
+        constexpr size_t dx10HeaderSize = 20;
+        constexpr uint32_t flagMipCount = 0x20000;
+        constexpr uint32_t pfFourCC     = 0x4;
+        constexpr uint32_t pfRGB        = 0x40;
+        constexpr uint32_t caps2Cubemap = 0x200;
+        constexpr uint32_t caps2Volume  = 0x200000;
+
+        if (size < headerSize || readU32(p + 4) != 124)
+        {
+            std::cerr << "DDS header is broken!\n";
+            return Result::eFailure;
+        }
+
+        const uint32_t flags    = readU32(p + 8);
+        mHeight                 = readU32(p + 12);
+        mWidth                  = readU32(p + 16);
+        const uint32_t mipCount = (flags & flagMipCount) ? std::max(readU32(p + 28), 1u) : 1u;
+        const uint32_t pfFlags  = readU32(p + 80);
+        const uint32_t fourCC   = readU32(p + 84);
+        const uint32_t caps2    = readU32(p + 112);
+
+        if (mWidth == 0 || mHeight == 0 || (caps2 & (caps2Cubemap | caps2Volume)))
+        {
+            std::cerr << "only 2D DDS texture is supported!\n";
+            return Result::eFailure;
+        }
+
+        size_t dataOffset = headerSize;
+        bool supported    = true;
+        if ((pfFlags & pfFourCC) && fourCC == makeFourCC('D', 'X', '1', '0'))
+        {
+            if (size < headerSize + dx10HeaderSize)
+            {
+                std::cerr << "DDS DX10 header is broken!\n";
+                return Result::eFailure;
+            }
+
+            const uint32_t dxgiFormat        = readU32(p + headerSize);
+            const uint32_t resourceDimension = readU32(p + headerSize + 4);
+            const uint32_t arraySize         = readU32(p + headerSize + 12);
+            // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+            if (resourceDimension != 3 || arraySize > 1)
+            {
+                std::cerr << "only 2D DDS texture is supported!\n";
+                return Result::eFailure;
+            }
+
+            supported  = convertDXGIFormat(dxgiFormat, mFormat);
+            dataOffset = headerSize + dx10HeaderSize;
+        }
+        else if (pfFlags & pfFourCC)
+        {
+            if (fourCC == makeFourCC('D', 'X', 'T', '1'))
+                mFormat = ResourceType::eBC1UNorm;
+            else if (fourCC == makeFourCC('D', 'X', 'T', '3'))
+                mFormat = ResourceType::eBC2UNorm;
+            else if (fourCC == makeFourCC('D', 'X', 'T', '5'))
+                mFormat = ResourceType::eBC3UNorm;
+            else if (fourCC == makeFourCC('A', 'T', 'I', '1') || fourCC == makeFourCC('B', 'C', '4', 'U'))
+                mFormat = ResourceType::eBC4UNorm;
+            else if (fourCC == makeFourCC('A', 'T', 'I', '2') || fourCC == makeFourCC('B', 'C', '5', 'U'))
+                mFormat = ResourceType::eBC5UNorm;
+            else
+                supported = false;
+        }
+        else
+        {
+            // only RGBA8 is read as uncompressed
+            supported = (pfFlags & pfRGB) && readU32(p + 88) == 32 &&
+                        readU32(p + 92) == 0x000000ff && readU32(p + 96) == 0x0000ff00 &&
+                        readU32(p + 100) == 0x00ff0000 && readU32(p + 104) == 0xff000000;
+            mFormat = ResourceType::eUNormVec4;
+        }
+
+        if (!supported)
+        {
+            std::cerr << "unsupported DDS format!\n";
+            return Result::eFailure;
+        }
+
+        if (mipCount > getFullMipLevels(mWidth, mHeight))
+        {
+            std::cerr << "DDS mip count exceeds the full mip chain!\n";
+            return Result::eFailure;
+        }
+
+        // levels are packed from level 0
+        const size_t total = setMipLevels(mipCount);
+
+        if (size - dataOffset < total)
+        {
+            std::cerr << "DDS data is shorter than its mip chain!\n";
+            return Result::eFailure;
+        }
+
+        mData.assign(p + dataOffset, p + dataOffset + total);
+
+        return Result::eSuccess;
+    }
+
+    size_t TextureFile::setMipLevels(const uint32_t levelCount)
+    {
+        size_t total = 0;
+        for (uint32_t i = 0; i < levelCount; ++i)
+        {
+            MipLevel level;
+            level.width  = std::max(mWidth >> i, 1u);
+            level.height = std::max(mHeight >> i, 1u);
+            level.offset = total;
+            level.size   = getTextureLevelSize(mFormat, level.width, level.height);
+            total += level.size;
+            mMipLevels.emplace_back(level);
+        }
+
+        return total;
+    }
+
+    bool TextureFile::isLoaded() const
+    {
+        return mIsLoaded;
+    }
+
+    ResourceType TextureFile::getFormat() const
+    {
+        return mFormat;
+    }
+
+    uint32_t TextureFile::getWidth() const
+    {
+        return mWidth;
+    }
+
+    uint32_t TextureFile::getHeight() const
+    {
+        return mHeight;
+    }
+
+    const std::vector<TextureFile::MipLevel>& TextureFile::getMipLevels() const
+    {
+        return mMipLevels;
+    }
+
+    const std::vector<uint8_t>& TextureFile::getData() const
+    {
+        return mData;
+    }
+}
@@ -0,0 +1,148 @@
+#include "../include/Trace.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace Cutlass
+{
+    namespace
+    {
+        // tids of GPU tracks, CPU threads follow them
+        constexpr uint32_t graphicsQueueTID = 1;
+        constexpr uint32_t computeQueueTID  = 2;
+        constexpr uint32_t firstThreadTID   = 10;
+
+        void writeEscaped(std::ofstream& ofs, std::string_view str)
+        {
+            for (const char c : str)
+            {
+                if (c == '"' || c == '\\')
+                    ofs << '\\' << c;
+                else if (static_cast<unsigned char>(c) < 0x20)
+                    ofs << ' ';
+                else
+                    ofs << c;
+            }
+        }
+    }
+
+    Tracer::Tracer()
+        : mEnabled(false)
+        , mOriginNs(0)
+    {
+
+    }
+
+    void Tracer::setEnabled(const bool enable)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (enable && !mEnabled)
+            mOriginNs = now();
+        mEnabled = enable;
+    }
+
+    bool Tracer::isEnabled() const
+    {
+        return mEnabled;
+    }
+
+    uint64_t Tracer::now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void Tracer::addEvent(std::string_view name, const Track track, const uint64_t beginNs, const uint64_t endNs)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (!mEnabled)
+            return;
+
+        uint32_t tid = 0;
+        switch (track)
+        {
+            case Track::eGraphicsQueue:
+                tid = graphicsQueueTID;
+                break;
+            case Track::eComputeQueue:
+                tid = computeQueueTID;
+                break;
+            default:
+            {
+                const auto itr = mThreadIDs.emplace(std::this_thread::get_id(), firstThreadTID + static_cast<uint32_t>(mThreadIDs.size())).first;
+                tid            = itr->second;
+                break;
+            }
+        }
+
+        mEvents.emplace_back(Event{std::string(name), tid, beginNs, endNs});
+    }
+
+    Result Tracer::write(std::string_view path)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        std::ofstream ofs{std::string(path)};
+        if (!ofs)
+        {
+            std::cerr << "failed to open trace file : " << path << "\n";
+            return Result::eFailure;
+        }
+
+        ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+        // track names
+        ofs << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << graphicsQueueTID << ",\"args\":{\"name\":\"GPU graphics queue\"}},\n";
+        ofs << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << computeQueueTID << ",\"args\":{\"name\":\"GPU compute queue\"}}";
+        for (const auto& [id, tid] : mThreadIDs)
+            ofs << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":\"CPU thread " << tid - firstThreadTID << "\"}}";
+
+        // complete events in microseconds from the origin (GPU events may precede it slightly)
+        ofs.precision(3);
+        ofs << std::fixed;
+        for (const auto& e : mEvents)
+        {
+            ofs << ",\n{\"name\":\"";
+            writeEscaped(ofs, e.name);
+            ofs << "\",\"cat\":\"" << (e.tid < firstThreadTID ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.tid
+                << ",\"ts\":" << (static_cast<double>(e.beginNs) - static_cast<double>(mOriginNs)) / 1000.
+                << ",\"dur\":" << (e.endNs > e.beginNs ? e.endNs - e.beginNs : 0) / 1000. << "}";
+        }
+
+        ofs << "\n]}\n";
+
+        if (!ofs)
+        {
+            std::cerr << "failed to write trace file : " << path << "\n";
+            return Result::eFailure;
+        }
+
+        mEvents.clear();
+
+        return Result::eSuccess;
+    }
+
+    void Tracer::clear()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEvents.clear();
+    }
+
+    TraceScope::TraceScope(Tracer& tracer, const char* name)
+        : mTracer(tracer)
+        , mName(name)
+        , mBeginNs(0)
+        , mEnabled(tracer.isEnabled())
+    {
+        if (mEnabled)
+            mBeginNs = Tracer::now();
+    }
+
+    TraceScope::~TraceScope()
+    {
+        if (mEnabled)
+            mTracer.addEvent(mName, Tracer::Track::eCPU, mBeginNs, Tracer::now());
+    }
+}